@@ -7,74 +7,18 @@
 #include <stdio.h>
 #include <stdbool.h>
 
-#define USE_DPORT = 1;
+#include "dsp48e1.h"
+#include "dsp48e1_probes.h"
 
-typedef struct dsp48e1_output_t
-{
-    int64_t p; // 48-bits
-    int64_t pcout; // 48-bits
-
-    int32_t acout; // 30-bits
-    int32_t bcout; // 18-bits
-
-    int8_t carryout; // 4-bit
-    bool carrycascout; // 1-bit
-    bool multsignout; // 1-bit
-
-    bool patterndetect; // 1-bit
-    bool patternbdetect; // 1-bit
-
-    bool overflow; // 1-bit
-    bool underflow; // 1-bit
-} dsp48e1_output_t;
+// Wrap a value to the 48-bit P/C/PCIN width and sign-extend it to int64
+static inline int64_t sign_extend_48(int64_t value) {
+    return (int64_t)((uint64_t)value << 16) >> 16;
+}
 
-typedef struct dsp48e1_input_t
-{
-    int32_t a; // 30-bits
-    int32_t b; // 18-bits
-    int64_t c; // 48-bits
-    int32_t d; // 25-bits
-
-    int8_t opmode; // 7-bits
-    int8_t alumode; // 4-bits
-    bool carryin; // 1-bit
-    int8_t carryinsel; // 3-bits
-    int8_t inmode; // 5-bits
-
-    bool cea_1; // 1-bit
-    bool cea_2; // 1-bit
-    bool ceb_1; // 1-bit
-    bool ceb_2; // 1-bit
-    bool cec; // 1-bit
-    bool ced; // 1-bit
-    bool cem; // 1-bit
-    bool cep; // 1-bit
-    bool cead; // 1-bit
-
-    bool cealumode; // 1-bit
-    bool cectrl; // 1-bit
-    bool cecarryin; // 1-bit
-    bool ceinmode; // 1-bit
-
-    bool rsta; // 1-bit
-    bool rstb; // 1-bit
-    bool rstc; // 1-bit
-    bool rstd; // 1-bit
-    bool rstm; // 1-bit
-    bool rstp; // 1-bit
-    bool rstctrl; // 1-bit
-    bool rstallcarryin; // 1-bit
-    bool rstaluinmode; // 1-bit
-    bool rstinmode; // 1-bit
-
-    bool clk; // 1-bit
-
-    int32_t acin; // 30-bits
-    int32_t bcin; // 18-bits
-    int64_t pcin; // 48-bits
-    bool carrycascin; // 1-bit
-    bool multsignin; // 1-bit
-} dsp48e1_input_t;
+// Sign-extend the low width bits of a port value
+static inline int32_t sign_extend_32(int32_t value, int width) {
+    return (int32_t)((uint32_t)value << (32 - width)) >> (32 - width);
+}
 
 int32_t a_select(int32_t a1, int32_t a2, int8_t inmode) {
     // A input selection based on INMODE
@@ -131,7 +75,11 @@ int32_t pre_adder(int32_t a1, int32_t a2, int32_t d, int8_t inmode) {
     int32_t d_input;
     int32_t preadder_output;   
 
-    #ifndef USE_DPORT
+    #if !DSP48E1_USE_DPORT
+        (void)a_input;
+        (void)d_input;
+        (void)inmode2;
+        (void)inmode3;
         preadder_output = a_select(a1, a2, inmode);
     #else
         a_input = a_select(a1, a2, inmode);
@@ -155,7 +103,8 @@ int64_t multiplier_y(int32_t a, int32_t b) {
     // Multiplier functionality
     // Assume that the inputs are already masked and sign-extended appropriately
 
-    int64_t m = (int64_t)a * (int64_t) (b & 0x3FE00);
+    // Upper partial product keeps the sign bits of B so that x + y == a * b
+    int64_t m = (int64_t)a * (int64_t) (b & ~0x1FF);
 
     return m;
 }
@@ -170,8 +119,8 @@ int64_t x_mux(int64_t m, int64_t p, int32_t a, int32_t b, int8_t opmode) {
 
     int64_t x_output;
 
-    uint64_t mask43 = 0x7FFFFFFFFFFULL; // Lower 43 bits
-    int64_t a_b_concat = ((int64_t)((((((uint64_t)a) << 18) | (uint64_t)b) & mask43) << 20)) >> 20; // Concatenate A and B inputs 
+    // Concatenate A[29:0] and B[17:0] into a 48-bit operand
+    int64_t a_b_concat = sign_extend_48((int64_t)((((uint64_t)a) << 18) | ((uint64_t)b & 0x3FFFF)));
 
     switch (x_control) {
         case 0: // 00
@@ -216,10 +165,10 @@ int64_t y_mux(int64_t m, int64_t c, int8_t opmode) {
                 y_output = 0; // Illegal case, default to 0
             }
             break;
-        case 2: // 10 - Illegal case, default to 0
-            y_output = 0xFFFFFFFFFFFFULL;
+        case 2: // 10 - All ones (48-bit -1)
+            y_output = -1;
             break;
-        case 3: // 11 - Illegal case, default to 0
+        case 3: // 11
             y_output = c;
             break;
     }
@@ -255,11 +204,11 @@ int64_t z_mux(int64_t pcin, int64_t p, int64_t c, int8_t opmode) {
         case 4: // 100
             z_output = ((y_control == 2) & (x_control == 0)) ? p : 0;
             break;
-        case 5: // 101
-            z_output = pcin << 17;
+        case 5: // 101 - 17-bit arithmetic right shift for wide multiplies
+            z_output = sign_extend_48(pcin) >> 17;
             break;
         case 6: // 110
-            z_output = p << 17;
+            z_output = sign_extend_48(p) >> 17;
             break;
         case 7: // 111 
             z_output = 0; // Illegal case, default to 0
@@ -269,9 +218,26 @@ int64_t z_mux(int64_t pcin, int64_t p, int64_t c, int8_t opmode) {
     return z_output;
 }
 
-int64_t stage2(int64_t x, int64_t y, int64_t z, int64_t cin, int8_t alumode, int8_t opmode) {
+// Second stage control decoded into lane masks so that one ALUMODE/OPMODE
+// pair can be applied to many operands without branches:
+// result = op((X ^ invert_x), (Z ^ invert_z)) ^ invert_out, wrapped to 48 bits
+typedef struct dsp48e1_alu48_t
+{
+    uint64_t invert_x;
+    uint64_t invert_z;
+    uint64_t invert_out;
+    uint64_t sel_add;
+    uint64_t sel_and;
+    uint64_t sel_or;
+    uint64_t sel_xor;
+} dsp48e1_alu48_t;
+
+static dsp48e1_alu48_t alu48_decode(int8_t alumode, int8_t opmode) {
     // Stage 2 functionality: Adder/Subtractor/Logic based on ALUMODE
-    // Assume that the inputs are already masked and sign-extended appropriately
+    // ALUMODE[3:2] == 00 selects the adder; otherwise OPMODE[3:2] picks
+    // between the Y = 0 and Y = all-ones variants of the logic unit
+
+    const uint64_t ones = ~(uint64_t)0;
 
     int8_t opmode_y_mask = 0xC; // Bits 2 and 3
     int8_t alumode4_mask = 0xF; // Bits 0 to 3
@@ -281,95 +247,127 @@ int64_t stage2(int64_t x, int64_t y, int64_t z, int64_t cin, int8_t alumode, int
     int8_t alumode4_control = alumode & alumode4_mask;
     int8_t alumode2_control = alumode & alumode2_mask;
 
-    //printf("Stage 2 - x: 0x%lX, y: 0x%lX, z: 0x%lX, cin: 0x%lX, alumode: 0b%04b, opmode_y: 0b%02b\n", x, y, z, cin, alumode4_control, opmode_y_control);
-
-    int64_t result;
-
-    if (opmode_y_control == 1 || opmode_y_control == 3) { // Three input operation
-        if (alumode4_control < 4) { // Three input operation
-            // Arithmetic operations
-            switch (alumode2_control) {
-                case 0: // 00
-                    result = x + y + z + cin;
-                    break;
-                case 1: // 01
-                    result = ~z + x + y + cin;
-                    break;
-                case 2: // 10
-                    result = ~(x + y + z + cin);
-                    break;
-                case 3: // 11
-                    result = z - (x + y + cin);  
-                    break; 
-            }
-        } else {
-            result = 0; // Illegal case
+    dsp48e1_alu48_t ctrl = {0, 0, 0, 0, 0, 0, 0}; // Illegal cases produce 0
+
+    if (alumode4_control < 4) {
+        // Arithmetic operations
+        ctrl.sel_add = ones;
+        switch (alumode2_control) {
+            case 0: // 00: Z + X + Y + CIN
+                break;
+            case 1: // 01: ~Z + X + Y + CIN
+                ctrl.invert_z = ones;
+                break;
+            case 2: // 10: ~(Z + X + Y + CIN)
+                ctrl.invert_out = ones;
+                break;
+            case 3: // 11: Z - (X + Y + CIN) == ~(~Z + X + Y + CIN)
+                ctrl.invert_z = ones;
+                ctrl.invert_out = ones;
+                break;
         }
-    } else { // Two input operation
-        if (opmode_y_control == 0) { // 00
-            switch(alumode4_control) {
-                case 4: // 0100
-                    result = x ^ z; // X XOR Z
-                    break;
-                case 5: // 0101
-                    result = ~(x ^ z); // X XNOR Z
-                    break;
-                case 6: // 0110
-                    result = ~(x ^ z); // X XNOR Z
-                    break;
-                case 7: // 0111
-                    result = x ^ z; // X XOR Z
-                    break;
-                case 12: // 1100
-                    result = x & z; // X AND Z
-                    break;
-                case 13: // 1101
-                    result = x & ~z; // X AND (NOT Z)
-                    break;
-                case 14: // 1110
-                    result = ~(x & z); // X NAND Z
-                    break;
-                case 15: // 1111
-                    result = ~x | z; // (NOT X) OR Z
-                    break;
-                default:
-                    result = 0; // Illegal case
-                    break;
-            }
-        } else if (opmode_y_control == 2) { // 10
-            switch(alumode4_control) {
-                case 4: // 0100
-                    result = ~(x ^ z); // X XNOR Z
-                    break;
-                case 5: // 0101
-                    result = x ^ z; // X XOR Z
-                    break;
-                case 6: // 0110
-                    result = x ^ z; // X XOR Z
-                    break;
-                case 7: // 0111
-                    result = ~(x ^ z); // X XNOR Z
-                    break;
-                case 12: // 1100
-                    result = x | z; // X OR Z
-                    break;
-                case 13: // 1101
-                    result = x | ~z; // X OR (NOT Z)
-                    break;
-                case 14: // 1110
-                    result = ~(x | z); // X NOR Z
-                    break;
-                case 15: // 1111
-                    result = ~x & z; // (NOT X) AND Z
-                    break;
-                default:
-                    result = 0; // Illegal case
-                    break;
-            }
+    } else if (opmode_y_control == 0) { // 00
+        switch (alumode4_control) {
+            case 4: // 0100: X XOR Z
+            case 7: // 0111: X XOR Z
+                ctrl.sel_xor = ones;
+                break;
+            case 5: // 0101: X XNOR Z
+            case 6: // 0110: X XNOR Z
+                ctrl.sel_xor = ones;
+                ctrl.invert_out = ones;
+                break;
+            case 12: // 1100: X AND Z
+                ctrl.sel_and = ones;
+                break;
+            case 13: // 1101: X AND (NOT Z)
+                ctrl.sel_and = ones;
+                ctrl.invert_z = ones;
+                break;
+            case 14: // 1110: X NAND Z
+                ctrl.sel_and = ones;
+                ctrl.invert_out = ones;
+                break;
+            case 15: // 1111: (NOT X) OR Z
+                ctrl.sel_or = ones;
+                ctrl.invert_x = ones;
+                break;
+            default: // Illegal case
+                break;
+        }
+    } else if (opmode_y_control == 2) { // 10
+        switch (alumode4_control) {
+            case 4: // 0100: X XNOR Z
+            case 7: // 0111: X XNOR Z
+                ctrl.sel_xor = ones;
+                ctrl.invert_out = ones;
+                break;
+            case 5: // 0101: X XOR Z
+            case 6: // 0110: X XOR Z
+                ctrl.sel_xor = ones;
+                break;
+            case 12: // 1100: X OR Z
+                ctrl.sel_or = ones;
+                break;
+            case 13: // 1101: X OR (NOT Z)
+                ctrl.sel_or = ones;
+                ctrl.invert_z = ones;
+                break;
+            case 14: // 1110: X NOR Z
+                ctrl.sel_or = ones;
+                ctrl.invert_out = ones;
+                break;
+            case 15: // 1111: (NOT X) AND Z
+                ctrl.sel_and = ones;
+                ctrl.invert_x = ones;
+                break;
+            default: // Illegal case
+                break;
         }
     }
 
-    return result;
+    return ctrl;
+}
+
+static inline int64_t alu48_apply(const dsp48e1_alu48_t *ctrl, int64_t x, int64_t y, int64_t z, int64_t cin) {
+    // Unsigned 64-bit lanes wrap modulo 2^64, so truncating to 48 bits at the
+    // end gives exact modulo-2^48 results for every intermediate sum
+    uint64_t xs = (uint64_t)x ^ ctrl->invert_x;
+    uint64_t zs = (uint64_t)z ^ ctrl->invert_z;
+    uint64_t sum = xs + (uint64_t)y + zs + (uint64_t)cin;
+
+    uint64_t result = (sum & ctrl->sel_add) |
+                      ((xs & zs) & ctrl->sel_and) |
+                      ((xs | zs) & ctrl->sel_or) |
+                      ((xs ^ zs) & ctrl->sel_xor);
+
+    return sign_extend_48((int64_t)(result ^ ctrl->invert_out));
+}
+
+int64_t stage2(int64_t x, int64_t y, int64_t z, int64_t cin, int8_t alumode, int8_t opmode) {
+    // Stage 2 functionality: Adder/Subtractor/Logic based on ALUMODE
+    // Assume that the inputs are already masked and sign-extended appropriately
+    // The result is P[47:0] sign-extended to 64 bits
+
+    //printf("Stage 2 - x: 0x%lX, y: 0x%lX, z: 0x%lX, cin: 0x%lX, alumode: 0b%04b, opmode: 0b%07b\n", x, y, z, cin, alumode, opmode);
+
+    dsp48e1_alu48_t ctrl = alu48_decode(alumode, opmode);
+    return alu48_apply(&ctrl, x, y, z, cin);
+}
+
+void dsp48e1_alu48_batch(const int64_t *x, const int64_t *y, const int64_t *z, const int64_t *cin, size_t n, int8_t alumode, int8_t opmode, int64_t *p) {
+    // Same control word for every lane: decode once, then a straight-line loop
+    const dsp48e1_alu48_t ctrl = alu48_decode(alumode, opmode);
+
+    if (cin) {
+        for (size_t i = 0; i < n; ++i) {
+            p[i] = alu48_apply(&ctrl, x[i], y[i], z[i], cin[i]);
+        }
+    } else {
+        for (size_t i = 0; i < n; ++i) {
+            p[i] = alu48_apply(&ctrl, x[i], y[i], z[i], 0);
+        }
+    }
 }
 
 int64_t carry_select(int8_t carryinsel, bool carryin, bool carrycascin, bool carrycascout, int32_t a, int32_t b, int64_t p, int64_t pcin) {
@@ -381,39 +379,54 @@ int64_t carry_select(int8_t carryinsel, bool carryin, bool carrycascin, bool car
 
     int64_t carryin_output; // 64 bit for compatibility
 
+    bool a_24 = (a & (0x1 << 24)) != 0;
+    bool b_17 = (b & (0x1 << 17)) != 0;
+
     switch(carryinsel_control){
         case 0: // 000
             carryin_output = (int64_t) carryin;
             break;
-        case 1: // 001
-            carryin_output = (int64_t) (~pcin & (0x1 << 47));
+        case 1: // 001 - ~PCIN[47], round PCIN towards infinity
+            carryin_output = (int64_t) ((~(uint64_t)pcin >> 47) & 0x1);
             break;
         case 2: // 010
             carryin_output = (int64_t) carrycascin;
             break;
-        case 3: // 011
-            carryin_output = (int64_t) ~(~pcin & (0x1 << 47));
+        case 3: // 011 - PCIN[47], round PCIN towards zero
+            carryin_output = (int64_t) (((uint64_t)pcin >> 47) & 0x1);
             break;
         case 4: // 100
             carryin_output = (int64_t) carrycascout;
             break;
-        case 5: // 101
-            carryin_output = (int64_t) (~p & (0x1 << 47));
+        case 5: // 101 - ~P[47], round P towards infinity
+            carryin_output = (int64_t) ((~(uint64_t)p >> 47) & 0x1);
             break;
-        case 6: // 110
-            bool a_24 = (a & (0x1ULL << 24)) != 0;
-            bool b_17 = (b & (0x1ULL << 17)) != 0;
-            carryin_output = (int64_t) (a_24 ^ b_17);
+        case 6: // 110 - A[24] XNOR B[17], round A * B
+            carryin_output = (int64_t) !(a_24 ^ b_17);
             break;
-        case 7: // 111
-            carryin_output = (int64_t) ~(~p & (0x1 << 47));
+        case 7: // 111 - P[47], round P towards zero
+            carryin_output = (int64_t) (((uint64_t)p >> 47) & 0x1);
             break;
     }
 
     return carryin_output;
 }
 
-int64_t dsp48e1(int32_t a1, int32_t a2, int32_t b1, int32_t b2, int64_t c, int32_t d, int8_t opmode, int8_t alumode, int8_t inmode, int8_t carryinsel, bool carryin, bool carrycascin) {
+// Values feeding the second stage, shared by the P-only and full-output entries
+typedef struct dsp48e1_datapath_t
+{
+    int32_t a_val; // Selected A (30-bits)
+    int32_t b_val; // Selected B (18-bits)
+    int64_t c_val; // 48-bits
+    int64_t m1; // Multiplier partial product 1
+    int64_t m2; // Multiplier partial product 2
+    int64_t x; // X MUX output
+    int64_t y; // Y MUX output
+    int64_t z; // Z MUX output
+    int64_t cin; // Selected carry-in
+} dsp48e1_datapath_t;
+
+static inline void dsp48e1_datapath(dsp48e1_datapath_t *dp, int32_t a1, int32_t a2, int32_t b1, int32_t b2, int64_t c, int32_t d, int8_t opmode, int8_t inmode, int8_t carryinsel, bool carryin, bool carrycascin) {
     // Core functionality of the DSP48E1 module
     // Inputs:
     // A[29:0] - Input to the multiplier or pre-adder
@@ -435,50 +448,17 @@ int64_t dsp48e1(int32_t a1, int32_t a2, int32_t b1, int32_t b2, int64_t c, int32
     const int C_WIDTH = 48;
     const int D_WIDTH = 25;
 
-    // Mask inputs to correct bit widths
-    int32_t a_mask          = 0x3FFFFFFF; // Lower 30 bits
-    int32_t a_mask_preadder = 0x01FFFFFF; // Lower 25 bits
-    int32_t b_mask          = 0x003FFFFF; // Lower 18 bits
-    int64_t c_mask          = 0x0000FFFFFFFFFFFF; // Lower 48 bits
-    int32_t d_mask          = 0x01FFFFFF; // Lower 25 bits
-
-    int32_t a1_val          = a1 & a_mask;
-    int32_t a1_val_preadder = a1 & a_mask_preadder;
-    int32_t a2_val          = a2 & a_mask;
-    int32_t a2_val_preadder = a2 & a_mask_preadder;
-    int32_t b1_val          = b1 & b_mask;
-    int32_t b2_val          = b2 & b_mask;
-    int64_t c_val           = c & c_mask;
-    int32_t d_val           = d & d_mask;
-
-    // Sign extend to fit the C types
-    // If the sign bit is set, extend the sign via the inverted mask
-    
-    if (a1_val & (1 << (A_WIDTH - 1))) {
-        a1_val |= ~a_mask;
-    }
-    if (a1_val_preadder & (1 << (A_WIDTH_PREADDER - 1))) {
-        a1_val_preadder |= ~a_mask_preadder;
-    }
-    if (a2_val & (1 << (A_WIDTH - 1))) {
-        a2_val |= ~a_mask;
-    }
-    if (a2_val_preadder & (1 << (A_WIDTH_PREADDER - 1))) {
-        a2_val_preadder |= ~a_mask_preadder;
-    }
-    if (b1_val & (1 << (B_WIDTH - 1))) {
-        b1_val |= ~b_mask;
-    }
-    if (b2_val & (1 << (B_WIDTH - 1))) {
-        b2_val |= ~b_mask;
-    }
-    if (c_val & (0x1ULL << (C_WIDTH - 1))) {
-        c_val |= ~c_mask;
-    }
-    if (d_val & (1 << (D_WIDTH - 1))) {
-        d_val |= ~d_mask;
-    }
-    
+    // Keep the low bits of each port and sign-extend them to fit the C types.
+    // Shifting up and back down keeps this branch-free, which matters when
+    // the sign bits of a batch of operands are random.
+    int32_t a1_val          = sign_extend_32(a1, A_WIDTH);
+    int32_t a1_val_preadder = sign_extend_32(a1, A_WIDTH_PREADDER);
+    int32_t a2_val          = sign_extend_32(a2, A_WIDTH);
+    int32_t a2_val_preadder = sign_extend_32(a2, A_WIDTH_PREADDER);
+    int32_t b1_val          = sign_extend_32(b1, B_WIDTH);
+    int32_t b2_val          = sign_extend_32(b2, B_WIDTH);
+    int64_t c_val           = (int64_t)((uint64_t)c << (64 - C_WIDTH)) >> (64 - C_WIDTH);
+    int32_t d_val           = sign_extend_32(d, D_WIDTH);
 
     //printf("A1: 0x%X, A2: 0x%X, B1: 0x%X, B2: 0x%X, C: 0x%lX, D: 0x%X\n", a1_val, a2_val, b1_val, b2_val, c_val, d_val);
 
@@ -509,11 +489,457 @@ int64_t dsp48e1(int32_t a1, int32_t a2, int32_t b1, int32_t b2, int64_t c, int32
 
     //printf("Carry-in selected: 0x%lX\n", cin);
 
+    dp->a_val = a_val;
+    dp->b_val = b_val;
+    dp->c_val = c_val;
+    dp->m1 = multiplier_result_1;
+    dp->m2 = multiplier_result_2;
+    dp->x = mux_x_output;
+    dp->y = mux_y_output;
+    dp->z = mux_z_output;
+    dp->cin = cin;
+}
+
+static inline int8_t alu_carryout(const dsp48e1_datapath_t *dp, int8_t alumode) {
+    // CARRYOUT[3] for ONE48 mode: carry out of bit 47 of the internal adder.
+    // ALUMODE[0] selects the ~Z operand (Z - (X + Y + CIN) is ~(~Z + X + Y + CIN)).
+    // Three 48-bit operands can carry into bits 48 and 49, so any bit above 47
+    // of the exact sum is a carry out, not only bit 48.
+    // Logic operations leave CARRYOUT undefined in hardware; report zero.
+    const uint64_t mask48 = 0xFFFFFFFFFFFFULL;
+
+    uint64_t arithmetic = (uint64_t)((alumode & 0xC) == 0);
+    uint64_t invert_z = (uint64_t)0 - (uint64_t)(alumode & 0x1);
+
+    uint64_t sum = (((uint64_t)dp->z ^ invert_z) & mask48) +
+                   ((uint64_t)dp->x & mask48) +
+                   ((uint64_t)dp->y & mask48) +
+                   ((uint64_t)dp->cin & mask48);
+
+    return (int8_t)(((uint64_t)((sum >> 48) != 0) & arithmetic) << 3);
+}
+
+int64_t dsp48e1(int32_t a1, int32_t a2, int32_t b1, int32_t b2, int64_t c, int32_t d, int8_t opmode, int8_t alumode, int8_t inmode, int8_t carryinsel, bool carryin, bool carrycascin) {
+    dsp48e1_datapath_t dp;
+    dsp48e1_datapath(&dp, a1, a2, b1, b2, c, d, opmode, inmode, carryinsel, carryin, carrycascin);
+
     // Second stage: Adder/Subtractor/Logic
-    int64_t p = stage2(mux_x_output, mux_y_output, mux_z_output, cin, alumode, opmode);
-    
+    int64_t p = stage2(dp.x, dp.y, dp.z, dp.cin, alumode, opmode);
+
+    DSP48E1_PROBE3(slice, opmode, alumode, p);
     return p;
 }
+
+void dsp48e1_batch(const dsp48e1_batch_ports_t *ports, size_t n, int8_t opmode, int8_t alumode, int8_t inmode, int8_t carryinsel, int64_t *p) {
+    // Decode the ALU once; the first stage runs per lane with a fixed control word
+    const dsp48e1_alu48_t ctrl = alu48_decode(alumode, opmode);
+    DSP48E1_PROBE3(slice__batch, n, opmode, alumode);
+
+    for (size_t i = 0; i < n; ++i) {
+        const bool carryin = ports->carryin ? ports->carryin[i] : false;
+        const bool carrycascin = ports->carrycascin ? ports->carrycascin[i] : false;
+
+        dsp48e1_datapath_t dp;
+        dsp48e1_datapath(&dp, ports->a1[i], ports->a2[i], ports->b1[i], ports->b2[i], ports->c[i], ports->d[i], opmode, inmode, carryinsel, carryin, carrycascin);
+        p[i] = alu48_apply(&ctrl, dp.x, dp.y, dp.z, dp.cin);
+    }
+}
+
+void dsp48e1_bind_b(const int32_t *b1, const int32_t *b2, size_t n, int8_t inmode, dsp48e1_bound_b_t *bound) {
+    const int B_WIDTH = 18;
+
+    for (size_t i = 0; i < n; ++i) {
+        int32_t b1_val = sign_extend_32(b1[i], B_WIDTH);
+        int32_t b2_val = b2 ? sign_extend_32(b2[i], B_WIDTH) : b1_val;
+        int32_t b_val = b_select(b1_val, b2_val, inmode);
+
+        bound[i].lo = (int64_t)(b_val & 0x1FF);
+        bound[i].hi = (int64_t)(b_val & ~0x1FF);
+        bound[i].concat = (int64_t)(b_val & 0x3FFFF);
+        bound[i].b = b_val;
+        bound[i].b17 = (b_val >> 17) & 0x1;
+    }
+}
+
+// First-stage control for a stream with bound B, decoded into lane masks
+typedef struct dsp48e1_bound_ctrl_t
+{
+    int32_t zero_a; // INMODE[1]
+    int32_t use_a1; // INMODE[0]
+    int32_t use_d; // INMODE[2], gated by USE_DPORT
+    int32_t sub; // INMODE[3], gated by USE_DPORT
+    uint64_t x_m; // X = M
+    uint64_t x_ab; // X = A:B
+    uint64_t y_m; // Y = M
+    uint64_t y_ones; // Y = all ones
+    uint64_t y_c; // Y = C
+    uint64_t z_c; // Z = C (PCIN and P are zero here)
+    uint64_t cin_one; // CARRYINSEL 001/101 with PCIN = P = 0
+    uint64_t cin_carryin;
+    uint64_t cin_cascin;
+    uint64_t cin_round; // CARRYINSEL 110: A[24] XNOR B[17]
+} dsp48e1_bound_ctrl_t;
+
+static dsp48e1_bound_ctrl_t bound_ctrl_decode(int8_t opmode, int8_t inmode, int8_t carryinsel) {
+    // Mirrors x_mux/y_mux/z_mux/carry_select for PCIN = P = CARRYCASCOUT = 0
+    const uint64_t ones = ~(uint64_t)0;
+    int8_t x_control = opmode & 0x3;
+    int8_t y_control = (opmode & 0xC) >> 2;
+    int8_t z_control = (opmode & 0x70) >> 4;
+    int8_t cin_control = carryinsel & 0x7;
+
+    dsp48e1_bound_ctrl_t ctrl;
+    memset(&ctrl, 0, sizeof(ctrl));
+    ctrl.zero_a = (inmode & 0x2) != 0;
+    ctrl.use_a1 = (inmode & 0x1) != 0;
+    ctrl.use_d = DSP48E1_USE_DPORT && (inmode & 0x4) != 0;
+    ctrl.sub = DSP48E1_USE_DPORT && (inmode & 0x8) != 0;
+
+    ctrl.x_m = (x_control == 1 && y_control == 1) ? ones : 0;
+    ctrl.x_ab = x_control == 3 ? ones : 0;
+    ctrl.y_m = (y_control == 1 && x_control == 1) ? ones : 0;
+    ctrl.y_ones = y_control == 2 ? ones : 0;
+    ctrl.y_c = y_control == 3 ? ones : 0;
+    ctrl.z_c = z_control == 3 ? ones : 0;
+
+    ctrl.cin_carryin = cin_control == 0 ? ones : 0;
+    ctrl.cin_one = (cin_control == 1 || cin_control == 5) ? ones : 0;
+    ctrl.cin_cascin = cin_control == 2 ? ones : 0;
+    ctrl.cin_round = cin_control == 6 ? ones : 0;
+    return ctrl;
+}
+
+// One bound-B stream; callers pass literal flags so that each port
+// combination gets its own loop without per-lane NULL checks
+static inline void bound_b_stream(const dsp48e1_bound_b_t *bound, size_t b_stride, const dsp48e1_batch_ports_t *ports, size_t n, const dsp48e1_bound_ctrl_t *ctrl, const dsp48e1_alu48_t *alu, bool has_c, bool has_d, bool has_carry, int64_t *p) {
+    const int A_WIDTH = 30;
+    const int A_WIDTH_PREADDER = 25;
+    const int C_WIDTH = 48;
+    const int D_WIDTH = 25;
+
+    const int32_t *a = ctrl->use_a1 || !ports->a2 ? ports->a1 : ports->a2;
+    const int32_t a_keep = ctrl->zero_a ? 0 : -1;
+    const int32_t d_keep = ctrl->use_d ? -1 : 0;
+    const int32_t sub = ctrl->sub ? -1 : 0;
+
+    for (size_t i = 0; i < n; ++i) {
+        const dsp48e1_bound_b_t *b = &bound[i * b_stride];
+        int32_t a_val = sign_extend_32(a[i], A_WIDTH) & a_keep;
+        int32_t a_pre = sign_extend_32(a[i], A_WIDTH_PREADDER) & a_keep;
+        int32_t d_val = has_d ? sign_extend_32(ports->d[i], D_WIDTH) & d_keep : 0;
+        int64_t c_val = has_c ? (int64_t)((uint64_t)ports->c[i] << (64 - C_WIDTH)) >> (64 - C_WIDTH) : 0;
+
+        // d - a == d + ~a + 1
+        int32_t pre = d_val + ((a_pre ^ sub) - sub);
+        int64_t m1 = (int64_t)pre * b->lo;
+        int64_t m2 = (int64_t)pre * b->hi;
+        uint64_t ab = (uint64_t)sign_extend_48((int64_t)(((uint64_t)a_val << 18) | (uint64_t)b->concat));
+
+        uint64_t x = ((uint64_t)m1 & ctrl->x_m) | (ab & ctrl->x_ab);
+        uint64_t y = ((uint64_t)m2 & ctrl->y_m) | ctrl->y_ones | ((uint64_t)c_val & ctrl->y_c);
+        uint64_t z = (uint64_t)c_val & ctrl->z_c;
+
+        uint64_t round = (uint64_t)(((a_pre >> 24) & 0x1) == b->b17);
+        uint64_t cin = (1 & ctrl->cin_one) | (round & ctrl->cin_round);
+        if (has_carry) {
+            uint64_t carryin = ports->carryin ? (uint64_t)ports->carryin[i] : 0;
+            uint64_t cascin = ports->carrycascin ? (uint64_t)ports->carrycascin[i] : 0;
+            cin |= (carryin & ctrl->cin_carryin) | (cascin & ctrl->cin_cascin);
+        }
+
+        p[i] = alu48_apply(alu, (int64_t)x, (int64_t)y, (int64_t)z, (int64_t)cin);
+    }
+}
+
+void dsp48e1_bound_b_batch(const dsp48e1_bound_b_t *bound, size_t b_stride, const dsp48e1_batch_ports_t *ports, size_t n, int8_t opmode, int8_t alumode, int8_t inmode, int8_t carryinsel, int64_t *p) {
+    // Both stages are decoded once; the loop only selects with masks
+    const dsp48e1_bound_ctrl_t ctrl = bound_ctrl_decode(opmode, inmode, carryinsel);
+    const dsp48e1_alu48_t alu = alu48_decode(alumode, opmode);
+    DSP48E1_PROBE3(slice__batch, n, opmode, alumode);
+
+    const bool has_c = ports->c != NULL && (ctrl.y_c | ctrl.z_c) != 0;
+    const bool has_d = ports->d != NULL && ctrl.use_d;
+    const bool has_carry = (ports->carryin != NULL && ctrl.cin_carryin) ||
+                           (ports->carrycascin != NULL && ctrl.cin_cascin);
+
+    if (!has_c && !has_d && !has_carry) {
+        // Plain weight-stationary multiply (and logic/A:B forms without C)
+        bound_b_stream(bound, b_stride, ports, n, &ctrl, &alu, false, false, false, p);
+    } else if (has_c && !has_d && !has_carry) {
+        bound_b_stream(bound, b_stride, ports, n, &ctrl, &alu, true, false, false, p);
+    } else {
+        bound_b_stream(bound, b_stride, ports, n, &ctrl, &alu, has_c, has_d, has_carry, p);
+    }
+}
+
+dsp48e1_output_t dsp48e1_full(int32_t a1, int32_t a2, int32_t b1, int32_t b2, int64_t c, int32_t d, int8_t opmode, int8_t alumode, int8_t inmode, int8_t carryinsel, bool carryin, bool carrycascin, const dsp48e1_pattern_t *pattern, const dsp48e1_output_t *prev) {
+    const uint64_t mask48 = 0xFFFFFFFFFFFFULL;
+
+    dsp48e1_datapath_t dp;
+    dsp48e1_datapath(&dp, a1, a2, b1, b2, c, d, opmode, inmode, carryinsel, carryin, carrycascin);
+
+    int64_t p = stage2(dp.x, dp.y, dp.z, dp.cin, alumode, opmode);
+
+    // Pattern detector: every flag below is computed with masks and table lookups only
+    // Without attributes the defaults apply: PATTERN = 0, MASK = 48'h3FFFFFFFFFFF (P[47:46] only)
+    uint64_t pattern_value = 0;
+    uint64_t ignore_mask = DSP48E1_DEFAULT_MASK;
+    if (pattern) {
+        uint64_t use_c = (uint64_t)0 - (uint64_t)pattern->sel_pattern_c;
+        pattern_value = ((uint64_t)dp.c_val & use_c) | ((uint64_t)pattern->pattern & ~use_c);
+
+        const uint64_t masks[4] = {
+            (uint64_t)pattern->mask,        // MASK
+            (uint64_t)dp.c_val,             // C
+            ~(uint64_t)dp.c_val << 1,       // ROUNDING_MODE1
+            ~(uint64_t)dp.c_val << 2        // ROUNDING_MODE2
+        };
+        ignore_mask = masks[pattern->sel_mask & 0x3];
+    }
+
+    uint64_t care = ~ignore_mask & mask48;
+    uint64_t p48 = (uint64_t)p & mask48;
+
+    bool patterndetect = ((p48 ^ pattern_value) & care) == 0;
+    bool patternbdetect = ((p48 ^ ~pattern_value) & care) == 0;
+    bool detect_past = prev ? prev->patterndetect : false;
+    bool detectb_past = prev ? prev->patternbdetect : false;
+    bool neither = !(patterndetect | patternbdetect);
+
+    int8_t carryout = alu_carryout(&dp, alumode);
+
+    dsp48e1_output_t out;
+    out.p = p;
+    out.pcout = p;
+    out.acout = dp.a_val & 0x3FFFFFFF;
+    out.bcout = dp.b_val & 0x0003FFFF;
+    out.carryout = carryout;
+    out.carrycascout = (carryout >> 3) & 0x1;
+    out.multsignout = (dp.m1 + dp.m2) < 0;
+    out.patterndetect = patterndetect;
+    out.patternbdetect = patternbdetect;
+    out.overflow = detect_past & neither;
+    out.underflow = detectb_past & neither;
+
+    return out;
+}
+static uint64_t self_test_next(uint64_t *state) {
+    // xorshift64* generator so the self-test is reproducible everywhere
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+static int64_t reference_wrap_48(__int128 value) {
+    // Reference big-integer reduction: exact value modulo 2^48 in two's complement
+    const __int128 modulus = (__int128)1 << 48;
+    __int128 r = value % modulus;
+    if (r < 0) {
+        r += modulus;
+    }
+    if (r >= modulus / 2) {
+        r -= modulus;
+    }
+    return (int64_t)r;
+}
+
+static int64_t reference_signed(uint64_t value, int width) {
+    // Interpret the low `width` bits of value as a two's complement integer
+    __int128 v = (__int128)(value & ((1ULL << width) - 1));
+    if (v >= ((__int128)1 << (width - 1))) {
+        v -= (__int128)1 << width;
+    }
+    return (int64_t)v;
+}
+
+int dsp48e1_self_test(void) {
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+
+    // A * B + C with every arithmetic ALUMODE against exact integer arithmetic
+    for (int i = 0; i < 100000; ++i) {
+        uint64_t r = self_test_next(&state);
+        int32_t a = (int32_t)self_test_next(&state);
+        int32_t b = (int32_t)self_test_next(&state);
+        int64_t c = (int64_t)self_test_next(&state);
+        int8_t alumode = (int8_t)(r & 0x3);
+        bool carryin = (r >> 2) & 0x1;
+
+        __int128 m = (__int128)reference_signed((uint64_t)a, 25) * reference_signed((uint64_t)b, 18);
+        __int128 cc = reference_signed((uint64_t)c, 48);
+        __int128 s = m + carryin;
+        __int128 expected;
+        switch (alumode) {
+            case 0: expected = cc + s; break;
+            case 1: expected = -cc - 1 + s; break;
+            case 2: expected = -(cc + s) - 1; break;
+            default: expected = cc - s; break;
+        }
+
+        int64_t p = dsp48e1(a, a, b, b, c, 0, 0b0110101, alumode, 0b00000, 0b000, carryin, false);
+        if (p != reference_wrap_48(expected)) {
+            return -1;
+        }
+
+        // A:B + C through the X/Y MUX concatenation path
+        __int128 ab = reference_signed(((uint64_t)a << 18) | ((uint64_t)b & 0x3FFFF), 48);
+        p = dsp48e1(a, a, b, b, c, 0, 0b0001111, 0b0000, 0b00000, 0b000, false, false);
+        if (p != reference_wrap_48(ab + cc)) {
+            return -1;
+        }
+    }
+
+    // Long accumulation through C = P that overflows 48 bits many times
+    __int128 exact = 0;
+    int64_t acc = 0;
+    for (int i = 0; i < 100000; ++i) {
+        int32_t a = (int32_t)reference_signed(self_test_next(&state), 25);
+        int32_t b = (int32_t)reference_signed(self_test_next(&state), 18);
+        exact += (__int128)a * b;
+        acc = dsp48e1(a, a, b, b, acc, 0, 0b0110101, 0b0000, 0b00000, 0b000, false, false);
+        if (acc != reference_wrap_48(exact)) {
+            return -1;
+        }
+    }
+
+    // Vector lanes must match the scalar second stage for every control word
+    enum { LANES = 64 };
+    int64_t x[LANES], y[LANES], z[LANES], cin[LANES], p[LANES];
+    for (int opmode_y = 0; opmode_y < 4; ++opmode_y) {
+        for (int alumode = 0; alumode < 16; ++alumode) {
+            for (int i = 0; i < LANES; ++i) {
+                x[i] = sign_extend_48((int64_t)self_test_next(&state));
+                y[i] = sign_extend_48((int64_t)self_test_next(&state));
+                z[i] = sign_extend_48((int64_t)self_test_next(&state));
+                cin[i] = (int64_t)(self_test_next(&state) & 0x1);
+            }
+            int8_t opmode = (int8_t)(opmode_y << 2);
+            dsp48e1_alu48_batch(x, y, z, cin, LANES, (int8_t)alumode, opmode, p);
+            for (int i = 0; i < LANES; ++i) {
+                if (p[i] != stage2(x[i], y[i], z[i], cin[i], (int8_t)alumode, opmode)) {
+                    return -1;
+                }
+                if (alumode < 4 && p[i] != stage2(x[i], y[i], z[i], cin[i], (int8_t)alumode, 0b0110101)) {
+                    return -1;
+                }
+            }
+        }
+    }
+
+    // Default detector watches P[47:46]: 00 is PATTERNDETECT, 11 is PATTERNBDETECT
+    dsp48e1_output_t prev = dsp48e1_full(0, 0, 5, 5, 0, 0, 0b0001111, 0b0000, 0b00000, 0b000, false, false, NULL, NULL);
+    if (prev.p != 5 || !prev.patterndetect || prev.patternbdetect || prev.overflow || prev.underflow) {
+        return -1;
+    }
+    // 2^46 leaves the 00 pattern after a matching cycle: OVERFLOW
+    dsp48e1_output_t out = dsp48e1_full(0, 0, 0, 0, (int64_t)1 << 46, 0, 0b0001111, 0b0000, 0b00000, 0b000, false, false, NULL, &prev);
+    if (out.patterndetect || out.patternbdetect || !out.overflow || out.underflow) {
+        return -1;
+    }
+    // -2^46 - 1 leaves the 11 pattern after a matching cycle: UNDERFLOW
+    prev = dsp48e1_full(0, 0, 0, 0, -5, 0, 0b0001111, 0b0000, 0b00000, 0b000, false, false, NULL, NULL);
+    out = dsp48e1_full(0, 0, 0, 0, -((int64_t)1 << 46) - 1, 0, 0b0001111, 0b0000, 0b00000, 0b000, false, false, NULL, &prev);
+    if (prev.patterndetect || !prev.patternbdetect || out.overflow || !out.underflow) {
+        return -1;
+    }
+
+    // Explicit attributes: exact match on P, and MASK = C ignoring the C bits
+    const dsp48e1_pattern_t match = {0x1234, 0, false, DSP48E1_SEL_MASK_MASK};
+    out = dsp48e1_full(0, 0, 0x1234, 0x1234, 0, 0, 0b0001111, 0b0000, 0b00000, 0b000, false, false, &match, NULL);
+    if (!out.patterndetect || out.patternbdetect) {
+        return -1;
+    }
+    out = dsp48e1_full(0, 0, 0x1235, 0x1235, 0, 0, 0b0001111, 0b0000, 0b00000, 0b000, false, false, &match, NULL);
+    if (out.patterndetect) {
+        return -1;
+    }
+    const dsp48e1_pattern_t by_c = {0, 0, false, DSP48E1_SEL_MASK_C};
+    out = dsp48e1_full(0, 0, 0, 0, 0xFFFFFFFFFFFFLL, 0, 0b0001100, 0b0000, 0b00000, 0b000, false, false, &by_c, NULL);
+    if (!out.patterndetect || !out.patternbdetect) {
+        return -1;
+    }
+
+    // CARRYOUT[3] is the carry out of bit 47; CARRYCASCOUT mirrors it, logic ops report zero
+    out = dsp48e1_full(0, 0, 1, 1, -1, 0, 0b0001111, 0b0000, 0b00000, 0b000, false, false, NULL, NULL);
+    if (out.p != 0 || out.carryout != 0x8 || !out.carrycascout) {
+        return -1;
+    }
+    out = dsp48e1_full(0, 0, 1, 1, 5, 0, 0b0001111, 0b0000, 0b00000, 0b000, false, false, NULL, NULL);
+    if (out.p != 6 || out.carryout != 0 || out.carrycascout) {
+        return -1;
+    }
+    out = dsp48e1_full(0, 0, 1, 1, -1, 0, 0b0001111, 0b1100, 0b00000, 0b000, false, false, NULL, NULL);
+    if (out.carryout != 0) {
+        return -1;
+    }
+
+    // Three operands summing to exactly 2^49: the carry lands in bit 49, not bit 48
+    // X = A:B = 2, Y = Z = C = -1
+    out = dsp48e1_full(0, 0, 2, 2, -1, 0, 0b0111111, 0b0000, 0b00000, 0b000, false, false, NULL, NULL);
+    if (out.p != 0 || out.carryout != 0x8 || !out.carrycascout) {
+        return -1;
+    }
+    // ~Z + X + Y + CIN with X = A:B = all ones, Y = Z = C = 0, CIN = 1
+    out = dsp48e1_full(0x3FFFFFFF, 0x3FFFFFFF, 0x3FFFF, 0x3FFFF, 0, 0, 0b0111111, 0b0011, 0b00000, 0b000, true, false, NULL, NULL);
+    if (out.carryout != 0x8) {
+        return -1;
+    }
+
+    // P, PCOUT and MULTSIGNOUT agree with the P-only path
+    for (int i = 0; i < 1000; ++i) {
+        int32_t a = (int32_t)self_test_next(&state);
+        int32_t b = (int32_t)self_test_next(&state);
+        int64_t c = (int64_t)self_test_next(&state);
+        out = dsp48e1_full(a, a, b, b, c, 0, 0b0110101, 0b0000, 0b00000, 0b000, false, false, NULL, NULL);
+        int64_t m = reference_signed((uint64_t)a, 25) * reference_signed((uint64_t)b, 18);
+        if (out.p != dsp48e1(a, a, b, b, c, 0, 0b0110101, 0b0000, 0b00000, 0b000, false, false) ||
+            out.pcout != out.p || out.multsignout != (m < 0)) {
+            return -1;
+        }
+    }
+
+    // Bound weights match dsp48e1() per lane and broadcast, including B2 selection and the pre-adder
+    static const int8_t bound_controls[][4] = {
+        {0b0000101, 0b0000, 0b00000, 0},
+        {0b0110101, 0b0011, 0b00000, 0},
+        {0b0110101, 0b0000, 0b10100, 0},
+        {0b0110011, 0b0000, 0b10000, 0},
+        {0b0110101, 0b0000, 0b00000, 6},
+    };
+    int32_t a1[LANES], a2[LANES], b1[LANES], b2[LANES], d[LANES];
+    int64_t c[LANES];
+    bool carryin[LANES];
+    dsp48e1_bound_b_t bound[LANES];
+    for (size_t k = 0; k < sizeof(bound_controls) / sizeof(bound_controls[0]); ++k) {
+        const int8_t *control = bound_controls[k];
+        for (int i = 0; i < LANES; ++i) {
+            a1[i] = (int32_t)reference_signed(self_test_next(&state), 30);
+            a2[i] = (int32_t)reference_signed(self_test_next(&state), 30);
+            b1[i] = (int32_t)reference_signed(self_test_next(&state), 18);
+            b2[i] = (int32_t)reference_signed(self_test_next(&state), 18);
+            d[i] = (int32_t)reference_signed(self_test_next(&state), 25);
+            c[i] = sign_extend_48((int64_t)self_test_next(&state));
+            carryin[i] = (self_test_next(&state) & 1) != 0;
+        }
+        const dsp48e1_batch_ports_t ports = {a1, a2, NULL, NULL, c, d, carryin, NULL};
+        dsp48e1_bind_b(b1, b2, LANES, control[2], bound);
+        for (size_t b_stride = 0; b_stride < 2; ++b_stride) {
+            dsp48e1_bound_b_batch(bound, b_stride, &ports, LANES, control[0], control[1], control[2], control[3], p);
+            for (int i = 0; i < LANES; ++i) {
+                const int w = b_stride ? i : 0;
+                if (p[i] != dsp48e1(a1[i], a2[i], b1[w], b2[w], c[i], d[i], control[0], control[1],
+                                    control[2], control[3], carryin[i], false)) {
+                    return -1;
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
 /*
 int main() {
     // A basic test code to call the dsp48e1 function
@@ -0,0 +1,220 @@
+#ifndef DSP48E1_H
+#define DSP48E1_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file dsp48e1.h
+ *
+ * Bit-level emulation of a single Xilinx DSP48E1 slice.  dsp48e1() is the
+ * P-only fast path; dsp48e1_full() additionally evaluates the pattern
+ * detector, carry and sign outputs of the slice.
+ */
+
+/*
+ * USE_DPORT attribute used by dsp48e1().  The templates in dsp48e1.hpp take
+ * it as a parameter, so it can also be chosen per slice instance.
+ */
+#ifndef DSP48E1_USE_DPORT
+#define DSP48E1_USE_DPORT 1
+#endif
+
+typedef struct dsp48e1_output_t
+{
+    int64_t p; // 48-bits
+    int64_t pcout; // 48-bits
+
+    int32_t acout; // 30-bits
+    int32_t bcout; // 18-bits
+
+    int8_t carryout; // 4-bit
+    bool carrycascout; // 1-bit
+    bool multsignout; // 1-bit
+
+    bool patterndetect; // 1-bit
+    bool patternbdetect; // 1-bit
+
+    bool overflow; // 1-bit
+    bool underflow; // 1-bit
+} dsp48e1_output_t;
+
+typedef struct dsp48e1_input_t
+{
+    int32_t a; // 30-bits
+    int32_t b; // 18-bits
+    int64_t c; // 48-bits
+    int32_t d; // 25-bits
+
+    int8_t opmode; // 7-bits
+    int8_t alumode; // 4-bits
+    bool carryin; // 1-bit
+    int8_t carryinsel; // 3-bits
+    int8_t inmode; // 5-bits
+
+    bool cea_1; // 1-bit
+    bool cea_2; // 1-bit
+    bool ceb_1; // 1-bit
+    bool ceb_2; // 1-bit
+    bool cec; // 1-bit
+    bool ced; // 1-bit
+    bool cem; // 1-bit
+    bool cep; // 1-bit
+    bool cead; // 1-bit
+
+    bool cealumode; // 1-bit
+    bool cectrl; // 1-bit
+    bool cecarryin; // 1-bit
+    bool ceinmode; // 1-bit
+
+    bool rsta; // 1-bit
+    bool rstb; // 1-bit
+    bool rstc; // 1-bit
+    bool rstd; // 1-bit
+    bool rstm; // 1-bit
+    bool rstp; // 1-bit
+    bool rstctrl; // 1-bit
+    bool rstallcarryin; // 1-bit
+    bool rstaluinmode; // 1-bit
+    bool rstinmode; // 1-bit
+
+    bool clk; // 1-bit
+
+    int32_t acin; // 30-bits
+    int32_t bcin; // 18-bits
+    int64_t pcin; // 48-bits
+    bool carrycascin; // 1-bit
+    bool multsignin; // 1-bit
+} dsp48e1_input_t;
+
+/* SEL_MASK attribute values. */
+typedef enum {
+    DSP48E1_SEL_MASK_MASK = 0,
+    DSP48E1_SEL_MASK_C,
+    DSP48E1_SEL_MASK_ROUNDING_MODE1, /* ~C << 1 */
+    DSP48E1_SEL_MASK_ROUNDING_MODE2  /* ~C << 2 */
+} dsp48e1_sel_mask_t;
+
+/* Default MASK attribute: only P[47:46] take part in pattern detection. */
+#define DSP48E1_DEFAULT_MASK 0x3FFFFFFFFFFFULL
+
+/**
+ * Pattern detector attributes (PATTERN, MASK, SEL_PATTERN, SEL_MASK).
+ * A set bit in the mask excludes that bit of P from the comparison.
+ */
+typedef struct dsp48e1_pattern_t
+{
+    int64_t pattern; // 48-bits
+    int64_t mask; // 48-bits
+    bool sel_pattern_c; // SEL_PATTERN = "C"
+    int8_t sel_mask; // dsp48e1_sel_mask_t
+} dsp48e1_pattern_t;
+
+/**
+ * Evaluate the slice and return P only.  This is the hot path used by the
+ * FP32 multiplier and does no pattern/carry work.  P is computed modulo 2^48
+ * and returned sign-extended to 64 bits, as are the C and PCIN operands.
+ */
+int64_t dsp48e1(int32_t a1, int32_t a2, int32_t b1, int32_t b2, int64_t c, int32_t d, int8_t opmode, int8_t alumode, int8_t inmode, int8_t carryinsel, bool carryin, bool carrycascin);
+
+/**
+ * Evaluate the slice and return every output port.
+ *
+ * pattern may be NULL, in which case the primitive's defaults apply:
+ * PATTERN = 0 and MASK = DSP48E1_DEFAULT_MASK, so PATTERNDETECT and
+ * PATTERNBDETECT watch P[47:46] for overflow/underflow detection.  prev holds the previous registered outputs
+ * and is used for the PATTERNDETECTPAST/PATTERNBDETECTPAST terms of
+ * OVERFLOW/UNDERFLOW; pass NULL when there is no history.
+ *
+ * CARRYOUT[3] is the carry out of bit 47 of the ALU adder (ONE48 SIMD mode)
+ * and is zero for logic operations; CARRYCASCOUT mirrors it.
+ */
+dsp48e1_output_t dsp48e1_full(int32_t a1, int32_t a2, int32_t b1, int32_t b2, int64_t c, int32_t d, int8_t opmode, int8_t alumode, int8_t inmode, int8_t carryinsel, bool carryin, bool carrycascin, const dsp48e1_pattern_t *pattern, const dsp48e1_output_t *prev);
+
+/* Signature shared by dsp48e1() and its compile-time specializations. */
+typedef int64_t (*dsp48e1_fn_t)(int32_t a1, int32_t a2, int32_t b1, int32_t b2, int64_t c, int32_t d, int8_t opmode, int8_t alumode, int8_t inmode, int8_t carryinsel, bool carryin, bool carrycascin);
+
+/**
+ * Return an implementation of dsp48e1() specialized for the given control
+ * words (see dsp48e1_shim.cpp for the exported set).  The control arguments
+ * passed to the returned function are ignored.  Configurations without a
+ * specialization return dsp48e1 itself, so the result is never NULL.
+ */
+dsp48e1_fn_t dsp48e1_specialize(int8_t opmode, int8_t alumode, int8_t inmode, int8_t carryinsel);
+
+/**
+ * Apply one ALUMODE/OPMODE second-stage operation to n independent lanes:
+ * p[i] = ALU(x[i], y[i], z[i], cin[i]) wrapped to 48 bits and sign-extended.
+ * The control word is decoded once and the loop is branch-free, so it
+ * vectorizes over 64-bit lanes.  cin may be NULL for a zero carry-in.
+ */
+void dsp48e1_alu48_batch(const int64_t *x, const int64_t *y, const int64_t *z, const int64_t *cin, size_t n, int8_t alumode, int8_t opmode, int64_t *p);
+
+/* Per-lane port arrays for dsp48e1_batch().  carryin/carrycascin may be NULL. */
+typedef struct dsp48e1_batch_ports_t
+{
+    const int32_t *a1;
+    const int32_t *a2;
+    const int32_t *b1;
+    const int32_t *b2;
+    const int64_t *c;
+    const int32_t *d;
+    const bool *carryin;
+    const bool *carrycascin;
+} dsp48e1_batch_ports_t;
+
+/**
+ * Evaluate n independent slices that share one control word:
+ * p[i] = dsp48e1(lane i of ports, opmode, alumode, inmode, carryinsel).
+ * The ALU control is decoded once for the whole batch.
+ */
+void dsp48e1_batch(const dsp48e1_batch_ports_t *ports, size_t n, int8_t opmode, int8_t alumode, int8_t inmode, int8_t carryinsel, int64_t *p);
+
+/*
+ * A B-port value bound once for weight-stationary evaluation: selected by
+ * INMODE[4], sign-extended and split into the multiplier partial-product
+ * operands, so none of that is repeated per A sample.
+ */
+typedef struct dsp48e1_bound_b_t
+{
+    int64_t lo; // B & 0x1FF, the multiplier_x operand
+    int64_t hi; // B & ~0x1FF, the multiplier_y operand
+    int64_t concat; // B[17:0] for the A:B X MUX input
+    int32_t b; // Selected B (18-bits)
+    int32_t b17; // B[17], for CARRYINSEL = 110
+} dsp48e1_bound_b_t;
+
+/**
+ * Bind n B-port values.  b2 may be NULL when both B registers hold the same
+ * value.  Only INMODE[4] is used; the rest of INMODE is applied per sample.
+ */
+void dsp48e1_bind_b(const int32_t *b1, const int32_t *b2, size_t n, int8_t inmode, dsp48e1_bound_b_t *bound);
+
+/**
+ * Stream n A samples against bound B values with one control word:
+ * p[i] = dsp48e1(a1[i], a2[i], B, B, c[i], d[i], ...) where B is bound[i * b_stride].
+ * b_stride = 0 streams every sample through one slice, 1 gives each lane its
+ * own weight.  The b1/b2 ports are ignored; a2 may be NULL (taken as a1) and
+ * c, d, carryin and carrycascin may be NULL (taken as zero).  INMODE[4] must
+ * match the value passed to dsp48e1_bind_b().
+ */
+void dsp48e1_bound_b_batch(const dsp48e1_bound_b_t *bound, size_t b_stride, const dsp48e1_batch_ports_t *ports, size_t n, int8_t opmode, int8_t alumode, int8_t inmode, int8_t carryinsel, int64_t *p);
+
+/**
+ * Differential check of the slice arithmetic (including 48-bit wraparound
+ * over long accumulations) against an exact 128-bit integer reference,
+ * plus the pattern detector, CARRYOUT and cascade outputs of
+ * dsp48e1_full().  Returns 0 when all checks pass.
+ */
+int dsp48e1_self_test(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DSP48E1_H */
@@ -0,0 +1,418 @@
+#ifndef DSP48E1_HPP
+#define DSP48E1_HPP
+
+/**
+ * @file dsp48e1.hpp
+ *
+ * Header-only C++17 layer where the DSP48E1 attributes and the tensor-unit
+ * pipeline latencies are template parameters.  Every instantiation resolves
+ * its MUX, pre-adder, carry and ALU decoding at compile time, leaving only
+ * the arithmetic of the selected configuration in the generated code.
+ *
+ * The results are bit-identical to dsp48e1() and dsp48e1_model_step_fp32().
+ * dsp48e1_shim.cpp exports a set of common instantiations through the C API
+ * (dsp48e1_specialize() and dsp48e1_model_specialize()).
+ */
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "dsp48e1.h"
+#include "dsp48e1_model.h"
+
+namespace dsp48e1_cxx {
+
+namespace detail {
+
+constexpr int64_t sign_extend(int64_t value, int width) {
+    return (int64_t)((uint64_t)value << (64 - width)) >> (64 - width);
+}
+
+// Second stage decoded the same way as alu48_decode() in dsp48e1.c
+struct alu48_ctrl {
+    uint64_t invert_x;
+    uint64_t invert_z;
+    uint64_t invert_out;
+    uint64_t sel_add;
+    uint64_t sel_and;
+    uint64_t sel_or;
+    uint64_t sel_xor;
+};
+
+constexpr alu48_ctrl alu48_decode(int alumode, int opmode) {
+    const uint64_t ones = ~(uint64_t)0;
+    const int y_control = (opmode >> 2) & 0x3;
+    const int alu = alumode & 0xF;
+
+    alu48_ctrl c{0, 0, 0, 0, 0, 0, 0};
+    if (alu < 4) {
+        c.sel_add = ones;
+        c.invert_z = (alu & 0x1) ? ones : 0;
+        c.invert_out = (alu & 0x2) ? ones : 0;
+    } else if (y_control == 0 || y_control == 2) {
+        const bool y_ones = y_control == 2;
+        switch (alu) {
+            case 4: case 7: // XOR / XNOR
+                c.sel_xor = ones;
+                c.invert_out = y_ones ? ones : 0;
+                break;
+            case 5: case 6: // XNOR / XOR
+                c.sel_xor = ones;
+                c.invert_out = y_ones ? 0 : ones;
+                break;
+            case 12: // AND / OR
+                (y_ones ? c.sel_or : c.sel_and) = ones;
+                break;
+            case 13: // X AND ~Z / X OR ~Z
+                (y_ones ? c.sel_or : c.sel_and) = ones;
+                c.invert_z = ones;
+                break;
+            case 14: // NAND / NOR
+                (y_ones ? c.sel_or : c.sel_and) = ones;
+                c.invert_out = ones;
+                break;
+            case 15: // ~X OR Z / ~X AND Z
+                (y_ones ? c.sel_and : c.sel_or) = ones;
+                c.invert_x = ones;
+                break;
+            default:
+                break;
+        }
+    }
+    return c;
+}
+
+} // namespace detail
+
+/**
+ * Combinational slice with OPMODE, ALUMODE, INMODE, CARRYINSEL and USE_DPORT
+ * fixed at compile time.  eval() has the semantics of dsp48e1(); p and pcin
+ * feed the Z MUX and carry-in rounding paths (dsp48e1() ties them to zero).
+ */
+template <int OPMODE, int ALUMODE, int INMODE = 0, int CARRYINSEL = 0, bool USE_DPORT = true>
+struct slice_eval {
+    static constexpr int x_control = OPMODE & 0x3;
+    static constexpr int y_control = (OPMODE >> 2) & 0x3;
+    static constexpr int z_control = (OPMODE >> 4) & 0x7;
+    static constexpr bool inmode0 = (INMODE & 0x1) != 0;
+    static constexpr bool inmode1 = (INMODE & 0x2) != 0;
+    static constexpr bool inmode2 = (INMODE & 0x4) != 0;
+    static constexpr bool inmode3 = (INMODE & 0x8) != 0;
+    static constexpr bool inmode4 = (INMODE & 0x10) != 0;
+    static constexpr detail::alu48_ctrl alu = detail::alu48_decode(ALUMODE, OPMODE);
+
+    static constexpr bool uses_multiplier = x_control == 1 && y_control == 1;
+
+    static inline int64_t eval(int32_t a1, int32_t a2, int32_t b1, int32_t b2,
+                               int64_t c, int32_t d, bool carryin, bool carrycascin,
+                               int64_t p = 0, int64_t pcin = 0) {
+        const int32_t a_pre = (int32_t)detail::sign_extend(inmode1 ? 0 : (inmode0 ? a1 : a2), 25);
+        const int32_t a_val = (int32_t)detail::sign_extend(inmode1 ? 0 : (inmode0 ? a1 : a2), 30);
+        const int32_t b_val = (int32_t)detail::sign_extend(inmode4 ? b1 : b2, 18);
+        const int64_t c_val = detail::sign_extend(c, 48);
+
+        int64_t x = 0;
+        int64_t y = 0;
+        if constexpr (uses_multiplier) {
+            int32_t pre = a_pre;
+            if constexpr (USE_DPORT) {
+                const int32_t d_val = inmode2 ? (int32_t)detail::sign_extend(d, 25) : 0;
+                pre = inmode3 ? d_val - a_pre : d_val + a_pre;
+            }
+            // X + Y carries the full product; the partial product split of
+            // dsp48e1() only matters for CARRYOUT, which eval() does not report
+            x = (int64_t)pre * (int64_t)b_val;
+        } else if constexpr (x_control == 2) {
+            x = p;
+        } else if constexpr (x_control == 3) {
+            x = detail::sign_extend((int64_t)(((uint64_t)a_val << 18) | ((uint64_t)b_val & 0x3FFFF)), 48);
+        }
+
+        if constexpr (y_control == 2) {
+            y = -1;
+        } else if constexpr (y_control == 3) {
+            y = c_val;
+        }
+
+        int64_t z = 0;
+        if constexpr (z_control == 1) {
+            z = pcin;
+        } else if constexpr (z_control == 2) {
+            z = p;
+        } else if constexpr (z_control == 3) {
+            z = c_val;
+        } else if constexpr (z_control == 4) {
+            z = (y_control == 2 && x_control == 0) ? p : 0;
+        } else if constexpr (z_control == 5) {
+            z = detail::sign_extend(pcin, 48) >> 17;
+        } else if constexpr (z_control == 6) {
+            z = detail::sign_extend(p, 48) >> 17;
+        }
+
+        int64_t cin = 0;
+        if constexpr (CARRYINSEL == 0) {
+            cin = carryin;
+        } else if constexpr (CARRYINSEL == 1) {
+            cin = (int64_t)((~(uint64_t)pcin >> 47) & 0x1);
+        } else if constexpr (CARRYINSEL == 2) {
+            cin = carrycascin;
+        } else if constexpr (CARRYINSEL == 3) {
+            cin = (int64_t)(((uint64_t)pcin >> 47) & 0x1);
+        } else if constexpr (CARRYINSEL == 5) {
+            cin = (int64_t)((~(uint64_t)p >> 47) & 0x1);
+        } else if constexpr (CARRYINSEL == 6) {
+            cin = !(((a_pre >> 24) & 0x1) ^ ((b_val >> 17) & 0x1));
+        } else if constexpr (CARRYINSEL == 7) {
+            cin = (int64_t)(((uint64_t)p >> 47) & 0x1);
+        }
+
+        const uint64_t xs = (uint64_t)x ^ alu.invert_x;
+        const uint64_t zs = (uint64_t)z ^ alu.invert_z;
+        uint64_t result = 0;
+        if constexpr (alu.sel_add != 0) {
+            result = xs + (uint64_t)y + zs + (uint64_t)cin;
+        } else if constexpr (alu.sel_and != 0) {
+            result = xs & zs;
+        } else if constexpr (alu.sel_or != 0) {
+            result = xs | zs;
+        } else if constexpr (alu.sel_xor != 0) {
+            result = xs ^ zs;
+        }
+        (void)xs;
+        (void)zs;
+        (void)carryin;
+        (void)carrycascin;
+
+        return detail::sign_extend((int64_t)(result ^ alu.invert_out), 48);
+    }
+};
+
+/**
+ * Clocked slice.  AREG/BREG (0-2) and MREG/PREG (0-1) set the register depth
+ * on each path; a register depth of zero is a wire.  With AREG/BREG = 2 the
+ * A1/B1 and A2/B2 registers are both present and INMODE selects between
+ * them exactly as in dsp48e1(); with a depth of one both taps see the
+ * single register.  The registered P feeds the Z/X MUX P paths.
+ */
+template <int AREG, int BREG, int MREG, int PREG, bool USE_DPORT,
+          int OPMODE, int ALUMODE, int INMODE = 0, int CARRYINSEL = 0>
+class slice {
+    static_assert(AREG >= 0 && AREG <= 2, "AREG must be 0, 1 or 2");
+    static_assert(BREG >= 0 && BREG <= 2, "BREG must be 0, 1 or 2");
+    static_assert(MREG == 0 || MREG == 1, "MREG must be 0 or 1");
+    static_assert(PREG == 0 || PREG == 1, "PREG must be 0 or 1");
+
+    using eval_t = slice_eval<OPMODE, ALUMODE, INMODE, CARRYINSEL, USE_DPORT>;
+
+public:
+    static constexpr int latency = (AREG > BREG ? AREG : BREG) + MREG + PREG;
+
+    /**
+     * Advance one clock with the given port values and return P.  The
+     * returned value is the P register output when PREG = 1, otherwise the
+     * combinational ALU output of this cycle.
+     */
+    int64_t clock(int32_t a, int32_t b, int64_t c, int32_t d, bool carryin, int64_t pcin = 0) {
+        int32_t a1 = a, a2 = a, b1 = b, b2 = b;
+        if constexpr (AREG == 1) {
+            a1 = a2 = a_reg_[0];
+            a_reg_[0] = a;
+        } else if constexpr (AREG == 2) {
+            a1 = a_reg_[0];
+            a2 = a_reg_[1];
+            a_reg_[1] = a_reg_[0];
+            a_reg_[0] = a;
+        }
+        if constexpr (BREG == 1) {
+            b1 = b2 = b_reg_[0];
+            b_reg_[0] = b;
+        } else if constexpr (BREG == 2) {
+            b1 = b_reg_[0];
+            b2 = b_reg_[1];
+            b_reg_[1] = b_reg_[0];
+            b_reg_[0] = b;
+        }
+
+        // With MREG = 1 the operands of the second stage are registered
+        // together with M, so C and CARRYIN stay aligned with the product
+        int64_t p_next;
+        if constexpr (MREG == 1) {
+            p_next = eval_t::eval(m_a1_, m_a2_, m_b1_, m_b2_, m_c_, m_d_, m_cin_, false, p_, pcin);
+            m_a1_ = a1;
+            m_a2_ = a2;
+            m_b1_ = b1;
+            m_b2_ = b2;
+            m_c_ = c;
+            m_d_ = d;
+            m_cin_ = carryin;
+        } else {
+            p_next = eval_t::eval(a1, a2, b1, b2, c, d, carryin, false, p_, pcin);
+        }
+
+        if constexpr (PREG == 1) {
+            const int64_t out = p_;
+            p_ = p_next;
+            return out;
+        } else {
+            return p_next;
+        }
+    }
+
+    int64_t p() const { return p_; }
+
+    void reset() { *this = slice(); }
+
+private:
+    std::array<int32_t, 2> a_reg_{};
+    std::array<int32_t, 2> b_reg_{};
+    int32_t m_a1_ = 0, m_a2_ = 0, m_b1_ = 0, m_b2_ = 0, m_d_ = 0;
+    int64_t m_c_ = 0;
+    bool m_cin_ = false;
+    int64_t p_ = 0;
+};
+
+/**
+ * Shift register of fixed length; a length of zero is a wire.
+ */
+template <typename T, unsigned N>
+struct delay_line {
+    std::array<T, N> slots{};
+
+    T shift(T incoming) {
+        const T outgoing = slots[N - 1];
+        for (unsigned i = N - 1; i > 0; --i) {
+            slots[i] = slots[i - 1];
+        }
+        slots[0] = incoming;
+        return outgoing;
+    }
+};
+
+template <typename T>
+struct delay_line<T, 0> {
+    T shift(T incoming) { return incoming; }
+};
+
+/**
+ * One tensor-unit processing element with compile-time pipeline latencies.
+ * step() has the semantics of dsp48e1_model_step_fp32() for a single
+ * element of a model configured with the same latencies and flags.
+ */
+template <unsigned MUL, unsigned ADD, unsigned ACC, unsigned RND, unsigned SAT,
+          bool ROUNDING = true, bool SATURATION = false>
+class pe {
+public:
+    static constexpr unsigned latency = MUL + ADD + ACC + RND + SAT;
+
+    bool step(bool input_valid, float a, float b, float addend, float *out_value) {
+        const float mul_ready = mul_.shift(a * b);
+        const bool mul_valid = mul_valid_.shift(input_valid);
+
+        const float add_ready = add_.shift(mul_ready + addend);
+        const bool add_valid = add_valid_.shift(mul_valid);
+
+        float accum_input = accumulator_;
+        if (add_valid) {
+            accum_input = accumulator_ + add_ready;
+            accumulator_ = accum_input;
+        }
+        const float accum_ready = accum_.shift(accum_input);
+        const bool accum_valid = accum_valid_.shift(add_valid);
+
+        float round_input = accum_ready;
+        if constexpr (ROUNDING) {
+            if (accum_valid) {
+                round_input = std::nearbyint(accum_ready / 2.0f) * 2.0f;
+            }
+        }
+        const float round_ready = round_.shift(round_input);
+        const bool round_valid = round_valid_.shift(accum_valid);
+
+        float sat_input = round_ready;
+        if constexpr (SATURATION) {
+            if (round_valid) {
+                sat_input = saturate(round_ready);
+            }
+        }
+        const float out_ready = out_.shift(sat_input);
+        const bool out_valid = out_valid_.shift(round_valid);
+
+        if (out_value) {
+            *out_value = out_valid ? out_ready : 0.0f;
+        }
+        return out_valid;
+    }
+
+    float accumulator() const { return accumulator_; }
+
+    /* Preload the accumulator, e.g. with a bias, before the first product. */
+    void preload(float value) { accumulator_ = value; }
+
+private:
+    static float saturate(float value) {
+        const float max = 3.40282346638528859812e+38f;
+        if (!std::isfinite(value)) {
+            return value > 0.0f ? max : -max;
+        }
+        return value;
+    }
+
+    float accumulator_ = 0.0f;
+    delay_line<float, MUL> mul_;
+    delay_line<bool, MUL> mul_valid_;
+    delay_line<float, ADD> add_;
+    delay_line<bool, ADD> add_valid_;
+    delay_line<float, ACC> accum_;
+    delay_line<bool, ACC> accum_valid_;
+    delay_line<float, RND> round_;
+    delay_line<bool, RND> round_valid_;
+    delay_line<float, SAT> out_;
+    delay_line<bool, SAT> out_valid_;
+};
+
+/**
+ * GEMM tile on a grid of PE instances; same contract and results as
+ * dsp48e1_model_gemm_fp32() for a model with matching latencies.  Elements
+ * are independent, so each PE runs its whole k loop and flush back to back.
+ */
+template <typename PE>
+int gemm_tile(size_t rows, size_t cols, size_t depth,
+              const float *lhs, size_t lhs_stride,
+              const float *rhs, size_t rhs_stride,
+              const float *bias,
+              float *dst, size_t dst_stride) {
+    if (!lhs || !rhs || !dst || rows == 0 || cols == 0 || depth == 0 ||
+        lhs_stride < depth || rhs_stride < cols || dst_stride < cols) {
+        return -1;
+    }
+
+    for (size_t row = 0; row < rows; ++row) {
+        const float *lhs_row = lhs + row * lhs_stride;
+        for (size_t col = 0; col < cols; ++col) {
+            PE unit;
+            if (bias) {
+                unit.preload(bias[col]);
+            }
+            float last = 0.0f;
+            float value = 0.0f;
+            for (size_t k = 0; k < depth; ++k) {
+                if (unit.step(true, lhs_row[k], rhs[k * rhs_stride + col], 0.0f, &value)) {
+                    last = value;
+                }
+            }
+            for (unsigned f = 0; f < PE::latency; ++f) {
+                if (unit.step(false, 0.0f, 0.0f, 0.0f, &value)) {
+                    last = value;
+                }
+            }
+            dst[row * dst_stride + col] = last;
+        }
+    }
+    return 0;
+}
+
+} // namespace dsp48e1_cxx
+
+#endif /* DSP48E1_HPP */
@@ -0,0 +1,224 @@
+#include "dsp48e1_batch.h"
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dsp48e1_probes.h"
+
+typedef struct {
+    dsp48e1_model_t *model;
+    dsp48e1_model_t own_model;
+    int owns_model;
+    int pooled;  /* model came from the caller's pool. */
+    const dsp48e1_gemm_desc_t *batch;
+    size_t count;
+    size_t lhs_stride;
+    size_t rhs_stride;
+    size_t dst_stride;
+    int status;
+} batch_worker_t;
+
+static void *batch_worker_main(void *arg) {
+    batch_worker_t *worker = (batch_worker_t *)arg;
+    worker->status = dsp48e1_model_gemm_batch_fp32(worker->model, worker->batch, worker->count,
+                                                   worker->lhs_stride, worker->rhs_stride,
+                                                   worker->dst_stride);
+    return NULL;
+}
+
+int dsp48e1_gemm_batch_parallel(dsp48e1_model_t *model,
+                                const dsp48e1_gemm_desc_t *batch,
+                                size_t count,
+                                size_t lhs_stride,
+                                size_t rhs_stride,
+                                size_t dst_stride,
+                                size_t threads) {
+    return dsp48e1_gemm_batch_pooled(model, NULL, batch, count, lhs_stride, rhs_stride, dst_stride, threads);
+}
+
+int dsp48e1_gemm_batch_pooled(dsp48e1_model_t *model,
+                              dsp48e1_model_pool_t *model_pool,
+                              const dsp48e1_gemm_desc_t *batch,
+                              size_t count,
+                              size_t lhs_stride,
+                              size_t rhs_stride,
+                              size_t dst_stride,
+                              size_t threads) {
+    if (!model || !model->accumulators || (!batch && count > 0)) {
+        return -1;
+    }
+
+    size_t workers = threads == 0 ? 1 : threads;
+    if (workers > count) {
+        workers = count == 0 ? 1 : count;
+    }
+    DSP48E1_PROBE2(batch__dispatch, count, workers);
+    if (workers == 1) {
+        return dsp48e1_model_gemm_batch_fp32(model, batch, count,
+                                             lhs_stride, rhs_stride, dst_stride);
+    }
+
+    batch_worker_t *pool = (batch_worker_t *)calloc(workers, sizeof(batch_worker_t));
+    pthread_t *handles = (pthread_t *)calloc(workers, sizeof(pthread_t));
+    uint8_t *started = (uint8_t *)calloc(workers, sizeof(uint8_t));
+    if (!pool || !handles || !started) {
+        free(pool);
+        free(handles);
+        free(started);
+        return -1;
+    }
+
+    int status = 0;
+    size_t offset = 0;
+    for (size_t w = 0; w < workers; ++w) {
+        batch_worker_t *worker = &pool[w];
+        const size_t chunk = count / workers + (w < count % workers ? 1U : 0U);
+        worker->batch = batch + offset;
+        worker->count = chunk;
+        worker->lhs_stride = lhs_stride;
+        worker->rhs_stride = rhs_stride;
+        worker->dst_stride = dst_stride;
+        worker->status = -1;
+        offset += chunk;
+
+        if (w == 0) {
+            worker->model = model;
+            continue;
+        }
+        worker->model = model_pool ? dsp48e1_model_pool_acquire(model_pool, model->rows, model->cols, model->depth)
+                                   : NULL;
+        worker->pooled = worker->model != NULL;
+        if (!worker->model) {
+            if (dsp48e1_model_init(&worker->own_model, &model->config,
+                                   model->rows, model->cols, model->depth) != 0) {
+                status = -1;
+                break;
+            }
+            worker->owns_model = 1;
+            worker->model = &worker->own_model;
+        }
+        if (pthread_create(&handles[w], NULL, batch_worker_main, worker) != 0) {
+            status = -1;
+            break;
+        }
+        started[w] = 1;
+    }
+
+    if (status == 0) {
+        batch_worker_main(&pool[0]);
+    }
+
+    for (size_t w = 1; w < workers; ++w) {
+        if (started[w]) {
+            pthread_join(handles[w], NULL);
+        }
+    }
+    for (size_t w = 0; w < workers; ++w) {
+        if (status == 0 && pool[w].status != 0) {
+            status = -1;
+        }
+        if (pool[w].owns_model) {
+            dsp48e1_model_free(&pool[w].own_model);
+        }
+        if (pool[w].pooled) {
+            dsp48e1_model_pool_release(model_pool, pool[w].model);
+        }
+    }
+
+    if (status == 0) {
+        /* The chunks model one unit issuing the whole batch back to back. */
+        model->cycle = (uint64_t)count * model->depth + dsp48e1_config_latency(&model->config);
+    }
+
+    free(pool);
+    free(handles);
+    free(started);
+    return status;
+}
+
+int dsp48e1_batch_self_test(void) {
+    enum { ROWS = 3, COLS = 4, K = 6, COUNT = 7 };
+    dsp48e1_config_t config;
+    dsp48e1_default_fp32_config(&config);
+    config.enable_rounding = 0;
+
+    float lhs[COUNT][ROWS * K];
+    float rhs[COUNT][K * COLS];
+    float bias[COUNT][COLS];
+    float expected[COUNT][ROWS * COLS];
+    float actual[COUNT][ROWS * COLS];
+    for (size_t g = 0; g < COUNT; ++g) {
+        for (size_t i = 0; i < ROWS * K; ++i) {
+            lhs[g][i] = (float)((int)((i + g) * 37 % 19) - 9) * 0.375f;
+        }
+        for (size_t i = 0; i < K * COLS; ++i) {
+            rhs[g][i] = (float)((int)((i + 3 * g) * 11 % 23) - 11) * 0.25f;
+        }
+        for (size_t i = 0; i < COLS; ++i) {
+            bias[g][i] = (float)i - (float)g;
+        }
+    }
+
+    dsp48e1_model_t model;
+    if (dsp48e1_model_init(&model, &config, ROWS, COLS, K) != 0) {
+        return -1;
+    }
+
+    int status = 0;
+    for (size_t g = 0; g < COUNT && status == 0; ++g) {
+        status = dsp48e1_model_gemm_fp32(&model, lhs[g], K, rhs[g], COLS, bias[g], expected[g], COLS);
+    }
+
+    /* Every thread count, including more threads than GEMMs, gives the same dst and cycles. */
+    const size_t thread_counts[] = {0, 1, 2, 3, COUNT + 2};
+    const uint64_t cycles = (uint64_t)COUNT * K + dsp48e1_config_latency(&config);
+    for (size_t t = 0; t < sizeof(thread_counts) / sizeof(thread_counts[0]) && status == 0; ++t) {
+        dsp48e1_gemm_desc_t batch[COUNT];
+        memset(actual, 0, sizeof(actual));
+        for (size_t g = 0; g < COUNT; ++g) {
+            batch[g].lhs = lhs[g];
+            batch[g].rhs = rhs[g];
+            batch[g].bias = bias[g];
+            batch[g].dst = actual[g];
+        }
+        if (dsp48e1_gemm_batch_parallel(&model, batch, COUNT, K, COLS, COLS, thread_counts[t]) != 0 ||
+            memcmp(actual, expected, sizeof(actual)) != 0 || model.cycle != cycles) {
+            status = -1;
+        }
+    }
+
+    /* Two pooled workers and one private fallback; every pooled model is returned. */
+    dsp48e1_model_pool_t model_pool;
+    if (status == 0 && dsp48e1_model_pool_init(&model_pool, &config, 2) == 0) {
+        dsp48e1_gemm_desc_t batch[COUNT];
+        memset(actual, 0, sizeof(actual));
+        for (size_t g = 0; g < COUNT; ++g) {
+            batch[g].lhs = lhs[g];
+            batch[g].rhs = rhs[g];
+            batch[g].bias = bias[g];
+            batch[g].dst = actual[g];
+        }
+        if (dsp48e1_gemm_batch_pooled(&model, &model_pool, batch, COUNT, K, COLS, COLS, 4) != 0 ||
+            memcmp(actual, expected, sizeof(actual)) != 0 || model.cycle != cycles) {
+            status = -1;
+        }
+        dsp48e1_model_t *first = dsp48e1_model_pool_acquire(&model_pool, ROWS, COLS, K);
+        dsp48e1_model_t *second = dsp48e1_model_pool_acquire(&model_pool, ROWS, COLS, K);
+        if (!first || !second) {
+            status = -1;
+        }
+        dsp48e1_model_pool_free(&model_pool);
+    } else {
+        status = -1;
+    }
+
+    if (status == 0 && dsp48e1_gemm_batch_parallel(&model, NULL, 1, K, COLS, COLS, 2) == 0) {
+        status = -1;
+    }
+
+    dsp48e1_model_free(&model);
+    return status;
+}
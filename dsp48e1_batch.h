@@ -0,0 +1,69 @@
+#ifndef DSP48E1_BATCH_H
+#define DSP48E1_BATCH_H
+
+#include <stddef.h>
+
+#include "dsp48e1_model.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file dsp48e1_batch.h
+ *
+ * Multithreaded driver for dsp48e1_model_gemm_batch_fp32().  The batch is
+ * split into contiguous chunks, each simulated back to back on its own
+ * model by a worker thread.
+ */
+
+/**
+ * Run a batched GEMM of the model's shape on up to threads worker threads
+ * (0 or 1 runs on the calling thread).  The caller's model simulates the
+ * first chunk; the other workers initialise private models with the same
+ * configuration and shape.
+ *
+ * The threads only speed up the simulation: every dst is identical to the
+ * single-threaded result, and on success model->cycle is set to the
+ * count * depth + latency cycles of issuing the whole batch back to back on
+ * one tensor unit.
+ *
+ * Returns 0 on success or -1 on parameter/allocation/thread errors.
+ */
+int dsp48e1_gemm_batch_parallel(dsp48e1_model_t *model,
+                                const dsp48e1_gemm_desc_t *batch,
+                                size_t count,
+                                size_t lhs_stride,
+                                size_t rhs_stride,
+                                size_t dst_stride,
+                                size_t threads);
+
+/**
+ * dsp48e1_gemm_batch_parallel() drawing the extra workers' models from
+ * model_pool (configured like model; may be NULL), so a caller that runs
+ * many batches does not allocate worker models each time.  A worker for
+ * which the pool has no idle model falls back to a private one.  The
+ * models are released back to the pool before returning.
+ */
+int dsp48e1_gemm_batch_pooled(dsp48e1_model_t *model,
+                              dsp48e1_model_pool_t *model_pool,
+                              const dsp48e1_gemm_desc_t *batch,
+                              size_t count,
+                              size_t lhs_stride,
+                              size_t rhs_stride,
+                              size_t dst_stride,
+                              size_t threads);
+
+/**
+ * Check that every thread count, including more threads than problems,
+ * and a pool smaller than the worker count yield the single-GEMM results
+ * and the back-to-back cycle count.
+ * Returns 0 on success.
+ */
+int dsp48e1_batch_self_test(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DSP48E1_BATCH_H */
@@ -0,0 +1,357 @@
+#include "dsp48e1_bfp.h"
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dsp48e1.h"
+#include "dsp48e1_estimate.h"
+
+enum {
+    BFP_DEFAULT_BLOCK = 32,
+    BFP_DEFAULT_MANTISSA_BITS = 8,
+    BFP_MAX_MANTISSA_BITS = 18, /* Signed width of the B port. */
+    BFP_P_BITS = 47             /* Magnitude bits of the signed P register. */
+};
+
+/* P + M, with the running P fed back through C (the stateless form of Z = P). */
+#define BFP_OPMODE_MACC 0b0110101
+
+static unsigned bfp_ceil_log2(size_t value) {
+    unsigned bits = 0;
+    while (((size_t)1 << bits) < value) {
+        bits++;
+    }
+    return bits;
+}
+
+int dsp48e1_bfp_quantize(const float *src,
+                         size_t stride,
+                         size_t count,
+                         size_t block,
+                         unsigned mantissa_bits,
+                         int32_t *mantissas,
+                         int16_t *exponents) {
+    if (!src || (count > 0 && (!mantissas || !exponents)) || block == 0 ||
+        mantissa_bits < 2 || mantissa_bits > BFP_MAX_MANTISSA_BITS) {
+        return -1;
+    }
+    const double limit = (double)((1 << (mantissa_bits - 1)) - 1);
+
+    for (size_t begin = 0; begin < count; begin += block) {
+        const size_t end = count - begin < block ? count : begin + block;
+
+        /* Largest biased exponent field; zeros and subnormals count as 1. */
+        uint32_t field_max = 1;
+        for (size_t i = begin; i < end; ++i) {
+            uint32_t bits;
+            memcpy(&bits, &src[i * stride], sizeof(bits));
+            const uint32_t field = (bits >> 23) & 0xFF;
+            field_max = field > field_max ? field : field_max;
+        }
+        if (field_max == 0xFF) {
+            return -1;
+        }
+
+        /* |value| < 2^(field_max - 126), so the scaled value stays below 2^(mantissa_bits - 1). */
+        const int lsb = (int)field_max - 126 - (int)(mantissa_bits - 1);
+        const double scale = ldexp(1.0, -lsb);
+        for (size_t i = begin; i < end; ++i) {
+            double m = nearbyint((double)src[i * stride] * scale);
+            m = m > limit ? limit : (m < -limit ? -limit : m);
+            mantissas[i] = (int32_t)m;
+        }
+        exponents[begin / block] = (int16_t)lsb;
+    }
+    return 0;
+}
+
+/* 2^exponent as a double; exponent stays well inside the normal range here. */
+static inline double bfp_pow2(int32_t exponent) {
+    const uint64_t bits = (uint64_t)(exponent + 1023) << 52;
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/* Add one row's block sums to the FP32 outputs: the only normalization per block. */
+static void bfp_normalize(const int64_t *sums, int32_t lhs_exponent, const int16_t *rhs_exponents, size_t cols, float *out) {
+    for (size_t col = 0; col < cols; ++col) {
+        out[col] += (float)((double)sums[col] * bfp_pow2(lhs_exponent + rhs_exponents[col]));
+    }
+}
+
+static void bfp_error(const float *lhs,
+                      size_t lhs_stride,
+                      const float *rhs,
+                      size_t rhs_stride,
+                      size_t k,
+                      const float *bias,
+                      const float *dst,
+                      size_t dst_stride,
+                      size_t rows,
+                      size_t cols,
+                      dsp48e1_bfp_stats_t *stats) {
+    double max_abs = 0.0;
+    double max_ref = 0.0;
+    double sum_sq = 0.0;
+    for (size_t row = 0; row < rows; ++row) {
+        for (size_t col = 0; col < cols; ++col) {
+            float ref = bias ? bias[col] : 0.0f;
+            for (size_t kk = 0; kk < k; ++kk) {
+                ref += lhs[row * lhs_stride + kk] * rhs[kk * rhs_stride + col];
+            }
+            const double error = fabs((double)dst[row * dst_stride + col] - (double)ref);
+            max_abs = error > max_abs ? error : max_abs;
+            max_ref = fabs((double)ref) > max_ref ? fabs((double)ref) : max_ref;
+            sum_sq += error * error;
+        }
+    }
+    stats->max_abs_error = max_abs;
+    stats->rms_error = rows * cols > 0 ? sqrt(sum_sq / (double)(rows * cols)) : 0.0;
+    stats->max_rel_error = max_ref > 0.0 ? max_abs / max_ref : 0.0;
+}
+
+static void bfp_cost(const dsp48e1_config_t *config, size_t rows, size_t cols, size_t k, size_t block, dsp48e1_bfp_stats_t *stats) {
+    const size_t blocks = (k + block - 1) / block;
+    const uint64_t elements = (uint64_t)rows * cols;
+
+    /* A block sum cannot leave P faster than the FP32 adder takes it. */
+    uint64_t issue = 0;
+    for (size_t b = 0; b < blocks; ++b) {
+        const uint64_t length = b + 1 < blocks ? block : k - b * block;
+        issue += length > config->adder_latency ? length : config->adder_latency;
+    }
+    const uint64_t tail = (uint64_t)config->multiplier_latency + 1U + config->rounding_latency + config->adder_latency;
+
+    stats->blocks = blocks;
+    stats->cycles = blocks > 0 ? issue + tail : 0;
+    stats->fp32_cycles = k + dsp48e1_config_latency(config);
+    stats->slices = elements;
+    stats->fp32_slices = elements * dsp48e1_estimate_slices_per_pe(config);
+    stats->normalizations = elements * blocks;
+    stats->fp32_normalizations = elements * k;
+}
+
+int dsp48e1_gemm_bfp(dsp48e1_model_t *model,
+                     const float *lhs,
+                     size_t lhs_stride,
+                     const float *rhs,
+                     size_t rhs_stride,
+                     size_t k,
+                     const float *bias,
+                     float *dst,
+                     size_t dst_stride,
+                     const dsp48e1_bfp_options_t *options,
+                     dsp48e1_bfp_stats_t *stats) {
+    const size_t block = options && options->block ? options->block : BFP_DEFAULT_BLOCK;
+    const unsigned mantissa_bits = options && options->mantissa_bits ? options->mantissa_bits : BFP_DEFAULT_MANTISSA_BITS;
+    const int host_kernel = options ? options->host_kernel : 0;
+
+    if (!model || !lhs || !rhs || !dst || k == 0 ||
+        mantissa_bits < 2 || mantissa_bits > BFP_MAX_MANTISSA_BITS ||
+        2U * (mantissa_bits - 1U) + bfp_ceil_log2(block) > BFP_P_BITS) {
+        return -1;
+    }
+    const size_t rows = model->rows;
+    const size_t cols = model->cols;
+    const size_t blocks = (k + block - 1) / block;
+
+    int32_t *lhs_mantissas = (int32_t *)malloc(sizeof(int32_t) * rows * k);
+    int16_t *lhs_exponents = (int16_t *)malloc(sizeof(int16_t) * rows * blocks);
+    int32_t *rhs_mantissas = (int32_t *)malloc(sizeof(int32_t) * k * cols);  /* k x cols */
+    int16_t *rhs_exponents = (int16_t *)malloc(sizeof(int16_t) * blocks * cols);  /* blocks x cols */
+    int32_t *column = (int32_t *)malloc(sizeof(int32_t) * k);
+    int16_t *column_exponents = (int16_t *)malloc(sizeof(int16_t) * blocks);
+    int64_t *sums = (int64_t *)malloc(sizeof(int64_t) * cols);
+    int32_t *broadcast = (int32_t *)malloc(sizeof(int32_t) * cols);
+    dsp48e1_bound_b_t *bound = host_kernel ? NULL : (dsp48e1_bound_b_t *)malloc(sizeof(dsp48e1_bound_b_t) * k * cols);
+    float *out = (float *)malloc(sizeof(float) * cols);
+    int status = 0;
+
+    if (!lhs_mantissas || !lhs_exponents || !rhs_mantissas || !rhs_exponents || !column ||
+        !column_exponents || !sums || !broadcast || (!host_kernel && !bound) || !out) {
+        status = -1;
+    }
+
+    for (size_t row = 0; status == 0 && row < rows; ++row) {
+        status = dsp48e1_bfp_quantize(lhs + row * lhs_stride, 1, k, block, mantissa_bits,
+                                      lhs_mantissas + row * k, lhs_exponents + row * blocks);
+    }
+    for (size_t col = 0; status == 0 && col < cols; ++col) {
+        status = dsp48e1_bfp_quantize(rhs + col, rhs_stride, k, block, mantissa_bits, column, column_exponents);
+        for (size_t kk = 0; status == 0 && kk < k; ++kk) {
+            rhs_mantissas[kk * cols + col] = column[kk];
+        }
+        for (size_t b = 0; status == 0 && b < blocks; ++b) {
+            rhs_exponents[b * cols + col] = column_exponents[b];
+        }
+    }
+    if (status == 0 && bound) {
+        dsp48e1_bind_b(rhs_mantissas, NULL, k * cols, 0b00000, bound);
+    }
+
+    for (size_t row = 0; status == 0 && row < rows; ++row) {
+        for (size_t col = 0; col < cols; ++col) {
+            out[col] = bias ? bias[col] : 0.0f;
+        }
+        const int32_t *a = lhs_mantissas + row * k;
+
+        for (size_t b = 0; b < blocks; ++b) {
+            const size_t begin = b * block;
+            const size_t end = k - begin < block ? k : begin + block;
+            memset(sums, 0, sizeof(int64_t) * cols);
+
+            if (host_kernel) {
+                for (size_t kk = begin; kk < end; ++kk) {
+                    const int64_t a_value = a[kk];
+                    const int32_t *b_row = rhs_mantissas + kk * cols;
+                    for (size_t col = 0; col < cols; ++col) {
+                        sums[col] += a_value * b_row[col];
+                    }
+                }
+            } else {
+                /* One slice per column: P = P + A * B for every product of the block. */
+                const dsp48e1_batch_ports_t ports = {broadcast, NULL, NULL, NULL, sums, NULL, NULL, NULL};
+                for (size_t kk = begin; kk < end; ++kk) {
+                    for (size_t col = 0; col < cols; ++col) {
+                        broadcast[col] = a[kk];
+                    }
+                    dsp48e1_bound_b_batch(bound + kk * cols, 1, &ports, cols, BFP_OPMODE_MACC, 0b0000, 0b00000, 0b000, sums);
+                }
+            }
+            bfp_normalize(sums, lhs_exponents[row * blocks + b], rhs_exponents + b * cols, cols, out);
+        }
+        memcpy(dst + row * dst_stride, out, sizeof(float) * cols);
+    }
+
+    if (status == 0) {
+        dsp48e1_bfp_stats_t cost;
+        memset(&cost, 0, sizeof(cost));
+        bfp_cost(&model->config, rows, cols, k, block, &cost);
+        model->cycle = cost.cycles;
+        if (stats) {
+            bfp_error(lhs, lhs_stride, rhs, rhs_stride, k, bias, dst, dst_stride, rows, cols, &cost);
+            *stats = cost;
+        }
+    }
+
+    free(lhs_mantissas);
+    free(lhs_exponents);
+    free(rhs_mantissas);
+    free(rhs_exponents);
+    free(column);
+    free(column_exponents);
+    free(sums);
+    free(broadcast);
+    free(bound);
+    free(out);
+    return status;
+}
+
+int dsp48e1_bfp_self_test(void) {
+    enum { ROWS = 3, COLS = 4, K = 37, BLOCK = 8 };
+
+    /* Block exponent from the largest value, ties to even, and clamping at two bits. */
+    const float block[] = {3.0f, 1.5f / 32.0f, 2.5f / 32.0f, -1.5f / 32.0f, 1.5f};
+    int32_t mantissas[5];
+    int16_t exponents[2];
+    if (dsp48e1_bfp_quantize(block, 1, 4, 4, 8, mantissas, exponents) != 0 ||
+        mantissas[0] != 96 || mantissas[1] != 2 || mantissas[2] != 2 || mantissas[3] != -2 || exponents[0] != -5 ||
+        dsp48e1_bfp_quantize(block + 4, 1, 1, 1, 2, mantissas, exponents) != 0 ||
+        mantissas[0] != 1 || exponents[0] != 0) {
+        return -1;
+    }
+    const float inf = INFINITY;
+    if (dsp48e1_bfp_quantize(&inf, 1, 1, 1, 8, mantissas, exponents) == 0 ||
+        dsp48e1_bfp_quantize(block, 1, 4, 4, BFP_MAX_MANTISSA_BITS + 1U, mantissas, exponents) == 0) {
+        return -1;
+    }
+
+    dsp48e1_config_t config;
+    dsp48e1_default_fp32_config(&config);
+    config.enable_rounding = 0;
+    dsp48e1_model_t model;
+    if (dsp48e1_model_init(&model, &config, ROWS, COLS, K) != 0) {
+        return -1;
+    }
+
+    /* Small integers are exact at 8 bits, so BFP must match FP32 exactly. */
+    float lhs[ROWS * K];
+    float rhs[K * COLS];
+    float bias[COLS];
+    float expected[ROWS * COLS];
+    float dst[ROWS * COLS];
+    float host[ROWS * COLS];
+    for (size_t i = 0; i < ROWS * K; ++i) {
+        lhs[i] = (float)((int)(i * 37 % 201) - 100);
+    }
+    for (size_t i = 0; i < K * COLS; ++i) {
+        rhs[i] = (float)((int)(i * 53 % 31) - 15);
+    }
+    for (size_t col = 0; col < COLS; ++col) {
+        bias[col] = (float)col - 1.5f;
+    }
+
+    int status = dsp48e1_model_gemm_fp32(&model, lhs, K, rhs, COLS, bias, expected, COLS);
+    dsp48e1_bfp_options_t options;
+    memset(&options, 0, sizeof(options));
+    options.block = BLOCK;
+    dsp48e1_bfp_stats_t stats;
+    if (status == 0) {
+        status = dsp48e1_gemm_bfp(&model, lhs, K, rhs, COLS, K, bias, dst, COLS, &options, &stats);
+    }
+    const size_t blocks = (K + BLOCK - 1) / BLOCK;
+    if (status != 0 || memcmp(dst, expected, sizeof(dst)) != 0 || stats.max_abs_error != 0.0 ||
+        stats.blocks != blocks || model.cycle != stats.cycles || stats.slices != (uint64_t)ROWS * COLS ||
+        stats.slices >= stats.fp32_slices ||
+        stats.normalizations != (uint64_t)ROWS * COLS * blocks ||
+        stats.fp32_normalizations != (uint64_t)ROWS * COLS * K) {
+        status = -1;
+    }
+
+    /* Fractional operands: both kernels agree bitwise and more bits mean less error. */
+    for (size_t i = 0; i < ROWS * K; ++i) {
+        lhs[i] = ldexpf((float)((int)(i * 7919 % 2001) - 1000), (int)(i % 5) - 12);
+    }
+    for (size_t i = 0; i < K * COLS; ++i) {
+        rhs[i] = (float)((int)(i * 104729 % 3001) - 1500) / 1024.0f;
+    }
+    double previous_error = INFINITY;
+    const unsigned widths[] = {4, 8, 12, BFP_MAX_MANTISSA_BITS};
+    for (size_t w = 0; w < sizeof(widths) / sizeof(widths[0]) && status == 0; ++w) {
+        options.mantissa_bits = widths[w];
+        options.host_kernel = 0;
+        if (dsp48e1_gemm_bfp(&model, lhs, K, rhs, COLS, K, bias, dst, COLS, &options, &stats) != 0) {
+            status = -1;
+            break;
+        }
+        options.host_kernel = 1;
+        if (dsp48e1_gemm_bfp(&model, lhs, K, rhs, COLS, K, bias, host, COLS, &options, NULL) != 0 ||
+            memcmp(dst, host, sizeof(dst)) != 0 || !(stats.max_rel_error < previous_error) ||
+            stats.max_rel_error > ldexp(1.0, 4 - (int)widths[w])) {
+            status = -1;
+        }
+        previous_error = stats.max_rel_error;
+    }
+
+    /* Empty K, a too-wide mantissa and a NaN operand are rejected. */
+    options.mantissa_bits = 0;
+    if (status == 0 && dsp48e1_gemm_bfp(&model, lhs, K, rhs, COLS, 0, bias, dst, COLS, &options, NULL) == 0) {
+        status = -1;
+    }
+    options.mantissa_bits = BFP_MAX_MANTISSA_BITS + 1U;
+    if (status == 0 && dsp48e1_gemm_bfp(&model, lhs, K, rhs, COLS, K, bias, dst, COLS, &options, NULL) == 0) {
+        status = -1;
+    }
+    options.mantissa_bits = 0;
+    lhs[K + 3] = NAN;
+    if (status == 0 && dsp48e1_gemm_bfp(&model, lhs, K, rhs, COLS, K, bias, dst, COLS, &options, NULL) == 0) {
+        status = -1;
+    }
+
+    dsp48e1_model_free(&model);
+    return status;
+}
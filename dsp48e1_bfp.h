@@ -0,0 +1,98 @@
+#ifndef DSP48E1_BFP_H
+#define DSP48E1_BFP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dsp48e1_model.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file dsp48e1_bfp.h
+ *
+ * Block floating point GEMM.  Along K, every block of lhs row values and of
+ * rhs column values shares one exponent, and each value keeps only a signed
+ * integer mantissa.  A processing element then needs one slice: the
+ * mantissa products of a block are summed exactly in the 48-bit P register,
+ * and the block sum is normalized to FP32 and added to the output once per
+ * block instead of once per product.
+ */
+
+typedef struct {
+    size_t block;           /* K values sharing an exponent; 0 = 32. */
+    unsigned mantissa_bits; /* Signed mantissa width, 2..18; 0 = 8. */
+    int host_kernel;        /* Integer MACs on the host instead of emulated slices. */
+} dsp48e1_bfp_options_t;
+
+typedef struct {
+    size_t blocks;                 /* K blocks per output. */
+    uint64_t cycles;               /* Modeled BFP tile cycles. */
+    uint64_t fp32_cycles;          /* The same tile on the FP32 datapath. */
+    uint64_t slices;
+    uint64_t fp32_slices;
+    uint64_t normalizations;       /* Block sums converted to FP32. */
+    uint64_t fp32_normalizations;  /* One per product on the FP32 datapath. */
+    /* Error against a serial FP32 GEMM of the unquantized operands. */
+    double max_abs_error;
+    double rms_error;
+    double max_rel_error;          /* max_abs_error / largest |reference|. */
+} dsp48e1_bfp_stats_t;
+
+/**
+ * Quantize count values src[i * stride] into blocks of block values:
+ * src[i] ~= mantissas[i] * 2^exponents[i / block], with the exponent chosen
+ * from the largest magnitude of the block and mantissas rounded to nearest
+ * even and clamped to mantissa_bits.  Returns -1 for Inf/NaN input or an
+ * invalid width.
+ */
+int dsp48e1_bfp_quantize(const float *src,
+                         size_t stride,
+                         size_t count,
+                         size_t block,
+                         unsigned mantissa_bits,
+                         int32_t *mantissas,
+                         int16_t *exponents);
+
+/**
+ * dst = lhs (rows x k) * rhs (k x cols) + bias on the model's rows x cols
+ * shape with both operands in block floating point.  bias (length cols,
+ * may be NULL) seeds the FP32 output accumulators.  The emulated and host
+ * kernels give bitwise identical results.
+ *
+ * Cycles: operands are taken to arrive already quantized (weights offline,
+ * activations by the producing layer).  Each PE does one MAC per cycle, and
+ * a block sum leaves P at most every adder_latency cycles (the FP32 add of
+ * the previous block sum).  The tail is the multiplier, P register,
+ * normalization (rounding_latency) and adder stages.
+ *
+ * On success model->cycle holds the modeled cycle count and stats (may be
+ * NULL) the breakdown and error.  Returns 0 on success, -1 on invalid
+ * parameters, non-finite operands or allocation failure.
+ */
+int dsp48e1_gemm_bfp(dsp48e1_model_t *model,
+                     const float *lhs,
+                     size_t lhs_stride,
+                     const float *rhs,
+                     size_t rhs_stride,
+                     size_t k,
+                     const float *bias,
+                     float *dst,
+                     size_t dst_stride,
+                     const dsp48e1_bfp_options_t *options,
+                     dsp48e1_bfp_stats_t *stats);
+
+/**
+ * Check quantization rounding and clamping, exact results on integer
+ * operands, kernel agreement and error shrinking with mantissa width.
+ * Returns 0 on success.
+ */
+int dsp48e1_bfp_self_test(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DSP48E1_BFP_H */
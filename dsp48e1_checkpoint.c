@@ -0,0 +1,486 @@
+#define _GNU_SOURCE /* fsync, O_DIRECTORY */
+
+#include "dsp48e1_checkpoint.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#define CHECKPOINT_MAGIC "D48E1CKP"
+#define CHECKPOINT_BYTE_ORDER 0x01020304U
+
+enum { CHECKPOINT_MAX_IOV = 16 };
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t header_size;
+
+    uint32_t format_kind;
+    uint32_t format_total_bits;
+    uint32_t format_exponent_bits;
+    uint32_t format_mantissa_bits;
+    uint32_t format_fractional_bits;
+    uint32_t format_specials;
+    int32_t format_exponent_bias;
+    uint32_t multiplier_latency;
+    uint32_t adder_latency;
+    uint32_t accumulator_latency;
+    uint32_t rounding_latency;
+    uint32_t saturation_latency;
+    uint32_t enable_rounding;
+    uint32_t enable_saturation;
+    uint32_t accum_mode;
+    uint32_t accum_fraction_bits;
+    uint32_t stream_active;
+
+    uint64_t rows;
+    uint64_t cols;
+    uint64_t depth;
+    uint64_t stream_k;
+    uint64_t cycle;
+    uint64_t payload_bytes;
+} checkpoint_header_t;
+
+typedef struct {
+    struct iovec iov[CHECKPOINT_MAX_IOV];
+    int count;
+    size_t bytes;
+} checkpoint_iov_t;
+
+static void checkpoint_add(checkpoint_iov_t *list, void *base, size_t len) {
+    if (len == 0) {
+        return;
+    }
+    list->iov[list->count].iov_base = base;
+    list->iov[list->count].iov_len = len;
+    list->count++;
+    list->bytes += len;
+}
+
+/* Describe every state buffer of the model, in file order. */
+static void checkpoint_describe(const dsp48e1_model_t *model, checkpoint_iov_t *list) {
+    const size_t elements = model->rows * model->cols;
+    const size_t words = model->valid_words;
+
+    checkpoint_add(list, model->accumulators, sizeof(float) * elements);
+    if (model->accum_state) {
+        checkpoint_add(list, model->accum_state, sizeof(int64_t) * elements);
+    }
+    checkpoint_add(list, model->contrib_counts, sizeof(size_t) * elements);
+    checkpoint_add(list, model->output_panel, sizeof(float) * elements);
+
+    float *const stages[] = {model->pipeline_mul, model->pipeline_add, model->pipeline_accum,
+                             model->pipeline_round, model->pipeline_out};
+    uint64_t *const valids[] = {model->pipeline_mul_valid, model->pipeline_add_valid,
+                                model->pipeline_accum_valid, model->pipeline_round_valid,
+                                model->pipeline_out_valid};
+    const size_t spans[] = {model->mul_span, model->add_span, model->accum_span,
+                            model->round_span, model->out_span};
+    for (size_t s = 0; s < 5; ++s) {
+        checkpoint_add(list, stages[s], sizeof(float) * spans[s] * elements);
+        checkpoint_add(list, valids[s], sizeof(uint64_t) * spans[s] * words);
+    }
+}
+
+/*
+ * Check every header field against the range of the model field it is
+ * restored into, and compute the payload size the shape implies, so a
+ * corrupted header is rejected before anything is allocated.
+ */
+static int checkpoint_header_valid(const checkpoint_header_t *header, size_t *payload) {
+    if (header->format_kind > DSP48E1_FORMAT_CUSTOM ||
+        header->format_total_bits > UINT8_MAX || header->format_exponent_bits > UINT8_MAX ||
+        header->format_mantissa_bits > UINT8_MAX || header->format_fractional_bits > UINT8_MAX ||
+        header->format_specials > DSP48E1_SPECIALS_FN ||
+        header->multiplier_latency > UINT8_MAX || header->adder_latency > UINT8_MAX ||
+        header->accumulator_latency > UINT8_MAX || header->rounding_latency > UINT8_MAX ||
+        header->saturation_latency > UINT8_MAX ||
+        header->enable_rounding > 1 || header->enable_saturation > 1 || header->stream_active > 1 ||
+        header->accum_mode > DSP48E1_ACCUM_KAHAN || header->accum_fraction_bits > 47 ||
+        header->rows == 0 || header->cols == 0 || header->depth == 0 ||
+        header->rows > SIZE_MAX || header->cols > SIZE_MAX || header->depth > SIZE_MAX) {
+        return -1;
+    }
+
+    /* Mirrors checkpoint_describe(). */
+    const size_t spans = (size_t)header->multiplier_latency + header->adder_latency +
+                         header->accumulator_latency + header->rounding_latency +
+                         header->saturation_latency;
+    const size_t element_bytes = sizeof(float) * (2 + spans) + sizeof(size_t) +
+                                 (header->accum_mode != DSP48E1_ACCUM_FP32 ? sizeof(int64_t) : 0);
+    size_t elements;
+    size_t volume;
+    size_t value_bytes;
+    size_t valid_bytes;
+    if (__builtin_mul_overflow((size_t)header->rows, (size_t)header->cols, &elements) ||
+        __builtin_mul_overflow(elements, (size_t)header->depth, &volume) ||
+        __builtin_mul_overflow(elements, element_bytes, &value_bytes) ||
+        __builtin_mul_overflow((elements + DSP48E1_MODEL_VALID_BITS - 1) / DSP48E1_MODEL_VALID_BITS,
+                               sizeof(uint64_t) * spans, &valid_bytes) ||
+        __builtin_add_overflow(value_bytes, valid_bytes, payload) ||
+        header->payload_bytes != *payload) {
+        return -1;
+    }
+    return 0;
+}
+
+/* Advance past n bytes already transferred. */
+static void checkpoint_consume(struct iovec **iov, int *count, size_t n) {
+    while (*count > 0 && n >= (*iov)->iov_len) {
+        n -= (*iov)->iov_len;
+        (*iov)++;
+        (*count)--;
+    }
+    if (*count > 0) {
+        (*iov)->iov_base = (char *)(*iov)->iov_base + n;
+        (*iov)->iov_len -= n;
+    }
+}
+
+/*
+ * One writev()/readv() normally moves everything; loop only for the short
+ * transfers the kernel may return on very large buffers.
+ */
+static int checkpoint_transfer(int fd, struct iovec *iov, int count, int writing) {
+    while (count > 0) {
+        const ssize_t n = writing ? writev(fd, iov, count) : readv(fd, iov, count);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        if (n == 0) {
+            return -1;
+        }
+        checkpoint_consume(&iov, &count, (size_t)n);
+    }
+    return 0;
+}
+
+/* Flush the directory entry of path so a completed rename survives a crash. */
+static int checkpoint_sync_parent(const char *path) {
+    const char *slash = strrchr(path, '/');
+    const size_t len = !slash ? 1 : (slash == path ? 1 : (size_t)(slash - path));
+    char *dir = (char *)malloc(len + 1);
+    if (!dir) {
+        return -1;
+    }
+    if (slash) {
+        memcpy(dir, path, len);
+    } else {
+        dir[0] = '.';
+    }
+    dir[len] = '\0';
+
+    int status = -1;
+    const int fd = open(dir, O_RDONLY | O_DIRECTORY);
+    if (fd >= 0) {
+        status = fsync(fd);
+        close(fd);
+    }
+    free(dir);
+    return status == 0 ? 0 : -1;
+}
+
+int dsp48e1_model_checkpoint(const dsp48e1_model_t *model, const char *path) {
+    if (!model || !model->accumulators || !path) {
+        return -1;
+    }
+
+    checkpoint_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+    header.version = DSP48E1_CHECKPOINT_VERSION;
+    header.byte_order = CHECKPOINT_BYTE_ORDER;
+    header.header_size = (uint32_t)sizeof(header);
+
+    const dsp48e1_config_t *cfg = &model->config;
+    header.format_kind = (uint32_t)cfg->format.kind;
+    header.format_total_bits = cfg->format.total_bits;
+    header.format_exponent_bits = cfg->format.exponent_bits;
+    header.format_mantissa_bits = cfg->format.mantissa_bits;
+    header.format_fractional_bits = cfg->format.fractional_bits;
+    header.format_specials = cfg->format.specials;
+    header.format_exponent_bias = cfg->format.exponent_bias;
+    header.multiplier_latency = cfg->multiplier_latency;
+    header.adder_latency = cfg->adder_latency;
+    header.accumulator_latency = cfg->accumulator_latency;
+    header.rounding_latency = cfg->rounding_latency;
+    header.saturation_latency = cfg->saturation_latency;
+    header.enable_rounding = (uint32_t)cfg->enable_rounding;
+    header.enable_saturation = (uint32_t)cfg->enable_saturation;
+    header.accum_mode = (uint32_t)cfg->accum_mode;
+    header.accum_fraction_bits = cfg->accum_fraction_bits;
+    header.stream_active = (uint32_t)model->stream_active;
+    header.rows = model->rows;
+    header.cols = model->cols;
+    header.depth = model->depth;
+    header.stream_k = model->stream_k;
+    header.cycle = model->cycle;
+
+    checkpoint_iov_t list;
+    memset(&list, 0, sizeof(list));
+    checkpoint_add(&list, &header, sizeof(header));
+    checkpoint_describe(model, &list);
+    header.payload_bytes = list.bytes - sizeof(header);
+
+    const size_t path_len = strlen(path);
+    char *tmp_path = (char *)malloc(path_len + 5);
+    if (!tmp_path) {
+        return -1;
+    }
+    memcpy(tmp_path, path, path_len);
+    memcpy(tmp_path + path_len, ".tmp", 5);
+
+    int status = -1;
+    const int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd >= 0) {
+        status = checkpoint_transfer(fd, list.iov, list.count, 1);
+        /* The data must be on disk before the rename can make it visible. */
+        if (status == 0 && fsync(fd) != 0) {
+            status = -1;
+        }
+        if (close(fd) != 0) {
+            status = -1;
+        }
+        if (status == 0 && rename(tmp_path, path) != 0) {
+            status = -1;
+        }
+        if (status != 0) {
+            unlink(tmp_path);
+        }
+    }
+    if (status == 0) {
+        status = checkpoint_sync_parent(path);
+    }
+
+    free(tmp_path);
+    return status;
+}
+
+int dsp48e1_model_restore(dsp48e1_model_t *model, const char *path) {
+    if (!model || !path) {
+        return -1;
+    }
+
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+
+    checkpoint_header_t header;
+    struct iovec header_iov = {&header, sizeof(header)};
+    struct stat st;
+    size_t payload;
+    if (checkpoint_transfer(fd, &header_iov, 1, 0) != 0 ||
+        memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != DSP48E1_CHECKPOINT_VERSION ||
+        header.byte_order != CHECKPOINT_BYTE_ORDER ||
+        header.header_size != sizeof(header) ||
+        checkpoint_header_valid(&header, &payload) != 0 ||
+        fstat(fd, &st) != 0 || (uint64_t)st.st_size != sizeof(header) + (uint64_t)payload) {
+        close(fd);
+        return -1;
+    }
+
+    dsp48e1_config_t cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.format.kind = (dsp48e1_format_kind_t)header.format_kind;
+    cfg.format.total_bits = (uint8_t)header.format_total_bits;
+    cfg.format.exponent_bits = (uint8_t)header.format_exponent_bits;
+    cfg.format.mantissa_bits = (uint8_t)header.format_mantissa_bits;
+    cfg.format.fractional_bits = (uint8_t)header.format_fractional_bits;
+    cfg.format.specials = (uint8_t)header.format_specials;
+    cfg.format.exponent_bias = header.format_exponent_bias;
+    cfg.multiplier_latency = (uint8_t)header.multiplier_latency;
+    cfg.adder_latency = (uint8_t)header.adder_latency;
+    cfg.accumulator_latency = (uint8_t)header.accumulator_latency;
+    cfg.rounding_latency = (uint8_t)header.rounding_latency;
+    cfg.saturation_latency = (uint8_t)header.saturation_latency;
+    cfg.enable_rounding = (int)header.enable_rounding;
+    cfg.enable_saturation = (int)header.enable_saturation;
+    cfg.accum_mode = (dsp48e1_accum_mode_t)header.accum_mode;
+    cfg.accum_fraction_bits = (uint8_t)header.accum_fraction_bits;
+
+    /* Build the restored model aside so a bad file leaves the caller's model intact. */
+    dsp48e1_model_t restored;
+    if (dsp48e1_model_init(&restored, &cfg, (size_t)header.rows, (size_t)header.cols,
+                           (size_t)header.depth) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    checkpoint_iov_t list;
+    memset(&list, 0, sizeof(list));
+    checkpoint_describe(&restored, &list);
+    if (list.bytes != header.payload_bytes ||
+        checkpoint_transfer(fd, list.iov, list.count, 0) != 0) {
+        close(fd);
+        dsp48e1_model_free(&restored);
+        return -1;
+    }
+    close(fd);
+
+    restored.stream_k = header.stream_k;
+    restored.stream_active = (int)header.stream_active;
+    restored.cycle = header.cycle;
+    if (model->accumulators) {
+        dsp48e1_model_free(model);
+    }
+    *model = restored;
+    return 0;
+}
+
+/* Copy the checkpoint at src to dst with len bytes at offset replaced by value. */
+static int checkpoint_corrupt(const char *src, const char *dst, size_t offset, const void *value, size_t len) {
+    FILE *in = fopen(src, "rb");
+    if (!in) {
+        return -1;
+    }
+    char buffer[4096];
+    const size_t size = fread(buffer, 1, sizeof(buffer), in);
+    fclose(in);
+    if (size == sizeof(buffer) || offset + len > size) {
+        return -1;
+    }
+    memcpy(buffer + offset, value, len);
+    FILE *out = fopen(dst, "wb");
+    if (!out) {
+        return -1;
+    }
+    const int status = fwrite(buffer, 1, size, out) == size ? 0 : -1;
+    return fclose(out) == 0 ? status : -1;
+}
+
+int dsp48e1_checkpoint_self_test(void) {
+    enum { ROWS = 3, COLS = 4, K = 10, SPLIT = 4 };
+    dsp48e1_config_t config;
+    dsp48e1_default_fp32_config(&config);
+    config.enable_rounding = 0;
+    config.multiplier_latency = 2;
+    config.accum_mode = DSP48E1_ACCUM_KAHAN;
+
+    float lhs[ROWS * K];
+    float rhs[K * COLS];
+    float bias[COLS];
+    for (size_t i = 0; i < ROWS * K; ++i) {
+        lhs[i] = (float)((int)(i * 37 % 19) - 9) * 0.1f;
+    }
+    for (size_t i = 0; i < K * COLS; ++i) {
+        rhs[i] = (float)((int)(i * 11 % 23) - 11) * 0.3f;
+    }
+    for (size_t i = 0; i < COLS; ++i) {
+        bias[i] = (float)i * 0.7f;
+    }
+
+    const char *tmpdir = getenv("TMPDIR");
+    char path[512];
+    char truncated[512];
+    tmpdir = tmpdir ? tmpdir : "/tmp";
+    snprintf(path, sizeof(path), "%s/dsp48e1_checkpoint_%ld.ckp", tmpdir, (long)getpid());
+    snprintf(truncated, sizeof(truncated), "%s/dsp48e1_checkpoint_%ld.short", tmpdir, (long)getpid());
+
+    dsp48e1_model_t model;
+    dsp48e1_model_t resumed;
+    memset(&resumed, 0, sizeof(resumed));
+    if (dsp48e1_model_init(&model, &config, ROWS, COLS, K) != 0) {
+        return -1;
+    }
+
+    int status = dsp48e1_model_stream_begin(&model, bias);
+    if (status == 0) {
+        status = dsp48e1_model_stream_push(&model, lhs, K, rhs, COLS, SPLIT);
+    }
+    if (status == 0) {
+        status = dsp48e1_model_checkpoint(&model, path);
+    }
+    if (status == 0) {
+        status = dsp48e1_model_checkpoint(&model, truncated);
+    }
+    if (status == 0) {
+        status = truncate(truncated, (off_t)sizeof(checkpoint_header_t) + 8) == 0 ? 0 : -1;
+    }
+
+    /* A truncated file fails and leaves the model exactly as it was. */
+    if (status == 0) {
+        const dsp48e1_model_t before = model;
+        if (dsp48e1_model_restore(&model, truncated) == 0 ||
+            model.accumulators != before.accumulators || model.cycle != before.cycle ||
+            model.stream_k != before.stream_k || !model.stream_active) {
+            status = -1;
+        }
+    }
+
+    /* Every out-of-range header field is rejected, again leaving the model alone. */
+    const struct {
+        size_t offset;
+        uint64_t value;
+        size_t len;
+    } corruptions[] = {
+        {offsetof(checkpoint_header_t, format_kind), DSP48E1_FORMAT_CUSTOM + 1, 4},
+        {offsetof(checkpoint_header_t, format_total_bits), 256 + 32, 4},
+        {offsetof(checkpoint_header_t, format_specials), 7, 4},
+        {offsetof(checkpoint_header_t, multiplier_latency), 256 + 2, 4},
+        {offsetof(checkpoint_header_t, saturation_latency), 1U << 31, 4},
+        {offsetof(checkpoint_header_t, enable_rounding), 2, 4},
+        {offsetof(checkpoint_header_t, accum_mode), DSP48E1_ACCUM_KAHAN + 1, 4},
+        {offsetof(checkpoint_header_t, accum_fraction_bits), 48, 4},
+        {offsetof(checkpoint_header_t, stream_active), 3, 4},
+        {offsetof(checkpoint_header_t, rows), 0, 8},
+        {offsetof(checkpoint_header_t, rows), ROWS + 1, 8},
+        {offsetof(checkpoint_header_t, cols), (uint64_t)1 << 62, 8},
+        {offsetof(checkpoint_header_t, depth), UINT64_MAX, 8},
+        {offsetof(checkpoint_header_t, payload_bytes), 1, 8},
+    };
+    for (size_t i = 0; status == 0 && i < sizeof(corruptions) / sizeof(corruptions[0]); ++i) {
+        const dsp48e1_model_t before = model;
+        const uint32_t narrow = (uint32_t)corruptions[i].value;
+        const void *value = corruptions[i].len == sizeof(narrow) ? (const void *)&narrow
+                                                                  : (const void *)&corruptions[i].value;
+        if (checkpoint_corrupt(path, truncated, corruptions[i].offset, value, corruptions[i].len) != 0 ||
+            dsp48e1_model_restore(&model, truncated) == 0 ||
+            model.accumulators != before.accumulators || model.cycle != before.cycle) {
+            status = -1;
+        }
+    }
+
+    if (status == 0) {
+        status = dsp48e1_model_restore(&resumed, path);
+    }
+
+    float expected[ROWS * COLS];
+    float actual[ROWS * COLS];
+    if (status == 0) {
+        status = dsp48e1_model_stream_push(&model, lhs + SPLIT, K, rhs + SPLIT * COLS, COLS, K - SPLIT);
+    }
+    if (status == 0) {
+        status = dsp48e1_model_stream_end(&model, expected, COLS);
+    }
+    if (status == 0) {
+        status = dsp48e1_model_stream_push(&resumed, lhs + SPLIT, K, rhs + SPLIT * COLS, COLS, K - SPLIT);
+    }
+    if (status == 0) {
+        status = dsp48e1_model_stream_end(&resumed, actual, COLS);
+    }
+    if (status == 0 && (memcmp(expected, actual, sizeof(actual)) != 0 || model.cycle != resumed.cycle)) {
+        status = -1;
+    }
+
+    unlink(path);
+    unlink(truncated);
+    if (resumed.accumulators) {
+        dsp48e1_model_free(&resumed);
+    }
+    dsp48e1_model_free(&model);
+    return status;
+}
@@ -0,0 +1,59 @@
+#ifndef DSP48E1_CHECKPOINT_H
+#define DSP48E1_CHECKPOINT_H
+
+#include "dsp48e1_model.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file dsp48e1_checkpoint.h
+ *
+ * Snapshot and restore of the complete tensor-unit model state, so long
+ * simulations can resume after a crash or preemption.
+ *
+ * File layout (native byte order, checked on restore): a fixed header with
+ * the format version, configuration, tile shape, stream state and cycle
+ * counter, followed by the raw accumulators, accumulator-mode state,
+ * contribution counts, output panel, and the values and packed
+ * valid bits of every pipeline stage.  Only the active rows x cols region
+ * is stored.
+ */
+
+#define DSP48E1_CHECKPOINT_VERSION 2
+
+/**
+ * Write the model state to path with a single writev().  The data goes to
+ * a temporary file that is fsync()ed and renamed over path, and the
+ * directory is then fsync()ed, so neither an interrupted checkpoint nor a
+ * crash after a successful one leaves path without a complete checkpoint.
+ * Returns 0 on success, -1 on error.
+ */
+int dsp48e1_model_checkpoint(const dsp48e1_model_t *model, const char *path);
+
+/**
+ * Load a checkpoint written by dsp48e1_model_checkpoint().  model must be
+ * zeroed or previously initialised; on success it is replaced by a model
+ * with the saved configuration and shape whose state is restored
+ * bit-exactly.  On failure model is left untouched.
+ * Returns 0 on success, -1 on I/O error or a file that is truncated, from
+ * another version, written with a different byte order, or whose header
+ * holds a field outside the range of the model (including a shape whose
+ * rows * cols * depth overflows).
+ */
+int dsp48e1_model_restore(dsp48e1_model_t *model, const char *path);
+
+/**
+ * Checkpoint a model in the middle of a streamed GEMM, check that a
+ * truncated file or a corrupted header is rejected without touching the
+ * model, and that the restored model finishes bit-identically.  Files are
+ * written to $TMPDIR (default /tmp).  Returns 0 on success.
+ */
+int dsp48e1_checkpoint_self_test(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DSP48E1_CHECKPOINT_H */
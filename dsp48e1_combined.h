@@ -0,0 +1,41 @@
+#ifndef DSP48E1_COMBINED_H
+#define DSP48E1_COMBINED_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file dsp48e1_combined.h
+ *
+ * IEEE-754 single-precision multiply built from two DSP48E1 slices.
+ * Operands and results are raw FP32 bit patterns.  Results are correctly
+ * rounded (round to nearest, ties to even) and match a host FP32 multiply
+ * bit for bit, including signed zeros, subnormals, infinities and overflow.
+ * A NaN operand is returned quieted (a's first); 0 * Inf gives 0x7FC00000.
+ */
+
+/** c = a * b. */
+uint32_t dsp48e1_combined(uint32_t a, uint32_t b);
+
+/**
+ * c[i] = a[i] * b[i] for n lanes.  Normal operands go through a branch-free
+ * loop; lanes with special operands or results are fixed up afterwards.
+ * c may alias a or b.
+ */
+void dsp48e1_combined_batch(const uint32_t *a, const uint32_t *b, uint32_t *c, size_t n);
+
+/**
+ * Compare both paths against the host FP32 multiply on edge operands and
+ * random bit patterns.  Returns 0 on success.
+ */
+int dsp48e1_combined_self_test(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DSP48E1_COMBINED_H */
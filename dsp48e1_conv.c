@@ -0,0 +1,453 @@
+#include "dsp48e1_conv.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    dsp48e1_conv2d_params_t p; /* Normalised copy (strides etc. >= 1). */
+    size_t out_h;
+    size_t out_w;
+    size_t group_in;   /* in_channels / groups */
+    size_t group_out;  /* out_channels / groups */
+    size_t reduction;  /* group_in * kernel_h * kernel_w */
+    size_t gemm_m;     /* batch * out_h * out_w */
+} conv_shape_t;
+
+/* Position of one reduction index inside the receptive field. */
+typedef struct {
+    size_t channel;
+    size_t kr;
+    size_t ks;
+} conv_tap_t;
+
+/* Output extent along one axis (0 if the kernel does not fit); -1 on overflow. */
+static int conv_out_extent(size_t in, size_t pad, size_t kernel, size_t stride, size_t dilation,
+                           size_t *extent) {
+    size_t padded;
+    size_t span;
+    if (__builtin_mul_overflow(pad, 2, &padded) || __builtin_add_overflow(in, padded, &padded) ||
+        __builtin_mul_overflow(dilation, kernel - 1, &span) || __builtin_add_overflow(span, 1, &span)) {
+        return -1;
+    }
+    *extent = padded < span ? 0 : (padded - span) / stride + 1;
+    return 0;
+}
+
+static int conv_shape(const dsp48e1_conv2d_params_t *params, conv_shape_t *shape) {
+    if (!params) {
+        return -1;
+    }
+    shape->p = *params;
+    dsp48e1_conv2d_params_t *p = &shape->p;
+    p->stride_h = p->stride_h ? p->stride_h : 1;
+    p->stride_w = p->stride_w ? p->stride_w : 1;
+    p->dilation_h = p->dilation_h ? p->dilation_h : 1;
+    p->dilation_w = p->dilation_w ? p->dilation_w : 1;
+    p->groups = p->groups ? p->groups : 1;
+
+    if (p->batch == 0 || p->in_channels == 0 || p->out_channels == 0 ||
+        p->kernel_h == 0 || p->kernel_w == 0 ||
+        p->in_channels % p->groups != 0 || p->out_channels % p->groups != 0 ||
+        (p->layout != DSP48E1_LAYOUT_NCHW && p->layout != DSP48E1_LAYOUT_NHWC)) {
+        return -1;
+    }
+
+    if (conv_out_extent(p->in_height, p->pad_h, p->kernel_h, p->stride_h, p->dilation_h, &shape->out_h) != 0 ||
+        conv_out_extent(p->in_width, p->pad_w, p->kernel_w, p->stride_w, p->dilation_w, &shape->out_w) != 0 ||
+        shape->out_h == 0 || shape->out_w == 0) {
+        return -1;
+    }
+    shape->group_in = p->in_channels / p->groups;
+    shape->group_out = p->out_channels / p->groups;
+
+    /* Every input, weight and output index must be representable. */
+    size_t count;
+    if (__builtin_mul_overflow(shape->group_in, p->kernel_h, &shape->reduction) ||
+        __builtin_mul_overflow(shape->reduction, p->kernel_w, &shape->reduction) ||
+        __builtin_mul_overflow(p->out_channels, shape->reduction, &count) ||
+        __builtin_mul_overflow(p->batch, shape->out_h, &shape->gemm_m) ||
+        __builtin_mul_overflow(shape->gemm_m, shape->out_w, &shape->gemm_m) ||
+        __builtin_mul_overflow(shape->gemm_m, p->out_channels, &count) ||
+        __builtin_mul_overflow(count, shape->reduction, &count) ||
+        __builtin_mul_overflow(p->batch, p->in_channels, &count) ||
+        __builtin_mul_overflow(count, p->in_height, &count) ||
+        __builtin_mul_overflow(count, p->in_width, &count)) {
+        return -1;
+    }
+    return 0;
+}
+
+size_t dsp48e1_conv2d_out_height(const dsp48e1_conv2d_params_t *params) {
+    conv_shape_t shape;
+    return conv_shape(params, &shape) == 0 ? shape.out_h : 0;
+}
+
+size_t dsp48e1_conv2d_out_width(const dsp48e1_conv2d_params_t *params) {
+    conv_shape_t shape;
+    return conv_shape(params, &shape) == 0 ? shape.out_w : 0;
+}
+
+int dsp48e1_conv2d_gemm_shape(const dsp48e1_conv2d_params_t *params,
+                              size_t *gemm_m,
+                              size_t *gemm_n,
+                              size_t *gemm_k,
+                              size_t *groups) {
+    conv_shape_t shape;
+    if (!gemm_m || !gemm_n || !gemm_k || !groups || conv_shape(params, &shape) != 0) {
+        return -1;
+    }
+    *gemm_m = shape.gemm_m;
+    *gemm_n = shape.group_out;
+    *gemm_k = shape.reduction;
+    *groups = shape.p.groups;
+    return 0;
+}
+
+static float conv_input_at(const conv_shape_t *shape,
+                           const float *input,
+                           size_t n,
+                           size_t channel,
+                           size_t ih,
+                           size_t iw) {
+    const dsp48e1_conv2d_params_t *p = &shape->p;
+    if (p->layout == DSP48E1_LAYOUT_NCHW) {
+        return input[((n * p->in_channels + channel) * p->in_height + ih) * p->in_width + iw];
+    }
+    return input[((n * p->in_height + ih) * p->in_width + iw) * p->in_channels + channel];
+}
+
+/*
+ * Fill a rows x k_count panel of the lowered input for output pixels
+ * [m0, m0 + rows) and reduction indices [k0, k0 + k_count) of group g.
+ */
+static void conv_lhs_panel(const conv_shape_t *shape,
+                           const conv_tap_t *taps,
+                           const float *input,
+                           size_t g,
+                           size_t m0,
+                           size_t rows,
+                           size_t k0,
+                           size_t k_count,
+                           float *panel) {
+    const dsp48e1_conv2d_params_t *p = &shape->p;
+    const size_t pixels = shape->out_h * shape->out_w;
+
+    for (size_t row = 0; row < rows; ++row) {
+        const size_t m = m0 + row;
+        const size_t n = m / pixels;
+        const size_t oh = (m % pixels) / shape->out_w;
+        const size_t ow = m % shape->out_w;
+        /* Top-left input coordinate, offset by the padding to stay unsigned. */
+        const size_t h0 = oh * p->stride_h;
+        const size_t w0 = ow * p->stride_w;
+        float *out = panel + row * k_count;
+
+        for (size_t k = 0; k < k_count; ++k) {
+            const conv_tap_t *tap = &taps[k0 + k];
+            const size_t hp = h0 + tap->kr * p->dilation_h;
+            const size_t wp = w0 + tap->ks * p->dilation_w;
+            if (hp < p->pad_h || wp < p->pad_w ||
+                hp - p->pad_h >= p->in_height || wp - p->pad_w >= p->in_width) {
+                out[k] = 0.0f;
+            } else {
+                out[k] = conv_input_at(shape, input, n, g * shape->group_in + tap->channel,
+                                       hp - p->pad_h, wp - p->pad_w);
+            }
+        }
+    }
+}
+
+/*
+ * Fill a k_count x cols panel of weights for output channels
+ * [n0, n0 + cols) of group g.
+ */
+static void conv_rhs_panel(const conv_shape_t *shape,
+                           const float *weights,
+                           size_t g,
+                           size_t n0,
+                           size_t cols,
+                           size_t k0,
+                           size_t k_count,
+                           float *panel) {
+    for (size_t col = 0; col < cols; ++col) {
+        const float *filter = weights + (g * shape->group_out + n0 + col) * shape->reduction + k0;
+        for (size_t k = 0; k < k_count; ++k) {
+            panel[k * cols + col] = filter[k];
+        }
+    }
+}
+
+static void conv_store_tile(const conv_shape_t *shape,
+                            const float *tile,
+                            size_t g,
+                            size_t m0,
+                            size_t rows,
+                            size_t n0,
+                            size_t cols,
+                            float *output) {
+    const dsp48e1_conv2d_params_t *p = &shape->p;
+    const size_t pixels = shape->out_h * shape->out_w;
+
+    for (size_t row = 0; row < rows; ++row) {
+        const size_t m = m0 + row;
+        const size_t n = m / pixels;
+        const size_t pixel = m % pixels;
+        for (size_t col = 0; col < cols; ++col) {
+            const size_t channel = g * shape->group_out + n0 + col;
+            size_t offset;
+            if (p->layout == DSP48E1_LAYOUT_NCHW) {
+                offset = (n * p->out_channels + channel) * pixels + pixel;
+            } else {
+                offset = (n * pixels + pixel) * p->out_channels + channel;
+            }
+            output[offset] = tile[row * cols + col];
+        }
+    }
+}
+
+int dsp48e1_conv2d_fp32(dsp48e1_model_t *model,
+                        const dsp48e1_conv2d_params_t *params,
+                        const float *input,
+                        const float *weights,
+                        const float *bias,
+                        float *output,
+                        dsp48e1_conv2d_stats_t *stats) {
+    conv_shape_t shape;
+    if (!model || !model->accumulators || !input || !weights || !output ||
+        conv_shape(params, &shape) != 0) {
+        return -1;
+    }
+
+    const dsp48e1_conv2d_params_t *p = &shape.p;
+    const size_t tile_rows = model->rows;
+    const size_t tile_cols = model->cols;
+    const size_t tile_depth = model->depth;
+    const size_t gemm_m = shape.gemm_m;
+
+    size_t lhs_count;
+    size_t rhs_count;
+    if (__builtin_mul_overflow(tile_rows, tile_depth, &lhs_count) ||
+        __builtin_mul_overflow(tile_depth, tile_cols, &rhs_count)) {
+        return -1;
+    }
+    conv_tap_t *taps = (conv_tap_t *)calloc(shape.reduction, sizeof(conv_tap_t));
+    float *lhs_panel = (float *)calloc(lhs_count, sizeof(float));
+    float *rhs_panel = (float *)calloc(rhs_count, sizeof(float));
+    float *tile = (float *)calloc(tile_rows * tile_cols, sizeof(float));
+    if (!taps || !lhs_panel || !rhs_panel || !tile) {
+        free(taps);
+        free(lhs_panel);
+        free(rhs_panel);
+        free(tile);
+        return -1;
+    }
+
+    /* Reduction order follows the weight layout so filters are contiguous. */
+    for (size_t k = 0; k < shape.reduction; ++k) {
+        conv_tap_t *tap = &taps[k];
+        if (p->layout == DSP48E1_LAYOUT_NCHW) {
+            tap->channel = k / (p->kernel_h * p->kernel_w);
+            tap->kr = (k / p->kernel_w) % p->kernel_h;
+            tap->ks = k % p->kernel_w;
+        } else {
+            tap->channel = k % shape.group_in;
+            tap->kr = k / (p->kernel_w * shape.group_in);
+            tap->ks = (k / shape.group_in) % p->kernel_w;
+        }
+    }
+
+    dsp48e1_conv2d_stats_t totals = {0, 0, 0};
+    totals.macs = (uint64_t)gemm_m * p->out_channels * shape.reduction;
+
+    int status = 0;
+    for (size_t g = 0; g < p->groups && status == 0; ++g) {
+        for (size_t m0 = 0; m0 < gemm_m && status == 0; m0 += tile_rows) {
+            const size_t rows = (gemm_m - m0) < tile_rows ? (gemm_m - m0) : tile_rows;
+            for (size_t n0 = 0; n0 < shape.group_out && status == 0; n0 += tile_cols) {
+                const size_t cols = (shape.group_out - n0) < tile_cols ? (shape.group_out - n0) : tile_cols;
+
+                if ((rows != model->rows || cols != model->cols) &&
+                    dsp48e1_model_reshape(model, rows, cols, tile_depth) != 0) {
+                    status = -1;
+                    break;
+                }
+
+                const float *tile_bias = bias ? bias + g * shape.group_out + n0 : NULL;
+                status = dsp48e1_model_stream_begin(model, tile_bias);
+                for (size_t k0 = 0; k0 < shape.reduction && status == 0; k0 += tile_depth) {
+                    const size_t k_count = (shape.reduction - k0) < tile_depth ? (shape.reduction - k0) : tile_depth;
+                    conv_lhs_panel(&shape, taps, input, g, m0, rows, k0, k_count, lhs_panel);
+                    conv_rhs_panel(&shape, weights, g, n0, cols, k0, k_count, rhs_panel);
+                    status = dsp48e1_model_stream_push(model, lhs_panel, k_count, rhs_panel, cols, k_count);
+                }
+                if (status == 0) {
+                    status = dsp48e1_model_stream_end(model, tile, cols);
+                }
+                if (status == 0) {
+                    conv_store_tile(&shape, tile, g, m0, rows, n0, cols, output);
+                    totals.cycles += model->cycle;
+                    totals.tiles++;
+                }
+            }
+        }
+    }
+
+    if (model->rows != tile_rows || model->cols != tile_cols) {
+        dsp48e1_model_reshape(model, tile_rows, tile_cols, tile_depth);
+    }
+
+    if (stats) {
+        *stats = totals;
+    }
+
+    free(taps);
+    free(lhs_panel);
+    free(rhs_panel);
+    free(tile);
+    return status;
+}
+
+/* Direct convolution used as the self-test reference. */
+static float conv_reference_at(const conv_shape_t *shape,
+                               const float *input,
+                               const float *weights,
+                               const float *bias,
+                               size_t n,
+                               size_t oc,
+                               size_t oh,
+                               size_t ow) {
+    const dsp48e1_conv2d_params_t *p = &shape->p;
+    const size_t g = oc / shape->group_out;
+    float sum = bias ? bias[oc] : 0.0f;
+    for (size_t c = 0; c < shape->group_in; ++c) {
+        for (size_t kr = 0; kr < p->kernel_h; ++kr) {
+            for (size_t ks = 0; ks < p->kernel_w; ++ks) {
+                const long ih = (long)(oh * p->stride_h + kr * p->dilation_h) - (long)p->pad_h;
+                const long iw = (long)(ow * p->stride_w + ks * p->dilation_w) - (long)p->pad_w;
+                if (ih < 0 || iw < 0 || ih >= (long)p->in_height || iw >= (long)p->in_width) {
+                    continue;
+                }
+                const size_t ic = g * shape->group_in + c;
+                size_t in_index;
+                size_t w_index;
+                if (p->layout == DSP48E1_LAYOUT_NCHW) {
+                    in_index = ((n * p->in_channels + ic) * p->in_height + (size_t)ih) * p->in_width + (size_t)iw;
+                    w_index = ((oc * shape->group_in + c) * p->kernel_h + kr) * p->kernel_w + ks;
+                } else {
+                    in_index = ((n * p->in_height + (size_t)ih) * p->in_width + (size_t)iw) * p->in_channels + ic;
+                    w_index = ((oc * p->kernel_h + kr) * p->kernel_w + ks) * shape->group_in + c;
+                }
+                sum += input[in_index] * weights[w_index];
+            }
+        }
+    }
+    return sum;
+}
+
+int dsp48e1_conv_self_test(void) {
+    enum { TILE_ROWS = 4, TILE_COLS = 3, TILE_DEPTH = 5 };
+    dsp48e1_config_t config;
+    dsp48e1_default_fp32_config(&config);
+    config.enable_rounding = 0;
+
+    dsp48e1_model_t model;
+    if (dsp48e1_model_init(&model, &config, TILE_ROWS, TILE_COLS, TILE_DEPTH) != 0) {
+        return -1;
+    }
+
+    /* Odd extents force edge tiles on every axis; small integers keep sums exact. */
+    dsp48e1_conv2d_params_t cases[4];
+    cases[0] = (dsp48e1_conv2d_params_t){DSP48E1_LAYOUT_NCHW, 2, 3, 5, 6, 5, 3, 3, 1, 1, 1, 1, 1, 1, 1};
+    cases[1] = (dsp48e1_conv2d_params_t){DSP48E1_LAYOUT_NHWC, 2, 3, 5, 6, 5, 3, 3, 1, 1, 1, 1, 1, 1, 1};
+    cases[2] = (dsp48e1_conv2d_params_t){DSP48E1_LAYOUT_NCHW, 1, 4, 7, 7, 6, 3, 2, 2, 1, 0, 1, 2, 1, 2};
+    cases[3] = (dsp48e1_conv2d_params_t){DSP48E1_LAYOUT_NHWC, 1, 4, 7, 7, 6, 3, 2, 2, 1, 0, 1, 2, 1, 2};
+
+    int status = 0;
+    for (size_t t = 0; t < sizeof(cases) / sizeof(cases[0]) && status == 0; ++t) {
+        const dsp48e1_conv2d_params_t *params = &cases[t];
+        conv_shape_t shape;
+        if (conv_shape(params, &shape) != 0) {
+            status = -1;
+            break;
+        }
+        const dsp48e1_conv2d_params_t *p = &shape.p;
+        const size_t input_count = p->batch * p->in_channels * p->in_height * p->in_width;
+        const size_t weight_count = p->out_channels * shape.reduction;
+        const size_t output_count = p->batch * p->out_channels * shape.out_h * shape.out_w;
+        float *input = (float *)malloc(sizeof(float) * input_count);
+        float *weights = (float *)malloc(sizeof(float) * weight_count);
+        float *bias = (float *)malloc(sizeof(float) * p->out_channels);
+        float *output = (float *)malloc(sizeof(float) * output_count);
+        if (!input || !weights || !bias || !output) {
+            status = -1;
+        }
+        for (size_t i = 0; status == 0 && i < input_count; ++i) {
+            input[i] = (float)((int)(i * 7 % 11) - 5);
+        }
+        for (size_t i = 0; status == 0 && i < weight_count; ++i) {
+            weights[i] = (float)((int)(i * 5 % 7) - 3);
+        }
+        for (size_t i = 0; status == 0 && i < p->out_channels; ++i) {
+            bias[i] = (float)i - 2.0f;
+        }
+
+        dsp48e1_conv2d_stats_t stats;
+        if (status == 0 &&
+            dsp48e1_conv2d_fp32(&model, params, input, weights, bias, output, &stats) != 0) {
+            status = -1;
+        }
+        if (status == 0 && (model.rows != TILE_ROWS || model.cols != TILE_COLS ||
+                            model.depth != TILE_DEPTH ||
+                            stats.macs != (uint64_t)output_count * shape.reduction)) {
+            status = -1;
+        }
+        for (size_t n = 0; status == 0 && n < p->batch; ++n) {
+            for (size_t oc = 0; oc < p->out_channels; ++oc) {
+                for (size_t oh = 0; oh < shape.out_h; ++oh) {
+                    for (size_t ow = 0; ow < shape.out_w; ++ow) {
+                        const size_t index = p->layout == DSP48E1_LAYOUT_NCHW
+                            ? ((n * p->out_channels + oc) * shape.out_h + oh) * shape.out_w + ow
+                            : ((n * shape.out_h + oh) * shape.out_w + ow) * p->out_channels + oc;
+                        if (output[index] != conv_reference_at(&shape, input, weights, bias, n, oc, oh, ow)) {
+                            status = -1;
+                        }
+                    }
+                }
+            }
+        }
+        free(input);
+        free(weights);
+        free(bias);
+        free(output);
+    }
+
+    /* A kernel wider than the padded input has no output. */
+    dsp48e1_conv2d_params_t empty = cases[0];
+    empty.kernel_w = 9;
+    float dummy = 0.0f;
+    if (status == 0 && dsp48e1_conv2d_fp32(&model, &empty, &dummy, &dummy, NULL, &dummy, NULL) == 0) {
+        status = -1;
+    }
+
+    /* Extents and sizes that wrap size_t are rejected before any access. */
+    dsp48e1_conv2d_params_t wrapping[4];
+    for (size_t i = 0; i < 4; ++i) {
+        wrapping[i] = cases[0];
+    }
+    wrapping[0].pad_h = SIZE_MAX / 2;
+    wrapping[1].dilation_w = SIZE_MAX / 2;
+    wrapping[2].batch = SIZE_MAX / 8;
+    wrapping[3].in_channels = wrapping[3].out_channels = (size_t)1 << (sizeof(size_t) * 4);
+    for (size_t i = 0; status == 0 && i < 4; ++i) {
+        size_t gemm_m, gemm_n, gemm_k, groups;
+        if (dsp48e1_conv2d_gemm_shape(&wrapping[i], &gemm_m, &gemm_n, &gemm_k, &groups) == 0 ||
+            dsp48e1_conv2d_fp32(&model, &wrapping[i], &dummy, &dummy, NULL, &dummy, NULL) == 0) {
+            status = -1;
+        }
+    }
+
+    dsp48e1_model_free(&model);
+    return status;
+}
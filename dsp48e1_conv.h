@@ -0,0 +1,104 @@
+#ifndef DSP48E1_CONV_H
+#define DSP48E1_CONV_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dsp48e1_model.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file dsp48e1_conv.h
+ *
+ * 2-D convolution front end for the tensor-unit model.  Each group is lowered
+ * to a GEMM of (batch * out_h * out_w) x (out_channels / groups) with an
+ * inner dimension of (in_channels / groups) * kernel_h * kernel_w.  Operand
+ * panels are generated on the fly one K chunk at a time (implicit im2col),
+ * so the expanded matrix is never materialised.
+ */
+
+typedef enum {
+    DSP48E1_LAYOUT_NCHW = 0,
+    DSP48E1_LAYOUT_NHWC
+} dsp48e1_layout_t;
+
+/*
+ * Weights are [out_channels][in_channels / groups][kernel_h][kernel_w] for
+ * NCHW and [out_channels][kernel_h][kernel_w][in_channels / groups] for NHWC.
+ * The output uses the same layout as the input.  Zero stride/dilation values
+ * are treated as 1 and zero groups as 1.
+ */
+typedef struct {
+    dsp48e1_layout_t layout;
+    size_t batch;
+    size_t in_channels;
+    size_t in_height;
+    size_t in_width;
+    size_t out_channels;
+    size_t kernel_h;
+    size_t kernel_w;
+    size_t stride_h;
+    size_t stride_w;
+    size_t pad_h;
+    size_t pad_w;
+    size_t dilation_h;
+    size_t dilation_w;
+    size_t groups;
+} dsp48e1_conv2d_params_t;
+
+typedef struct {
+    uint64_t cycles; /* Modelled tile clocks summed over all tiles. */
+    uint64_t macs;   /* Useful multiply-accumulates of the layer. */
+    size_t tiles;    /* GEMM tiles issued to the model. */
+} dsp48e1_conv2d_stats_t;
+
+/**
+ * Output spatial size for the given parameters (0 if the kernel does not fit).
+ */
+size_t dsp48e1_conv2d_out_height(const dsp48e1_conv2d_params_t *params);
+size_t dsp48e1_conv2d_out_width(const dsp48e1_conv2d_params_t *params);
+
+/**
+ * Shape of the lowered per-group GEMM: gemm_m output pixels by gemm_n
+ * output channels with a reduction of gemm_k, repeated for each of groups
+ * groups.  Returns 0 on success, -1 for invalid parameters or sizes that
+ * overflow size_t.
+ */
+int dsp48e1_conv2d_gemm_shape(const dsp48e1_conv2d_params_t *params,
+                              size_t *gemm_m,
+                              size_t *gemm_n,
+                              size_t *gemm_k,
+                              size_t *groups);
+
+/**
+ * Run the convolution on the model, tiling the lowered GEMM by the model's
+ * rows x cols and streaming K in chunks of its depth.  The model is reshaped
+ * for edge tiles and restored to its original shape on return.  bias
+ * (length out_channels) and stats may be NULL.
+ *
+ * Returns 0 on success, non-zero on parameter (including overflowing
+ * extents) or allocation failure.
+ */
+int dsp48e1_conv2d_fp32(dsp48e1_model_t *model,
+                        const dsp48e1_conv2d_params_t *params,
+                        const float *input,
+                        const float *weights,
+                        const float *bias,
+                        float *output,
+                        dsp48e1_conv2d_stats_t *stats);
+
+/**
+ * Check NCHW and NHWC convolutions with stride, padding, dilation and groups
+ * against a direct reference on a model whose shape forces edge tiles.
+ * Returns 0 when every output matches exactly.
+ */
+int dsp48e1_conv_self_test(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DSP48E1_CONV_H */
@@ -0,0 +1,1171 @@
+#include "dsp48e1_dse.h"
+
+#include <math.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "dsp48e1_format.h"
+
+#define DSE_CACHE_HEADER "# dsp48e1 dse cache v2"
+
+enum {
+    DSE_KEY_WORDS = 17,
+    DSE_ERROR_KEY_FIRST = 5,  /* Words 5..14 determine the numerics. */
+    DSE_ERROR_KEY_LAST = 14,
+    DSE_MAX_RANGE_VALUES = 4096,
+    DSE_CHUNK = 16,
+    DSE_VALIDATE_MAX_DEPTH = 64
+};
+
+typedef struct {
+    uint64_t words[DSE_KEY_WORDS];
+} dse_key_t;
+
+typedef struct {
+    dse_key_t key;
+    size_t index;
+} dse_keyed_t;
+
+typedef struct {
+    uint64_t hash;
+    uint64_t cycles;
+    uint64_t macs;
+    uint64_t tiles;
+    uint64_t slices;
+    uint64_t registers;
+    double error;
+    int validated;
+} dse_cache_entry_t;
+
+typedef struct {
+    dse_cache_entry_t *entries;
+    size_t count;
+    size_t capacity;
+} dse_cache_t;
+
+/* ---- enumeration and keys ---------------------------------------------- */
+
+static size_t dse_range_values(const dsp48e1_dse_range_t *range, size_t *values) {
+    const size_t step = range->step ? range->step : 1;
+    const size_t max = range->max < range->min ? range->min : range->max;
+    size_t count = 0;
+
+    for (size_t v = range->min; v <= max && count < DSE_MAX_RANGE_VALUES; ) {
+        values[count++] = v;
+        const size_t next = range->geometric ? v * (step > 1 ? step : 2) : v + step;
+        if (next <= v) {
+            break; /* Overflow or a geometric range starting at 0. */
+        }
+        v = next;
+    }
+    return count;
+}
+
+static size_t dse_option_values(unsigned options, int *values) {
+    size_t count = 0;
+    if (options == 0 || (options & DSP48E1_DSE_OFF)) {
+        values[count++] = 0;
+    }
+    if (options & DSP48E1_DSE_ON) {
+        values[count++] = 1;
+    }
+    return count;
+}
+
+static void dse_design_key(const dsp48e1_tile_design_t *design, dse_key_t *key) {
+    const dsp48e1_config_t *c = &design->config;
+    uint64_t *w = key->words;
+    w[0] = c->multiplier_latency;
+    w[1] = c->adder_latency;
+    w[2] = c->accumulator_latency;
+    w[3] = c->rounding_latency;
+    w[4] = c->saturation_latency;
+    w[5] = c->enable_rounding != 0;
+    w[6] = c->enable_saturation != 0;
+    w[7] = (uint64_t)c->accum_mode;
+    w[8] = c->accum_mode == DSP48E1_ACCUM_FIXED48 ? c->accum_fraction_bits : 0;
+    w[9] = (uint64_t)c->format.kind | ((uint64_t)c->format.specials << 8);
+    w[10] = c->format.total_bits;
+    w[11] = c->format.exponent_bits;
+    w[12] = c->format.mantissa_bits;
+    w[13] = c->format.fractional_bits;
+    w[14] = (uint32_t)c->format.exponent_bias;
+    w[15] = design->tile_rows;
+    w[16] = design->tile_cols;
+}
+
+static int dse_key_compare(const dse_key_t *a, const dse_key_t *b, size_t first, size_t last) {
+    for (size_t i = first; i <= last; ++i) {
+        if (a->words[i] != b->words[i]) {
+            return a->words[i] < b->words[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+static int dse_keyed_compare(const void *lhs, const void *rhs) {
+    const dse_keyed_t *a = (const dse_keyed_t *)lhs;
+    const dse_keyed_t *b = (const dse_keyed_t *)rhs;
+    const int order = dse_key_compare(&a->key, &b->key, 0, DSE_KEY_WORDS - 1);
+    if (order != 0) {
+        return order;
+    }
+    return a->index < b->index ? -1 : (a->index > b->index ? 1 : 0);
+}
+
+static uint64_t dse_hash(uint64_t hash, const uint64_t *words, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        for (int byte = 0; byte < 8; ++byte) {
+            hash ^= (words[i] >> (8 * byte)) & 0xFFU;
+            hash *= 0x100000001B3ULL;
+        }
+    }
+    return hash;
+}
+
+/* Hash of everything besides the design that affects a cached result. */
+static uint64_t dse_context_hash(const dsp48e1_workload_t *workloads,
+                                 size_t count,
+                                 const dsp48e1_dse_options_t *options,
+                                 size_t sample_rows,
+                                 size_t sample_cols,
+                                 size_t sample_depth) {
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    const uint64_t setup[5] = {sample_rows, sample_cols, sample_depth, options->seed,
+                               (uint64_t)(options->back_to_back != 0)};
+    hash = dse_hash(hash, setup, 5);
+
+    for (size_t i = 0; i < count; ++i) {
+        const dsp48e1_workload_t *w = &workloads[i];
+        const uint64_t head[5] = {(uint64_t)w->kind, w->m, w->n, w->k, w->repeat ? w->repeat : 1};
+        hash = dse_hash(hash, head, 5);
+        if (w->kind == DSP48E1_WORKLOAD_CONV2D && w->conv) {
+            const dsp48e1_conv2d_params_t *p = w->conv;
+            const uint64_t conv[15] = {(uint64_t)p->layout, p->batch, p->in_channels, p->in_height,
+                                       p->in_width, p->out_channels, p->kernel_h, p->kernel_w,
+                                       p->stride_h, p->stride_w, p->pad_h, p->pad_w,
+                                       p->dilation_h, p->dilation_w, p->groups};
+            hash = dse_hash(hash, conv, 15);
+        }
+    }
+    return hash;
+}
+
+/* ---- disk cache ---------------------------------------------------------- */
+
+static int dse_cache_entry_compare(const void *lhs, const void *rhs) {
+    const uint64_t a = ((const dse_cache_entry_t *)lhs)->hash;
+    const uint64_t b = ((const dse_cache_entry_t *)rhs)->hash;
+    return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+static int dse_cache_push(dse_cache_t *cache, const dse_cache_entry_t *entry) {
+    if (cache->count == cache->capacity) {
+        const size_t capacity = cache->capacity ? cache->capacity * 2 : 256;
+        dse_cache_entry_t *entries = (dse_cache_entry_t *)realloc(cache->entries,
+                                                                  sizeof(dse_cache_entry_t) * capacity);
+        if (!entries) {
+            return -1;
+        }
+        cache->entries = entries;
+        cache->capacity = capacity;
+    }
+    cache->entries[cache->count++] = *entry;
+    return 0;
+}
+
+static void dse_cache_load(dse_cache_t *cache, const char *path) {
+    FILE *file = path ? fopen(path, "r") : NULL;
+    if (!file) {
+        return;
+    }
+
+    char line[256];
+    if (!fgets(line, sizeof(line), file) || strncmp(line, DSE_CACHE_HEADER, strlen(DSE_CACHE_HEADER)) != 0) {
+        fclose(file);
+        return;
+    }
+    while (fgets(line, sizeof(line), file)) {
+        dse_cache_entry_t entry;
+        unsigned long long hash, cycles, macs, tiles, slices, registers;
+        if (sscanf(line, "%llx %llu %llu %llu %llu %llu %lg %d", &hash, &cycles, &macs, &tiles,
+                   &slices, &registers, &entry.error, &entry.validated) != 8) {
+            continue;
+        }
+        entry.hash = hash;
+        entry.cycles = cycles;
+        entry.macs = macs;
+        entry.tiles = tiles;
+        entry.slices = slices;
+        entry.registers = registers;
+        if (dse_cache_push(cache, &entry) != 0) {
+            break;
+        }
+    }
+    fclose(file);
+    qsort(cache->entries, cache->count, sizeof(dse_cache_entry_t), dse_cache_entry_compare);
+}
+
+static const dse_cache_entry_t *dse_cache_find(const dse_cache_t *cache, uint64_t hash) {
+    dse_cache_entry_t probe;
+    probe.hash = hash;
+    if (cache->count == 0) {
+        return NULL;
+    }
+    return (const dse_cache_entry_t *)bsearch(&probe, cache->entries, cache->count,
+                                              sizeof(dse_cache_entry_t), dse_cache_entry_compare);
+}
+
+/* Append the new results; a missing file gets the header first. */
+static void dse_cache_append(const char *path, const dse_cache_entry_t *entries, size_t count) {
+    if (!path || count == 0) {
+        return;
+    }
+    FILE *probe = fopen(path, "r");
+    const int exists = probe != NULL;
+    if (probe) {
+        fclose(probe);
+    }
+
+    FILE *file = fopen(path, "a");
+    if (!file) {
+        return;
+    }
+    if (!exists) {
+        fprintf(file, "%s\n", DSE_CACHE_HEADER);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        const dse_cache_entry_t *e = &entries[i];
+        fprintf(file, "%016llx %llu %llu %llu %llu %llu %.17g %d\n",
+                (unsigned long long)e->hash, (unsigned long long)e->cycles,
+                (unsigned long long)e->macs, (unsigned long long)e->tiles,
+                (unsigned long long)e->slices, (unsigned long long)e->registers,
+                e->error, e->validated);
+    }
+    fclose(file);
+}
+
+/* ---- parallel loop ----------------------------------------------------- */
+
+typedef void (*dse_task_fn)(void *ctx, size_t index);
+
+typedef struct {
+    pthread_mutex_t lock;
+    size_t next;
+    size_t count;
+    dse_task_fn fn;
+    void *ctx;
+} dse_queue_t;
+
+static void *dse_worker_main(void *arg) {
+    dse_queue_t *queue = (dse_queue_t *)arg;
+    for (;;) {
+        pthread_mutex_lock(&queue->lock);
+        const size_t begin = queue->next;
+        queue->next = begin + DSE_CHUNK < queue->count ? begin + DSE_CHUNK : queue->count;
+        const size_t end = queue->next;
+        pthread_mutex_unlock(&queue->lock);
+        if (begin >= end) {
+            break;
+        }
+        for (size_t i = begin; i < end; ++i) {
+            queue->fn(queue->ctx, i);
+        }
+    }
+    return NULL;
+}
+
+static int dse_parallel_for(size_t threads, size_t count, dse_task_fn fn, void *ctx) {
+    dse_queue_t queue;
+    queue.next = 0;
+    queue.count = count;
+    queue.fn = fn;
+    queue.ctx = ctx;
+    pthread_mutex_init(&queue.lock, NULL);
+
+    size_t workers = threads < count ? threads : count;
+    pthread_t *handles = workers > 1 ? (pthread_t *)calloc(workers, sizeof(pthread_t)) : NULL;
+    size_t started = 0;
+    if (handles) {
+        for (size_t w = 1; w < workers; ++w) {
+            if (pthread_create(&handles[w], NULL, dse_worker_main, &queue) != 0) {
+                break;
+            }
+            started = w;
+        }
+    }
+    dse_worker_main(&queue); /* The caller works too; this also covers thread failures. */
+    for (size_t w = 1; w <= started; ++w) {
+        pthread_join(handles[w], NULL);
+    }
+
+    free(handles);
+    pthread_mutex_destroy(&queue.lock);
+    return 0;
+}
+
+/* ---- numerical error ----------------------------------------------------- */
+
+/*
+ * Round count values to format: INT8 onto a symmetric grid of int_scale
+ * steps per unit, floating-point formats through the format codec, so
+ * their exponent range, subnormals and specials apply.  Returns -1 for a
+ * format the codec does not support.
+ */
+static int dse_quantize(const dsp48e1_format_desc_t *format,
+                        const float *values,
+                        size_t count,
+                        float int_scale,
+                        float *out) {
+    if (format->kind == DSP48E1_FORMAT_INT8) {
+        const float max_code = (float)((1 << ((format->total_bits ? format->total_bits : 8) - 1)) - 1);
+        for (size_t i = 0; i < count; ++i) {
+            float code = nearbyintf(values[i] * int_scale);
+            code = code > max_code ? max_code : (code < -max_code ? -max_code : code);
+            out[i] = code / int_scale;
+        }
+        return 0;
+    }
+
+    dsp48e1_format_codec_t codec;
+    if (dsp48e1_format_codec_init(&codec, format) != 0) {
+        return -1;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = dsp48e1_format_decode(&codec, dsp48e1_format_encode(&codec, values[i], 0));
+    }
+    dsp48e1_format_codec_free(&codec);
+    return 0;
+}
+
+typedef struct {
+    const dsp48e1_dse_point_t *points;
+    const size_t *class_point;  /* A representative point for each class. */
+    double *class_error;
+    const float *lhs;
+    const float *rhs;
+    size_t rows;
+    size_t cols;
+    size_t depth;
+} dse_error_ctx_t;
+
+static void dse_error_task(void *arg, size_t index) {
+    dse_error_ctx_t *ctx = (dse_error_ctx_t *)arg;
+    const dsp48e1_config_t *config = &ctx->points[ctx->class_point[index]].design.config;
+    const size_t rows = ctx->rows;
+    const size_t cols = ctx->cols;
+    const size_t depth = ctx->depth;
+
+    float *lhs = (float *)malloc(sizeof(float) * rows * depth);
+    float *rhs = (float *)malloc(sizeof(float) * depth * cols);
+    float *dst = (float *)malloc(sizeof(float) * rows * cols);
+    dsp48e1_model_t model;
+    if (!lhs || !rhs || !dst || dsp48e1_model_init(&model, config, rows, cols, depth) != 0) {
+        free(lhs);
+        free(rhs);
+        free(dst);
+        ctx->class_error[index] = INFINITY;
+        return;
+    }
+
+    /* Operands lie in [-1, 1], so INT8 uses a full-range symmetric grid. */
+    const float int_scale = 127.0f;
+    double error = INFINITY;
+    if (dse_quantize(&config->format, ctx->lhs, rows * depth, int_scale, lhs) == 0 &&
+        dse_quantize(&config->format, ctx->rhs, depth * cols, int_scale, rhs) == 0 &&
+        dsp48e1_model_gemm_fp32(&model, lhs, depth, rhs, cols, NULL, dst, cols) == 0) {
+        error = 0.0;
+        for (size_t row = 0; row < rows; ++row) {
+            for (size_t col = 0; col < cols; ++col) {
+                double exact = 0.0;
+                double magnitude = 0.0;
+                for (size_t k = 0; k < depth; ++k) {
+                    const double term = (double)ctx->lhs[row * depth + k] * (double)ctx->rhs[k * cols + col];
+                    exact += term;
+                    magnitude += fabs(term);
+                }
+                const double diff = fabs((double)dst[row * cols + col] - exact);
+                const double relative = magnitude > 0.0 ? diff / magnitude : diff;
+                error = relative > error || isnan(relative) ? relative : error;
+            }
+        }
+    }
+
+    dsp48e1_model_free(&model);
+    free(lhs);
+    free(rhs);
+    free(dst);
+    ctx->class_error[index] = error;
+}
+
+/* ---- estimate + validation ----------------------------------------------- */
+
+typedef struct {
+    dsp48e1_dse_point_t *points;
+    const size_t *pending;      /* Indices of points to evaluate. */
+    const size_t *point_class;  /* Error class of each point. */
+    const double *class_error;
+    const dsp48e1_workload_t *workloads;
+    size_t workload_count;
+    size_t validate_every;
+    size_t validate_depth;
+} dse_eval_ctx_t;
+
+/* Simulate one tile and check the model's cycles against the estimate. */
+static int dse_validate(const dsp48e1_tile_design_t *design, size_t depth) {
+    dsp48e1_model_t model;
+    const size_t rows = design->tile_rows;
+    const size_t cols = design->tile_cols;
+    float *lhs = (float *)calloc(rows * depth, sizeof(float));
+    float *rhs = (float *)calloc(depth * cols, sizeof(float));
+    float *dst = (float *)calloc(rows * cols, sizeof(float));
+    int status = -1;
+
+    if (lhs && rhs && dst && dsp48e1_model_init(&model, &design->config, rows, cols, depth) == 0) {
+        dsp48e1_tile_design_t single = *design;
+        single.back_to_back = 0;
+        dsp48e1_workload_t tile;
+        memset(&tile, 0, sizeof(tile));
+        tile.kind = DSP48E1_WORKLOAD_GEMM;
+        tile.m = rows;
+        tile.n = cols;
+        tile.k = depth;
+
+        dsp48e1_estimate_t expected;
+        if (dsp48e1_model_gemm_epilogue_fp32(&model, lhs, depth, rhs, cols, design->epilogue, dst, cols) == 0 &&
+            dsp48e1_estimate(&single, &tile, 1, &expected) == 0 &&
+            expected.cycles == model.cycle) {
+            status = 1;
+        }
+        dsp48e1_model_free(&model);
+    }
+
+    free(lhs);
+    free(rhs);
+    free(dst);
+    return status;
+}
+
+static void dse_eval_task(void *arg, size_t index) {
+    dse_eval_ctx_t *ctx = (dse_eval_ctx_t *)arg;
+    const size_t p = ctx->pending[index];
+    dsp48e1_dse_point_t *point = &ctx->points[p];
+
+    if (dsp48e1_estimate(&point->design, ctx->workloads, ctx->workload_count, &point->estimate) != 0) {
+        point->error = INFINITY;
+        return;
+    }
+    point->error = ctx->class_error[ctx->point_class[p]];
+    if (ctx->validate_every && index % ctx->validate_every == 0) {
+        point->validated = dse_validate(&point->design, ctx->validate_depth);
+    }
+}
+
+/* ---- Pareto front ------------------------------------------------------ */
+
+/* Sort keys of one point, so the comparator needs no access to the points. */
+typedef struct {
+    uint64_t cycles;
+    uint64_t slices;
+    double error;
+    size_t index;
+} dse_rank_t;
+
+static int dse_rank_compare(const void *lhs, const void *rhs) {
+    const dse_rank_t *a = (const dse_rank_t *)lhs;
+    const dse_rank_t *b = (const dse_rank_t *)rhs;
+    if (a->cycles != b->cycles) {
+        return a->cycles < b->cycles ? -1 : 1;
+    }
+    if (a->slices != b->slices) {
+        return a->slices < b->slices ? -1 : 1;
+    }
+    if (a->error != b->error) {
+        return a->error < b->error ? -1 : 1;
+    }
+    return a->index < b->index ? -1 : (a->index > b->index ? 1 : 0);
+}
+
+static int dse_dominates(const dse_rank_t *a, const dse_rank_t *b) {
+    const int no_worse = a->cycles <= b->cycles && a->slices <= b->slices && a->error <= b->error;
+    const int better = a->cycles < b->cycles || a->slices < b->slices || a->error < b->error;
+    return no_worse && better;
+}
+
+/*
+ * Sort by (cycles, slices, error): a point can only be dominated by one
+ * before it, and a dominated point is always dominated by a front member.
+ * Returns the front as indices in cycle order, or NULL on allocation failure.
+ */
+static size_t *dse_pareto_front(const dsp48e1_dse_point_t *points, size_t count, size_t *front_count) {
+    dse_rank_t *ranks = (dse_rank_t *)malloc(sizeof(dse_rank_t) * (count ? count : 1));
+    size_t *front = (size_t *)malloc(sizeof(size_t) * (count ? count : 1));
+    if (!ranks || !front) {
+        free(ranks);
+        free(front);
+        return NULL;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        ranks[i].cycles = points[i].estimate.cycles;
+        ranks[i].slices = points[i].estimate.dsp_slices;
+        ranks[i].error = points[i].error;
+        ranks[i].index = i;
+    }
+    qsort(ranks, count, sizeof(dse_rank_t), dse_rank_compare);
+
+    /* Front members are compacted to the start of ranks as they are found. */
+    size_t members = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const dse_rank_t candidate = ranks[i];
+        if (isinf(candidate.error) && candidate.cycles == 0) {
+            continue; /* Failed evaluation. */
+        }
+        int dominated = 0;
+        for (size_t f = 0; f < members && !dominated; ++f) {
+            dominated = dse_dominates(&ranks[f], &candidate);
+        }
+        if (!dominated) {
+            ranks[members] = candidate;
+            front[members++] = candidate.index;
+        }
+    }
+
+    free(ranks);
+    *front_count = members;
+    return front;
+}
+
+/* ---- driver ------------------------------------------------------------ */
+
+static uint64_t dse_random(uint64_t *state) {
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return x;
+}
+
+static int dse_enumerate(const dsp48e1_dse_space_t *space,
+                         dsp48e1_dse_point_t **points_out,
+                         size_t *count_out) {
+    size_t *values[7];
+    size_t counts[7];
+    const dsp48e1_dse_range_t *ranges[7] = {
+        &space->multiplier_latency, &space->adder_latency, &space->accumulator_latency,
+        &space->rounding_latency, &space->saturation_latency, &space->tile_rows, &space->tile_cols
+    };
+    int status = 0;
+    for (size_t r = 0; r < 7; ++r) {
+        values[r] = (size_t *)malloc(sizeof(size_t) * DSE_MAX_RANGE_VALUES);
+        counts[r] = values[r] ? dse_range_values(ranges[r], values[r]) : 0;
+        if (!values[r]) {
+            status = -1;
+        }
+    }
+
+    int rounding[2];
+    int saturation[2];
+    const size_t rounding_count = dse_option_values(space->rounding_options, rounding);
+    const size_t saturation_count = dse_option_values(space->saturation_options, saturation);
+    const unsigned accum_modes = space->accum_modes ? space->accum_modes : (1U << DSP48E1_ACCUM_FP32);
+
+    dsp48e1_format_desc_t fp32;
+    dsp48e1_format_fp32(&fp32);
+    const dsp48e1_format_desc_t *formats = space->formats ? space->formats : &fp32;
+    const size_t format_count = space->formats ? space->format_count : 1;
+
+    size_t mode_count = 0;
+    for (unsigned mode = 0; mode <= DSP48E1_ACCUM_KAHAN; ++mode) {
+        mode_count += (accum_modes >> mode) & 1U;
+    }
+    /* A space too large to count is too large to allocate. */
+    size_t total = mode_count;
+    const size_t factors[3] = {rounding_count, saturation_count, format_count};
+    for (size_t f = 0; f < 3; ++f) {
+        if (__builtin_mul_overflow(total, factors[f], &total)) {
+            status = -1;
+        }
+    }
+    for (size_t r = 0; r < 7; ++r) {
+        if (__builtin_mul_overflow(total, counts[r], &total)) {
+            status = -1;
+        }
+    }
+
+    dsp48e1_dse_point_t *points = NULL;
+    if (status == 0 && total > 0) {
+        points = (dsp48e1_dse_point_t *)calloc(total, sizeof(dsp48e1_dse_point_t));
+        if (!points) {
+            status = -1;
+        }
+    }
+
+    size_t count = 0;
+    for (size_t f = 0; status == 0 && f < format_count; ++f) {
+        dsp48e1_format_desc_t format = formats[f];
+        if (format.kind == DSP48E1_FORMAT_FP32) {
+            dsp48e1_format_fp32(&format);
+        }
+        for (unsigned mode = 0; mode <= DSP48E1_ACCUM_KAHAN; ++mode) {
+            if (!((accum_modes >> mode) & 1U)) {
+                continue;
+            }
+            for (size_t ro = 0; ro < rounding_count; ++ro)
+            for (size_t so = 0; so < saturation_count; ++so)
+            for (size_t i0 = 0; i0 < counts[0]; ++i0)
+            for (size_t i1 = 0; i1 < counts[1]; ++i1)
+            for (size_t i2 = 0; i2 < counts[2]; ++i2)
+            for (size_t i3 = 0; i3 < counts[3]; ++i3)
+            for (size_t i4 = 0; i4 < counts[4]; ++i4)
+            for (size_t i5 = 0; i5 < counts[5]; ++i5)
+            for (size_t i6 = 0; i6 < counts[6]; ++i6) {
+                if (values[0][i0] > UINT8_MAX || values[1][i1] > UINT8_MAX ||
+                    values[2][i2] > UINT8_MAX || values[3][i3] > UINT8_MAX ||
+                    values[4][i4] > UINT8_MAX || values[5][i5] == 0 || values[6][i6] == 0) {
+                    continue;
+                }
+                dsp48e1_tile_design_t *design = &points[count].design;
+                dsp48e1_config_t *cfg = &design->config;
+                cfg->format = format;
+                cfg->multiplier_latency = (uint8_t)values[0][i0];
+                cfg->adder_latency = (uint8_t)values[1][i1];
+                cfg->accumulator_latency = (uint8_t)values[2][i2];
+                cfg->rounding_latency = (uint8_t)values[3][i3];
+                cfg->saturation_latency = (uint8_t)values[4][i4];
+                cfg->enable_rounding = rounding[ro];
+                cfg->enable_saturation = saturation[so];
+                cfg->accum_mode = (dsp48e1_accum_mode_t)mode;
+                cfg->accum_fraction_bits = mode == DSP48E1_ACCUM_FIXED48 ? space->accum_fraction_bits : 0;
+                design->tile_rows = values[5][i5];
+                design->tile_cols = values[6][i6];
+
+                const uint64_t slices = dsp48e1_estimate_tile_slices(cfg, design->tile_rows, design->tile_cols);
+                if (space->max_slices && slices > space->max_slices) {
+                    continue;
+                }
+                count++;
+            }
+        }
+    }
+
+    for (size_t r = 0; r < 7; ++r) {
+        free(values[r]);
+    }
+    if (status != 0) {
+        free(points);
+        return -1;
+    }
+    *points_out = points;
+    *count_out = count;
+    return 0;
+}
+
+int dsp48e1_dse_run(const dsp48e1_dse_space_t *space,
+                    const dsp48e1_workload_t *workloads,
+                    size_t count,
+                    const dsp48e1_dse_options_t *options,
+                    dsp48e1_dse_result_t *result) {
+    if (!space || !result || !workloads || count == 0) {
+        return -1;
+    }
+    memset(result, 0, sizeof(*result));
+
+    dsp48e1_dse_options_t opts;
+    memset(&opts, 0, sizeof(opts));
+    if (options) {
+        opts = *options;
+    }
+    if (opts.threads == 0) {
+        const long online = sysconf(_SC_NPROCESSORS_ONLN);
+        opts.threads = online > 0 ? (size_t)online : 1;
+    }
+
+    /* Sample GEMM for the error metric. */
+    size_t first_m, first_n, first_k = workloads[0].k, first_groups;
+    if (workloads[0].kind == DSP48E1_WORKLOAD_CONV2D &&
+        (!workloads[0].conv ||
+         dsp48e1_conv2d_gemm_shape(workloads[0].conv, &first_m, &first_n, &first_k, &first_groups) != 0)) {
+        return -1;
+    }
+    const size_t sample_rows = opts.sample_rows ? opts.sample_rows : 8;
+    const size_t sample_cols = opts.sample_cols ? opts.sample_cols : 8;
+    size_t sample_depth = opts.sample_depth ? opts.sample_depth : (first_k < 1024 ? first_k : 1024);
+    sample_depth = sample_depth ? sample_depth : 1;
+    const size_t validate_depth = sample_depth < DSE_VALIDATE_MAX_DEPTH ? sample_depth : DSE_VALIDATE_MAX_DEPTH;
+
+    dsp48e1_dse_point_t *points = NULL;
+    size_t enumerated = 0;
+    if (dse_enumerate(space, &points, &enumerated) != 0) {
+        return -1;
+    }
+
+    /* Deduplicate: sort by canonical key and keep the first of each run. */
+    dse_keyed_t *keyed = (dse_keyed_t *)malloc(sizeof(dse_keyed_t) * (enumerated ? enumerated : 1));
+    if (!keyed) {
+        free(points);
+        return -1;
+    }
+    for (size_t i = 0; i < enumerated; ++i) {
+        points[i].design.back_to_back = opts.back_to_back;
+        dse_design_key(&points[i].design, &keyed[i].key);
+        keyed[i].index = i;
+    }
+    qsort(keyed, enumerated, sizeof(dse_keyed_t), dse_keyed_compare);
+
+    dsp48e1_dse_point_t *unique = (dsp48e1_dse_point_t *)calloc(enumerated ? enumerated : 1,
+                                                                sizeof(dsp48e1_dse_point_t));
+    size_t *point_class = (size_t *)calloc(enumerated ? enumerated : 1, sizeof(size_t));
+    size_t *class_point = (size_t *)calloc(enumerated ? enumerated : 1, sizeof(size_t));
+    uint64_t *hashes = (uint64_t *)calloc(enumerated ? enumerated : 1, sizeof(uint64_t));
+    size_t *pending = (size_t *)calloc(enumerated ? enumerated : 1, sizeof(size_t));
+    dse_keyed_t *class_keys = (dse_keyed_t *)calloc(enumerated ? enumerated : 1, sizeof(dse_keyed_t));
+    if (!unique || !point_class || !class_point || !hashes || !pending || !class_keys) {
+        free(points);
+        free(keyed);
+        free(unique);
+        free(point_class);
+        free(class_point);
+        free(hashes);
+        free(pending);
+        free(class_keys);
+        return -1;
+    }
+
+    const uint64_t context = dse_context_hash(workloads, count, &opts,
+                                              sample_rows, sample_cols, sample_depth);
+    size_t distinct = 0;
+    for (size_t i = 0; i < enumerated; ++i) {
+        if (i > 0 && dse_key_compare(&keyed[i].key, &keyed[i - 1].key, 0, DSE_KEY_WORDS - 1) == 0) {
+            result->duplicates++;
+            continue;
+        }
+        unique[distinct] = points[keyed[i].index];
+        hashes[distinct] = dse_hash(context, keyed[i].key.words, DSE_KEY_WORDS);
+        class_keys[distinct].key = keyed[i].key;
+        class_keys[distinct].index = distinct;
+        distinct++;
+    }
+    free(points);
+    free(keyed);
+    points = unique;
+
+    /* Cache lookup. */
+    dse_cache_t cache;
+    memset(&cache, 0, sizeof(cache));
+    dse_cache_load(&cache, opts.cache_path);
+
+    size_t pending_count = 0;
+    for (size_t i = 0; i < distinct; ++i) {
+        const dse_cache_entry_t *hit = dse_cache_find(&cache, hashes[i]);
+        if (!hit) {
+            pending[pending_count++] = i;
+            continue;
+        }
+        dsp48e1_dse_point_t *point = &points[i];
+        const double peak = (double)point->design.tile_rows * (double)point->design.tile_cols;
+        point->estimate.cycles = hit->cycles;
+        point->estimate.macs = hit->macs;
+        point->estimate.tiles = hit->tiles;
+        point->estimate.dsp_slices = hit->slices;
+        point->estimate.registers = hit->registers;
+        point->estimate.peak_macs_per_cycle = peak;
+        point->estimate.achieved_macs_per_cycle = hit->cycles ? (double)hit->macs / (double)hit->cycles : 0.0;
+        point->estimate.utilization = peak > 0.0 ? point->estimate.achieved_macs_per_cycle / peak : 0.0;
+        point->error = hit->error;
+        point->validated = hit->validated;
+        point->cached = 1;
+        result->cached++;
+    }
+    free(cache.entries);
+
+    /* Group pending points into numeric classes (words 5..14 of the key). */
+    for (size_t i = 0; i < pending_count; ++i) {
+        class_keys[i] = class_keys[pending[i]];
+        memset(class_keys[i].key.words, 0, sizeof(uint64_t) * DSE_ERROR_KEY_FIRST);
+        memset(class_keys[i].key.words + DSE_ERROR_KEY_LAST + 1, 0,
+               sizeof(uint64_t) * (DSE_KEY_WORDS - DSE_ERROR_KEY_LAST - 1));
+    }
+    qsort(class_keys, pending_count, sizeof(dse_keyed_t), dse_keyed_compare);
+    size_t classes = 0;
+    for (size_t i = 0; i < pending_count; ++i) {
+        if (i == 0 || dse_key_compare(&class_keys[i].key, &class_keys[i - 1].key,
+                                      DSE_ERROR_KEY_FIRST, DSE_ERROR_KEY_LAST) != 0) {
+            class_point[classes++] = class_keys[i].index;
+        }
+        point_class[class_keys[i].index] = classes - 1;
+    }
+    free(class_keys);
+
+    int status = 0;
+    double *class_error = (double *)calloc(classes ? classes : 1, sizeof(double));
+    float *sample_lhs = (float *)malloc(sizeof(float) * sample_rows * sample_depth);
+    float *sample_rhs = (float *)malloc(sizeof(float) * sample_depth * sample_cols);
+    if (!class_error || !sample_lhs || !sample_rhs) {
+        status = -1;
+    }
+
+    if (status == 0 && classes > 0) {
+        uint64_t state = opts.seed ? opts.seed : 0x9E3779B97F4A7C15ULL;
+        for (size_t i = 0; i < sample_rows * sample_depth; ++i) {
+            sample_lhs[i] = (float)((double)(dse_random(&state) >> 11) * 0x1.0p-52 - 1.0);
+        }
+        for (size_t i = 0; i < sample_depth * sample_cols; ++i) {
+            sample_rhs[i] = (float)((double)(dse_random(&state) >> 11) * 0x1.0p-52 - 1.0);
+        }
+
+        dse_error_ctx_t error_ctx = {points, class_point, class_error, sample_lhs, sample_rhs,
+                                     sample_rows, sample_cols, sample_depth};
+        status = dse_parallel_for(opts.threads, classes, dse_error_task, &error_ctx);
+        result->error_classes = classes;
+    }
+
+    dse_cache_entry_t *fresh = NULL;
+    if (status == 0 && pending_count > 0) {
+        dse_eval_ctx_t eval_ctx = {points, pending, point_class, class_error, workloads, count,
+                                   opts.validate_every, validate_depth};
+        status = dse_parallel_for(opts.threads, pending_count, dse_eval_task, &eval_ctx);
+
+        fresh = (dse_cache_entry_t *)malloc(sizeof(dse_cache_entry_t) * pending_count);
+        for (size_t i = 0; status == 0 && i < pending_count; ++i) {
+            const dsp48e1_dse_point_t *point = &points[pending[i]];
+            result->validated += point->validated != 0;
+            result->validation_failures += point->validated < 0;
+            if (fresh) {
+                dse_cache_entry_t *e = &fresh[i];
+                e->hash = hashes[pending[i]];
+                e->cycles = point->estimate.cycles;
+                e->macs = point->estimate.macs;
+                e->tiles = point->estimate.tiles;
+                e->slices = point->estimate.dsp_slices;
+                e->registers = point->estimate.registers;
+                e->error = point->error;
+                e->validated = point->validated;
+            }
+        }
+        if (status == 0 && fresh) {
+            dse_cache_append(opts.cache_path, fresh, pending_count);
+        }
+        result->evaluated = pending_count;
+    }
+    free(fresh);
+    free(class_error);
+    free(sample_lhs);
+    free(sample_rhs);
+    free(point_class);
+    free(class_point);
+    free(hashes);
+    free(pending);
+
+    if (status == 0) {
+        size_t front_count = 0;
+        size_t *front = dse_pareto_front(points, distinct, &front_count);
+        if (!front) {
+            status = -1;
+        }
+        for (size_t f = 0; f < front_count; ++f) {
+            points[front[f]].pareto = 1;
+        }
+        free(front);
+        result->pareto_count = front_count;
+    }
+
+    if (status != 0) {
+        free(points);
+        memset(result, 0, sizeof(*result));
+        return -1;
+    }
+    result->points = points;
+    result->count = distinct;
+    return 0;
+}
+
+static const char *dse_accum_name(dsp48e1_accum_mode_t mode) {
+    switch (mode) {
+    case DSP48E1_ACCUM_FP64:
+        return "fp64";
+    case DSP48E1_ACCUM_FIXED48:
+        return "fixed48";
+    case DSP48E1_ACCUM_KAHAN:
+        return "kahan";
+    case DSP48E1_ACCUM_FP32:
+    default:
+        return "fp32";
+    }
+}
+
+static const char *dse_format_name(dsp48e1_format_kind_t kind) {
+    switch (kind) {
+    case DSP48E1_FORMAT_BFLOAT16:
+        return "bf16";
+    case DSP48E1_FORMAT_FP16:
+        return "fp16";
+    case DSP48E1_FORMAT_INT8:
+        return "int8";
+    case DSP48E1_FORMAT_CUSTOM:
+        return "custom";
+    case DSP48E1_FORMAT_FP32:
+    default:
+        return "fp32";
+    }
+}
+
+int dsp48e1_dse_write_pareto_csv(const dsp48e1_dse_result_t *result, const char *path) {
+    if (!result || !path) {
+        return -1;
+    }
+    size_t front_count = 0;
+    size_t *front = dse_pareto_front(result->points, result->count, &front_count);
+    if (!front) {
+        return -1;
+    }
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        free(front);
+        return -1;
+    }
+
+    fprintf(file, "format,mantissa_bits,accum_mode,multiplier_latency,adder_latency,"
+                  "accumulator_latency,rounding_latency,saturation_latency,enable_rounding,"
+                  "enable_saturation,tile_rows,tile_cols,dsp_slices,registers,cycles,"
+                  "achieved_macs_per_cycle,utilization,error,validated\n");
+    for (size_t f = 0; f < front_count; ++f) {
+        const dsp48e1_dse_point_t *p = &result->points[front[f]];
+        const dsp48e1_config_t *c = &p->design.config;
+        fprintf(file, "%s,%u,%s,%u,%u,%u,%u,%u,%d,%d,%zu,%zu,%llu,%llu,%llu,%.6g,%.6g,%.6g,%d\n",
+                dse_format_name(c->format.kind), (unsigned)c->format.mantissa_bits,
+                dse_accum_name(c->accum_mode),
+                (unsigned)c->multiplier_latency, (unsigned)c->adder_latency,
+                (unsigned)c->accumulator_latency, (unsigned)c->rounding_latency,
+                (unsigned)c->saturation_latency, c->enable_rounding != 0, c->enable_saturation != 0,
+                p->design.tile_rows, p->design.tile_cols,
+                (unsigned long long)p->estimate.dsp_slices, (unsigned long long)p->estimate.registers,
+                (unsigned long long)p->estimate.cycles, p->estimate.achieved_macs_per_cycle,
+                p->estimate.utilization, p->error, p->validated);
+    }
+
+    free(front);
+    return fclose(file) == 0 ? 0 : -1;
+}
+
+void dsp48e1_dse_result_free(dsp48e1_dse_result_t *result) {
+    if (!result) {
+        return;
+    }
+    free(result->points);
+    memset(result, 0, sizeof(*result));
+}
+
+int dsp48e1_dse_self_test(void) {
+    /* The codec applies the E4M3 exponent range: 2^-9 is its smallest subnormal. */
+    dsp48e1_format_desc_t formats[3];
+    dsp48e1_format_fp32(&formats[0]);
+    dsp48e1_format_e4m3(&formats[1]);
+    dsp48e1_format_e5m2(&formats[2]);
+    const float tiny[3] = {0x1.0p-9f, 0x1.0p-11f, 0.3f};
+    float rounded[3];
+    if (dse_quantize(&formats[1], tiny, 3, 127.0f, rounded) != 0 ||
+        rounded[0] != 0x1.0p-9f || rounded[1] != 0.0f || rounded[2] != 0.3125f) {
+        return -1;
+    }
+
+    dsp48e1_dse_space_t space;
+    memset(&space, 0, sizeof(space));
+    space.multiplier_latency = (dsp48e1_dse_range_t){0, 2, 1, 0};
+    space.adder_latency = (dsp48e1_dse_range_t){1, 1, 1, 0};
+    space.tile_rows = (dsp48e1_dse_range_t){2, 8, 2, 1};
+    space.tile_cols = (dsp48e1_dse_range_t){4, 4, 1, 0};
+    space.rounding_options = DSP48E1_DSE_OFF;
+    space.formats = formats;
+    space.format_count = 3;
+    const dsp48e1_workload_t gemm = {DSP48E1_WORKLOAD_GEMM, 16, 8, 12, NULL, 1};
+
+    dsp48e1_dse_options_t options;
+    memset(&options, 0, sizeof(options));
+    options.validate_every = 1;
+    options.sample_rows = 4;
+    options.sample_cols = 4;
+    options.threads = 1;
+
+    dsp48e1_dse_result_t serial;
+    dsp48e1_dse_result_t parallel;
+    if (dsp48e1_dse_run(&space, &gemm, 1, &options, &serial) != 0) {
+        return -1;
+    }
+    options.threads = 4;
+    if (dsp48e1_dse_run(&space, &gemm, 1, &options, &parallel) != 0) {
+        dsp48e1_dse_result_free(&serial);
+        return -1;
+    }
+
+    /* 3 formats x 3 latencies x 3 tile shapes, all simulated and matching. */
+    int status = 0;
+    if (serial.count != 27 || serial.validated != 27 || serial.validation_failures != 0 ||
+        parallel.count != serial.count || parallel.pareto_count != serial.pareto_count ||
+        serial.pareto_count == 0) {
+        status = -1;
+    }
+    double error_by_format[3] = {0.0, 0.0, 0.0};
+    for (size_t i = 0; status == 0 && i < serial.count; ++i) {
+        const dsp48e1_dse_point_t *p = &serial.points[i];
+        if (p->error != parallel.points[i].error || p->pareto != parallel.points[i].pareto ||
+            p->estimate.cycles != parallel.points[i].estimate.cycles) {
+            status = -1;
+        }
+        for (size_t f = 0; f < 3; ++f) {
+            if (p->design.config.format.mantissa_bits == formats[f].mantissa_bits) {
+                error_by_format[f] = p->error;
+            }
+        }
+        /* Exactly the points no other point dominates are on the front. */
+        int dominated = 0;
+        for (size_t j = 0; j < serial.count; ++j) {
+            const dsp48e1_dse_point_t *q = &serial.points[j];
+            dominated |= q->estimate.cycles <= p->estimate.cycles &&
+                         q->estimate.dsp_slices <= p->estimate.dsp_slices && q->error <= p->error &&
+                         (q->estimate.cycles < p->estimate.cycles ||
+                          q->estimate.dsp_slices < p->estimate.dsp_slices || q->error < p->error);
+        }
+        if (p->pareto == dominated) {
+            status = -1;
+        }
+    }
+    if (status == 0 && !(error_by_format[0] < error_by_format[1] && error_by_format[1] < error_by_format[2])) {
+        status = -1;
+    }
+    dsp48e1_dse_result_free(&serial);
+    dsp48e1_dse_result_free(&parallel);
+
+    /*
+     * The slice budget counts packed formats the way dsp48e1_estimate() does:
+     * with 4 columns, E4M3 (3 products per slice) needs 4, 8 and 12 slices
+     * for 2, 4 and 8 rows, so all three fit a budget of 12, while FP32 (2
+     * slices per PE) needs 16 even for 2 rows.
+     */
+    dsp48e1_dse_space_t budget_space;
+    memset(&budget_space, 0, sizeof(budget_space));
+    budget_space.tile_rows = (dsp48e1_dse_range_t){2, 8, 2, 1};
+    budget_space.tile_cols = (dsp48e1_dse_range_t){4, 4, 1, 0};
+    budget_space.rounding_options = DSP48E1_DSE_OFF;
+    budget_space.formats = formats;
+    budget_space.format_count = 2;
+    budget_space.max_slices = 12;
+    options.threads = 1;
+    if (status == 0 && dsp48e1_dse_run(&budget_space, &gemm, 1, &options, &serial) == 0) {
+        uint64_t largest = 0;
+        for (size_t i = 0; i < serial.count; ++i) {
+            const dsp48e1_dse_point_t *p = &serial.points[i];
+            if (p->design.config.format.mantissa_bits != formats[1].mantissa_bits ||
+                p->estimate.dsp_slices > budget_space.max_slices) {
+                status = -1;
+            }
+            largest = p->estimate.dsp_slices > largest ? p->estimate.dsp_slices : largest;
+        }
+        if (serial.count != 3 || largest != 12) {
+            status = -1;
+        }
+        dsp48e1_dse_result_free(&serial);
+    } else {
+        status = -1;
+    }
+
+    /*
+     * Disk cache: FP32 listed twice gives 4 duplicates of 8 designs.  A
+     * repeated run takes every point from the cache with identical results,
+     * a wider space evaluates only the new points, and another seed changes
+     * the context hash so nothing matches.
+     */
+    const char *tmpdir = getenv("TMPDIR");
+    char cache_path[512];
+    snprintf(cache_path, sizeof(cache_path), "%s/dsp48e1_dse_%ld.cache", tmpdir ? tmpdir : "/tmp", (long)getpid());
+    unlink(cache_path);
+    const dsp48e1_format_desc_t cache_formats[3] = {formats[0], formats[1], formats[0]};
+    dsp48e1_dse_space_t cache_space;
+    memset(&cache_space, 0, sizeof(cache_space));
+    cache_space.multiplier_latency = (dsp48e1_dse_range_t){0, 1, 1, 0};
+    cache_space.tile_rows = (dsp48e1_dse_range_t){2, 4, 2, 1};
+    cache_space.tile_cols = (dsp48e1_dse_range_t){4, 4, 1, 0};
+    cache_space.rounding_options = DSP48E1_DSE_OFF;
+    cache_space.formats = cache_formats;
+    cache_space.format_count = 3;
+    options.threads = 2;
+    options.cache_path = cache_path;
+
+    dsp48e1_dse_result_t first;
+    dsp48e1_dse_result_t again;
+    if (status == 0 && dsp48e1_dse_run(&cache_space, &gemm, 1, &options, &first) != 0) {
+        status = -1;
+    } else if (status == 0) {
+        if (first.count != 8 || first.duplicates != 4 || first.evaluated != 8 || first.cached != 0 ||
+            dsp48e1_dse_run(&cache_space, &gemm, 1, &options, &again) != 0) {
+            status = -1;
+        } else {
+            if (again.count != 8 || again.duplicates != 4 || again.cached != 8 || again.evaluated != 0 ||
+                again.error_classes != 0 || again.pareto_count != first.pareto_count) {
+                status = -1;
+            }
+            for (size_t i = 0; status == 0 && i < again.count; ++i) {
+                const dsp48e1_dse_point_t *p = &first.points[i];
+                const dsp48e1_dse_point_t *q = &again.points[i];
+                if (!q->cached || p->cached || q->error != p->error || q->validated != p->validated ||
+                    q->estimate.cycles != p->estimate.cycles ||
+                    q->estimate.dsp_slices != p->estimate.dsp_slices || q->pareto != p->pareto) {
+                    status = -1;
+                }
+            }
+            dsp48e1_dse_result_free(&again);
+        }
+        dsp48e1_dse_result_free(&first);
+    }
+    cache_space.multiplier_latency.max = 2;
+    if (status == 0 && dsp48e1_dse_run(&cache_space, &gemm, 1, &options, &again) == 0) {
+        if (again.count != 12 || again.cached != 8 || again.evaluated != 4) {
+            status = -1;
+        }
+        dsp48e1_dse_result_free(&again);
+    } else {
+        status = -1;
+    }
+    options.seed = 7;
+    if (status == 0 && dsp48e1_dse_run(&cache_space, &gemm, 1, &options, &again) == 0) {
+        if (again.cached != 0 || again.evaluated != 12) {
+            status = -1;
+        }
+        dsp48e1_dse_result_free(&again);
+    } else {
+        status = -1;
+    }
+    size_t lines = 0;
+    FILE *cache_file = fopen(cache_path, "r");
+    for (int c; cache_file && (c = fgetc(cache_file)) != EOF; ) {
+        lines += c == '\n';
+    }
+    if (!cache_file || lines != 1 + 8 + 4 + 12) {
+        status = -1;
+    }
+    if (cache_file) {
+        fclose(cache_file);
+    }
+    unlink(cache_path);
+    options.cache_path = NULL;
+
+    /* 4096^7 designs overflow size_t; the run must fail rather than wrap. */
+    const dsp48e1_dse_range_t wide = {1, SIZE_MAX, 1, 0};
+    space.multiplier_latency = wide;
+    space.adder_latency = wide;
+    space.accumulator_latency = wide;
+    space.rounding_latency = wide;
+    space.saturation_latency = wide;
+    space.tile_rows = wide;
+    space.tile_cols = wide;
+    if (status == 0 && dsp48e1_dse_run(&space, &gemm, 1, &options, &serial) == 0) {
+        dsp48e1_dse_result_free(&serial);
+        status = -1;
+    }
+    return status;
+}
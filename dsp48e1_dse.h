@@ -0,0 +1,126 @@
+#ifndef DSP48E1_DSE_H
+#define DSP48E1_DSE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dsp48e1_estimate.h"
+#include "dsp48e1_model.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file dsp48e1_dse.h
+ *
+ * Design-space exploration over the model's configuration knobs and tile
+ * shape.  Cycles and resources come from dsp48e1_estimate(); numerical
+ * error comes from simulating a sample GEMM once per distinct numeric
+ * configuration; a sample of designs is also simulated to check that the
+ * analytic cycle count matches the model.  Work is spread over threads and
+ * results are cached on disk, so re-running a sweep only evaluates new
+ * points.
+ */
+
+/*
+ * Inclusive range min..max.  Values advance by step (0 counts as 1), or
+ * are multiplied by step when geometric is set (e.g. 8, 16, 32 ...).
+ */
+typedef struct {
+    size_t min;
+    size_t max;
+    size_t step;
+    int geometric;
+} dsp48e1_dse_range_t;
+
+/* Bits of the rounding/saturation option masks. */
+#define DSP48E1_DSE_OFF 0x1U
+#define DSP48E1_DSE_ON  0x2U
+
+typedef struct {
+    dsp48e1_dse_range_t multiplier_latency;
+    dsp48e1_dse_range_t adder_latency;
+    dsp48e1_dse_range_t accumulator_latency;
+    dsp48e1_dse_range_t rounding_latency;
+    dsp48e1_dse_range_t saturation_latency;
+    dsp48e1_dse_range_t tile_rows;
+    dsp48e1_dse_range_t tile_cols;
+    unsigned rounding_options;   /* DSP48E1_DSE_OFF | DSP48E1_DSE_ON */
+    unsigned saturation_options;
+    unsigned accum_modes;        /* Bit (1 << dsp48e1_accum_mode_t); 0 = FP32 only. */
+    uint8_t accum_fraction_bits; /* Used by FIXED48. */
+    const dsp48e1_format_desc_t *formats; /* NULL = FP32 only. */
+    size_t format_count;
+    uint64_t max_slices;         /* Skip larger designs; 0 = no limit. */
+} dsp48e1_dse_space_t;
+
+typedef struct {
+    size_t threads;         /* 0 = one per online CPU. */
+    size_t validate_every;  /* Simulate every Nth new design; 0 = never. */
+    size_t sample_rows;     /* Error-sample GEMM shape; 0 picks 8 x 8 x K */
+    size_t sample_cols;     /* with K from the first workload, capped at */
+    size_t sample_depth;    /* 1024. */
+    uint64_t seed;
+    int back_to_back;       /* Estimate with back-to-back tile issue. */
+    const char *cache_path; /* NULL = no cache. */
+} dsp48e1_dse_options_t;
+
+typedef struct {
+    dsp48e1_tile_design_t design;
+    dsp48e1_estimate_t estimate;
+    double error;    /* Max |sim - exact| / sum |a*b| over the sample outputs. */
+    int validated;   /* 1 simulated and matched, -1 mismatch, 0 not simulated. */
+    int cached;      /* Loaded from the cache instead of evaluated. */
+    int pareto;      /* On the cycles / slices / error Pareto front. */
+} dsp48e1_dse_point_t;
+
+typedef struct {
+    dsp48e1_dse_point_t *points;
+    size_t count;              /* Distinct designs within max_slices. */
+    size_t duplicates;         /* Enumerated designs equal to an earlier one. */
+    size_t cached;
+    size_t evaluated;
+    size_t error_classes;      /* Numeric configurations simulated for error. */
+    size_t validated;
+    size_t validation_failures;
+    size_t pareto_count;
+} dsp48e1_dse_result_t;
+
+/**
+ * Enumerate space, evaluate every distinct design on workloads (count
+ * layers) and mark the Pareto front.  options may be NULL for defaults.
+ * result must be released with dsp48e1_dse_result_free().
+ * Returns 0 on success, -1 on invalid input, allocation or thread errors.
+ * A cache file that cannot be read or written is ignored.
+ */
+int dsp48e1_dse_run(const dsp48e1_dse_space_t *space,
+                    const dsp48e1_workload_t *workloads,
+                    size_t count,
+                    const dsp48e1_dse_options_t *options,
+                    dsp48e1_dse_result_t *result);
+
+/**
+ * Write the Pareto-optimal points as CSV, sorted by cycles.
+ * Returns 0 on success.
+ */
+int dsp48e1_dse_write_pareto_csv(const dsp48e1_dse_result_t *result, const char *path);
+
+void dsp48e1_dse_result_free(dsp48e1_dse_result_t *result);
+
+/**
+ * Sweep FP32, E4M3 and E5M2 designs serially and on four threads, and check
+ * that the results agree, every design validates, the Pareto flags match a
+ * brute-force dominance check and an uncountable space is rejected.  The
+ * slice budget must count packed E4M3 slices as the estimate does.  A cache
+ * file in $TMPDIR (default /tmp) must serve a repeated sweep entirely, a
+ * wider one incrementally, and nothing to a sweep with another seed.
+ * Returns 0 on success.
+ */
+int dsp48e1_dse_self_test(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DSP48E1_DSE_H */
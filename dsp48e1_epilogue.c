@@ -0,0 +1,262 @@
+#include "dsp48e1_epilogue.h"
+
+#include <float.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "dsp48e1_model.h"
+
+/* Largest finite bfloat16, 0x7F7F. */
+#define EPILOGUE_BF16_MAX 3.38953139e38f
+
+size_t dsp48e1_epilogue_latency(const dsp48e1_epilogue_t *epilogue) {
+    if (!epilogue) {
+        return 0;
+    }
+
+    size_t stages = 0;
+    stages += epilogue->bias ? 1U : 0U;
+    stages += epilogue->scale ? 1U : 0U;
+    stages += epilogue->activation != DSP48E1_ACTIVATION_NONE ? 1U : 0U;
+    stages += (epilogue->output != DSP48E1_EPILOGUE_FP32 || epilogue->saturate) ? 1U : 0U;
+    return stages;
+}
+
+size_t dsp48e1_epilogue_element_size(const dsp48e1_epilogue_t *epilogue) {
+    if (!epilogue) {
+        return sizeof(float);
+    }
+    switch (epilogue->output) {
+    case DSP48E1_EPILOGUE_BF16:
+        return sizeof(uint16_t);
+    case DSP48E1_EPILOGUE_INT8:
+        return sizeof(int8_t);
+    case DSP48E1_EPILOGUE_FP32:
+    default:
+        return sizeof(float);
+    }
+}
+
+static float epilogue_clamp(float value, float lo, float hi) {
+    value = value < lo ? lo : value;
+    return value > hi ? hi : value;
+}
+
+static float epilogue_gelu(float value) {
+    const float k = 0.7978845608f; /* sqrt(2 / pi) */
+    return 0.5f * value * (1.0f + tanhf(k * (value + 0.044715f * value * value * value)));
+}
+
+static uint16_t epilogue_to_bf16(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    if ((bits & 0x7FFFFFFFU) > 0x7F800000U) {
+        return (uint16_t)((bits >> 16) | 0x0040U); /* quiet NaN */
+    }
+    bits += 0x7FFFU + ((bits >> 16) & 1U);
+    return (uint16_t)(bits >> 16);
+}
+
+void dsp48e1_epilogue_apply(const dsp48e1_epilogue_t *epilogue,
+                            const float *values,
+                            size_t count,
+                            void *dst) {
+    if (!epilogue) {
+        memcpy(dst, values, sizeof(float) * count);
+        return;
+    }
+
+    for (size_t col = 0; col < count; ++col) {
+        float value = values[col];
+        if (epilogue->bias) {
+            value += epilogue->bias[col];
+        }
+        if (epilogue->scale) {
+            value *= epilogue->scale[col];
+        }
+
+        switch (epilogue->activation) {
+        case DSP48E1_ACTIVATION_RELU:
+            value = value > 0.0f ? value : 0.0f;
+            break;
+        case DSP48E1_ACTIVATION_GELU:
+            value = epilogue_gelu(value);
+            break;
+        case DSP48E1_ACTIVATION_CLIP:
+            value = epilogue_clamp(value, epilogue->clip_min, epilogue->clip_max);
+            break;
+        case DSP48E1_ACTIVATION_NONE:
+        default:
+            break;
+        }
+
+        switch (epilogue->output) {
+        case DSP48E1_EPILOGUE_BF16:
+            if (epilogue->saturate && !isnan(value)) {
+                value = epilogue_clamp(value, -EPILOGUE_BF16_MAX, EPILOGUE_BF16_MAX);
+            }
+            ((uint16_t *)dst)[col] = epilogue_to_bf16(value);
+            break;
+        case DSP48E1_EPILOGUE_INT8: {
+            /* NaN maps to the zero point. */
+            const float shifted = isnan(value) ? (float)epilogue->zero_point :
+                                  nearbyintf(value) + (float)epilogue->zero_point;
+            ((int8_t *)dst)[col] = (int8_t)epilogue_clamp(shifted, -128.0f, 127.0f);
+            break;
+        }
+        case DSP48E1_EPILOGUE_FP32:
+        default:
+            if (epilogue->saturate && !isnan(value)) {
+                value = epilogue_clamp(value, -FLT_MAX, FLT_MAX);
+            }
+            ((float *)dst)[col] = value;
+            break;
+        }
+    }
+}
+
+int dsp48e1_epilogue_self_test(void) {
+    const float values[6] = {2.5f, 3.5f, -2.5f, 200.0f, -200.0f, NAN};
+    const float bias[6] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    const float scale[6] = {1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f};
+
+    /* INT8: ties round to even, then the zero point, then saturation; NaN is the zero point. */
+    dsp48e1_epilogue_t epilogue;
+    memset(&epilogue, 0, sizeof(epilogue));
+    epilogue.output = DSP48E1_EPILOGUE_INT8;
+    epilogue.zero_point = 1;
+    const int8_t int8_expected[6] = {3, 5, -1, 127, -128, 1};
+    int8_t int8_out[6];
+    dsp48e1_epilogue_apply(&epilogue, values, 6, int8_out);
+    if (memcmp(int8_out, int8_expected, sizeof(int8_out)) != 0 ||
+        dsp48e1_epilogue_latency(&epilogue) != 1 ||
+        dsp48e1_epilogue_element_size(&epilogue) != sizeof(int8_t)) {
+        return -1;
+    }
+
+    /* Bias, scale and ReLU each add a stage and run in that order. */
+    epilogue.bias = bias;
+    epilogue.scale = scale;
+    epilogue.activation = DSP48E1_ACTIVATION_RELU;
+    const int8_t relu_expected[6] = {3, 5, 1, 127, 1, 1};
+    dsp48e1_epilogue_apply(&epilogue, values, 6, int8_out);
+    if (memcmp(int8_out, relu_expected, sizeof(int8_out)) != 0 ||
+        dsp48e1_epilogue_latency(&epilogue) != 4) {
+        return -1;
+    }
+
+    /* BF16: 1 + 2^-8 is a tie and rounds to 1, 1 + 3 * 2^-8 rounds up; NaN stays quiet. */
+    memset(&epilogue, 0, sizeof(epilogue));
+    epilogue.output = DSP48E1_EPILOGUE_BF16;
+    epilogue.saturate = 1;
+    const float bf16_in[4] = {1.00390625f, 1.01171875f, INFINITY, NAN};
+    uint16_t bf16_out[4];
+    dsp48e1_epilogue_apply(&epilogue, bf16_in, 4, bf16_out);
+    if (bf16_out[0] != 0x3F80U || bf16_out[1] != 0x3F82U || bf16_out[2] != 0x7F7FU ||
+        (bf16_out[3] & 0x7FC0U) != 0x7FC0U) {
+        return -1;
+    }
+
+    /* FP32 with saturation clamps infinities; without an epilogue values pass through. */
+    memset(&epilogue, 0, sizeof(epilogue));
+    epilogue.saturate = 1;
+    epilogue.activation = DSP48E1_ACTIVATION_CLIP;
+    epilogue.clip_min = -INFINITY;
+    epilogue.clip_max = INFINITY;
+    const float fp32_in[2] = {INFINITY, -INFINITY};
+    float fp32_out[2];
+    dsp48e1_epilogue_apply(&epilogue, fp32_in, 2, fp32_out);
+    if (fp32_out[0] != FLT_MAX || fp32_out[1] != -FLT_MAX || dsp48e1_epilogue_latency(&epilogue) != 2) {
+        return -1;
+    }
+    dsp48e1_epilogue_apply(NULL, fp32_in, 2, fp32_out);
+    if (fp32_out[0] != INFINITY || fp32_out[1] != -INFINITY || dsp48e1_epilogue_latency(NULL) != 0) {
+        return -1;
+    }
+
+    /*
+     * Through the model: a 2 x 3 tile of depth 4 takes 4 push clocks, the
+     * 5-stage default pipeline and the epilogue's stages.  Narrow outputs
+     * use a dst_stride wider than the tile; padding must stay untouched.
+     */
+    enum { ROWS = 2, COLS = 3, DEPTH = 4, INT8_STRIDE = 5, BF16_STRIDE = 4 };
+    const float lhs[ROWS][DEPTH] = {{1.0f, 2.0f, -3.0f, 4.0f}, {-2.0f, 1.0f, 0.0f, 3.0f}};
+    const float rhs[DEPTH][COLS] = {
+        {1.0f, -1.0f, 2.0f}, {3.0f, 0.0f, -2.0f}, {1.0f, 2.0f, 1.0f}, {2.0f, 1.0f, 1.0f}
+    };
+    const float tile_bias[COLS] = {1.0f, -4.0f, 0.0f};
+    const float tile_scale[COLS] = {2.0f, 1.0f, 3.0f};
+    dsp48e1_config_t config;
+    dsp48e1_default_fp32_config(&config);
+    config.enable_rounding = 0;
+    dsp48e1_model_t model;
+    if (dsp48e1_model_init(&model, &config, ROWS, COLS, DEPTH) != 0) {
+        return -1;
+    }
+
+    float sums[ROWS][COLS];
+    for (size_t row = 0; row < ROWS; ++row) {
+        for (size_t col = 0; col < COLS; ++col) {
+            sums[row][col] = 0.0f;
+            for (size_t k = 0; k < DEPTH; ++k) {
+                sums[row][col] += lhs[row][k] * rhs[k][col];
+            }
+        }
+    }
+
+    int status = 0;
+    memset(&epilogue, 0, sizeof(epilogue));
+    epilogue.bias = tile_bias;
+    epilogue.scale = tile_scale;
+    epilogue.activation = DSP48E1_ACTIVATION_RELU;
+    epilogue.output = DSP48E1_EPILOGUE_INT8;
+    epilogue.zero_point = -3;
+    int8_t int8_dst[ROWS][INT8_STRIDE];
+    memset(int8_dst, 0x5A, sizeof(int8_dst));
+    if (dsp48e1_model_gemm_epilogue_fp32(&model, &lhs[0][0], DEPTH, &rhs[0][0], COLS,
+                                         &epilogue, int8_dst, INT8_STRIDE) != 0 ||
+        model.cycle != DEPTH + dsp48e1_config_latency(&config) + 4) {
+        status = -1;
+    }
+    for (size_t row = 0; status == 0 && row < ROWS; ++row) {
+        for (size_t col = 0; col < INT8_STRIDE; ++col) {
+            int expected = 0x5A;
+            if (col < COLS) {
+                const float value = (sums[row][col] + tile_bias[col]) * tile_scale[col];
+                expected = (int)(value > 0.0f ? value : 0.0f) + epilogue.zero_point;
+                expected = expected > 127 ? 127 : expected;
+            }
+            if (int8_dst[row][col] != expected) {
+                status = -1;
+            }
+        }
+    }
+
+    /* BF16 of small integers is exact: the top half of the FP32 encoding. */
+    memset(&epilogue, 0, sizeof(epilogue));
+    epilogue.output = DSP48E1_EPILOGUE_BF16;
+    uint16_t bf16_dst[ROWS][BF16_STRIDE];
+    memset(bf16_dst, 0xA5, sizeof(bf16_dst));
+    if (status == 0 &&
+        (dsp48e1_model_gemm_epilogue_fp32(&model, &lhs[0][0], DEPTH, &rhs[0][0], COLS,
+                                          &epilogue, bf16_dst, BF16_STRIDE) != 0 ||
+         model.cycle != DEPTH + dsp48e1_config_latency(&config) + 1)) {
+        status = -1;
+    }
+    for (size_t row = 0; status == 0 && row < ROWS; ++row) {
+        for (size_t col = 0; col < BF16_STRIDE; ++col) {
+            uint32_t bits = 0xA5A50000U;
+            if (col < COLS) {
+                memcpy(&bits, &sums[row][col], sizeof(bits));
+            }
+            if (bf16_dst[row][col] != (uint16_t)(bits >> 16)) {
+                status = -1;
+            }
+        }
+    }
+
+    dsp48e1_model_free(&model);
+    return status;
+}
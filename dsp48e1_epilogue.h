@@ -0,0 +1,79 @@
+#ifndef DSP48E1_EPILOGUE_H
+#define DSP48E1_EPILOGUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file dsp48e1_epilogue.h
+ *
+ * Post-accumulation stage of the tensor unit.  Results leaving the last
+ * pipeline stage pass through, in order: bias add, per-channel scale,
+ * activation, and conversion to the output type (with optional saturation).
+ * Each enabled step is one extra pipeline stage in hardware.
+ */
+
+typedef enum {
+    DSP48E1_ACTIVATION_NONE = 0,
+    DSP48E1_ACTIVATION_RELU,
+    DSP48E1_ACTIVATION_GELU, /* tanh approximation */
+    DSP48E1_ACTIVATION_CLIP  /* clamp to [clip_min, clip_max] */
+} dsp48e1_activation_t;
+
+typedef enum {
+    DSP48E1_EPILOGUE_FP32 = 0, /* float */
+    DSP48E1_EPILOGUE_BF16,     /* uint16_t, round to nearest even */
+    DSP48E1_EPILOGUE_INT8      /* int8_t, round to nearest even + zero_point */
+} dsp48e1_epilogue_output_t;
+
+/*
+ * bias and scale have one entry per output column (channel) and may be
+ * NULL.  saturate clamps FP32/BF16 outputs to the largest finite value of
+ * the output type; INT8 outputs always saturate to [-128, 127].
+ */
+typedef struct {
+    const float *bias;
+    const float *scale;
+    dsp48e1_activation_t activation;
+    float clip_min;
+    float clip_max;
+    dsp48e1_epilogue_output_t output;
+    int32_t zero_point;
+    int saturate;
+} dsp48e1_epilogue_t;
+
+/**
+ * Pipeline stages the epilogue adds after the model's last stage: one for
+ * each of bias, scale, activation and a narrowing or saturating conversion
+ * that is enabled.  A NULL epilogue costs nothing.
+ */
+size_t dsp48e1_epilogue_latency(const dsp48e1_epilogue_t *epilogue);
+
+/** Size in bytes of one output element. */
+size_t dsp48e1_epilogue_element_size(const dsp48e1_epilogue_t *epilogue);
+
+/**
+ * Apply the epilogue to count consecutive columns starting at column 0 and
+ * write them to dst, an array of the output type.  A NULL epilogue copies
+ * the values to a float dst unchanged.
+ */
+void dsp48e1_epilogue_apply(const dsp48e1_epilogue_t *epilogue,
+                            const float *values,
+                            size_t count,
+                            void *dst);
+
+/**
+ * Check rounding, saturation and NaN handling of every output type and the
+ * stage count of each step.  Returns 0 on success.
+ */
+int dsp48e1_epilogue_self_test(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DSP48E1_EPILOGUE_H */
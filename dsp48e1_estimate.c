@@ -0,0 +1,205 @@
+#include "dsp48e1_estimate.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "dsp48e1_format.h"
+
+enum {
+    ESTIMATE_A_BITS = 24,     /* Unsigned width of the 25-bit A port. */
+    ESTIMATE_B_BITS = 17,     /* Unsigned width of the 18-bit B port. */
+    ESTIMATE_VALUE_BITS = 32  /* Pipeline registers carry FP32 values. */
+};
+
+static unsigned estimate_significand_bits(const dsp48e1_format_desc_t *format) {
+    switch (format->kind) {
+    case DSP48E1_FORMAT_INT8:
+        return 8;
+    case DSP48E1_FORMAT_FP32:
+    case DSP48E1_FORMAT_BFLOAT16:
+    case DSP48E1_FORMAT_FP16:
+    case DSP48E1_FORMAT_CUSTOM:
+    default:
+        /* Hidden bit plus the stored mantissa. */
+        return (unsigned)format->mantissa_bits + 1U;
+    }
+}
+
+static unsigned estimate_accumulator_bits(const dsp48e1_config_t *config) {
+    switch (config->accum_mode) {
+    case DSP48E1_ACCUM_FP64:
+        return 64;
+    case DSP48E1_ACCUM_FIXED48:
+        return 48;
+    case DSP48E1_ACCUM_KAHAN:
+        return 64; /* Sum and compensation. */
+    case DSP48E1_ACCUM_FP32:
+    default:
+        return 32;
+    }
+}
+
+unsigned dsp48e1_estimate_slices_per_pe(const dsp48e1_config_t *config) {
+    if (!config) {
+        return 0;
+    }
+    const unsigned width = estimate_significand_bits(&config->format);
+    const unsigned a_pieces = (width + ESTIMATE_A_BITS - 1) / ESTIMATE_A_BITS;
+    const unsigned b_pieces = (width + ESTIMATE_B_BITS - 1) / ESTIMATE_B_BITS;
+    return a_pieces * b_pieces;
+}
+
+uint64_t dsp48e1_estimate_tile_slices(const dsp48e1_config_t *config, size_t tile_rows, size_t tile_cols) {
+    if (!config) {
+        return 0;
+    }
+    /* Narrow significands of one column share B and pack several rows per slice. */
+    const unsigned packed = dsp48e1_format_products_per_slice(&config->format);
+    uint64_t slices;
+    if (packed > 1) {
+        const uint64_t groups = tile_rows / packed + (tile_rows % packed != 0);
+        if (__builtin_mul_overflow((uint64_t)tile_cols, groups, &slices)) {
+            return UINT64_MAX;
+        }
+    } else if (__builtin_mul_overflow((uint64_t)tile_rows, (uint64_t)tile_cols, &slices) ||
+               __builtin_mul_overflow(slices, (uint64_t)dsp48e1_estimate_slices_per_pe(config), &slices)) {
+        return UINT64_MAX;
+    }
+    return slices;
+}
+
+/* Lower a workload to a GEMM of m x n x k run groups times. */
+static int estimate_gemm_shape(const dsp48e1_workload_t *workload,
+                               size_t *m,
+                               size_t *n,
+                               size_t *k,
+                               size_t *groups) {
+    switch (workload->kind) {
+    case DSP48E1_WORKLOAD_GEMM:
+        if (workload->m == 0 || workload->n == 0 || workload->k == 0) {
+            return -1;
+        }
+        *m = workload->m;
+        *n = workload->n;
+        *k = workload->k;
+        *groups = 1;
+        return 0;
+    case DSP48E1_WORKLOAD_CONV2D:
+        return dsp48e1_conv2d_gemm_shape(workload->conv, m, n, k, groups);
+    default:
+        return -1;
+    }
+}
+
+int dsp48e1_estimate(const dsp48e1_tile_design_t *design,
+                     const dsp48e1_workload_t *workloads,
+                     size_t count,
+                     dsp48e1_estimate_t *estimate) {
+    if (!design || !estimate || (!workloads && count > 0) ||
+        design->tile_rows == 0 || design->tile_cols == 0) {
+        return -1;
+    }
+
+    const dsp48e1_config_t *config = &design->config;
+    const uint64_t elements = (uint64_t)design->tile_rows * design->tile_cols;
+    const uint64_t latency = dsp48e1_config_latency(config) +
+                             dsp48e1_epilogue_latency(design->epilogue);
+
+    dsp48e1_estimate_t result;
+    memset(&result, 0, sizeof(result));
+    result.dsp_slices = dsp48e1_estimate_tile_slices(config, design->tile_rows, design->tile_cols);
+    /* Every stage slot holds a value and a valid bit, plus the accumulator. */
+    result.registers = elements * (dsp48e1_config_latency(config) * (ESTIMATE_VALUE_BITS + 1U) +
+                                   estimate_accumulator_bits(config));
+    result.peak_macs_per_cycle = (double)elements;
+
+    for (size_t i = 0; i < count; ++i) {
+        size_t m, n, k, groups;
+        if (estimate_gemm_shape(&workloads[i], &m, &n, &k, &groups) != 0) {
+            return -1;
+        }
+        const uint64_t repeat = workloads[i].repeat ? workloads[i].repeat : 1U;
+        const uint64_t tiles = (uint64_t)groups *
+                               ((m + design->tile_rows - 1) / design->tile_rows) *
+                               ((n + design->tile_cols - 1) / design->tile_cols);
+        const uint64_t cycles = design->back_to_back ? tiles * k + latency
+                                                     : tiles * (k + latency);
+
+        result.tiles += repeat * tiles;
+        result.cycles += repeat * cycles;
+        result.macs += repeat * groups * (uint64_t)m * n * k;
+    }
+
+    if (result.cycles > 0) {
+        result.achieved_macs_per_cycle = (double)result.macs / (double)result.cycles;
+        result.utilization = result.achieved_macs_per_cycle / result.peak_macs_per_cycle;
+    }
+
+    *estimate = result;
+    return 0;
+}
+
+int dsp48e1_estimate_self_test(void) {
+    enum { TILE_ROWS = 4, TILE_COLS = 3, DEPTH = 6 };
+    dsp48e1_tile_design_t design;
+    memset(&design, 0, sizeof(design));
+    dsp48e1_default_fp32_config(&design.config);
+    design.config.enable_rounding = 0;
+    design.tile_rows = TILE_ROWS;
+    design.tile_cols = TILE_COLS;
+
+    dsp48e1_estimate_t estimate;
+    if (dsp48e1_estimate_slices_per_pe(&design.config) != 2 ||
+        dsp48e1_estimate(&design, NULL, 0, &estimate) != 0 ||
+        estimate.dsp_slices != 2U * TILE_ROWS * TILE_COLS || estimate.cycles != 0) {
+        return -1;
+    }
+
+    /* Tiles, MACs and cycles of a conv layer match what the simulation reports. */
+    const dsp48e1_conv2d_params_t conv = {DSP48E1_LAYOUT_NCHW, 1, 4, 6, 5, 6, 3, 3, 1, 1, 1, 1, 1, 1, 2};
+    const dsp48e1_workload_t layers[2] = {
+        {DSP48E1_WORKLOAD_CONV2D, 0, 0, 0, &conv, 0},
+        {DSP48E1_WORKLOAD_GEMM, 3 * TILE_ROWS, TILE_COLS, DEPTH, NULL, 2},
+    };
+    dsp48e1_model_t model;
+    if (dsp48e1_model_init(&model, &design.config, TILE_ROWS, TILE_COLS, DEPTH) != 0) {
+        return -1;
+    }
+    float input[4 * 6 * 5];
+    float weights[6 * 2 * 3 * 3];
+    float output[6 * 6 * 5];
+    for (size_t i = 0; i < sizeof(input) / sizeof(input[0]); ++i) {
+        input[i] = (float)(i % 5);
+    }
+    for (size_t i = 0; i < sizeof(weights) / sizeof(weights[0]); ++i) {
+        weights[i] = (float)(i % 3) - 1.0f;
+    }
+
+    int status = 0;
+    dsp48e1_conv2d_stats_t stats;
+    if (dsp48e1_conv2d_fp32(&model, &conv, input, weights, NULL, output, &stats) != 0 ||
+        dsp48e1_estimate(&design, layers, 1, &estimate) != 0 ||
+        estimate.tiles != stats.tiles || estimate.macs != stats.macs || estimate.cycles != stats.cycles) {
+        status = -1;
+    }
+
+    /* Back to back, three full tiles pay one drain, as in a batched GEMM. */
+    design.back_to_back = 1;
+    const uint64_t latency = dsp48e1_config_latency(&design.config);
+    if (status == 0 &&
+        (dsp48e1_estimate(&design, &layers[1], 1, &estimate) != 0 ||
+         estimate.tiles != 6 || estimate.cycles != 2 * (3 * DEPTH + latency) ||
+         estimate.macs != 2U * 3 * TILE_ROWS * TILE_COLS * DEPTH ||
+         estimate.achieved_macs_per_cycle > estimate.peak_macs_per_cycle)) {
+        status = -1;
+    }
+
+    const dsp48e1_workload_t empty = {DSP48E1_WORKLOAD_GEMM, 0, 1, 1, NULL, 1};
+    if (status == 0 && dsp48e1_estimate(&design, &empty, 1, &estimate) == 0) {
+        status = -1;
+    }
+
+    dsp48e1_model_free(&model);
+    return status;
+}
@@ -0,0 +1,107 @@
+#ifndef DSP48E1_ESTIMATE_H
+#define DSP48E1_ESTIMATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dsp48e1_conv.h"
+#include "dsp48e1_epilogue.h"
+#include "dsp48e1_model.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file dsp48e1_estimate.h
+ *
+ * Closed-form resource and throughput estimates for a tile design, for
+ * design-space sweeps that cannot afford to simulate every point.
+ *
+ * Cycle counts follow the model exactly: a tile streams its K products in
+ * K clocks and drains in dsp48e1_config_latency() clocks plus the epilogue
+ * stages, edge tiles cost the same as full ones, and back-to-back issue
+ * (dsp48e1_model_gemm_batch_fp32()) pays for a single drain per workload.
+ * Tile counts and cycles therefore match what dsp48e1_conv2d_fp32() and
+ * dsp48e1_tensor_gemm() report for the same shapes.
+ */
+
+typedef enum {
+    DSP48E1_WORKLOAD_GEMM = 0,
+    DSP48E1_WORKLOAD_CONV2D
+} dsp48e1_workload_kind_t;
+
+/*
+ * One layer of a workload.  GEMM uses m x n x k; CONV2D uses conv and is
+ * lowered the same way as dsp48e1_conv2d_fp32().  repeat runs the layer
+ * that many times (0 counts as 1).
+ */
+typedef struct {
+    dsp48e1_workload_kind_t kind;
+    size_t m;
+    size_t n;
+    size_t k;
+    const dsp48e1_conv2d_params_t *conv;
+    size_t repeat;
+} dsp48e1_workload_t;
+
+typedef struct {
+    dsp48e1_config_t config;
+    size_t tile_rows;
+    size_t tile_cols;
+    const dsp48e1_epilogue_t *epilogue; /* May be NULL. */
+    int back_to_back;                   /* Issue tiles without draining. */
+} dsp48e1_tile_design_t;
+
+typedef struct {
+    uint64_t dsp_slices;       /* DSP48E1 slices for the whole tile. */
+    uint64_t registers;        /* Pipeline and accumulator flip-flops. */
+    double peak_macs_per_cycle;
+    double achieved_macs_per_cycle;
+    double utilization;        /* achieved / peak */
+    uint64_t cycles;
+    uint64_t macs;
+    uint64_t tiles;
+} dsp48e1_estimate_t;
+
+/**
+ * DSP48E1 slices for one processing element.  A significand of w bits is
+ * split into 24-bit pieces on the A port and 17-bit pieces on the B port
+ * (the unsigned widths of the 25x18 multiplier), so FP32 takes two slices
+ * and BF16/FP16/INT8 take one.  The FIXED48 accumulator reuses the P
+ * register of the last slice; the floating-point accumulators are fabric
+ * logic.  dsp48e1_estimate() additionally packs formats with significands
+ * of 8 bits or fewer several rows per slice (dsp48e1_format.h).
+ */
+unsigned dsp48e1_estimate_slices_per_pe(const dsp48e1_config_t *config);
+
+/**
+ * DSP48E1 slices for a tile_rows x tile_cols tile: tile_cols *
+ * ceil(tile_rows / products_per_slice) for packed formats, otherwise
+ * tile_rows * tile_cols * dsp48e1_estimate_slices_per_pe().  Saturates at
+ * UINT64_MAX.  This is the dsp_slices of dsp48e1_estimate().
+ */
+uint64_t dsp48e1_estimate_tile_slices(const dsp48e1_config_t *config, size_t tile_rows, size_t tile_cols);
+
+/**
+ * Estimate resources and cycles of running workloads (count layers) on
+ * design.  Runs in O(count) with no allocation.  Returns 0 on success, -1
+ * for an invalid design or workload.
+ */
+int dsp48e1_estimate(const dsp48e1_tile_design_t *design,
+                     const dsp48e1_workload_t *workloads,
+                     size_t count,
+                     dsp48e1_estimate_t *estimate);
+
+/**
+ * Check the estimate of a grouped conv layer against the tiles, MACs and
+ * cycles dsp48e1_conv2d_fp32() reports, and the back-to-back cycle count.
+ * Returns 0 on success.
+ */
+int dsp48e1_estimate_self_test(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DSP48E1_ESTIMATE_H */
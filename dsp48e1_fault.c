@@ -0,0 +1,789 @@
+#include "dsp48e1_fault.h"
+
+#include <math.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+    FAULT_STAGES = 5,
+    FAULT_DEFAULT_INTERVAL = 16,
+    FAULT_RECORD_HEADER = 16  /* accum_state (8), accumulator (4), last output (4). */
+};
+
+/* One PE's view of a pipeline stage. */
+typedef struct {
+    float *values;
+    uint64_t *valid;
+    size_t span;
+} fault_stage_t;
+
+typedef struct {
+    dsp48e1_model_t *model;     /* Golden model, left in its final state. */
+    const float *lhs;
+    size_t lhs_stride;
+    const float *rhs;
+    size_t rhs_stride;
+    size_t k;
+    uint64_t tile_cycles;
+    size_t interval;
+    size_t total_span;          /* Pipeline slots per PE over all stages. */
+    size_t record_bytes;
+    size_t snapshot_count;
+    unsigned char *snapshots;   /* snapshot-major, then PE-major records. */
+    float *golden;              /* rows * cols fault-free outputs. */
+    uint32_t targets;
+    uint64_t target_bits[DSP48E1_FAULT_TARGETS];
+    uint64_t register_bits;
+    uint64_t seed;
+    double tolerance;
+} fault_campaign_t;
+
+typedef struct {
+    const fault_campaign_t *campaign;
+    uint64_t first;
+    uint64_t end;
+    dsp48e1_fault_t *faults;
+    dsp48e1_fault_stats_t stats;
+    int status;
+} fault_worker_t;
+
+static void fault_stages(const dsp48e1_model_t *model, fault_stage_t stages[FAULT_STAGES]) {
+    stages[0] = (fault_stage_t){model->pipeline_mul, model->pipeline_mul_valid, model->mul_span};
+    stages[1] = (fault_stage_t){model->pipeline_add, model->pipeline_add_valid, model->add_span};
+    stages[2] = (fault_stage_t){model->pipeline_accum, model->pipeline_accum_valid, model->accum_span};
+    stages[3] = (fault_stage_t){model->pipeline_round, model->pipeline_round_valid, model->round_span};
+    stages[4] = (fault_stage_t){model->pipeline_out, model->pipeline_out_valid, model->out_span};
+}
+
+/* Bits of the running-sum register in each accumulation mode. */
+static unsigned fault_accumulator_bits(dsp48e1_accum_mode_t mode) {
+    switch (mode) {
+    case DSP48E1_ACCUM_FP64:
+    case DSP48E1_ACCUM_KAHAN:
+        return 64;
+    case DSP48E1_ACCUM_FIXED48:
+        return 48;
+    case DSP48E1_ACCUM_FP32:
+    default:
+        return 32;
+    }
+}
+
+/*
+ * Copy PE idx's registers and last output into a record.  The layout does
+ * not depend on the tile shape, so records of the golden tile and of a
+ * 1 x 1 trial model compare with memcmp.
+ */
+static void fault_gather(const dsp48e1_model_t *model,
+                         size_t idx,
+                         float last_out,
+                         size_t record_bytes,
+                         unsigned char *record) {
+    const size_t elements = model->rows * model->cols;
+    const size_t words = model->valid_words;
+    fault_stage_t stages[FAULT_STAGES];
+    fault_stages(model, stages);
+
+    memset(record, 0, record_bytes);
+    switch (model->config.accum_mode) {
+    case DSP48E1_ACCUM_FP64:
+    case DSP48E1_ACCUM_FIXED48:
+        memcpy(record, (const int64_t *)model->accum_state + idx, sizeof(int64_t));
+        break;
+    case DSP48E1_ACCUM_KAHAN:
+        memcpy(record, (const float *)model->accum_state + idx, sizeof(float));
+        break;
+    case DSP48E1_ACCUM_FP32:
+    default:
+        break;
+    }
+    memcpy(record + 8, &model->accumulators[idx], sizeof(float));
+    memcpy(record + 12, &last_out, sizeof(float));
+
+    float *values = (float *)(record + FAULT_RECORD_HEADER);
+    size_t slots = 0;
+    for (size_t s = 0; s < FAULT_STAGES; ++s) {
+        slots += stages[s].span;
+    }
+    unsigned char *valid = record + FAULT_RECORD_HEADER + slots * sizeof(float);
+    for (size_t s = 0; s < FAULT_STAGES; ++s) {
+        for (size_t i = 0; i < stages[s].span; ++i) {
+            *values++ = stages[s].values[i * elements + idx];
+            *valid++ = (unsigned char)((stages[s].valid[i * words + idx / DSP48E1_MODEL_VALID_BITS] >>
+                                        (idx % DSP48E1_MODEL_VALID_BITS)) & 1U);
+        }
+    }
+}
+
+/* Load a record into a 1 x 1 model; returns the record's last output. */
+static float fault_scatter(dsp48e1_model_t *pe, const unsigned char *record) {
+    fault_stage_t stages[FAULT_STAGES];
+    fault_stages(pe, stages);
+
+    switch (pe->config.accum_mode) {
+    case DSP48E1_ACCUM_FP64:
+    case DSP48E1_ACCUM_FIXED48:
+        memcpy(pe->accum_state, record, sizeof(int64_t));
+        break;
+    case DSP48E1_ACCUM_KAHAN:
+        memcpy(pe->accum_state, record, sizeof(float));
+        break;
+    case DSP48E1_ACCUM_FP32:
+    default:
+        break;
+    }
+    memcpy(&pe->accumulators[0], record + 8, sizeof(float));
+    float last_out;
+    memcpy(&last_out, record + 12, sizeof(float));
+
+    size_t slots = 0;
+    for (size_t s = 0; s < FAULT_STAGES; ++s) {
+        slots += stages[s].span;
+    }
+    const float *values = (const float *)(record + FAULT_RECORD_HEADER);
+    const unsigned char *valid = record + FAULT_RECORD_HEADER + slots * sizeof(float);
+    for (size_t s = 0; s < FAULT_STAGES; ++s) {
+        for (size_t i = 0; i < stages[s].span; ++i) {
+            stages[s].values[i] = *values++;
+            stages[s].valid[i] = *valid++;
+        }
+    }
+    return last_out;
+}
+
+static void fault_flip_float(float *value, unsigned bit) {
+    uint32_t bits;
+    memcpy(&bits, value, sizeof(bits));
+    bits ^= (uint32_t)1 << bit;
+    memcpy(value, &bits, sizeof(bits));
+}
+
+/* Flip the chosen bit of a 1 x 1 model. */
+static void fault_flip(dsp48e1_model_t *pe, const dsp48e1_fault_t *fault) {
+    fault_stage_t stages[FAULT_STAGES];
+    fault_stages(pe, stages);
+
+    if (fault->target < DSP48E1_FAULT_VALID) {
+        fault_flip_float(&stages[fault->target].values[fault->slot], fault->bit);
+        return;
+    }
+    if (fault->target == DSP48E1_FAULT_VALID) {
+        stages[fault->bit].valid[fault->slot] ^= 1U;
+        return;
+    }
+
+    switch (pe->config.accum_mode) {
+    case DSP48E1_ACCUM_FP64:
+        ((uint64_t *)pe->accum_state)[0] ^= (uint64_t)1 << fault->bit;
+        break;
+    case DSP48E1_ACCUM_FIXED48: {
+        /* The register is 48 bits wide; keep the value sign extended from bit 47. */
+        int64_t *fixed = (int64_t *)pe->accum_state;
+        const uint64_t flipped = (uint64_t)fixed[0] ^ ((uint64_t)1 << fault->bit);
+        fixed[0] = (int64_t)(flipped << 16) >> 16;
+        break;
+    }
+    case DSP48E1_ACCUM_KAHAN:
+        if (fault->bit >= 32) {
+            fault_flip_float((float *)pe->accum_state, fault->bit - 32U);
+            break;
+        }
+        fault_flip_float(&pe->accumulators[0], fault->bit);
+        break;
+    case DSP48E1_ACCUM_FP32:
+    default:
+        fault_flip_float(&pe->accumulators[0], fault->bit);
+        break;
+    }
+}
+
+static uint64_t fault_splitmix(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/* Draw trial's fault from the seed and the trial index only. */
+static void fault_draw(const fault_campaign_t *campaign, const dsp48e1_model_t *model,
+                       uint64_t trial, dsp48e1_fault_t *fault) {
+    uint64_t state = campaign->seed ^ (trial * 0xD1B54A32D192ED03ULL);
+    const uint64_t elements = (uint64_t)model->rows * model->cols;
+
+    memset(fault, 0, sizeof(*fault));
+    fault->cycle = fault_splitmix(&state) % campaign->tile_cycles;
+    const uint64_t idx = fault_splitmix(&state) % elements;
+    fault->row = (uint32_t)(idx / model->cols);
+    fault->col = (uint32_t)(idx % model->cols);
+
+    uint64_t bit = fault_splitmix(&state) % campaign->register_bits;
+    unsigned target = 0;
+    while (bit >= campaign->target_bits[target]) {
+        bit -= campaign->target_bits[target++];
+    }
+    fault->target = (uint8_t)target;
+
+    if (target < DSP48E1_FAULT_VALID) {
+        fault->slot = (uint16_t)(bit / 32U);
+        fault->bit = (uint8_t)(bit % 32U);
+    } else if (target == DSP48E1_FAULT_VALID) {
+        fault_stage_t stages[FAULT_STAGES];
+        fault_stages(model, stages);
+        unsigned stage = 0;
+        while (bit >= stages[stage].span) {
+            bit -= stages[stage++].span;
+        }
+        fault->slot = (uint16_t)bit;
+        fault->bit = (uint8_t)stage;
+    } else {
+        fault->bit = (uint8_t)bit;
+    }
+}
+
+static dsp48e1_fault_outcome_t fault_classify(float golden, float faulty, double tolerance) {
+    uint32_t golden_bits;
+    uint32_t faulty_bits;
+    memcpy(&golden_bits, &golden, sizeof(golden_bits));
+    memcpy(&faulty_bits, &faulty, sizeof(faulty_bits));
+
+    if (golden_bits == faulty_bits) {
+        return DSP48E1_FAULT_MASKED;
+    }
+    if (!isfinite(faulty)) {
+        return isfinite(golden) ? DSP48E1_FAULT_NON_FINITE : DSP48E1_FAULT_CORRUPTED;
+    }
+    if (isfinite(golden) &&
+        fabs((double)faulty - (double)golden) <= tolerance * fabs((double)golden)) {
+        return DSP48E1_FAULT_TOLERATED;
+    }
+    return DSP48E1_FAULT_CORRUPTED;
+}
+
+/*
+ * Replay PE (row, col) from the snapshot before the fault, flip the bit and
+ * run to the end of the tile, or until the state matches a later snapshot
+ * (*reconverged is then set and the golden output is returned).  With no
+ * fault the PE is replayed from cycle 0 to the end without early exit.
+ * Returns the PE's last output.
+ */
+static float fault_replay(const fault_campaign_t *campaign,
+                          dsp48e1_model_t *pe,
+                          unsigned char *scratch,
+                          size_t row,
+                          size_t col,
+                          const dsp48e1_fault_t *fault,
+                          int *reconverged,
+                          uint64_t *replayed_cycles) {
+    const dsp48e1_model_t *model = campaign->model;
+    const size_t elements = model->rows * model->cols;
+    const size_t idx = row * model->cols + col;
+    const float *lhs_row = campaign->lhs + row * campaign->lhs_stride;
+    const float *rhs_col = campaign->rhs + col;
+    const size_t record_bytes = campaign->record_bytes;
+    const uint64_t start = fault ? fault->cycle - fault->cycle % campaign->interval : 0;
+
+    const unsigned char *snapshot = campaign->snapshots +
+                                    ((size_t)(start / campaign->interval) * elements + idx) * record_bytes;
+    float out = fault_scatter(pe, snapshot);
+    *reconverged = 0;
+
+    for (uint64_t cycle = start; cycle < campaign->tile_cycles; ++cycle) {
+        if (fault && cycle == fault->cycle) {
+            fault_flip(pe, fault);
+        } else if (fault && cycle > fault->cycle && cycle % campaign->interval == 0) {
+            snapshot = campaign->snapshots +
+                       ((size_t)(cycle / campaign->interval) * elements + idx) * record_bytes;
+            fault_gather(pe, 0, out, record_bytes, scratch);
+            if (memcmp(scratch, snapshot, record_bytes) == 0) {
+                *reconverged = 1;
+                return campaign->golden[idx];
+            }
+        }
+
+        const int input_valid = cycle < campaign->k;
+        const float a = input_valid ? lhs_row[cycle] : 0.0f;
+        const float b = input_valid ? rhs_col[cycle * campaign->rhs_stride] : 0.0f;
+        uint64_t out_valid = 0;
+        float value = 0.0f;
+        dsp48e1_model_step_tile_fp32(pe, input_valid, input_valid ? &a : NULL, input_valid ? &b : NULL,
+                                     NULL, &out_valid, &value);
+        out = (out_valid & 1U) ? value : out;
+        (*replayed_cycles)++;
+    }
+    return out;
+}
+
+/* Replay one trial's fault and record its outcome. */
+static void fault_trial(const fault_campaign_t *campaign,
+                        dsp48e1_model_t *pe,
+                        unsigned char *scratch,
+                        dsp48e1_fault_t *fault,
+                        dsp48e1_fault_stats_t *stats) {
+    int reconverged;
+    fault->golden = campaign->golden[(size_t)fault->row * campaign->model->cols + fault->col];
+    fault->faulty = fault_replay(campaign, pe, scratch, fault->row, fault->col, fault,
+                                 &reconverged, &stats->replayed_cycles);
+    fault->outcome = (uint8_t)fault_classify(fault->golden, fault->faulty, campaign->tolerance);
+
+    stats->trials++;
+    stats->reconverged += (uint64_t)reconverged;
+    stats->outcomes[fault->outcome]++;
+    stats->target_trials[fault->target]++;
+    stats->target_outcomes[fault->target][fault->outcome]++;
+    if (fault->outcome == DSP48E1_FAULT_CORRUPTED && isfinite(fault->faulty) && isfinite(fault->golden)) {
+        const double error = fabs((double)fault->faulty - (double)fault->golden);
+        stats->max_abs_error = error > stats->max_abs_error ? error : stats->max_abs_error;
+    }
+}
+
+static void *fault_worker_main(void *arg) {
+    fault_worker_t *worker = (fault_worker_t *)arg;
+    const fault_campaign_t *campaign = worker->campaign;
+    dsp48e1_model_t pe;
+    unsigned char *scratch = (unsigned char *)malloc(campaign->record_bytes);
+
+    if (!scratch || dsp48e1_model_init(&pe, &campaign->model->config, 1, 1, 1) != 0) {
+        free(scratch);
+        worker->status = -1;
+        return NULL;
+    }
+
+    for (uint64_t trial = worker->first; trial < worker->end; ++trial) {
+        dsp48e1_fault_t fault;
+        fault_draw(campaign, campaign->model, trial, &fault);
+        fault_trial(campaign, &pe, scratch, &fault, &worker->stats);
+        if (worker->faults) {
+            worker->faults[trial - worker->first] = fault;
+        }
+    }
+
+    dsp48e1_model_free(&pe);
+    free(scratch);
+    worker->status = 0;
+    return NULL;
+}
+
+/*
+ * Fault-free run of the tile, one K step per cycle and then the flush, with
+ * every PE's registers recorded every interval cycles.  Same arithmetic as
+ * dsp48e1_model_stream_push() and dsp48e1_model_stream_end().
+ */
+static int fault_golden(fault_campaign_t *campaign, const float *bias, float *golden) {
+    dsp48e1_model_t *model = campaign->model;
+    const size_t rows = model->rows;
+    const size_t cols = model->cols;
+    const size_t elements = rows * cols;
+    const size_t record_bytes = campaign->record_bytes;
+    float *a_panel = (float *)malloc(sizeof(float) * elements);
+    float *b_panel = (float *)malloc(sizeof(float) * elements);
+    float *values = (float *)malloc(sizeof(float) * elements);
+    uint64_t *valid = (uint64_t *)malloc(sizeof(uint64_t) * model->valid_words);
+
+    if (!a_panel || !b_panel || !values || !valid ||
+        dsp48e1_model_stream_begin(model, bias) != 0) {
+        free(a_panel);
+        free(b_panel);
+        free(values);
+        free(valid);
+        return -1;
+    }
+    memset(golden, 0, sizeof(float) * elements);
+
+    for (uint64_t cycle = 0; cycle <= campaign->tile_cycles; ++cycle) {
+        if (cycle % campaign->interval == 0) {
+            unsigned char *snapshot = campaign->snapshots +
+                                      (size_t)(cycle / campaign->interval) * elements * record_bytes;
+            for (size_t idx = 0; idx < elements; ++idx) {
+                fault_gather(model, idx, golden[idx], record_bytes, snapshot + idx * record_bytes);
+            }
+        }
+        if (cycle == campaign->tile_cycles) {
+            break;
+        }
+
+        const int input_valid = cycle < campaign->k;
+        if (input_valid) {
+            const float *rhs_row = campaign->rhs + cycle * campaign->rhs_stride;
+            for (size_t row = 0; row < rows; ++row) {
+                const float a = campaign->lhs[row * campaign->lhs_stride + cycle];
+                for (size_t col = 0; col < cols; ++col) {
+                    a_panel[row * cols + col] = a;
+                    b_panel[row * cols + col] = rhs_row[col];
+                }
+            }
+        }
+        dsp48e1_model_step_tile_fp32(model, input_valid, input_valid ? a_panel : NULL,
+                                     input_valid ? b_panel : NULL, NULL, valid, values);
+        for (size_t idx = 0; idx < elements; ++idx) {
+            const uint64_t word = valid[idx / DSP48E1_MODEL_VALID_BITS];
+            golden[idx] = ((word >> (idx % DSP48E1_MODEL_VALID_BITS)) & 1U) ? values[idx] : golden[idx];
+        }
+    }
+    model->stream_k = campaign->k;
+    model->stream_active = 0;
+
+    free(a_panel);
+    free(b_panel);
+    free(values);
+    free(valid);
+    return 0;
+}
+
+static void fault_merge(dsp48e1_fault_stats_t *total, const dsp48e1_fault_stats_t *part) {
+    total->trials += part->trials;
+    total->replayed_cycles += part->replayed_cycles;
+    total->reconverged += part->reconverged;
+    for (size_t o = 0; o < DSP48E1_FAULT_OUTCOMES; ++o) {
+        total->outcomes[o] += part->outcomes[o];
+    }
+    for (size_t t = 0; t < DSP48E1_FAULT_TARGETS; ++t) {
+        total->target_trials[t] += part->target_trials[t];
+        for (size_t o = 0; o < DSP48E1_FAULT_OUTCOMES; ++o) {
+            total->target_outcomes[t][o] += part->target_outcomes[t][o];
+        }
+    }
+    total->max_abs_error = part->max_abs_error > total->max_abs_error ? part->max_abs_error : total->max_abs_error;
+}
+
+/*
+ * Fill in the campaign, allocate the snapshots and run the golden tile.
+ * Returns -1 on invalid parameters, an empty target mask, a snapshot buffer
+ * whose size does not fit in size_t, or allocation failure.
+ */
+static int fault_prepare(fault_campaign_t *campaign,
+                         dsp48e1_model_t *model,
+                         const float *lhs,
+                         size_t lhs_stride,
+                         const float *rhs,
+                         size_t rhs_stride,
+                         size_t k,
+                         const float *bias,
+                         const dsp48e1_fault_options_t *options) {
+    memset(campaign, 0, sizeof(*campaign));
+    if (!model || !model->accumulators || !lhs || !rhs || !options || k == 0 ||
+        lhs_stride < k || rhs_stride < model->cols ||
+        (model->rows * model->cols) > UINT32_MAX) {
+        return -1;
+    }
+
+    campaign->model = model;
+    campaign->lhs = lhs;
+    campaign->lhs_stride = lhs_stride;
+    campaign->rhs = rhs;
+    campaign->rhs_stride = rhs_stride;
+    campaign->k = k;
+    campaign->tile_cycles = k + dsp48e1_config_latency(&model->config);
+    campaign->interval = options->snapshot_interval ? options->snapshot_interval : FAULT_DEFAULT_INTERVAL;
+    campaign->targets = options->targets ? options->targets : (1U << DSP48E1_FAULT_TARGETS) - 1U;
+    campaign->seed = options->seed;
+    campaign->tolerance = options->tolerance;
+
+    fault_stage_t stages[FAULT_STAGES];
+    fault_stages(model, stages);
+    for (size_t s = 0; s < FAULT_STAGES; ++s) {
+        campaign->total_span += stages[s].span;
+        campaign->target_bits[s] = (uint64_t)stages[s].span * 32U;
+    }
+    if (campaign->total_span > UINT16_MAX) {
+        return -1;
+    }
+    campaign->target_bits[DSP48E1_FAULT_VALID] = campaign->total_span;
+    campaign->target_bits[DSP48E1_FAULT_ACCUMULATOR] = fault_accumulator_bits(model->config.accum_mode);
+    for (size_t t = 0; t < DSP48E1_FAULT_TARGETS; ++t) {
+        if (!(campaign->targets & (1U << t))) {
+            campaign->target_bits[t] = 0;
+        }
+        campaign->register_bits += campaign->target_bits[t];
+    }
+    if (campaign->register_bits == 0) {
+        return -1;
+    }
+
+    const size_t elements = model->rows * model->cols;
+    const uint64_t snapshots = campaign->tile_cycles / campaign->interval + 1U;
+    size_t snapshot_bytes;
+    campaign->record_bytes = (FAULT_RECORD_HEADER + campaign->total_span * (sizeof(float) + 1U) + 7U) & ~(size_t)7U;
+    if (__builtin_mul_overflow(snapshots, elements, &snapshot_bytes) ||
+        __builtin_mul_overflow(snapshot_bytes, campaign->record_bytes, &snapshot_bytes)) {
+        return -1;
+    }
+    campaign->snapshot_count = (size_t)snapshots;
+
+    campaign->golden = (float *)malloc(sizeof(float) * elements);
+    campaign->snapshots = (unsigned char *)malloc(snapshot_bytes);
+    if (!campaign->golden || !campaign->snapshots || fault_golden(campaign, bias, campaign->golden) != 0) {
+        free(campaign->golden);
+        free(campaign->snapshots);
+        campaign->golden = NULL;
+        campaign->snapshots = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+static void fault_release(fault_campaign_t *campaign) {
+    free(campaign->golden);
+    free(campaign->snapshots);
+    campaign->golden = NULL;
+    campaign->snapshots = NULL;
+}
+
+int dsp48e1_fault_campaign_fp32(dsp48e1_model_t *model,
+                                const float *lhs,
+                                size_t lhs_stride,
+                                const float *rhs,
+                                size_t rhs_stride,
+                                size_t k,
+                                const float *bias,
+                                float *golden,
+                                size_t golden_stride,
+                                const dsp48e1_fault_options_t *options,
+                                dsp48e1_fault_t *faults,
+                                dsp48e1_fault_stats_t *stats) {
+    fault_campaign_t campaign;
+    if ((golden && model && golden_stride < model->cols) ||
+        fault_prepare(&campaign, model, lhs, lhs_stride, rhs, rhs_stride, k, bias, options) != 0) {
+        return -1;
+    }
+
+    const size_t rows = model->rows;
+    const size_t cols = model->cols;
+    size_t workers = options->threads ? options->threads : 1;
+    if (workers > options->trials) {
+        workers = options->trials ? (size_t)options->trials : 1;
+    }
+
+    fault_worker_t *pool = (fault_worker_t *)calloc(workers, sizeof(fault_worker_t));
+    pthread_t *handles = (pthread_t *)calloc(workers, sizeof(pthread_t));
+    uint8_t *started = (uint8_t *)calloc(workers, sizeof(uint8_t));
+    int status = pool && handles && started ? 0 : -1;
+
+    for (size_t w = 0; status == 0 && w < workers; ++w) {
+        fault_worker_t *worker = &pool[w];
+        worker->campaign = &campaign;
+        worker->first = options->trials * w / workers;
+        worker->end = options->trials * (w + 1) / workers;
+        worker->faults = faults ? faults + worker->first : NULL;
+        worker->status = -1;
+
+        if (w == 0) {
+            continue;
+        }
+        if (pthread_create(&handles[w], NULL, fault_worker_main, worker) != 0) {
+            status = -1;
+            break;
+        }
+        started[w] = 1;
+    }
+
+    if (status == 0) {
+        fault_worker_main(&pool[0]);
+    }
+
+    dsp48e1_fault_stats_t total;
+    memset(&total, 0, sizeof(total));
+    for (size_t w = 1; started && w < workers; ++w) {
+        if (started[w]) {
+            pthread_join(handles[w], NULL);
+        }
+    }
+    for (size_t w = 0; status == 0 && w < workers; ++w) {
+        if (pool[w].status != 0) {
+            status = -1;
+        }
+        fault_merge(&total, &pool[w].stats);
+    }
+
+    if (status == 0) {
+        total.register_bits = campaign.register_bits;
+        total.tile_cycles = campaign.tile_cycles;
+        total.snapshots = campaign.snapshot_count;
+        if (stats) {
+            *stats = total;
+        }
+        if (golden) {
+            for (size_t row = 0; row < rows; ++row) {
+                memcpy(golden + row * golden_stride, campaign.golden + row * cols, sizeof(float) * cols);
+            }
+        }
+    }
+
+    fault_release(&campaign);
+    free(pool);
+    free(handles);
+    free(started);
+    return status;
+}
+
+static int fault_same(const dsp48e1_fault_t *a, const dsp48e1_fault_t *b) {
+    return a->cycle == b->cycle && a->row == b->row && a->col == b->col && a->slot == b->slot &&
+           a->target == b->target && a->bit == b->bit && a->outcome == b->outcome &&
+           memcmp(&a->golden, &b->golden, sizeof(float)) == 0 && memcmp(&a->faulty, &b->faulty, sizeof(float)) == 0;
+}
+
+int dsp48e1_fault_self_test(void) {
+    enum { ROWS = 3, COLS = 4, K = 9, TRIALS = 1500 };
+    dsp48e1_config_t config;
+    dsp48e1_default_fp32_config(&config);
+    config.enable_rounding = 0;
+
+    float lhs[ROWS * K];
+    float rhs[K * COLS];
+    float bias[COLS];
+    float expected[ROWS * COLS];
+    float golden[ROWS * COLS];
+    for (size_t i = 0; i < ROWS * K; ++i) {
+        lhs[i] = (float)((int)(i * 37 % 19) - 9) * 0.375f;
+    }
+    for (size_t i = 0; i < K * COLS; ++i) {
+        rhs[i] = (float)((int)(i * 11 % 23) - 11) * 0.25f;
+    }
+    for (size_t col = 0; col < COLS; ++col) {
+        bias[col] = (float)col - 1.5f;
+    }
+
+    dsp48e1_model_t model;
+    if (dsp48e1_model_init(&model, &config, ROWS, COLS, K) != 0) {
+        return -1;
+    }
+    dsp48e1_fault_t *serial = (dsp48e1_fault_t *)malloc(sizeof(dsp48e1_fault_t) * TRIALS);
+    dsp48e1_fault_t *parallel = (dsp48e1_fault_t *)malloc(sizeof(dsp48e1_fault_t) * TRIALS);
+    int status = serial && parallel ? 0 : -1;
+    if (status == 0) {
+        status = dsp48e1_model_gemm_fp32(&model, lhs, K, rhs, COLS, bias, expected, COLS);
+    }
+
+    /* The golden run matches a plain GEMM, and trials do not depend on the thread count. */
+    dsp48e1_fault_options_t options;
+    memset(&options, 0, sizeof(options));
+    options.trials = TRIALS;
+    options.seed = 0x5EEDULL;
+    options.snapshot_interval = 4;
+    dsp48e1_fault_stats_t stats, parallel_stats;
+    if (status == 0 &&
+        (dsp48e1_fault_campaign_fp32(&model, lhs, K, rhs, COLS, K, bias, golden, COLS, &options, serial, &stats) != 0 ||
+         memcmp(golden, expected, sizeof(golden)) != 0)) {
+        status = -1;
+    }
+    options.threads = 3;
+    if (status == 0 &&
+        dsp48e1_fault_campaign_fp32(&model, lhs, K, rhs, COLS, K, bias, NULL, 0, &options, parallel, &parallel_stats) != 0) {
+        status = -1;
+    }
+
+    uint64_t outcomes = 0;
+    uint64_t targets = 0;
+    for (size_t o = 0; status == 0 && o < DSP48E1_FAULT_OUTCOMES; ++o) {
+        outcomes += stats.outcomes[o];
+        status = stats.outcomes[o] == parallel_stats.outcomes[o] ? 0 : -1;
+    }
+    for (size_t t = 0; status == 0 && t < DSP48E1_FAULT_TARGETS; ++t) {
+        targets += stats.target_trials[t];
+        status = stats.target_trials[t] == parallel_stats.target_trials[t] ? 0 : -1;
+    }
+    if (status == 0 &&
+        (stats.trials != TRIALS || outcomes != TRIALS || targets != TRIALS ||
+         stats.tile_cycles != K + dsp48e1_config_latency(&config) ||
+         stats.reconverged != parallel_stats.reconverged || stats.replayed_cycles != parallel_stats.replayed_cycles ||
+         stats.outcomes[DSP48E1_FAULT_MASKED] == 0 || stats.outcomes[DSP48E1_FAULT_CORRUPTED] == 0)) {
+        status = -1;
+    }
+    for (size_t i = 0; status == 0 && i < TRIALS; ++i) {
+        const dsp48e1_fault_t *fault = &serial[i];
+        const float reference = expected[fault->row * COLS + fault->col];
+        if (!fault_same(fault, &parallel[i]) || fault->cycle >= stats.tile_cycles ||
+            memcmp(&fault->golden, &reference, sizeof(float)) != 0 ||
+            fault->outcome != fault_classify(fault->golden, fault->faulty, 0.0)) {
+            status = -1;
+        }
+    }
+
+    /* A target mask confines the faults, and accumulator flips reach some outputs. */
+    options.targets = 1U << DSP48E1_FAULT_ACCUMULATOR;
+    options.trials = 200;
+    if (status == 0 &&
+        dsp48e1_fault_campaign_fp32(&model, lhs, K, rhs, COLS, K, bias, NULL, 0, &options, serial, &stats) != 0) {
+        status = -1;
+    }
+    for (size_t i = 0; status == 0 && i < options.trials; ++i) {
+        if (serial[i].target != DSP48E1_FAULT_ACCUMULATOR) {
+            status = -1;
+        }
+    }
+    if (status == 0 && (stats.target_trials[DSP48E1_FAULT_ACCUMULATOR] != options.trials ||
+                        stats.outcomes[DSP48E1_FAULT_MASKED] == options.trials)) {
+        status = -1;
+    }
+
+    /* An empty K and a mask naming no register are rejected. */
+    options.targets = 1U << DSP48E1_FAULT_TARGETS;
+    if (status == 0 &&
+        (dsp48e1_fault_campaign_fp32(&model, lhs, K, rhs, COLS, K, bias, NULL, 0, &options, NULL, NULL) == 0 ||
+         dsp48e1_fault_campaign_fp32(&model, lhs, K, rhs, COLS, 0, bias, NULL, 0, &options, NULL, NULL) == 0)) {
+        status = -1;
+    }
+
+    /* Replaying each PE from cycle 0 without a fault reproduces the golden output bit for bit. */
+    fault_campaign_t campaign;
+    dsp48e1_model_t pe;
+    unsigned char *scratch = NULL;
+    options.targets = 0;
+    if (status == 0 && fault_prepare(&campaign, &model, lhs, K, rhs, COLS, K, bias, &options) != 0) {
+        status = -1;
+    } else if (status == 0) {
+        scratch = (unsigned char *)malloc(campaign.record_bytes);
+        if (!scratch || dsp48e1_model_init(&pe, &config, 1, 1, 1) != 0) {
+            free(scratch);
+            fault_release(&campaign);
+            scratch = NULL;
+            status = -1;
+        }
+    }
+    for (size_t idx = 0; scratch && status == 0 && idx < ROWS * COLS; ++idx) {
+        int reconverged;
+        uint64_t replayed = 0;
+        const float out = fault_replay(&campaign, &pe, scratch, idx / COLS, idx % COLS, NULL,
+                                       &reconverged, &replayed);
+        if (memcmp(&out, &expected[idx], sizeof(float)) != 0 || reconverged ||
+            replayed != campaign.tile_cycles) {
+            status = -1;
+        }
+    }
+
+    /*
+     * Flipping the sign of PE (1, 3)'s accumulator before the first cycle
+     * turns its bias of +1.5 into -1.5.  The sums are exact, so the output
+     * drops by exactly 3 and is classed as corrupted.
+     */
+    if (scratch && status == 0) {
+        dsp48e1_fault_t fault;
+        memset(&fault, 0, sizeof(fault));
+        fault.row = 1;
+        fault.col = 3;
+        fault.target = DSP48E1_FAULT_ACCUMULATOR;
+        fault.bit = 31;
+        memset(&stats, 0, sizeof(stats));
+        fault_trial(&campaign, &pe, scratch, &fault, &stats);
+        const float reference = expected[1 * COLS + 3];
+        const float corrupted = reference - 3.0f;
+        if (memcmp(&fault.golden, &reference, sizeof(float)) != 0 ||
+            memcmp(&fault.faulty, &corrupted, sizeof(float)) != 0 ||
+            fault.outcome != DSP48E1_FAULT_CORRUPTED || stats.outcomes[DSP48E1_FAULT_CORRUPTED] != 1 ||
+            stats.reconverged != 0 || stats.max_abs_error != 3.0) {
+            status = -1;
+        }
+    }
+    if (scratch) {
+        dsp48e1_model_free(&pe);
+        free(scratch);
+        fault_release(&campaign);
+    }
+
+    free(serial);
+    free(parallel);
+    dsp48e1_model_free(&model);
+    return status;
+}
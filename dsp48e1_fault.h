@@ -0,0 +1,126 @@
+#ifndef DSP48E1_FAULT_H
+#define DSP48E1_FAULT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dsp48e1_model.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file dsp48e1_fault.h
+ *
+ * Monte Carlo soft-error injection into the model's pipeline registers.  A
+ * campaign runs one golden tile and keeps snapshots of every PE's register
+ * state at a fixed cycle interval.  Each trial flips one bit in one PE at
+ * one cycle and measures how that PE's output changes.
+ *
+ * PEs exchange no data, so a flip in one PE cannot reach another.  A trial
+ * therefore restores only the affected PE from the nearest earlier snapshot
+ * into a private 1 x 1 model, replays it through the injection cycle and on
+ * to the end of the tile.  When the faulty state matches the golden state
+ * at a later snapshot, the fault has been overwritten and the trial stops
+ * early.  A trial costs about K + latency single-PE cycles at most,
+ * whatever the tile size.
+ *
+ * Every bit of the enabled targets is equally likely to be hit, as for a
+ * uniform upset rate per flip-flop.  Trial i draws its fault from seed and
+ * i alone, so results do not depend on the thread count.
+ */
+
+/* Register groups a fault can hit. */
+typedef enum {
+    DSP48E1_FAULT_PIPELINE_MUL = 0,   /* pipeline_mul values. */
+    DSP48E1_FAULT_PIPELINE_ADD,
+    DSP48E1_FAULT_PIPELINE_ACCUM,
+    DSP48E1_FAULT_PIPELINE_ROUND,
+    DSP48E1_FAULT_PIPELINE_OUT,
+    DSP48E1_FAULT_VALID,              /* Valid flag of any pipeline slot. */
+    /* Running sum: FP32 or FP64 sum, 48-bit P value, Kahan sum + compensation. */
+    DSP48E1_FAULT_ACCUMULATOR,
+    DSP48E1_FAULT_TARGETS
+} dsp48e1_fault_target_t;
+
+typedef enum {
+    DSP48E1_FAULT_MASKED = 0,  /* Output bitwise identical to the golden run. */
+    DSP48E1_FAULT_TOLERATED,   /* Output within tolerance of the golden value. */
+    DSP48E1_FAULT_CORRUPTED,   /* Silent data corruption. */
+    DSP48E1_FAULT_NON_FINITE,  /* A finite golden output became Inf or NaN. */
+    DSP48E1_FAULT_OUTCOMES
+} dsp48e1_fault_outcome_t;
+
+typedef struct {
+    uint64_t trials;
+    uint64_t seed;
+    uint32_t targets;          /* Mask of 1 << dsp48e1_fault_target_t; 0 = all. */
+    size_t threads;            /* Worker threads; 0 or 1 = caller only. */
+    size_t snapshot_interval;  /* Golden cycles between snapshots; 0 = 16. */
+    double tolerance;          /* Relative error counted as tolerated; 0 = equal values only. */
+} dsp48e1_fault_options_t;
+
+/* One injected fault and its effect. */
+typedef struct {
+    uint64_t cycle;   /* The bit flips before this tile cycle is clocked. */
+    uint32_t row;
+    uint32_t col;
+    uint16_t slot;    /* Pipeline slot within the stage; 0 for the accumulator. */
+    uint8_t target;   /* dsp48e1_fault_target_t */
+    uint8_t bit;      /* For VALID, the stage (a dsp48e1_fault_target_t). */
+    uint8_t outcome;  /* dsp48e1_fault_outcome_t */
+    float golden;
+    float faulty;
+} dsp48e1_fault_t;
+
+typedef struct {
+    uint64_t trials;
+    uint64_t outcomes[DSP48E1_FAULT_OUTCOMES];
+    uint64_t target_trials[DSP48E1_FAULT_TARGETS];
+    uint64_t target_outcomes[DSP48E1_FAULT_TARGETS][DSP48E1_FAULT_OUTCOMES];
+    uint64_t register_bits;    /* Injectable bits per PE in the enabled targets. */
+    uint64_t tile_cycles;      /* K + pipeline latency. */
+    uint64_t snapshots;
+    uint64_t replayed_cycles;  /* Single-PE cycles simulated by all trials. */
+    uint64_t reconverged;      /* Trials stopped early at a matching snapshot. */
+    double max_abs_error;      /* Largest finite |faulty - golden| of a corrupted output. */
+} dsp48e1_fault_stats_t;
+
+/**
+ * Run options->trials single-bit faults against dst = lhs (rows x k) *
+ * rhs (k x cols) + bias on the model's rows x cols shape.  bias (length
+ * cols) and golden may be NULL.  golden receives the fault-free result,
+ * and the model is left in the golden run's final state.  faults (may be
+ * NULL) receives one record per trial, and stats (may be NULL) the totals.
+ *
+ * Returns 0 on success, or -1 on invalid parameters, an empty target mask,
+ * a snapshot buffer too large for size_t, or allocation or thread errors.
+ */
+int dsp48e1_fault_campaign_fp32(dsp48e1_model_t *model,
+                                const float *lhs,
+                                size_t lhs_stride,
+                                const float *rhs,
+                                size_t rhs_stride,
+                                size_t k,
+                                const float *bias,
+                                float *golden,
+                                size_t golden_stride,
+                                const dsp48e1_fault_options_t *options,
+                                dsp48e1_fault_t *faults,
+                                dsp48e1_fault_stats_t *stats);
+
+/**
+ * Check the golden run against a plain GEMM, identical trials at one and
+ * three threads, outcome classification, target masks, rejected
+ * parameters, a fault-free replay of every PE against the golden outputs
+ * and one targeted accumulator flip with a known result.  Returns 0 on
+ * success.
+ */
+int dsp48e1_fault_self_test(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DSP48E1_FAULT_H */
@@ -0,0 +1,535 @@
+#include "dsp48e1_format.h"
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dsp48e1.h"
+
+enum {
+    FORMAT_TABLE_BITS = 8,    /* Formats up to this width get lookup tables. */
+    FORMAT_A_BITS = 24,       /* Unsigned width of the 25-bit A port. */
+    FORMAT_P_BITS = 48,
+    FORMAT_PRODUCT_BITS = 24, /* Products must be exact FP32 significands. */
+    FORMAT_PACK_CHUNK = 256   /* Packed A words per bound-B stream call. */
+};
+
+#define FORMAT_MAX_LANES 6 /* Two-bit significands: offsets 0, 4, ..., 20. */
+
+void dsp48e1_format_e4m3(dsp48e1_format_desc_t *desc) {
+    if (!desc) {
+        return;
+    }
+    desc->kind = DSP48E1_FORMAT_CUSTOM;
+    desc->total_bits = 8;
+    desc->exponent_bits = 4;
+    desc->mantissa_bits = 3;
+    desc->fractional_bits = 0;
+    desc->specials = DSP48E1_SPECIALS_FN;
+    desc->exponent_bias = 7;
+}
+
+void dsp48e1_format_e5m2(dsp48e1_format_desc_t *desc) {
+    if (!desc) {
+        return;
+    }
+    desc->kind = DSP48E1_FORMAT_CUSTOM;
+    desc->total_bits = 8;
+    desc->exponent_bits = 5;
+    desc->mantissa_bits = 2;
+    desc->fractional_bits = 0;
+    desc->specials = DSP48E1_SPECIALS_IEEE;
+    desc->exponent_bias = 15;
+}
+
+unsigned dsp48e1_format_products_per_slice(const dsp48e1_format_desc_t *desc) {
+    if (!desc) {
+        return 0;
+    }
+    if (desc->kind == DSP48E1_FORMAT_INT8) {
+        return 1;
+    }
+    const unsigned width = (unsigned)desc->mantissa_bits + 1U;
+    if (2U * width > FORMAT_PRODUCT_BITS) {
+        return 0;
+    }
+    /* Lane i sits at bit i * 2w of A; its product at the same bit of P. */
+    unsigned lanes = 1;
+    while (lanes * 2U * width + width <= FORMAT_A_BITS && (lanes + 1U) * 2U * width <= FORMAT_P_BITS) {
+        ++lanes;
+    }
+    return lanes;
+}
+
+/* ---- scalar codec -------------------------------------------------------- */
+
+static uint32_t format_sign_bit(const dsp48e1_format_codec_t *codec) {
+    return 1U << (codec->desc.total_bits - 1U);
+}
+
+static void format_parts_compute(const dsp48e1_format_codec_t *codec, uint32_t code, dsp48e1_format_parts_t *parts) {
+    const unsigned m = codec->desc.mantissa_bits;
+    const uint32_t magnitude = code & (format_sign_bit(codec) - 1U);
+    const uint32_t field = magnitude >> m;
+    const uint32_t mantissa = magnitude & ((1U << m) - 1U);
+
+    memset(parts, 0, sizeof(*parts));
+    parts->sign = (uint8_t)((code >> (codec->desc.total_bits - 1U)) & 1U);
+    if (magnitude > codec->max_finite) {
+        parts->special = magnitude == codec->inf_code && codec->inf_code != codec->nan_code ? 1 : 2;
+        return;
+    }
+    if (field != 0) {
+        parts->significand = mantissa | (1U << m);
+        parts->exponent = (int16_t)((int32_t)field - codec->desc.exponent_bias - (int32_t)m);
+    } else {
+        parts->significand = mantissa;
+        parts->exponent = (int16_t)(1 - codec->desc.exponent_bias - (int32_t)m);
+    }
+}
+
+static float format_decode_compute(const dsp48e1_format_codec_t *codec, uint32_t code) {
+    dsp48e1_format_parts_t parts;
+    format_parts_compute(codec, code, &parts);
+    float value;
+    if (parts.special) {
+        value = parts.special == 1 ? INFINITY : NAN;
+    } else {
+        value = ldexpf((float)parts.significand, parts.exponent);
+    }
+    return parts.sign ? -value : value;
+}
+
+/*
+ * Round value to the format.  value is a double so that products of two
+ * decoded operands (at most 2 x 24 significand bits) arrive unrounded.
+ */
+static uint32_t format_encode_double(const dsp48e1_format_codec_t *codec, double value, int saturate) {
+    if (isnan(value)) {
+        return codec->nan_code;
+    }
+    const uint32_t sign = signbit(value) ? format_sign_bit(codec) : 0U;
+    const uint32_t overflow = saturate ? codec->max_finite : codec->inf_code;
+    const double magnitude = fabs(value);
+    if (magnitude == 0.0) {
+        return sign;
+    }
+    if (isinf(magnitude)) {
+        return sign | overflow;
+    }
+
+    const int m = codec->desc.mantissa_bits;
+    const int emin = 1 - codec->desc.exponent_bias;
+    const int emax = (int)(codec->max_finite >> m) - codec->desc.exponent_bias;
+    int exponent;
+    frexp(magnitude, &exponent);
+    exponent -= 1; /* magnitude in [2^exponent, 2^(exponent + 1)) */
+    if (exponent > emax) {
+        return sign | overflow;
+    }
+    if (exponent < emin) {
+        exponent = emin; /* Subnormal: the quantum stays 2^(emin - m). */
+    }
+
+    /*
+     * (exponent - emin) << m plus the rounded significand gives the code for
+     * normals and subnormals alike, and a rounding carry moves into the
+     * exponent field.
+     */
+    const uint64_t significand = (uint64_t)nearbyint(ldexp(magnitude, m - exponent));
+    const uint64_t code = ((uint64_t)(exponent - emin) << m) + significand;
+    if (code > codec->max_finite) {
+        return sign | overflow;
+    }
+    return sign | (uint32_t)code;
+}
+
+/* ---- codec setup --------------------------------------------------------- */
+
+static int format_desc_valid(const dsp48e1_format_desc_t *desc) {
+    if (desc->kind == DSP48E1_FORMAT_INT8 ||
+        desc->exponent_bits < 1 || desc->exponent_bits > 8 ||
+        desc->mantissa_bits < 1 || desc->mantissa_bits > 23 ||
+        desc->total_bits != 1U + desc->exponent_bits + desc->mantissa_bits ||
+        (desc->specials != DSP48E1_SPECIALS_IEEE && desc->specials != DSP48E1_SPECIALS_FN)) {
+        return 0;
+    }
+    /* Largest exponent below 2^128 and smallest subnormal at least 2^-149. */
+    const int32_t top_field = (1 << desc->exponent_bits) - (desc->specials == DSP48E1_SPECIALS_IEEE ? 2 : 1);
+    return top_field - desc->exponent_bias <= 127 &&
+           1 - desc->exponent_bias - (int32_t)desc->mantissa_bits >= -149;
+}
+
+int dsp48e1_format_codec_init(dsp48e1_format_codec_t *codec, const dsp48e1_format_desc_t *desc) {
+    if (!codec || !desc) {
+        return -1;
+    }
+    memset(codec, 0, sizeof(*codec));
+    if (!format_desc_valid(desc)) {
+        return -1;
+    }
+
+    codec->desc = *desc;
+    const unsigned m = desc->mantissa_bits;
+    const uint32_t exponent_ones = ((1U << desc->exponent_bits) - 1U) << m;
+    if (desc->specials == DSP48E1_SPECIALS_FN) {
+        codec->nan_code = exponent_ones | ((1U << m) - 1U);
+        codec->inf_code = codec->nan_code;
+        codec->max_finite = codec->nan_code - 1U;
+    } else {
+        codec->inf_code = exponent_ones;
+        codec->nan_code = exponent_ones | (1U << (m - 1U));
+        codec->max_finite = exponent_ones - 1U;
+    }
+    codec->significand_bits = m + 1U;
+    codec->lanes = dsp48e1_format_products_per_slice(desc);
+
+    if (desc->total_bits > FORMAT_TABLE_BITS) {
+        return 0;
+    }
+    const size_t count = (size_t)1 << desc->total_bits;
+    codec->decode_table = (float *)malloc(count * sizeof(float));
+    codec->parts_table = (dsp48e1_format_parts_t *)malloc(count * sizeof(dsp48e1_format_parts_t));
+    codec->mul_table = (uint8_t *)malloc(count * count);
+    if (!codec->decode_table || !codec->parts_table || !codec->mul_table) {
+        dsp48e1_format_codec_free(codec);
+        return -1;
+    }
+    for (size_t code = 0; code < count; ++code) {
+        codec->decode_table[code] = format_decode_compute(codec, (uint32_t)code);
+        format_parts_compute(codec, (uint32_t)code, &codec->parts_table[code]);
+    }
+    for (size_t a = 0; a < count; ++a) {
+        for (size_t b = 0; b < count; ++b) {
+            const double product = (double)codec->decode_table[a] * (double)codec->decode_table[b];
+            codec->mul_table[a * count + b] = (uint8_t)format_encode_double(codec, product, 0);
+        }
+    }
+    return 0;
+}
+
+void dsp48e1_format_codec_free(dsp48e1_format_codec_t *codec) {
+    if (!codec) {
+        return;
+    }
+    free(codec->decode_table);
+    free(codec->parts_table);
+    free(codec->mul_table);
+    codec->decode_table = NULL;
+    codec->parts_table = NULL;
+    codec->mul_table = NULL;
+}
+
+size_t dsp48e1_format_code_bytes(const dsp48e1_format_codec_t *codec) {
+    if (codec->desc.total_bits <= 8) {
+        return 1;
+    }
+    return codec->desc.total_bits <= 16 ? 2 : 4;
+}
+
+/* ---- public scalar API --------------------------------------------------- */
+
+static uint32_t format_code_mask(const dsp48e1_format_codec_t *codec) {
+    return (uint32_t)((1ULL << codec->desc.total_bits) - 1ULL);
+}
+
+float dsp48e1_format_decode(const dsp48e1_format_codec_t *codec, uint32_t code) {
+    code &= format_code_mask(codec);
+    return codec->decode_table ? codec->decode_table[code] : format_decode_compute(codec, code);
+}
+
+void dsp48e1_format_parts(const dsp48e1_format_codec_t *codec, uint32_t code, dsp48e1_format_parts_t *parts) {
+    code &= format_code_mask(codec);
+    if (codec->parts_table) {
+        *parts = codec->parts_table[code];
+    } else {
+        format_parts_compute(codec, code, parts);
+    }
+}
+
+uint32_t dsp48e1_format_encode(const dsp48e1_format_codec_t *codec, float value, int saturate) {
+    return format_encode_double(codec, (double)value, saturate);
+}
+
+uint32_t dsp48e1_format_mul(const dsp48e1_format_codec_t *codec, uint32_t a, uint32_t b) {
+    const uint32_t mask = format_code_mask(codec);
+    if (codec->mul_table) {
+        return codec->mul_table[((size_t)(a & mask) << codec->desc.total_bits) | (b & mask)];
+    }
+    const double product = (double)dsp48e1_format_decode(codec, a) * (double)dsp48e1_format_decode(codec, b);
+    return format_encode_double(codec, product, 0);
+}
+
+/* ---- batch API ----------------------------------------------------------- */
+
+static uint32_t format_load(const void *codes, size_t bytes, size_t i) {
+    switch (bytes) {
+    case 1:
+        return ((const uint8_t *)codes)[i];
+    case 2:
+        return ((const uint16_t *)codes)[i];
+    default:
+        return ((const uint32_t *)codes)[i];
+    }
+}
+
+static void format_store(void *codes, size_t bytes, size_t i, uint32_t code) {
+    switch (bytes) {
+    case 1:
+        ((uint8_t *)codes)[i] = (uint8_t)code;
+        break;
+    case 2:
+        ((uint16_t *)codes)[i] = (uint16_t)code;
+        break;
+    default:
+        ((uint32_t *)codes)[i] = code;
+        break;
+    }
+}
+
+void dsp48e1_format_decode_batch(const dsp48e1_format_codec_t *codec, const void *codes, size_t n, float *values) {
+    if (codec->decode_table) {
+        const uint8_t *bytes = (const uint8_t *)codes;
+        const uint8_t mask = (uint8_t)format_code_mask(codec);
+        for (size_t i = 0; i < n; ++i) {
+            values[i] = codec->decode_table[bytes[i] & mask];
+        }
+        return;
+    }
+    const size_t bytes = dsp48e1_format_code_bytes(codec);
+    for (size_t i = 0; i < n; ++i) {
+        values[i] = format_decode_compute(codec, format_load(codes, bytes, i) & format_code_mask(codec));
+    }
+}
+
+void dsp48e1_format_encode_batch(const dsp48e1_format_codec_t *codec, const float *values, size_t n, int saturate, void *codes) {
+    const size_t bytes = dsp48e1_format_code_bytes(codec);
+    for (size_t i = 0; i < n; ++i) {
+        format_store(codes, bytes, i, format_encode_double(codec, (double)values[i], saturate));
+    }
+}
+
+void dsp48e1_format_mul_batch(const dsp48e1_format_codec_t *codec, const void *a, const void *b, size_t n, void *out) {
+    if (codec->mul_table) {
+        const uint8_t *lhs = (const uint8_t *)a;
+        const uint8_t *rhs = (const uint8_t *)b;
+        uint8_t *dst = (uint8_t *)out;
+        const unsigned shift = codec->desc.total_bits;
+        const uint8_t mask = (uint8_t)format_code_mask(codec);
+        for (size_t i = 0; i < n; ++i) {
+            dst[i] = codec->mul_table[((size_t)(lhs[i] & mask) << shift) | (rhs[i] & mask)];
+        }
+        return;
+    }
+    const size_t bytes = dsp48e1_format_code_bytes(codec);
+    for (size_t i = 0; i < n; ++i) {
+        format_store(out, bytes, i, dsp48e1_format_mul(codec, format_load(a, bytes, i), format_load(b, bytes, i)));
+    }
+}
+
+/* ---- packed slice products ----------------------------------------------- */
+
+int dsp48e1_format_mul_packed(const dsp48e1_format_codec_t *codec,
+                              const void *a,
+                              uint32_t b,
+                              size_t n,
+                              float *products,
+                              uint64_t *slice_ops) {
+    if (!codec || codec->lanes == 0 || (n > 0 && (!a || !products))) {
+        return -1;
+    }
+
+    const size_t bytes = dsp48e1_format_code_bytes(codec);
+    const unsigned lanes = codec->lanes;
+    const unsigned width = 2U * codec->significand_bits;
+    const uint64_t product_mask = (1ULL << width) - 1ULL;
+
+    dsp48e1_format_parts_t rhs;
+    dsp48e1_format_parts(codec, b, &rhs);
+    const float rhs_value = dsp48e1_format_decode(codec, b);
+    const int32_t rhs_significand = (int32_t)rhs.significand;
+    dsp48e1_bound_b_t bound;
+    dsp48e1_bind_b(&rhs_significand, NULL, 1, 0b00000, &bound);
+
+    int32_t packed[FORMAT_PACK_CHUNK];
+    int64_t p[FORMAT_PACK_CHUNK];
+    dsp48e1_format_parts_t lhs[FORMAT_PACK_CHUNK * FORMAT_MAX_LANES];
+    uint64_t ops = 0;
+
+    for (size_t base = 0; base < n; base += (size_t)FORMAT_PACK_CHUNK * lanes) {
+        const size_t count = n - base < (size_t)FORMAT_PACK_CHUNK * lanes ? n - base : (size_t)FORMAT_PACK_CHUNK * lanes;
+        const size_t groups = (count + lanes - 1U) / lanes;
+
+        /* Significand i of a group at bit (i % lanes) * 2w of the A port. */
+        memset(packed, 0, groups * sizeof(packed[0]));
+        for (size_t i = 0; i < count; ++i) {
+            dsp48e1_format_parts(codec, format_load(a, bytes, base + i), &lhs[i]);
+            packed[i / lanes] |= (int32_t)(lhs[i].significand << ((i % lanes) * width));
+        }
+
+        const dsp48e1_batch_ports_t ports = {packed, NULL, NULL, NULL, NULL, NULL, NULL, NULL};
+        dsp48e1_bound_b_batch(&bound, 0, &ports, groups, 0b0000101, 0b0000, 0b00000, 0b000, p);
+        ops += groups;
+
+        for (size_t i = 0; i < count; ++i) {
+            if (lhs[i].special | rhs.special) {
+                products[base + i] = dsp48e1_format_decode(codec, format_load(a, bytes, base + i)) * rhs_value;
+                continue;
+            }
+            const uint64_t product = ((uint64_t)p[i / lanes] >> ((i % lanes) * width)) & product_mask;
+            /* The product has at most 24 bits, so only ldexpf can round (into subnormals). */
+            const float value = ldexpf((float)product, lhs[i].exponent + rhs.exponent);
+            products[base + i] = (lhs[i].sign ^ rhs.sign) ? -value : value;
+        }
+    }
+
+    if (slice_ops) {
+        *slice_ops = ops;
+    }
+    return 0;
+}
+
+/* ---- self-test ----------------------------------------------------------- */
+
+/* Every code of codec: decode/encode round trip, table products and packed products. */
+static int format_check_codes(const dsp48e1_format_codec_t *codec, size_t count) {
+    uint32_t *codes = (uint32_t *)malloc(count * sizeof(uint32_t));
+    float *values = (float *)malloc(count * sizeof(float));
+    float *products = (float *)malloc(count * sizeof(float));
+    uint8_t *narrow = (uint8_t *)malloc(count * 4U);
+    uint8_t *narrow_out = (uint8_t *)malloc(count * 4U);
+    int status = codes && values && products && narrow && narrow_out ? 0 : -1;
+
+    const size_t bytes = status == 0 ? dsp48e1_format_code_bytes(codec) : 0;
+    for (size_t i = 0; i < count && status == 0; ++i) {
+        codes[i] = (uint32_t)i;
+        format_store(narrow, bytes, i, (uint32_t)i);
+        dsp48e1_format_parts_t parts;
+        dsp48e1_format_parts(codec, (uint32_t)i, &parts);
+        const float value = dsp48e1_format_decode(codec, (uint32_t)i);
+        const uint32_t back = dsp48e1_format_encode(codec, value, 0);
+        if (parts.special == 2 ? (!isnan(value) || back != codec->nan_code) : back != (uint32_t)i) {
+            status = -1;
+        }
+    }
+
+    if (status == 0) {
+        dsp48e1_format_decode_batch(codec, narrow, count, values);
+        dsp48e1_format_encode_batch(codec, values, count, 0, narrow_out);
+        for (size_t i = 0; i < count && status == 0; ++i) {
+            const float value = dsp48e1_format_decode(codec, codes[i]);
+            const uint32_t code = format_load(narrow_out, bytes, i);
+            if (memcmp(&values[i], &value, sizeof(value)) != 0 ||
+                code != dsp48e1_format_encode(codec, value, 0)) {
+                status = -1;
+            }
+        }
+    }
+
+    /* Products against a few right-hand codes, including zero, a subnormal, Inf/NaN and the top code. */
+    const uint32_t rhs_codes[] = {0U, 1U, 3U << codec->desc.mantissa_bits, codec->max_finite,
+                                  codec->inf_code, format_sign_bit(codec) | codec->nan_code};
+    for (size_t r = 0; r < sizeof(rhs_codes) / sizeof(rhs_codes[0]) && status == 0; ++r) {
+        const uint32_t b = rhs_codes[r];
+        const float rhs_value = dsp48e1_format_decode(codec, b);
+        for (size_t i = 0; i < count; ++i) {
+            format_store(narrow_out, bytes, i, b);
+        }
+        dsp48e1_format_mul_batch(codec, narrow, narrow_out, count, narrow_out);
+        uint64_t slice_ops = 0;
+        if (dsp48e1_format_mul_packed(codec, narrow, b, count, products, &slice_ops) != 0 ||
+            slice_ops != (count + codec->lanes - 1U) / codec->lanes) {
+            status = -1;
+        }
+        for (size_t i = 0; i < count && status == 0; ++i) {
+            /* Significand products are exact in FP32, so the host product is the reference. */
+            const float exact = values[i] * rhs_value;
+            const uint32_t rounded = dsp48e1_format_encode(codec, exact, 0);
+            const uint32_t code = format_load(narrow_out, bytes, i);
+            if (code != rounded || code != dsp48e1_format_mul(codec, codes[i], b) ||
+                (isnan(exact) ? !isnan(products[i]) : memcmp(&products[i], &exact, sizeof(exact)) != 0)) {
+                status = -1;
+            }
+        }
+    }
+
+    free(codes);
+    free(values);
+    free(products);
+    free(narrow);
+    free(narrow_out);
+    return status;
+}
+
+int dsp48e1_format_self_test(void) {
+    dsp48e1_format_desc_t e4m3, e5m2, fp16, bad;
+    dsp48e1_format_e4m3(&e4m3);
+    dsp48e1_format_e5m2(&e5m2);
+    fp16 = e5m2;
+    fp16.total_bits = 16;
+    fp16.mantissa_bits = 10;
+
+    dsp48e1_format_codec_t codec;
+    int status = 0;
+
+    /* E4M3: range ends, saturation, NaN without Inf and ties to even. */
+    if (dsp48e1_format_codec_init(&codec, &e4m3) != 0) {
+        return -1;
+    }
+    if (dsp48e1_format_decode(&codec, 0x7E) != 448.0f || !isnan(dsp48e1_format_decode(&codec, 0x7F)) ||
+        dsp48e1_format_decode(&codec, 0x01) != ldexpf(1.0f, -9) ||
+        dsp48e1_format_decode(&codec, 0x08) != ldexpf(1.0f, -6) ||
+        dsp48e1_format_encode(&codec, 500.0f, 1) != 0x7E || dsp48e1_format_encode(&codec, -500.0f, 0) != 0xFF ||
+        dsp48e1_format_encode(&codec, 1.0625f, 0) != 0x38 || dsp48e1_format_encode(&codec, 1.1875f, 0) != 0x3A ||
+        dsp48e1_format_encode(&codec, ldexpf(1.0f, -11), 0) != 0x00 ||
+        dsp48e1_format_encode(&codec, ldexpf(3.0f, -11), 0) != 0x01 ||
+        codec.lanes != dsp48e1_format_products_per_slice(&e4m3) || codec.lanes < 2 ||
+        format_check_codes(&codec, 256) != 0) {
+        status = -1;
+    }
+    dsp48e1_format_codec_free(&codec);
+
+    /* E5M2: IEEE Inf and NaN. */
+    if (status == 0 && dsp48e1_format_codec_init(&codec, &e5m2) == 0) {
+        if (dsp48e1_format_decode(&codec, 0x7B) != 57344.0f || !isinf(dsp48e1_format_decode(&codec, 0x7C)) ||
+            dsp48e1_format_encode(&codec, 1e6f, 0) != 0x7C || dsp48e1_format_encode(&codec, 1e6f, 1) != 0x7B ||
+            format_check_codes(&codec, 256) != 0) {
+            status = -1;
+        }
+        dsp48e1_format_codec_free(&codec);
+    } else {
+        status = -1;
+    }
+
+    /* FP16 takes the table-free paths with two-byte codes. */
+    if (status == 0 && dsp48e1_format_codec_init(&codec, &fp16) == 0) {
+        if (codec.decode_table || dsp48e1_format_code_bytes(&codec) != 2 || codec.lanes != 1 ||
+            dsp48e1_format_decode(&codec, 0x3C00) != 1.0f || dsp48e1_format_decode(&codec, 0x7BFF) != 65504.0f ||
+            format_check_codes(&codec, 65536) != 0) {
+            status = -1;
+        }
+        dsp48e1_format_codec_free(&codec);
+    } else {
+        status = -1;
+    }
+
+    /* Inconsistent widths, INT8 and values FP32 cannot hold are rejected. */
+    bad = e4m3;
+    bad.total_bits = 9;
+    if (dsp48e1_format_codec_init(&codec, &bad) == 0) {
+        status = -1;
+    }
+    bad = e4m3;
+    bad.kind = DSP48E1_FORMAT_INT8;
+    if (dsp48e1_format_codec_init(&codec, &bad) == 0) {
+        status = -1;
+    }
+    bad = e5m2;
+    bad.exponent_bias = -120;
+    if (dsp48e1_format_codec_init(&codec, &bad) == 0) {
+        status = -1;
+    }
+    return status;
+}
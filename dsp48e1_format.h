@@ -0,0 +1,125 @@
+#ifndef DSP48E1_FORMAT_H
+#define DSP48E1_FORMAT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dsp48e1_model.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file dsp48e1_format.h
+ *
+ * Floating-point formats described by a dsp48e1_format_desc_t: sign bit,
+ * exponent_bits, mantissa_bits and exponent_bias.  One codec serves every
+ * such format (FP32, BF16, FP16, the two OCP FP8 formats or any custom
+ * layout); for formats of 8 bits or fewer it decodes and multiplies through
+ * precomputed tables.
+ *
+ * Codes are the raw bit patterns, right-aligned.  Batch calls store them in
+ * the smallest of uint8_t, uint16_t and uint32_t that holds total_bits
+ * (dsp48e1_format_code_bytes()).  Every finite value of a supported format
+ * must be exactly representable in FP32, so decoding never rounds.
+ *
+ * Narrow significands are multiplied several per slice: the A port carries
+ * the significands of `lanes` operands side by side, spaced by the product
+ * width, and the B port the shared significand, so one 25x18 multiply
+ * returns `lanes` separate products in P.
+ */
+
+/* Sign, significand and exponent of one code: value = +-significand * 2^exponent. */
+typedef struct {
+    uint32_t significand;
+    int16_t exponent;
+    uint8_t sign;
+    uint8_t special; /* 1 for Inf, 2 for NaN; significand and exponent are then 0. */
+} dsp48e1_format_parts_t;
+
+typedef struct {
+    dsp48e1_format_desc_t desc;
+    uint32_t max_finite;     /* Largest finite magnitude code. */
+    uint32_t inf_code;       /* Magnitude code of Inf; nan_code when there is none. */
+    uint32_t nan_code;       /* Canonical (quiet) NaN magnitude code. */
+    unsigned significand_bits;
+    unsigned lanes;          /* Products per slice multiply; 0 when one does not fit. */
+    float *decode_table;     /* 2^total_bits values when total_bits <= 8, else NULL. */
+    dsp48e1_format_parts_t *parts_table;
+    uint8_t *mul_table;      /* Rounded products indexed by (a << total_bits) | b. */
+} dsp48e1_format_codec_t;
+
+/** OCP 8-bit E4M3: bias 7, no Inf, NaN = S.1111.111, largest value 448. */
+void dsp48e1_format_e4m3(dsp48e1_format_desc_t *desc);
+
+/** OCP 8-bit E5M2: bias 15, IEEE Inf and NaN, largest value 57344. */
+void dsp48e1_format_e5m2(dsp48e1_format_desc_t *desc);
+
+/**
+ * Significand products one slice multiply returns for desc: 1 + the number
+ * of extra significands that fit the 24-bit unsigned A port at a spacing of
+ * twice the significand width.  Returns 0 for significands wider than 12
+ * bits, whose products do not fit a 24-bit FP32 significand, and 1 for INT8.
+ */
+unsigned dsp48e1_format_products_per_slice(const dsp48e1_format_desc_t *desc);
+
+/**
+ * Validate desc and build the codec.  total_bits must equal
+ * 1 + exponent_bits + mantissa_bits, mantissa_bits must be at least 1 and
+ * every finite value must be exact in FP32.  INT8 is rejected.
+ * Returns 0 on success, -1 on an unsupported descriptor or allocation failure.
+ */
+int dsp48e1_format_codec_init(dsp48e1_format_codec_t *codec, const dsp48e1_format_desc_t *desc);
+
+void dsp48e1_format_codec_free(dsp48e1_format_codec_t *codec);
+
+/** Bytes per code in batch buffers: 1, 2 or 4. */
+size_t dsp48e1_format_code_bytes(const dsp48e1_format_codec_t *codec);
+
+float dsp48e1_format_decode(const dsp48e1_format_codec_t *codec, uint32_t code);
+
+void dsp48e1_format_parts(const dsp48e1_format_codec_t *codec, uint32_t code, dsp48e1_format_parts_t *parts);
+
+/**
+ * Round value to the format (nearest, ties to even).  Out-of-range values
+ * become Inf (NaN in FN formats), or the largest finite value of the same
+ * sign when saturate is set.  NaN gives the canonical NaN.
+ */
+uint32_t dsp48e1_format_encode(const dsp48e1_format_codec_t *codec, float value, int saturate);
+
+/** a * b correctly rounded to the format, without saturation. */
+uint32_t dsp48e1_format_mul(const dsp48e1_format_codec_t *codec, uint32_t a, uint32_t b);
+
+void dsp48e1_format_decode_batch(const dsp48e1_format_codec_t *codec, const void *codes, size_t n, float *values);
+
+void dsp48e1_format_encode_batch(const dsp48e1_format_codec_t *codec, const float *values, size_t n, int saturate, void *codes);
+
+/** out[i] = dsp48e1_format_mul(a[i], b[i]). */
+void dsp48e1_format_mul_batch(const dsp48e1_format_codec_t *codec, const void *a, const void *b, size_t n, void *out);
+
+/**
+ * products[i] = a[i] * b exactly, as FP32, with the significand products
+ * computed on emulated slices codec->lanes at a time.  The result equals
+ * decode(a[i]) * decode(b) bit for bit.  slice_ops (may be NULL) receives
+ * the number of slice multiplies issued.  Returns -1 when codec->lanes is 0.
+ */
+int dsp48e1_format_mul_packed(const dsp48e1_format_codec_t *codec,
+                              const void *a,
+                              uint32_t b,
+                              size_t n,
+                              float *products,
+                              uint64_t *slice_ops);
+
+/**
+ * Check E4M3, E5M2 and FP16 codecs: known values, rounding, and every code
+ * through decode, encode, products and packed slice products.
+ * Returns 0 on success.
+ */
+int dsp48e1_format_self_test(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DSP48E1_FORMAT_H */
@@ -0,0 +1,410 @@
+#include "dsp48e1_memory.h"
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+enum {
+    MEMORY_VALUE_BYTES = 4, /* FP32 operands and results. */
+    MEMORY_SLOTS = 2        /* Double buffering. */
+};
+
+/* A write-back waiting for the DDR channel. */
+typedef struct {
+    uint64_t request;
+    uint64_t bytes;
+    int pending;
+} memory_write_t;
+
+typedef struct {
+    const dsp48e1_memory_config_t *memory;
+    double fill_bytes_per_cycle;
+    uint64_t read_bytes_per_cycle;          /* Bank read ports towards the tensor unit. */
+    uint64_t flush_cycles;
+    size_t k_chunk;
+    uint64_t chunks;
+    uint64_t tiles;
+    uint64_t ddr_free;                      /* DDR channel idle from here. */
+    uint64_t compute_free;                  /* Tensor unit idle from here. */
+    uint64_t slot_free[MEMORY_SLOTS];       /* Operand buffer halves. */
+    uint64_t out_slot_free[MEMORY_SLOTS];   /* Output buffer halves. */
+    memory_write_t writes[MEMORY_SLOTS];
+    uint64_t done;
+    dsp48e1_memory_stats_t *stats;
+} memory_timeline_t;
+
+void dsp48e1_memory_default_config(dsp48e1_memory_config_t *config) {
+    if (!config) {
+        return;
+    }
+    config->banks = 32;
+    config->bank_bytes = 4608;
+    config->bank_read_ports = 1;
+    config->bank_write_ports = 1;
+    config->port_bytes = 8;
+    config->ddr_bytes_per_cycle = 16.0;
+    config->ddr_latency = 40;
+}
+
+/* Serve one transfer on the DDR channel; returns the cycle its data has arrived. */
+static uint64_t timeline_transfer(memory_timeline_t *tl, uint64_t request, uint64_t bytes) {
+    const uint64_t start = request > tl->ddr_free ? request : tl->ddr_free;
+    const uint64_t duration = (uint64_t)ceil((double)bytes / tl->fill_bytes_per_cycle);
+    tl->ddr_free = start + duration;
+    return start + tl->memory->ddr_latency + duration;
+}
+
+/* Issue pending write-backs requested before `before`, oldest first (FCFS with reads). */
+static void timeline_flush_writes(memory_timeline_t *tl, uint64_t before) {
+    for (;;) {
+        memory_write_t *next = NULL;
+        for (size_t s = 0; s < MEMORY_SLOTS; ++s) {
+            memory_write_t *w = &tl->writes[s];
+            if (w->pending && w->request < before && (!next || w->request < next->request)) {
+                next = w;
+            }
+        }
+        if (!next) {
+            return;
+        }
+        const uint64_t complete = timeline_transfer(tl, next->request, next->bytes);
+        tl->out_slot_free[next - tl->writes] = complete;
+        tl->done = complete > tl->done ? complete : tl->done;
+        tl->stats->ddr_write_bytes += next->bytes;
+        next->pending = 0;
+    }
+}
+
+static void timeline_tile(memory_timeline_t *tl, size_t rows, size_t cols, size_t k) {
+    dsp48e1_memory_stats_t *stats = tl->stats;
+    /* An edge tile reads only its own rows + cols operands per K step. */
+    const uint64_t step_bytes = (uint64_t)(rows + cols) * MEMORY_VALUE_BYTES;
+    const uint64_t read_cycles_per_step = (step_bytes + tl->read_bytes_per_cycle - 1) / tl->read_bytes_per_cycle;
+
+    for (size_t k0 = 0; k0 < k; k0 += tl->k_chunk) {
+        const size_t k_count = k - k0 < tl->k_chunk ? k - k0 : tl->k_chunk;
+        const size_t slot = tl->chunks++ % MEMORY_SLOTS;
+        const uint64_t bytes = (uint64_t)(rows + cols) * k_count * MEMORY_VALUE_BYTES;
+
+        /* The load starts once the chunk that last used this half is consumed. */
+        const uint64_t request = tl->slot_free[slot];
+        timeline_flush_writes(tl, request + 1);
+        const uint64_t arrival = timeline_transfer(tl, request, bytes);
+        stats->ddr_read_bytes += bytes;
+
+        const uint64_t start = arrival > tl->compute_free ? arrival : tl->compute_free;
+        const uint64_t duration = (uint64_t)k_count * read_cycles_per_step;
+        stats->stall_cycles += start - tl->compute_free;
+        stats->compute_cycles += duration;
+        tl->compute_free = start + duration;
+        tl->slot_free[slot] = tl->compute_free;
+    }
+
+    /* Drain, then hand the results to a free half of the output buffer. */
+    tl->compute_free += tl->flush_cycles;
+    stats->compute_cycles += tl->flush_cycles;
+    const size_t out_slot = tl->tiles++ % MEMORY_SLOTS;
+    timeline_flush_writes(tl, tl->compute_free + 1);
+    if (tl->out_slot_free[out_slot] > tl->compute_free) {
+        stats->stall_cycles += tl->out_slot_free[out_slot] - tl->compute_free;
+        tl->compute_free = tl->out_slot_free[out_slot];
+    }
+    tl->writes[out_slot].request = tl->compute_free;
+    tl->writes[out_slot].bytes = (uint64_t)rows * cols * MEMORY_VALUE_BYTES;
+    tl->writes[out_slot].pending = 1;
+}
+
+static int timeline_init(memory_timeline_t *tl,
+                         const dsp48e1_memory_config_t *memory,
+                         const dsp48e1_config_t *config,
+                         size_t tile_rows,
+                         size_t tile_cols,
+                         size_t tile_depth,
+                         dsp48e1_memory_stats_t *stats) {
+    if (!memory || !config || tile_rows == 0 || tile_cols == 0 || tile_depth == 0 ||
+        memory->banks == 0 || memory->bank_read_ports == 0 || memory->bank_write_ports == 0 ||
+        memory->port_bytes == 0 || !(memory->ddr_bytes_per_cycle > 0.0)) {
+        return -1;
+    }
+
+    /* Two operand halves of (rows + cols) x k_chunk plus two output tiles. */
+    uint64_t capacity, output_bytes, per_k, read;
+    if (__builtin_mul_overflow((uint64_t)memory->banks, (uint64_t)memory->bank_bytes, &capacity) ||
+        __builtin_mul_overflow((uint64_t)tile_rows, (uint64_t)tile_cols, &output_bytes) ||
+        __builtin_mul_overflow(output_bytes, (uint64_t)MEMORY_SLOTS * MEMORY_VALUE_BYTES, &output_bytes) ||
+        __builtin_add_overflow((uint64_t)tile_rows, (uint64_t)tile_cols, &per_k) ||
+        __builtin_mul_overflow(per_k, (uint64_t)MEMORY_SLOTS * MEMORY_VALUE_BYTES, &per_k) ||
+        __builtin_mul_overflow((uint64_t)memory->banks * memory->bank_read_ports, (uint64_t)memory->port_bytes, &read)) {
+        return -1;
+    }
+    if (capacity <= output_bytes || (capacity - output_bytes) / per_k == 0) {
+        return -1;
+    }
+    const uint64_t fit = (capacity - output_bytes) / per_k;
+
+    const double fill = (double)memory->banks * memory->bank_write_ports * memory->port_bytes;
+
+    memset(tl, 0, sizeof(*tl));
+    memset(stats, 0, sizeof(*stats));
+    tl->memory = memory;
+    tl->fill_bytes_per_cycle = memory->ddr_bytes_per_cycle < fill ? memory->ddr_bytes_per_cycle : fill;
+    tl->read_bytes_per_cycle = read;
+    tl->flush_cycles = dsp48e1_config_latency(config);
+    tl->k_chunk = fit < tile_depth ? (size_t)fit : tile_depth;
+    tl->stats = stats;
+    stats->k_chunk = tl->k_chunk;
+    stats->buffer_bytes = output_bytes + per_k * tl->k_chunk;
+    stats->peak_macs_per_cycle = (double)tile_rows * (double)tile_cols;
+    return 0;
+}
+
+/* m * n * k, or -1 when the product does not fit in 64 bits. */
+static int memory_macs(size_t m, size_t n, size_t k, uint64_t *macs) {
+    uint64_t product;
+    if (__builtin_mul_overflow((uint64_t)m, (uint64_t)n, &product) ||
+        __builtin_mul_overflow(product, (uint64_t)k, &product)) {
+        return -1;
+    }
+    *macs = product;
+    return 0;
+}
+
+static void timeline_finish(memory_timeline_t *tl, uint64_t macs) {
+    dsp48e1_memory_stats_t *stats = tl->stats;
+    timeline_flush_writes(tl, UINT64_MAX);
+
+    stats->macs = macs;
+    stats->tiles = tl->tiles;
+    stats->cycles = tl->done > tl->compute_free ? tl->done : tl->compute_free;
+
+    const uint64_t ddr_bytes = stats->ddr_read_bytes + stats->ddr_write_bytes;
+    stats->arithmetic_intensity = ddr_bytes ? (double)stats->macs / (double)ddr_bytes : 0.0;
+    stats->achieved_macs_per_cycle = stats->cycles ? (double)stats->macs / (double)stats->cycles : 0.0;
+    stats->bandwidth_macs_per_cycle = stats->arithmetic_intensity * tl->memory->ddr_bytes_per_cycle;
+    stats->memory_bound = stats->bandwidth_macs_per_cycle < stats->peak_macs_per_cycle;
+}
+
+int dsp48e1_memory_gemm_cost(const dsp48e1_memory_config_t *memory,
+                             const dsp48e1_config_t *config,
+                             size_t tile_rows,
+                             size_t tile_cols,
+                             size_t tile_depth,
+                             size_t m,
+                             size_t n,
+                             size_t k,
+                             dsp48e1_memory_stats_t *stats) {
+    memory_timeline_t tl;
+    uint64_t macs;
+    if (!stats || m == 0 || n == 0 || k == 0 || memory_macs(m, n, k, &macs) != 0 ||
+        timeline_init(&tl, memory, config, tile_rows, tile_cols, tile_depth, stats) != 0) {
+        return -1;
+    }
+
+    for (size_t m0 = 0; m0 < m; m0 += tile_rows) {
+        const size_t rows = m - m0 < tile_rows ? m - m0 : tile_rows;
+        for (size_t n0 = 0; n0 < n; n0 += tile_cols) {
+            const size_t cols = n - n0 < tile_cols ? n - n0 : tile_cols;
+            timeline_tile(&tl, rows, cols, k);
+        }
+    }
+    timeline_finish(&tl, macs);
+    return 0;
+}
+
+int dsp48e1_gemm_memory_fp32(dsp48e1_model_t *model,
+                             const dsp48e1_memory_config_t *memory,
+                             const float *lhs,
+                             size_t lhs_stride,
+                             const float *rhs,
+                             size_t rhs_stride,
+                             const float *bias,
+                             float *dst,
+                             size_t dst_stride,
+                             size_t m,
+                             size_t n,
+                             size_t k,
+                             dsp48e1_memory_stats_t *stats) {
+    uint64_t macs;
+    if (!model || !model->accumulators || !lhs || !rhs || !dst || m == 0 || n == 0 || k == 0 ||
+        lhs_stride < k || rhs_stride < n || dst_stride < n || memory_macs(m, n, k, &macs) != 0) {
+        return -1;
+    }
+
+    const size_t tile_rows = model->rows;
+    const size_t tile_cols = model->cols;
+    const size_t tile_depth = model->depth;
+    dsp48e1_memory_stats_t totals;
+    memory_timeline_t tl;
+    if (timeline_init(&tl, memory, &model->config, tile_rows, tile_cols, tile_depth, &totals) != 0) {
+        return -1;
+    }
+
+    int status = 0;
+    for (size_t m0 = 0; m0 < m && status == 0; m0 += tile_rows) {
+        const size_t rows = m - m0 < tile_rows ? m - m0 : tile_rows;
+        for (size_t n0 = 0; n0 < n && status == 0; n0 += tile_cols) {
+            const size_t cols = n - n0 < tile_cols ? n - n0 : tile_cols;
+
+            if ((rows != model->rows || cols != model->cols) &&
+                dsp48e1_model_reshape(model, rows, cols, tile_depth) != 0) {
+                status = -1;
+                break;
+            }
+
+            /* The chunks the buffer holds are the ones pushed to the model. */
+            status = dsp48e1_model_stream_begin(model, bias ? bias + n0 : NULL);
+            for (size_t k0 = 0; k0 < k && status == 0; k0 += tl.k_chunk) {
+                const size_t k_count = k - k0 < tl.k_chunk ? k - k0 : tl.k_chunk;
+                status = dsp48e1_model_stream_push(model, lhs + m0 * lhs_stride + k0, lhs_stride,
+                                                   rhs + k0 * rhs_stride + n0, rhs_stride, k_count);
+            }
+            if (status == 0) {
+                status = dsp48e1_model_stream_end(model, dst + m0 * dst_stride + n0, dst_stride);
+            }
+            timeline_tile(&tl, rows, cols, k);
+        }
+    }
+    /* Edge tiles reshaped the model; give the caller its own shape back. */
+    if ((model->rows != tile_rows || model->cols != tile_cols) &&
+        dsp48e1_model_reshape(model, tile_rows, tile_cols, tile_depth) != 0) {
+        status = -1;
+    }
+    if (status != 0) {
+        return -1;
+    }
+
+    timeline_finish(&tl, macs);
+    /* Stalls only delay the chunks, so the model ran them back to back;
+     * replace its clock with the timeline's, which includes them. */
+    model->cycle = totals.cycles;
+    if (stats) {
+        *stats = totals;
+    }
+    return 0;
+}
+
+int dsp48e1_memory_write_roofline_csv(const char *path,
+                                      const char *const *labels,
+                                      const dsp48e1_memory_stats_t *stats,
+                                      size_t count) {
+    if (!path || (!stats && count > 0)) {
+        return -1;
+    }
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        return -1;
+    }
+
+    fprintf(file, "label,macs,ddr_bytes,arithmetic_intensity,achieved_macs_per_cycle,"
+                  "peak_macs_per_cycle,bandwidth_macs_per_cycle,bound,cycles,stall_cycles,k_chunk\n");
+    for (size_t i = 0; i < count; ++i) {
+        const dsp48e1_memory_stats_t *s = &stats[i];
+        fprintf(file, "%s,%llu,%llu,%.6g,%.6g,%.6g,%.6g,%s,%llu,%llu,%zu\n",
+                labels && labels[i] ? labels[i] : "",
+                (unsigned long long)s->macs,
+                (unsigned long long)(s->ddr_read_bytes + s->ddr_write_bytes),
+                s->arithmetic_intensity, s->achieved_macs_per_cycle, s->peak_macs_per_cycle,
+                s->bandwidth_macs_per_cycle, s->memory_bound ? "memory" : "compute",
+                (unsigned long long)s->cycles, (unsigned long long)s->stall_cycles, s->k_chunk);
+    }
+    return fclose(file) == 0 ? 0 : -1;
+}
+
+int dsp48e1_memory_self_test(void) {
+    enum { ROWS = 4, COLS = 3, DEPTH = 6, M = 10, N = 7, K = 15 };
+    dsp48e1_config_t config;
+    dsp48e1_default_fp32_config(&config);
+    config.enable_rounding = 0;
+
+    /* Four bytes per read cycle, so a K step of any tile costs its rows + cols cycles. */
+    dsp48e1_memory_config_t memory;
+    dsp48e1_memory_default_config(&memory);
+    memory.banks = 1;
+    memory.bank_bytes = 1 << 20;
+    memory.port_bytes = 4;
+    memory.ddr_bytes_per_cycle = 4.0;
+
+    float lhs[M * K];
+    float rhs[K * N];
+    float bias[N];
+    float expected[M * N];
+    float dst[M * N];
+    for (size_t i = 0; i < M * K; ++i) {
+        lhs[i] = (float)((int)(i * 37 % 19) - 9) * 0.375f;
+    }
+    for (size_t i = 0; i < K * N; ++i) {
+        rhs[i] = (float)((int)(i * 11 % 23) - 11) * 0.25f;
+    }
+    for (size_t col = 0; col < N; ++col) {
+        bias[col] = (float)col - 2.0f;
+    }
+
+    /* Dyadic operands keep every sum exact, so one big tile is the reference. */
+    dsp48e1_model_t reference;
+    if (dsp48e1_model_init(&reference, &config, M, N, K) != 0) {
+        return -1;
+    }
+    int status = dsp48e1_model_gemm_fp32(&reference, lhs, K, rhs, N, bias, expected, N);
+    dsp48e1_model_free(&reference);
+
+    dsp48e1_model_t model;
+    if (status != 0 || dsp48e1_model_init(&model, &config, ROWS, COLS, DEPTH) != 0) {
+        return -1;
+    }
+    dsp48e1_memory_stats_t stats, cost;
+    if (dsp48e1_gemm_memory_fp32(&model, &memory, lhs, K, rhs, N, bias, dst, N, M, N, K, &stats) != 0 ||
+        dsp48e1_memory_gemm_cost(&memory, &config, ROWS, COLS, DEPTH, M, N, K, &cost) != 0) {
+        status = -1;
+    }
+
+    /* Row tiles 4, 4, 2 and column tiles 3, 3, 1: each tile pays its own rows + cols per step. */
+    const uint64_t tiles = 3 * 3;
+    const uint64_t step_cycles = 3 * M + 3 * N;
+    if (status == 0 &&
+        (memcmp(dst, expected, sizeof(dst)) != 0 ||
+         model.rows != ROWS || model.cols != COLS || model.depth != DEPTH ||
+         stats.tiles != tiles || stats.macs != (uint64_t)M * N * K || model.cycle != stats.cycles ||
+         stats.compute_cycles != step_cycles * K + tiles * dsp48e1_config_latency(&config) ||
+         cost.cycles != stats.cycles || cost.stall_cycles != stats.stall_cycles ||
+         stats.ddr_write_bytes != (uint64_t)M * N * sizeof(float))) {
+        status = -1;
+    }
+
+    /* m * n * k past 64 bits and a buffer without room for one K step are rejected. */
+    const size_t huge = (size_t)1 << 22;
+    if (status == 0 &&
+        (dsp48e1_memory_gemm_cost(&memory, &config, ROWS, COLS, DEPTH, huge, huge, huge, &cost) == 0 ||
+         dsp48e1_gemm_memory_fp32(&model, &memory, lhs, huge, rhs, huge, NULL, dst, huge, huge, huge, huge, NULL) == 0)) {
+        status = -1;
+    }
+    memory.bank_bytes = 2 * ROWS * COLS * sizeof(float);
+    if (status == 0 && dsp48e1_memory_gemm_cost(&memory, &config, ROWS, COLS, DEPTH, M, N, K, &cost) == 0) {
+        status = -1;
+    }
+
+    const char *tmpdir = getenv("TMPDIR");
+    char path[512];
+    snprintf(path, sizeof(path), "%s/dsp48e1_roofline_%ld.csv", tmpdir ? tmpdir : "/tmp", (long)getpid());
+    const char *labels[] = {"edge"};
+    if (status == 0 && dsp48e1_memory_write_roofline_csv(path, labels, &stats, 1) == 0) {
+        FILE *file = fopen(path, "r");
+        char line[512];
+        if (!file || !fgets(line, sizeof(line), file) || !fgets(line, sizeof(line), file) ||
+            strncmp(line, "edge,1050,", 10) != 0) {
+            status = -1;
+        }
+        if (file) {
+            fclose(file);
+        }
+        unlink(path);
+    } else {
+        status = -1;
+    }
+
+    dsp48e1_model_free(&model);
+    return status;
+}
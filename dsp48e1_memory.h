@@ -0,0 +1,128 @@
+#ifndef DSP48E1_MEMORY_H
+#define DSP48E1_MEMORY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dsp48e1_model.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file dsp48e1_memory.h
+ *
+ * Memory hierarchy around the tensor unit: an on-chip operand buffer built
+ * from BRAM/URAM banks, filled from off-chip DDR.  A GEMM is split into
+ * model-sized output tiles and each tile's K dimension into chunks.  Chunks
+ * are double buffered: the next chunk loads while the current one is
+ * computed, and the tensor unit stalls when a chunk has not arrived.
+ *
+ * The model is event driven.  Each chunk is one event with a load start,
+ * arrival and compute window, so the cost is O(tiles * chunks), not
+ * O(cycles).  All times are tensor-unit clock cycles.
+ *
+ * Timing rules:
+ *  - DDR serves one transfer at a time at ddr_bytes_per_cycle, capped by the
+ *    buffer's fill bandwidth.  The access latency overlaps later transfers.
+ *  - A K step reads rows + cols FP32 operands from the banks.  When the read
+ *    ports cannot deliver them in one cycle, the step takes several.
+ *  - Tiles drain the pipeline (dsp48e1_config_latency()) before the next
+ *    starts.  Results go back to DDR through a double-buffered output
+ *    buffer.
+ */
+
+typedef struct {
+    size_t banks;               /* BRAM36/URAM banks in the operand buffer. */
+    size_t bank_bytes;          /* Capacity of one bank (4608 for BRAM36, 36864 for URAM). */
+    size_t bank_read_ports;     /* Ports per bank serving the tensor unit. */
+    size_t bank_write_ports;    /* Ports per bank taking DDR fills. */
+    size_t port_bytes;          /* Bytes per port per cycle (8 for a 72-bit port). */
+    double ddr_bytes_per_cycle; /* Sustained DDR bandwidth at the tensor clock. */
+    uint64_t ddr_latency;       /* Cycles from request to first data. */
+} dsp48e1_memory_config_t;
+
+typedef struct {
+    uint64_t macs;
+    uint64_t tiles;
+    size_t k_chunk;                 /* K values per buffered chunk. */
+    uint64_t buffer_bytes;          /* Operand and output buffer footprint. */
+    uint64_t cycles;                /* Completion of the last write-back. */
+    uint64_t compute_cycles;        /* Tensor-unit busy cycles, drains included. */
+    uint64_t stall_cycles;          /* Tensor unit waiting for operands. */
+    uint64_t ddr_read_bytes;
+    uint64_t ddr_write_bytes;
+    double arithmetic_intensity;    /* MACs per DDR byte. */
+    double achieved_macs_per_cycle;
+    double peak_macs_per_cycle;     /* rows * cols of the tile. */
+    double bandwidth_macs_per_cycle; /* Roof set by DDR: intensity * bandwidth. */
+    int memory_bound;               /* The DDR roof is below the compute peak. */
+} dsp48e1_memory_stats_t;
+
+/** A 32-bank BRAM36 buffer (true dual port, 72 bits) behind 16 bytes/cycle of DDR. */
+void dsp48e1_memory_default_config(dsp48e1_memory_config_t *config);
+
+/**
+ * Run the timeline for an m x n x k GEMM on a tile_rows x tile_cols unit
+ * with at most tile_depth K values per chunk, without computing anything.
+ * Returns 0 on success, -1 on invalid parameters, an m * n * k that does
+ * not fit in 64 bits, or when not even a one-deep chunk fits the buffer.
+ */
+int dsp48e1_memory_gemm_cost(const dsp48e1_memory_config_t *memory,
+                             const dsp48e1_config_t *config,
+                             size_t tile_rows,
+                             size_t tile_cols,
+                             size_t tile_depth,
+                             size_t m,
+                             size_t n,
+                             size_t k,
+                             dsp48e1_memory_stats_t *stats);
+
+/**
+ * dst = lhs (m x k) * rhs (k x n) + bias (length n, may be NULL), tiled
+ * over the model's rows x cols shape and streamed in chunks of up to
+ * model->depth.  Results come from the model.  Stalls are not clocked
+ * through the model: once the tiles have run, model->cycle is overwritten
+ * with the timeline's memory-aware cycle count (compute, stalls and the
+ * final write-back), discarding the model's own per-tile clock.  The model
+ * is reshaped for edge tiles and returned to its own shape at the end.
+ * Returns 0 on success, -1 on invalid parameters, an m * n * k that does not
+ * fit in 64 bits, or allocation failure.
+ */
+int dsp48e1_gemm_memory_fp32(dsp48e1_model_t *model,
+                             const dsp48e1_memory_config_t *memory,
+                             const float *lhs,
+                             size_t lhs_stride,
+                             const float *rhs,
+                             size_t rhs_stride,
+                             const float *bias,
+                             float *dst,
+                             size_t dst_stride,
+                             size_t m,
+                             size_t n,
+                             size_t k,
+                             dsp48e1_memory_stats_t *stats);
+
+/**
+ * Write a roofline CSV with one row per stats entry: label, intensity,
+ * achieved and roof MACs per cycle, the bound, cycles and stalls.  labels
+ * may be NULL.  Returns 0 on success.
+ */
+int dsp48e1_memory_write_roofline_csv(const char *path,
+                                      const char *const *labels,
+                                      const dsp48e1_memory_stats_t *stats,
+                                      size_t count);
+
+/**
+ * Check edge-tiled results against a single tile, the restored model
+ * shape, per-tile read cycles, rejected shapes and the roofline CSV (in
+ * $TMPDIR, default /tmp).  Returns 0 on success.
+ */
+int dsp48e1_memory_self_test(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DSP48E1_MEMORY_H */
@@ -8,6 +8,8 @@
 #include <string.h>
 #include <stdio.h>
 
+#include "dsp48e1_probes.h"
+
 static size_t total_pipeline_latency(const dsp48e1_config_t *cfg) {
     return (size_t)cfg->multiplier_latency +
            (size_t)cfg->adder_latency +
@@ -33,43 +35,102 @@ static float saturate_fp32(float value) {
     return value;
 }
 
+enum { MODEL_BLOCK = DSP48E1_MODEL_VALID_BITS };
+
 static float stage_shift_float(float *stage,
                                size_t span,
+                               size_t stride,
                                size_t idx,
                                float incoming) {
     if (span == 0 || stage == NULL) {
         return incoming;
     }
 
-    float *base = stage + idx * span;
-    float outgoing = base[span - 1];
+    float *base = stage + idx;
+    float outgoing = base[(span - 1) * stride];
     for (size_t i = span - 1; i > 0; --i) {
-        base[i] = base[i - 1];
+        base[i * stride] = base[(i - 1) * stride];
     }
     base[0] = incoming;
     return outgoing;
 }
 
-static uint8_t stage_shift_u8(uint8_t *stage,
-                              size_t span,
-                              size_t idx,
-                              uint8_t incoming) {
+static uint8_t stage_shift_bit(uint64_t *stage,
+                               size_t span,
+                               size_t words,
+                               size_t idx,
+                               uint8_t incoming) {
     if (span == 0 || stage == NULL) {
         return incoming;
     }
 
-    uint8_t *base = stage + idx * span;
-    uint8_t outgoing = base[span - 1];
+    uint64_t *base = stage + idx / MODEL_BLOCK;
+    const unsigned bit = (unsigned)(idx % MODEL_BLOCK);
+    const uint64_t mask = (uint64_t)1 << bit;
+    uint8_t outgoing = (uint8_t)((base[(span - 1) * words] >> bit) & 1U);
     for (size_t i = span - 1; i > 0; --i) {
-        base[i] = base[i - 1];
+        base[i * words] = (base[i * words] & ~mask) | (base[(i - 1) * words] & mask);
     }
-    base[0] = incoming;
+    base[0] = (base[0] & ~mask) | ((uint64_t)(incoming & 1U) << bit);
     return outgoing;
 }
 
+/*
+ * Shift one block of up to MODEL_BLOCK PEs (starting at a multiple of
+ * MODEL_BLOCK) through a stage.  values/valid carry the incoming block in and
+ * the outgoing block out; every slot copy is a contiguous vector move.
+ */
+static void stage_shift_block(float *stage,
+                              uint64_t *stage_valid,
+                              size_t span,
+                              size_t elements,
+                              size_t words,
+                              size_t base,
+                              size_t count,
+                              float *values,
+                              uint64_t *valid) {
+    if (span == 0 || stage == NULL) {
+        return;
+    }
+
+    float outgoing[MODEL_BLOCK];
+    const size_t bytes = count * sizeof(float);
+    memcpy(outgoing, stage + (span - 1) * elements + base, bytes);
+    for (size_t i = span - 1; i > 0; --i) {
+        memcpy(stage + i * elements + base, stage + (i - 1) * elements + base, bytes);
+    }
+    memcpy(stage + base, values, bytes);
+    memcpy(values, outgoing, bytes);
+
+    const size_t word = base / MODEL_BLOCK;
+    const uint64_t outgoing_valid = stage_valid[(span - 1) * words + word];
+    for (size_t i = span - 1; i > 0; --i) {
+        stage_valid[i * words + word] = stage_valid[(i - 1) * words + word];
+    }
+    stage_valid[word] = *valid;
+    *valid = outgoing_valid;
+}
+
+static int alloc_stage_buffers(size_t span,
+                               size_t elements,
+                               size_t words,
+                               float **value_buf,
+                               uint64_t **valid_buf) {
+    size_t values, flags;
+    if (span == 0) {
+        return 0;
+    }
+    if (__builtin_mul_overflow(elements, span, &values) || __builtin_mul_overflow(words, span, &flags)) {
+        return -1;
+    }
+    *value_buf = (float *)calloc(values, sizeof(float));
+    *valid_buf = (uint64_t *)calloc(flags, sizeof(uint64_t));
+    return (*value_buf && *valid_buf) ? 0 : -1;
+}
+
 static void free_stage_buffers(size_t span,
                                float **value_buf,
-                               uint8_t **valid_buf) {
+                               uint64_t **valid_buf) {
     if (span > 0) {
         free(*value_buf);
         free(*valid_buf);
@@ -78,6 +139,18 @@ static void free_stage_buffers(size_t span,
     *valid_buf = NULL;
 }
 
+static void clear_stage_buffers(size_t span,
+                                size_t elements,
+                                size_t words,
+                                float *value_buf,
+                                uint64_t *valid_buf) {
+    if (span == 0 || value_buf == NULL) {
+        return;
+    }
+    memset(value_buf, 0, sizeof(float) * elements * span);
+    memset(valid_buf, 0, sizeof(uint64_t) * words * span);
+}
+
 void dsp48e1_format_fp32(dsp48e1_format_desc_t *desc) {
     if (!desc) {
         return;
@@ -87,9 +160,14 @@ void dsp48e1_format_fp32(dsp48e1_format_desc_t *desc) {
     desc->exponent_bits = 8;
     desc->mantissa_bits = 23;
     desc->fractional_bits = 0;
+    desc->specials = DSP48E1_SPECIALS_IEEE;
     desc->exponent_bias = 127;
 }
 
+size_t dsp48e1_config_latency(const dsp48e1_config_t *cfg) {
+    return cfg ? total_pipeline_latency(cfg) : 0;
+}
+
 void dsp48e1_default_fp32_config(dsp48e1_config_t *cfg) {
     if (!cfg) {
         return;
@@ -102,6 +180,60 @@ void dsp48e1_default_fp32_config(dsp48e1_config_t *cfg) {
     cfg->saturation_latency = 0;
     cfg->enable_rounding = 1;
     cfg->enable_saturation = 0;
+    cfg->accum_mode = DSP48E1_ACCUM_FP32;
+    cfg->accum_fraction_bits = 0;
+}
+
+static void model_release_buffers(dsp48e1_model_t *model) {
+    free(model->accumulators);
+    free(model->accum_state);
+    free(model->contrib_counts);
+    free(model->output_panel);
+    model->accumulators = NULL;
+    model->accum_state = NULL;
+    model->contrib_counts = NULL;
+    model->output_panel = NULL;
+
+    free_stage_buffers(model->mul_span, &model->pipeline_mul, &model->pipeline_mul_valid);
+    free_stage_buffers(model->add_span, &model->pipeline_add, &model->pipeline_add_valid);
+    free_stage_buffers(model->accum_span, &model->pipeline_accum, &model->pipeline_accum_valid);
+    free_stage_buffers(model->round_span, &model->pipeline_round, &model->pipeline_round_valid);
+    free_stage_buffers(model->out_span, &model->pipeline_out, &model->pipeline_out_valid);
+    model->capacity = 0;
+}
+
+/* Allocate zeroed buffers for up to capacity PEs using the current spans. */
+static int model_alloc_buffers(dsp48e1_model_t *model, size_t capacity) {
+    const size_t words = (capacity + MODEL_BLOCK - 1) / MODEL_BLOCK;
+
+    model->accumulators = (float *)calloc(capacity, sizeof(float));
+    model->contrib_counts = (size_t *)calloc(capacity, sizeof(size_t));
+    model->output_panel = (float *)calloc(capacity, sizeof(float));
+    if (model->config.accum_mode != DSP48E1_ACCUM_FP32) {
+        model->accum_state = calloc(capacity, sizeof(int64_t));
+    }
+    if (!model->accumulators || !model->contrib_counts || !model->output_panel ||
+        (model->config.accum_mode != DSP48E1_ACCUM_FP32 && !model->accum_state)) {
+        model_release_buffers(model);
+        return -1;
+    }
+
+    if (alloc_stage_buffers(model->mul_span, capacity, words,
+                            &model->pipeline_mul, &model->pipeline_mul_valid) != 0 ||
+        alloc_stage_buffers(model->add_span, capacity, words,
+                            &model->pipeline_add, &model->pipeline_add_valid) != 0 ||
+        alloc_stage_buffers(model->accum_span, capacity, words,
+                            &model->pipeline_accum, &model->pipeline_accum_valid) != 0 ||
+        alloc_stage_buffers(model->round_span, capacity, words,
+                            &model->pipeline_round, &model->pipeline_round_valid) != 0 ||
+        alloc_stage_buffers(model->out_span, capacity, words,
+                            &model->pipeline_out, &model->pipeline_out_valid) != 0) {
+        model_release_buffers(model);
+        return -1;
+    }
+
+    model->capacity = capacity;
+    return 0;
 }
 
 int dsp48e1_model_init(dsp48e1_model_t *model,
@@ -109,7 +241,10 @@ int dsp48e1_model_init(dsp48e1_model_t *model,
                        size_t rows,
                        size_t cols,
                        size_t depth) {
-    if (!model || !config || rows == 0 || cols == 0 || depth == 0) {
+    size_t elements;
+    if (!model || !config || rows == 0 || cols == 0 || depth == 0 ||
+        config->accum_mode > DSP48E1_ACCUM_KAHAN || config->accum_fraction_bits > 47 ||
+        __builtin_mul_overflow(rows, cols, &elements)) {
         return -1;
     }
 
@@ -124,84 +259,187 @@ int dsp48e1_model_init(dsp48e1_model_t *model,
     model->round_span = config->rounding_latency;
     model->out_span = config->saturation_latency;
 
-    const size_t elements = rows * cols;
+    model->valid_words = (elements + MODEL_BLOCK - 1) / MODEL_BLOCK;
 
-    model->accumulators = (float *)calloc(elements, sizeof(float));
-    model->contrib_counts = (size_t *)calloc(elements, sizeof(size_t));
-    if (!model->accumulators || !model->contrib_counts) {
+    if (model_alloc_buffers(model, elements) != 0) {
         dsp48e1_model_free(model);
         return -1;
     }
 
-    if (model->mul_span) {
-        model->pipeline_mul = (float *)calloc(elements * model->mul_span, sizeof(float));
-        model->pipeline_mul_valid = (uint8_t *)calloc(elements * model->mul_span, sizeof(uint8_t));
-        if (!model->pipeline_mul || !model->pipeline_mul_valid) {
-            dsp48e1_model_free(model);
-            return -1;
-        }
+    return 0;
+}
+
+void dsp48e1_model_free(dsp48e1_model_t *model) {
+    if (!model) {
+        return;
     }
 
-    if (model->add_span) {
-        model->pipeline_add = (float *)calloc(elements * model->add_span, sizeof(float));
-        model->pipeline_add_valid = (uint8_t *)calloc(elements * model->add_span, sizeof(uint8_t));
-        if (!model->pipeline_add || !model->pipeline_add_valid) {
-            dsp48e1_model_free(model);
-            return -1;
-        }
+    model_release_buffers(model);
+
+    model->mul_span = model->add_span = model->accum_span = 0;
+    model->round_span = model->out_span = 0;
+    model->valid_words = 0;
+    model->rows = model->cols = model->depth = 0;
+    model->cycle = 0;
+    model->config = (dsp48e1_config_t){0};
+}
+
+/*
+ * Replace the buffers with zeroed ones for capacity PEs.  The new buffers
+ * are allocated first, so on failure the model keeps its old buffers and
+ * state.
+ */
+static int model_grow(dsp48e1_model_t *model, size_t capacity) {
+    dsp48e1_model_t grown = *model;
+    grown.accumulators = NULL;
+    grown.accum_state = NULL;
+    grown.contrib_counts = NULL;
+    grown.output_panel = NULL;
+    grown.pipeline_mul = grown.pipeline_add = grown.pipeline_accum = NULL;
+    grown.pipeline_round = grown.pipeline_out = NULL;
+    grown.pipeline_mul_valid = grown.pipeline_add_valid = grown.pipeline_accum_valid = NULL;
+    grown.pipeline_round_valid = grown.pipeline_out_valid = NULL;
+    if (model_alloc_buffers(&grown, capacity) != 0) {
+        return -1;
     }
+    model_release_buffers(model);
+    *model = grown;
+    return 0;
+}
 
-    if (model->accum_span) {
-        model->pipeline_accum = (float *)calloc(elements * model->accum_span, sizeof(float));
-        model->pipeline_accum_valid = (uint8_t *)calloc(elements * model->accum_span, sizeof(uint8_t));
-        if (!model->pipeline_accum || !model->pipeline_accum_valid) {
-            dsp48e1_model_free(model);
-            return -1;
-        }
+int dsp48e1_model_reserve(dsp48e1_model_t *model, size_t capacity) {
+    if (!model || !model->accumulators) {
+        return -1;
+    }
+    if (capacity <= model->capacity) {
+        return 0;
     }
 
-    if (model->round_span) {
-        model->pipeline_round = (float *)calloc(elements * model->round_span, sizeof(float));
-        model->pipeline_round_valid = (uint8_t *)calloc(elements * model->round_span, sizeof(uint8_t));
-        if (!model->pipeline_round || !model->pipeline_round_valid) {
-            dsp48e1_model_free(model);
-            return -1;
-        }
+    if (model_grow(model, capacity) != 0) {
+        return -1;
+    }
+    dsp48e1_model_reset(model);
+    return 0;
+}
+
+int dsp48e1_model_reshape(dsp48e1_model_t *model,
+                          size_t rows,
+                          size_t cols,
+                          size_t depth) {
+    if (!model || !model->accumulators || rows == 0 || cols == 0 || depth == 0) {
+        return -1;
     }
 
-    if (model->out_span) {
-        model->pipeline_out = (float *)calloc(elements * model->out_span, sizeof(float));
-        model->pipeline_out_valid = (uint8_t *)calloc(elements * model->out_span, sizeof(uint8_t));
-        if (!model->pipeline_out || !model->pipeline_out_valid) {
-            dsp48e1_model_free(model);
-            return -1;
-        }
+    size_t elements;
+    if (__builtin_mul_overflow(rows, cols, &elements) ||
+        (elements > model->capacity && model_grow(model, elements) != 0)) {
+        return -1;
     }
 
+    model->rows = rows;
+    model->cols = cols;
+    model->depth = depth;
+    model->valid_words = (elements + MODEL_BLOCK - 1) / MODEL_BLOCK;
+    dsp48e1_model_reset(model);
     return 0;
 }
 
-void dsp48e1_model_free(dsp48e1_model_t *model) {
-    if (!model) {
+int dsp48e1_model_pool_init(dsp48e1_model_pool_t *pool,
+                            const dsp48e1_config_t *config,
+                            size_t max_models) {
+    if (!pool || !config || max_models == 0) {
+        return -1;
+    }
+
+    memset(pool, 0, sizeof(*pool));
+    pool->config = *config;
+    pool->models = (dsp48e1_model_t *)calloc(max_models, sizeof(dsp48e1_model_t));
+    pool->in_use = (uint8_t *)calloc(max_models, sizeof(uint8_t));
+    if (!pool->models || !pool->in_use) {
+        free(pool->models);
+        free(pool->in_use);
+        pool->models = NULL;
+        pool->in_use = NULL;
+        return -1;
+    }
+    pool->max_models = max_models;
+    return 0;
+}
+
+void dsp48e1_model_pool_free(dsp48e1_model_pool_t *pool) {
+    if (!pool) {
         return;
     }
+    for (size_t i = 0; i < pool->max_models; ++i) {
+        dsp48e1_model_free(&pool->models[i]);
+    }
+    free(pool->models);
+    free(pool->in_use);
+    pool->models = NULL;
+    pool->in_use = NULL;
+    pool->max_models = 0;
+}
 
-    free(model->accumulators);
-    free(model->contrib_counts);
-    model->accumulators = NULL;
-    model->contrib_counts = NULL;
+dsp48e1_model_t *dsp48e1_model_pool_acquire(dsp48e1_model_pool_t *pool,
+                                            size_t rows,
+                                            size_t cols,
+                                            size_t depth) {
+    if (!pool || !pool->models || rows == 0 || cols == 0 || depth == 0) {
+        return NULL;
+    }
 
-    free_stage_buffers(model->mul_span, &model->pipeline_mul, &model->pipeline_mul_valid);
-    free_stage_buffers(model->add_span, &model->pipeline_add, &model->pipeline_add_valid);
-    free_stage_buffers(model->accum_span, &model->pipeline_accum, &model->pipeline_accum_valid);
-    free_stage_buffers(model->round_span, &model->pipeline_round, &model->pipeline_round_valid);
-    free_stage_buffers(model->out_span, &model->pipeline_out, &model->pipeline_out_valid);
+    /*
+     * Prefer the smallest idle model that already fits, then the largest
+     * idle model (least growth), and only then an unused slot.
+     */
+    const size_t elements = rows * cols;
+    size_t fit = SIZE_MAX;
+    size_t grow = SIZE_MAX;
+    size_t empty = SIZE_MAX;
+    for (size_t i = 0; i < pool->max_models; ++i) {
+        if (pool->in_use[i]) {
+            continue;
+        }
+        const size_t capacity = pool->models[i].capacity;
+        if (capacity == 0) {
+            if (empty == SIZE_MAX) {
+                empty = i;
+            }
+        } else if (capacity >= elements) {
+            if (fit == SIZE_MAX || capacity < pool->models[fit].capacity) {
+                fit = i;
+            }
+        } else if (grow == SIZE_MAX || capacity > pool->models[grow].capacity) {
+            grow = i;
+        }
+    }
 
-    model->mul_span = model->add_span = model->accum_span = 0;
-    model->round_span = model->out_span = 0;
-    model->rows = model->cols = model->depth = 0;
-    model->cycle = 0;
-    model->config = (dsp48e1_config_t){0};
+    size_t slot = fit != SIZE_MAX ? fit : (empty != SIZE_MAX ? empty : grow);
+    if (slot == SIZE_MAX) {
+        return NULL;
+    }
+
+    dsp48e1_model_t *model = &pool->models[slot];
+    int status;
+    if (model->capacity == 0) {
+        status = dsp48e1_model_init(model, &pool->config, rows, cols, depth);
+    } else {
+        status = dsp48e1_model_reshape(model, rows, cols, depth);
+    }
+    if (status != 0) {
+        return NULL;
+    }
+
+    pool->in_use[slot] = 1;
+    return model;
+}
+
+void dsp48e1_model_pool_release(dsp48e1_model_pool_t *pool, dsp48e1_model_t *model) {
+    if (!pool || !pool->models || !model ||
+        model < pool->models || model >= pool->models + pool->max_models) {
+        return;
+    }
+    pool->in_use[(size_t)(model - pool->models)] = 0;
 }
 
 void dsp48e1_model_reset(dsp48e1_model_t *model) {
@@ -213,32 +451,154 @@ void dsp48e1_model_reset(dsp48e1_model_t *model) {
     if (model->accumulators) {
         memset(model->accumulators, 0, sizeof(float) * elements);
     }
+    if (model->accum_state) {
+        memset(model->accum_state, 0, sizeof(int64_t) * elements);
+    }
     if (model->contrib_counts) {
         memset(model->contrib_counts, 0, sizeof(size_t) * elements);
     }
 
-    if (model->mul_span && model->pipeline_mul) {
-        memset(model->pipeline_mul, 0, sizeof(float) * elements * model->mul_span);
-        memset(model->pipeline_mul_valid, 0, sizeof(uint8_t) * elements * model->mul_span);
+    const size_t words = model->valid_words;
+    clear_stage_buffers(model->mul_span, elements, words,
+                        model->pipeline_mul, model->pipeline_mul_valid);
+    clear_stage_buffers(model->add_span, elements, words,
+                        model->pipeline_add, model->pipeline_add_valid);
+    clear_stage_buffers(model->accum_span, elements, words,
+                        model->pipeline_accum, model->pipeline_accum_valid);
+    clear_stage_buffers(model->round_span, elements, words,
+                        model->pipeline_round, model->pipeline_round_valid);
+    clear_stage_buffers(model->out_span, elements, words,
+                        model->pipeline_out, model->pipeline_out_valid);
+
+    model->stream_k = 0;
+    model->stream_active = 0;
+    model->cycle = 0;
+}
+
+static int64_t wrap_48(int64_t value) {
+    return (int64_t)((uint64_t)value << 16) >> 16;
+}
+
+/*
+ * Round to a 48-bit fixed-point value, saturating at the 48-bit range.
+ * Adding and subtracting 1.5 * 2^52 rounds to nearest-even without a libm
+ * call, which keeps the FIXED48 loop vectorizable.  NaN has no 48-bit
+ * encoding and becomes 0; converting it to int64_t would be undefined.
+ */
+static int64_t to_fixed48(float value, double scale) {
+    const double round_bias = 6755399441055744.0;
+    double scaled = (double)value * scale;
+    scaled = scaled == scaled ? scaled : 0.0;
+    scaled = scaled > 140737488355327.0 ? 140737488355327.0 : scaled;
+    scaled = scaled < -140737488355328.0 ? -140737488355328.0 : scaled;
+    scaled = (scaled + round_bias) - round_bias;
+    return (int64_t)scaled;
+}
+
+/*
+ * Set the running sums of PEs [base, base + count) to start (zeros when
+ * NULL) in the configured accumulator mode.
+ */
+static void model_accum_set(dsp48e1_model_t *model, size_t base, size_t count, const float *start) {
+    float *sums = model->accumulators + base;
+    for (size_t i = 0; i < count; ++i) {
+        sums[i] = start ? start[i] : 0.0f;
     }
-    if (model->add_span && model->pipeline_add) {
-        memset(model->pipeline_add, 0, sizeof(float) * elements * model->add_span);
-        memset(model->pipeline_add_valid, 0, sizeof(uint8_t) * elements * model->add_span);
+
+    switch (model->config.accum_mode) {
+    case DSP48E1_ACCUM_FP64: {
+        double *wide = (double *)model->accum_state + base;
+        for (size_t i = 0; i < count; ++i) {
+            wide[i] = (double)sums[i];
+        }
+        break;
+    }
+    case DSP48E1_ACCUM_FIXED48: {
+        const double scale = ldexp(1.0, model->config.accum_fraction_bits);
+        const double inv_scale = ldexp(1.0, -(int)model->config.accum_fraction_bits);
+        int64_t *fixed = (int64_t *)model->accum_state + base;
+        for (size_t i = 0; i < count; ++i) {
+            fixed[i] = to_fixed48(sums[i], scale);
+            sums[i] = (float)((double)fixed[i] * inv_scale);
+        }
+        break;
+    }
+    case DSP48E1_ACCUM_KAHAN:
+        memset((float *)model->accum_state + base, 0, sizeof(float) * count);
+        break;
+    case DSP48E1_ACCUM_FP32:
+    default:
+        break;
+    }
+}
+
+/*
+ * Accumulate values[i] into PE base + i for every set bit i of valid
+ * (count <= 64) and replace values[i] with that PE's running sum as FP32.
+ * Each mode is a separate branch-free loop so it vectorizes.
+ */
+static void model_accumulate(dsp48e1_model_t *model,
+                             size_t base,
+                             size_t count,
+                             uint64_t valid,
+                             float *values) {
+    float *sums = model->accumulators + base;
+    size_t *counts = model->contrib_counts + base;
+
+    switch (model->config.accum_mode) {
+    case DSP48E1_ACCUM_FP64: {
+        double *wide = (double *)model->accum_state + base;
+        for (size_t i = 0; i < count; ++i) {
+            const int lane_valid = (int)((valid >> i) & 1U);
+            const double next = wide[i] + (double)values[i];
+            wide[i] = lane_valid ? next : wide[i];
+            sums[i] = (float)wide[i];
+            values[i] = sums[i];
+        }
+        break;
     }
-    if (model->accum_span && model->pipeline_accum) {
-        memset(model->pipeline_accum, 0, sizeof(float) * elements * model->accum_span);
-        memset(model->pipeline_accum_valid, 0, sizeof(uint8_t) * elements * model->accum_span);
+    case DSP48E1_ACCUM_FIXED48: {
+        const double scale = ldexp(1.0, model->config.accum_fraction_bits);
+        const double inv_scale = ldexp(1.0, -(int)model->config.accum_fraction_bits);
+        int64_t *fixed = (int64_t *)model->accum_state + base;
+        for (size_t i = 0; i < count; ++i) {
+            const int lane_valid = (int)((valid >> i) & 1U);
+            const int64_t next = wrap_48(fixed[i] + to_fixed48(values[i], scale));
+            fixed[i] = lane_valid ? next : fixed[i];
+            sums[i] = (float)((double)fixed[i] * inv_scale);
+            values[i] = sums[i];
+        }
+        break;
     }
-    if (model->round_span && model->pipeline_round) {
-        memset(model->pipeline_round, 0, sizeof(float) * elements * model->round_span);
-        memset(model->pipeline_round_valid, 0, sizeof(uint8_t) * elements * model->round_span);
+    case DSP48E1_ACCUM_KAHAN: {
+        float *compensation = (float *)model->accum_state + base;
+        for (size_t i = 0; i < count; ++i) {
+            const int lane_valid = (int)((valid >> i) & 1U);
+            const float y = values[i] - compensation[i];
+            const float t = sums[i] + y;
+            const float c = (t - sums[i]) - y;
+            compensation[i] = lane_valid ? c : compensation[i];
+            sums[i] = lane_valid ? t : sums[i];
+            values[i] = sums[i];
+        }
+        break;
     }
-    if (model->out_span && model->pipeline_out) {
-        memset(model->pipeline_out, 0, sizeof(float) * elements * model->out_span);
-        memset(model->pipeline_out_valid, 0, sizeof(uint8_t) * elements * model->out_span);
+    case DSP48E1_ACCUM_FP32:
+    default:
+        for (size_t i = 0; i < count; ++i) {
+            const int lane_valid = (int)((valid >> i) & 1U);
+            const float prev_accum = sums[i];
+            const float accum_input = lane_valid ? prev_accum + values[i] : prev_accum;
+            sums[i] = accum_input;
+            values[i] = accum_input;
+        }
+        break;
     }
 
-    model->cycle = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const int lane_valid = (int)((valid >> i) & 1U);
+        counts[i] += (size_t)(lane_valid & (counts[i] < SIZE_MAX));
+    }
 }
 
 int dsp48e1_model_step_fp32(dsp48e1_model_t *model,
@@ -254,78 +614,84 @@ int dsp48e1_model_step_fp32(dsp48e1_model_t *model,
         return -1;
     }
 
+    DSP48E1_PROBE4(step, model, row, col, input_valid);
+
     const size_t idx = row * model->cols + col;
+    const size_t stride = model->rows * model->cols;
+    const size_t words = model->valid_words;
     const uint8_t valid_in = input_valid ? 1U : 0U;
 
     const float product = a * b;
     const float mul_ready = stage_shift_float(model->pipeline_mul,
                                               model->mul_span,
+                                              stride,
                                               idx,
                                               product);
-    const uint8_t mul_valid = stage_shift_u8(model->pipeline_mul_valid,
-                                             model->mul_span,
-                                             idx,
-                                             valid_in);
+    const uint8_t mul_valid = stage_shift_bit(model->pipeline_mul_valid,
+                                              model->mul_span,
+                                              words,
+                                              idx,
+                                              valid_in);
 
     const float add_input = mul_ready + addend;
     const float add_ready = stage_shift_float(model->pipeline_add,
                                               model->add_span,
+                                              stride,
                                               idx,
                                               add_input);
-    const uint8_t add_valid = stage_shift_u8(model->pipeline_add_valid,
-                                             model->add_span,
-                                             idx,
-                                             mul_valid);
+    const uint8_t add_valid = stage_shift_bit(model->pipeline_add_valid,
+                                              model->add_span,
+                                              words,
+                                              idx,
+                                              mul_valid);
 
-    const float prev_accum = model->accumulators[idx];
-    float accum_input = prev_accum;
-    if (add_valid) {
-        accum_input = prev_accum + add_ready;
-    }
+    float accum_input = add_ready;
+    model_accumulate(model, idx, 1, add_valid, &accum_input);
 
     const float accum_ready = stage_shift_float(model->pipeline_accum,
                                                 model->accum_span,
+                                                stride,
                                                 idx,
                                                 accum_input);
-    const uint8_t accum_valid = stage_shift_u8(model->pipeline_accum_valid,
-                                               model->accum_span,
-                                               idx,
-                                               add_valid);
-
-    if (add_valid) {
-        model->accumulators[idx] = accum_input;
-        if (model->contrib_counts[idx] < SIZE_MAX) {
-            model->contrib_counts[idx] += 1;
-        }
-    }
+    const uint8_t accum_valid = stage_shift_bit(model->pipeline_accum_valid,
+                                                model->accum_span,
+                                                words,
+                                                idx,
+                                                add_valid);
 
     float round_input = accum_ready;
     if (accum_valid && model->config.enable_rounding) {
         round_input = round_to_nearest_even(accum_ready);
+        DSP48E1_PROBE2(round, model, 1);
     }
 
     const float round_ready = stage_shift_float(model->pipeline_round,
                                                 model->round_span,
+                                                stride,
                                                 idx,
                                                 round_input);
-    const uint8_t round_valid = stage_shift_u8(model->pipeline_round_valid,
-                                               model->round_span,
-                                               idx,
-                                               accum_valid);
+    const uint8_t round_valid = stage_shift_bit(model->pipeline_round_valid,
+                                                model->round_span,
+                                                words,
+                                                idx,
+                                                accum_valid);
 
     float sat_input = round_ready;
     if (round_valid && model->config.enable_saturation) {
         sat_input = saturate_fp32(round_ready);
+        DSP48E1_PROBE2(saturate, model, 1);
     }
 
     const float out_ready = stage_shift_float(model->pipeline_out,
                                               model->out_span,
+                                              stride,
                                               idx,
                                               sat_input);
-    const uint8_t out_ready_valid = stage_shift_u8(model->pipeline_out_valid,
-                                                   model->out_span,
-                                                   idx,
-                                                   round_valid);
+    const uint8_t out_ready_valid = stage_shift_bit(model->pipeline_out_valid,
+                                                    model->out_span,
+                                                    words,
+                                                    idx,
+                                                    round_valid);
 
     model->cycle++;
 
@@ -343,6 +709,268 @@ int dsp48e1_model_step_fp32(dsp48e1_model_t *model,
     return 0;
 }
 
+/*
+ * Multiplier operands of one clock.  Either a and b hold one value per PE
+ * (rows * cols), or one K step is broadcast over the tile: PE (row, col)
+ * multiplies lhs[row * lhs_stride] by rhs[col].  The broadcast form reads
+ * the operands in place, so no per-PE panel is built.
+ */
+typedef struct {
+    const float *a;
+    const float *b;
+    const float *lhs;
+    size_t lhs_stride;
+    const float *rhs;
+} model_beat_t;
+
+/* Products of PEs [base, base + count); zeros without operands. */
+static void model_beat_products(const dsp48e1_model_t *model,
+                                const model_beat_t *beat,
+                                size_t base,
+                                size_t count,
+                                float *values) {
+    if (beat && beat->a && beat->b) {
+        for (size_t i = 0; i < count; ++i) {
+            values[i] = beat->a[base + i] * beat->b[base + i];
+        }
+    } else if (beat && beat->lhs && beat->rhs) {
+        /* Walk the block one row segment at a time. */
+        const size_t cols = model->cols;
+        size_t row = base / cols;
+        size_t col = base % cols;
+        for (size_t i = 0; i < count; ++row, col = 0) {
+            const size_t run = (cols - col) < (count - i) ? (cols - col) : (count - i);
+            const float lhs_value = beat->lhs[row * beat->lhs_stride];
+            const float *rhs = beat->rhs + col;
+            for (size_t j = 0; j < run; ++j) {
+                values[i + j] = lhs_value * rhs[j];
+            }
+            i += run;
+        }
+    } else {
+        memset(values, 0, sizeof(float) * count);
+    }
+}
+
+/*
+ * Advance PEs [base, base + count) by one clock, where base is a multiple of
+ * MODEL_BLOCK and count <= MODEL_BLOCK.  A NULL beat or addend feeds zeros.
+ * restart marks the beat reaching the accumulator as the first of a new
+ * problem: valid lanes start from restart_values[col] (zero when NULL)
+ * instead of the running sum.  With merge set, out_values is only written
+ * where the output is valid (used to track the latest result of every PE);
+ * otherwise invalid lanes get 0.0f.
+ */
+static void model_advance_block(dsp48e1_model_t *model,
+                                size_t base,
+                                size_t count,
+                                uint64_t valid_in,
+                                const model_beat_t *beat,
+                                const float *addend,
+                                int restart,
+                                const float *restart_values,
+                                uint64_t *out_valid,
+                                float *out_values,
+                                int merge) {
+    const size_t elements = model->rows * model->cols;
+    const size_t words = model->valid_words;
+    float values[MODEL_BLOCK];
+    uint64_t valid = valid_in;
+
+    model_beat_products(model, beat, base, count, values);
+    stage_shift_block(model->pipeline_mul, model->pipeline_mul_valid, model->mul_span,
+                      elements, words, base, count, values, &valid);
+
+    if (addend) {
+        for (size_t i = 0; i < count; ++i) {
+            values[i] = values[i] + addend[base + i];
+        }
+    } else {
+        /* A missing addend is +0.0f, as in the single-step path: -0.0f products become +0.0f. */
+        for (size_t i = 0; i < count; ++i) {
+            values[i] = values[i] + 0.0f;
+        }
+    }
+    stage_shift_block(model->pipeline_add, model->pipeline_add_valid, model->add_span,
+                      elements, words, base, count, values, &valid);
+
+    if (restart) {
+        for (size_t i = 0; i < count; ++i) {
+            if ((valid >> i) & 1U) {
+                const size_t col = (base + i) % model->cols;
+                model_accum_set(model, base + i, 1, restart_values ? restart_values + col : NULL);
+                model->contrib_counts[base + i] = 0;
+            }
+        }
+    }
+    model_accumulate(model, base, count, valid, values);
+    stage_shift_block(model->pipeline_accum, model->pipeline_accum_valid, model->accum_span,
+                      elements, words, base, count, values, &valid);
+
+    if (model->config.enable_rounding && valid) {
+        DSP48E1_PROBE2(round, model, valid);
+        for (size_t i = 0; i < count; ++i) {
+            if ((valid >> i) & 1U) {
+                values[i] = round_to_nearest_even(values[i]);
+            }
+        }
+    }
+    stage_shift_block(model->pipeline_round, model->pipeline_round_valid, model->round_span,
+                      elements, words, base, count, values, &valid);
+
+    if (model->config.enable_saturation && valid) {
+        DSP48E1_PROBE2(saturate, model, valid);
+        for (size_t i = 0; i < count; ++i) {
+            if ((valid >> i) & 1U) {
+                values[i] = saturate_fp32(values[i]);
+            }
+        }
+    }
+    stage_shift_block(model->pipeline_out, model->pipeline_out_valid, model->out_span,
+                      elements, words, base, count, values, &valid);
+
+    if (out_valid) {
+        out_valid[base / MODEL_BLOCK] = valid;
+    }
+    if (out_values) {
+        float *out = out_values + base;
+        if (merge) {
+            for (size_t i = 0; i < count; ++i) {
+                out[i] = ((valid >> i) & 1U) ? values[i] : out[i];
+            }
+        } else {
+            for (size_t i = 0; i < count; ++i) {
+                out[i] = ((valid >> i) & 1U) ? values[i] : 0.0f;
+            }
+        }
+    }
+}
+
+static void model_advance_tile(dsp48e1_model_t *model,
+                               int input_valid,
+                               const model_beat_t *beat,
+                               const float *addend,
+                               int restart,
+                               const float *restart_values,
+                               uint64_t *out_valid,
+                               float *out_values,
+                               int merge) {
+    const size_t elements = model->rows * model->cols;
+    for (size_t base = 0; base < elements; base += MODEL_BLOCK) {
+        const size_t count = (elements - base) < MODEL_BLOCK ? (elements - base) : MODEL_BLOCK;
+        const uint64_t valid_in = !input_valid ? 0U :
+                                  count == MODEL_BLOCK ? ~(uint64_t)0 :
+                                  (((uint64_t)1 << count) - 1U);
+        model_advance_block(model, base, count, valid_in, beat, addend, restart, restart_values,
+                            out_valid, out_values, merge);
+    }
+    model->cycle++;
+}
+
+int dsp48e1_model_step_tile_fp32(dsp48e1_model_t *model,
+                                 int input_valid,
+                                 const float *a,
+                                 const float *b,
+                                 const float *addend,
+                                 uint64_t *out_valid,
+                                 float *out_values) {
+    if (!model || !model->accumulators) {
+        return -1;
+    }
+
+    const model_beat_t beat = {a, b, NULL, 0, NULL};
+    model_advance_tile(model, input_valid, &beat, addend, 0, NULL, out_valid, out_values, 0);
+    return 0;
+}
+
+int dsp48e1_model_stream_begin(dsp48e1_model_t *model, const float *bias) {
+    if (!model || !model->accumulators) {
+        return -1;
+    }
+
+    dsp48e1_model_reset(model);
+
+    const size_t rows = model->rows;
+    const size_t cols = model->cols;
+    const size_t elements = rows * cols;
+    memset(model->output_panel, 0, sizeof(float) * elements);
+
+    /*
+     * Preload the accumulators with the bias.  The first accumulation then
+     * yields bias + a0 * b0, the same value as adding the bias to the first
+     * product, but without depending on when that product leaves the
+     * multiplier pipeline.
+     */
+    if (bias) {
+        for (size_t row = 0; row < rows; ++row) {
+            model_accum_set(model, row * cols, cols, bias);
+        }
+    }
+
+    model->stream_k = 0;
+    model->stream_active = 1;
+    return 0;
+}
+
+int dsp48e1_model_stream_push(dsp48e1_model_t *model,
+                              const float *lhs,
+                              size_t lhs_stride,
+                              const float *rhs,
+                              size_t rhs_stride,
+                              size_t k_count) {
+    if (!model || !model->stream_active || !lhs || !rhs ||
+        lhs_stride < k_count || rhs_stride < model->cols) {
+        return -1;
+    }
+
+    for (size_t k = 0; k < k_count; ++k) {
+        const model_beat_t beat = {NULL, NULL, lhs + k, lhs_stride, rhs + k * rhs_stride};
+        model_advance_tile(model, 1, &beat, NULL, 0, NULL, NULL, model->output_panel, 1);
+        model->stream_k++;
+    }
+
+    return 0;
+}
+
+int dsp48e1_model_stream_end(dsp48e1_model_t *model, float *dst, size_t dst_stride) {
+    return dsp48e1_model_stream_end_epilogue(model, NULL, dst, dst_stride);
+}
+
+int dsp48e1_model_stream_end_epilogue(dsp48e1_model_t *model,
+                                      const dsp48e1_epilogue_t *epilogue,
+                                      void *dst,
+                                      size_t dst_stride) {
+    if (!model || !model->stream_active || !dst || dst_stride < model->cols) {
+        return -1;
+    }
+
+    const size_t rows = model->rows;
+    const size_t cols = model->cols;
+    float *last_values = model->output_panel;
+
+    /* The last product pushed leaves the final stage after the full latency. */
+    const size_t flush_cycles = total_pipeline_latency(&model->config);
+    DSP48E1_PROBE2(flush__begin, model, flush_cycles);
+    for (size_t f = 0; f < flush_cycles; ++f) {
+        model_advance_tile(model, 0, NULL, NULL, 0, NULL, NULL, last_values, 1);
+    }
+    DSP48E1_PROBE2(flush__end, model, model->cycle);
+
+    /*
+     * The epilogue runs as one pass over the drained tile.  In hardware its
+     * stages follow the last pipeline stage, so only their latency is added.
+     */
+    const size_t row_bytes = dst_stride * dsp48e1_epilogue_element_size(epilogue);
+    for (size_t row = 0; row < rows; ++row) {
+        dsp48e1_epilogue_apply(epilogue, last_values + row * cols, cols,
+                               (unsigned char *)dst + row * row_bytes);
+    }
+    model->cycle += dsp48e1_epilogue_latency(epilogue);
+
+    model->stream_active = 0;
+    return 0;
+}
+
 int dsp48e1_model_gemm_fp32(dsp48e1_model_t *model,
                             const float *lhs,
                             size_t lhs_stride,
@@ -357,81 +985,131 @@ int dsp48e1_model_gemm_fp32(dsp48e1_model_t *model,
         return -1;
     }
 
-    dsp48e1_model_reset(model);
+    DSP48E1_PROBE4(gemm__begin, model, model->rows, model->cols, model->depth);
+    int status = -1;
+    if (dsp48e1_model_stream_begin(model, bias) == 0 &&
+        dsp48e1_model_stream_push(model, lhs, lhs_stride, rhs, rhs_stride, model->depth) == 0) {
+        status = dsp48e1_model_stream_end(model, dst, dst_stride);
+    }
+    DSP48E1_PROBE2(gemm__end, model, model->cycle);
+    return status;
+}
 
-    const size_t elements = model->rows * model->cols;
-    float *last_values = (float *)calloc(elements, sizeof(float));
-    if (!last_values) {
+int dsp48e1_model_gemm_epilogue_fp32(dsp48e1_model_t *model,
+                                     const float *lhs,
+                                     size_t lhs_stride,
+                                     const float *rhs,
+                                     size_t rhs_stride,
+                                     const dsp48e1_epilogue_t *epilogue,
+                                     void *dst,
+                                     size_t dst_stride) {
+    if (!model || !lhs || !rhs || !dst ||
+        lhs_stride < model->depth || rhs_stride < model->cols ||
+        dst_stride < model->cols) {
         return -1;
     }
 
-    for (size_t k = 0; k < model->depth; ++k) {
-        for (size_t row = 0; row < model->rows; ++row) {
-            const float *lhs_row = lhs + row * lhs_stride;
-            for (size_t col = 0; col < model->cols; ++col) {
-                float addend = 0.0f;
-                if (bias && k == 0) {
-                    addend = bias[col];
-                }
+    DSP48E1_PROBE4(gemm__begin, model, model->rows, model->cols, model->depth);
+    int status = -1;
+    if (dsp48e1_model_stream_begin(model, NULL) == 0 &&
+        dsp48e1_model_stream_push(model, lhs, lhs_stride, rhs, rhs_stride, model->depth) == 0) {
+        status = dsp48e1_model_stream_end_epilogue(model, epilogue, dst, dst_stride);
+    }
+    DSP48E1_PROBE2(gemm__end, model, model->cycle);
+    return status;
+}
 
-                int valid = 0;
-                float value = 0.0f;
-                const int status = dsp48e1_model_step_fp32(model,
-                                                           row,
-                                                           col,
-                                                           1,
-                                                           lhs_row[k],
-                                                           rhs[k * rhs_stride + col],
-                                                           addend,
-                                                           &valid,
-                                                           &value);
-                if (status != 0) {
-                    free(last_values);
-                    return status;
-                }
-                if (valid) {
-                    last_values[row * model->cols + col] = value;
-                }
-            }
+int dsp48e1_model_gemm_batch_fp32(dsp48e1_model_t *model,
+                                  const dsp48e1_gemm_desc_t *batch,
+                                  size_t count,
+                                  size_t lhs_stride,
+                                  size_t rhs_stride,
+                                  size_t dst_stride) {
+    if (!model || !model->accumulators || (!batch && count > 0) ||
+        lhs_stride < model->depth || rhs_stride < model->cols ||
+        dst_stride < model->cols || model->depth == 0) {
+        return -1;
+    }
+    for (size_t p = 0; p < count; ++p) {
+        if (!batch[p].lhs || !batch[p].rhs || !batch[p].dst) {
+            return -1;
         }
     }
 
-    const size_t flush_cycles = total_pipeline_latency(&model->config);
-    for (size_t f = 0; f <= flush_cycles; ++f) {
-        for (size_t row = 0; row < model->rows; ++row) {
-            for (size_t col = 0; col < model->cols; ++col) {
-                int valid = 0;
-                float value = 0.0f;
-                dsp48e1_model_step_fp32(model,
-                                        row,
-                                        col,
-                                        0,
-                                        0.0f,
-                                        0.0f,
-                                        0.0f,
-                                        &valid,
-                                        &value);
-                if (valid) {
-                    last_values[row * model->cols + col] = value;
-                }
+    dsp48e1_model_reset(model);
+    if (count == 0) {
+        return 0;
+    }
+    DSP48E1_PROBE3(batch__begin, model, count, model->depth);
+
+    const size_t rows = model->rows;
+    const size_t cols = model->cols;
+    const size_t depth = model->depth;
+    float *out_panel = model->output_panel;
+
+    /*
+     * Beat g = p * depth + k of problem p enters the multiplier at cycle g,
+     * reaches the accumulator front_latency cycles later and leaves the last
+     * stage after the full latency.  Problems are issued back to back, so the
+     * accumulator restarts on the first beat of each problem and problem p is
+     * complete when its last beat leaves the pipeline; only the final problem
+     * pays for a flush.
+     */
+    const size_t latency = total_pipeline_latency(&model->config);
+    const size_t front_latency = model->mul_span + model->add_span;
+    const size_t beats = count * depth;
+
+    for (size_t cycle = 0; cycle < beats + latency; ++cycle) {
+        const int input_valid = cycle < beats;
+        if (cycle == beats) {
+            /* The last beat has issued; the remaining cycles drain the pipeline. */
+            DSP48E1_PROBE2(flush__begin, model, latency);
+        }
+        model_beat_t beat = {NULL, NULL, NULL, 0, NULL};
+        if (input_valid) {
+            const dsp48e1_gemm_desc_t *desc = &batch[cycle / depth];
+            const size_t k = cycle % depth;
+            beat.lhs = desc->lhs + k;
+            beat.lhs_stride = lhs_stride;
+            beat.rhs = desc->rhs + k * rhs_stride;
+        }
+
+        int restart = 0;
+        const float *bias = NULL;
+        if (cycle >= front_latency) {
+            const size_t arriving = cycle - front_latency;
+            if (arriving < beats && arriving % depth == 0) {
+                restart = 1;
+                bias = batch[arriving / depth].bias;
             }
         }
-    }
 
-    for (size_t row = 0; row < model->rows; ++row) {
-        float *dst_row = dst + row * dst_stride;
-        for (size_t col = 0; col < model->cols; ++col) {
-            dst_row[col] = last_values[row * model->cols + col];
+        model_advance_tile(model, input_valid, input_valid ? &beat : NULL,
+                           NULL, restart, bias, NULL, out_panel, 0);
+
+        if (cycle >= latency) {
+            const size_t leaving = cycle - latency;
+            if (leaving < beats && (leaving + 1) % depth == 0) {
+                float *dst = batch[leaving / depth].dst;
+                for (size_t row = 0; row < rows; ++row) {
+                    memcpy(dst + row * dst_stride, out_panel + row * cols, sizeof(float) * cols);
+                }
+            }
         }
     }
 
-    free(last_values);
+    if (latency > 0) {
+        DSP48E1_PROBE2(flush__end, model, model->cycle);
+    }
+    DSP48E1_PROBE2(batch__end, model, model->cycle);
     return 0;
 }
 
 int dsp48e1_model_self_test_fp32(void) {
     dsp48e1_config_t cfg;
     dsp48e1_default_fp32_config(&cfg);
+    /* The rounding stage rounds to even integers; compare the unrounded datapath. */
+    cfg.enable_rounding = 0;
 
     dsp48e1_model_t model;
     if (dsp48e1_model_init(&model, &cfg, 2, 2, 3) != 0) {
@@ -484,11 +1162,185 @@ int dsp48e1_model_self_test_fp32(void) {
         }
     }
 
+    /*
+     * Regression: the bias used to be added to the value leaving the
+     * multiplier on the first beat, which is a pipeline bubble whenever
+     * multiplier_latency > 0, so it was dropped.  Every latency and
+     * accumulator mode must keep it, on the one-shot and batched paths.
+     */
+    for (unsigned mul = 0; status == 0 && mul < 4; ++mul) {
+        for (unsigned add = 0; status == 0 && add < 3; ++add) {
+            for (int mode = DSP48E1_ACCUM_FP32; status == 0 && mode <= DSP48E1_ACCUM_KAHAN; ++mode) {
+                dsp48e1_config_t latency_cfg = cfg;
+                latency_cfg.multiplier_latency = mul;
+                latency_cfg.adder_latency = add;
+                latency_cfg.accum_mode = (dsp48e1_accum_mode_t)mode;
+                latency_cfg.accum_fraction_bits = 16;
+
+                dsp48e1_model_t latency_model;
+                float batch_dst[2][2];
+                if (dsp48e1_model_init(&latency_model, &latency_cfg, 2, 2, 3) != 0) {
+                    status = -1;
+                    break;
+                }
+                const dsp48e1_gemm_desc_t desc = {&lhs[0][0], &rhs[0][0], bias, &batch_dst[0][0]};
+                if (dsp48e1_model_gemm_fp32(&latency_model, &lhs[0][0], 3, &rhs[0][0], 2, bias, &dst[0][0], 2) != 0 ||
+                    dsp48e1_model_gemm_batch_fp32(&latency_model, &desc, 1, 3, 2, 2) != 0 ||
+                    memcmp(dst, golden, sizeof(dst)) != 0 ||
+                    memcmp(batch_dst, golden, sizeof(batch_dst)) != 0) {
+                    status = -1;
+                }
+                dsp48e1_model_free(&latency_model);
+            }
+        }
+    }
+
+    /* FIXED48 has no NaN: a NaN product contributes 0 and infinities saturate. */
+    if (status == 0) {
+        dsp48e1_config_t fixed_cfg = cfg;
+        fixed_cfg.accum_mode = DSP48E1_ACCUM_FIXED48;
+        fixed_cfg.accum_fraction_bits = 16;
+        float special_lhs[2][3] = {
+            {NAN, 2.0f, 3.0f},
+            {INFINITY, 0.0f, 0.0f}
+        };
+        const float nan_bias[2] = {NAN, 0.0f};
+        const float expected[2][2] = {
+            {2.0f * 6.0f + 3.0f * 8.0f, 2.0f * 7.0f + 3.0f * 9.0f},
+            {(float)(140737488355327.0 / 65536.0), (float)(140737488355327.0 / 65536.0)}
+        };
+        dsp48e1_model_t fixed_model;
+        if (dsp48e1_model_init(&fixed_model, &fixed_cfg, 2, 2, 3) != 0) {
+            status = -1;
+        } else {
+            if (dsp48e1_model_gemm_fp32(&fixed_model, &special_lhs[0][0], 3, &rhs[0][0], 2, nan_bias, &dst[0][0], 2) != 0 ||
+                memcmp(dst, expected, sizeof(dst)) != 0) {
+                status = -1;
+            }
+            dsp48e1_model_free(&fixed_model);
+        }
+    }
+
+    /*
+     * 2^27 plus sixteen ones minus 2^27: each +1 is below half an FP32 ulp
+     * of the running sum, so FP32 returns 0 while FP64 is exact and Kahan
+     * recovers the lost ones.
+     */
+    if (status == 0) {
+        enum { CANCEL_DEPTH = 18 };
+        float cancel_lhs[CANCEL_DEPTH];
+        float cancel_rhs[CANCEL_DEPTH];
+        for (size_t k = 0; k < CANCEL_DEPTH; ++k) {
+            cancel_lhs[k] = 1.0f;
+            cancel_rhs[k] = 1.0f;
+        }
+        cancel_lhs[0] = 134217728.0f;
+        cancel_lhs[CANCEL_DEPTH - 1] = -134217728.0f;
+        float error[DSP48E1_ACCUM_KAHAN + 1] = {0.0f};
+        for (int mode = DSP48E1_ACCUM_FP32; status == 0 && mode <= DSP48E1_ACCUM_KAHAN; ++mode) {
+            if (mode == DSP48E1_ACCUM_FIXED48) {
+                continue;
+            }
+            dsp48e1_config_t cancel_cfg = cfg;
+            cancel_cfg.accum_mode = (dsp48e1_accum_mode_t)mode;
+            dsp48e1_model_t cancel_model;
+            float result = 0.0f;
+            if (dsp48e1_model_init(&cancel_model, &cancel_cfg, 1, 1, CANCEL_DEPTH) != 0) {
+                status = -1;
+                break;
+            }
+            if (dsp48e1_model_gemm_fp32(&cancel_model, cancel_lhs, CANCEL_DEPTH, cancel_rhs, 1,
+                                        NULL, &result, 1) != 0) {
+                status = -1;
+            }
+            error[mode] = fabsf(result - (float)(CANCEL_DEPTH - 2));
+            dsp48e1_model_free(&cancel_model);
+        }
+        if (status == 0 &&
+            (error[DSP48E1_ACCUM_FP32] != (float)(CANCEL_DEPTH - 2) ||
+             error[DSP48E1_ACCUM_FP64] != 0.0f ||
+             error[DSP48E1_ACCUM_KAHAN] >= error[DSP48E1_ACCUM_FP32])) {
+            status = -1;
+        }
+    }
+
+    /* FIXED48 wraps modulo 2^48: three products of 2^46 sum to -2^46. */
+    if (status == 0) {
+        const float wrap_lhs[3] = {70368744177664.0f, 70368744177664.0f, 70368744177664.0f};
+        const float wrap_rhs[3] = {1.0f, 1.0f, 1.0f};
+        dsp48e1_config_t wrap_cfg = cfg;
+        wrap_cfg.accum_mode = DSP48E1_ACCUM_FIXED48;
+        wrap_cfg.accum_fraction_bits = 0;
+        dsp48e1_model_t wrap_model;
+        float result = 0.0f;
+        if (dsp48e1_model_init(&wrap_model, &wrap_cfg, 1, 1, 3) != 0) {
+            status = -1;
+        } else {
+            if (dsp48e1_model_gemm_fp32(&wrap_model, wrap_lhs, 3, wrap_rhs, 1, NULL, &result, 1) != 0 ||
+                result != -70368744177664.0f) {
+                status = -1;
+            }
+            dsp48e1_model_free(&wrap_model);
+        }
+    }
+
+    /*
+     * reserve/reshape: shrinking and regrowing within the reservation keeps
+     * the buffers, reset clears only the active region, growing past the
+     * reservation reallocates, and a failed grow leaves the model usable.
+     */
+    if (status == 0) {
+        const float *reserved = NULL;
+        if (dsp48e1_model_reserve(&model, 64) != 0 || model.capacity != 64) {
+            status = -1;
+        } else {
+            reserved = model.accumulators;
+        }
+        if (status == 0 &&
+            (dsp48e1_model_reshape(&model, 4, 8, 3) != 0 ||
+             dsp48e1_model_reshape(&model, 2, 2, 3) != 0 ||
+             model.accumulators != reserved || model.capacity != 64 ||
+             dsp48e1_model_gemm_fp32(&model, &lhs[0][0], 3, &rhs[0][0], 2, bias, &dst[0][0], 2) != 0 ||
+             memcmp(dst, golden, sizeof(dst)) != 0)) {
+            status = -1;
+        }
+        if (status == 0) {
+            model.accumulators[10] = 7.0f;
+            dsp48e1_model_reset(&model);
+            for (size_t i = 0; i < 4; ++i) {
+                if (model.accumulators[i] != 0.0f) {
+                    status = -1;
+                }
+            }
+            if (model.accumulators[10] != 7.0f) {
+                status = -1;
+            }
+        }
+        if (status == 0 &&
+            (dsp48e1_model_reshape(&model, 8, 9, 3) != 0 || model.capacity != 72 ||
+             model.rows != 8 || model.cols != 9 ||
+             dsp48e1_model_reshape(&model, 2, 2, 3) != 0 || model.capacity != 72)) {
+            status = -1;
+        }
+        reserved = model.accumulators;
+        if (status == 0 &&
+            (dsp48e1_model_reserve(&model, SIZE_MAX / 4) == 0 ||
+             dsp48e1_model_reshape(&model, SIZE_MAX / 2, 4, 3) == 0 ||
+             model.accumulators != reserved || model.capacity != 72 ||
+             model.rows != 2 || model.cols != 2 ||
+             dsp48e1_model_gemm_fp32(&model, &lhs[0][0], 3, &rhs[0][0], 2, bias, &dst[0][0], 2) != 0 ||
+             memcmp(dst, golden, sizeof(dst)) != 0)) {
+            status = -1;
+        }
+    }
+
     dsp48e1_model_free(&model);
     return status;
 }
 
+#ifndef DSP48E1_NO_MAIN
 int main(void) {
     printf("%f\n", round_to_nearest_even(2.9));
     return 1;
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
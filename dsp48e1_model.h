@@ -4,6 +4,8 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "dsp48e1_epilogue.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -25,15 +27,41 @@ typedef enum {
     DSP48E1_FORMAT_CUSTOM
 } dsp48e1_format_kind_t;
 
+/* Encoding of Inf and NaN in floating-point formats (see dsp48e1_format.h). */
+typedef enum {
+    DSP48E1_SPECIALS_IEEE = 0, /* Exponent all ones: Inf (mantissa 0) or NaN. */
+    DSP48E1_SPECIALS_FN        /* No Inf; only exponent and mantissa all ones is NaN. */
+} dsp48e1_format_specials_t;
+
 typedef struct {
     dsp48e1_format_kind_t kind;
     uint8_t total_bits;
     uint8_t exponent_bits;
     uint8_t mantissa_bits;
     uint8_t fractional_bits; /* For fixed-point / integer formats. */
+    uint8_t specials;        /* dsp48e1_format_specials_t */
     int32_t exponent_bias;
 } dsp48e1_format_desc_t;
 
+/*
+ * Accumulator arithmetic.  Whatever the mode, the value handed to the
+ * rounding stage (and kept in accumulators[]) is the running sum converted
+ * to FP32.
+ *
+ * FP32     - serial FP32 additions (the original behaviour).
+ * FP64     - the running sum is kept in double precision.
+ * FIXED48  - products are rounded to 48-bit two's complement with
+ *            accum_fraction_bits fractional bits (saturating at the 48-bit
+ *            range, NaN as 0) and summed modulo 2^48, like the P register.
+ * KAHAN    - FP32 sum with a Kahan compensation term.
+ */
+typedef enum {
+    DSP48E1_ACCUM_FP32 = 0,
+    DSP48E1_ACCUM_FP64,
+    DSP48E1_ACCUM_FIXED48,
+    DSP48E1_ACCUM_KAHAN
+} dsp48e1_accum_mode_t;
+
 typedef struct {
     dsp48e1_format_desc_t format;
     uint8_t multiplier_latency;
@@ -43,8 +71,18 @@ typedef struct {
     uint8_t saturation_latency;
     int enable_rounding;
     int enable_saturation;
+    dsp48e1_accum_mode_t accum_mode;
+    uint8_t accum_fraction_bits; /* FIXED48 only; at most 47. */
 } dsp48e1_config_t;
 
+/*
+ * Pipeline state is stored stage-major: slot s of the stage for element
+ * idx = row * cols + col lives at pipeline_x[s * elements + idx], so one
+ * pipeline slot of every PE is a contiguous vector.  Valid flags are packed
+ * 64 PEs per word: bit (idx % 64) of pipeline_x_valid[s * valid_words + idx / 64].
+ */
+#define DSP48E1_MODEL_VALID_BITS 64
+
 typedef struct {
     dsp48e1_config_t config;
     size_t rows;
@@ -55,21 +93,51 @@ typedef struct {
     size_t accum_span;
     size_t round_span;
     size_t out_span;
+    size_t valid_words;
     float *accumulators;
+    void *accum_state; /* FP64 sums, FIXED48 P values or Kahan compensation. */
     float *pipeline_mul;
     float *pipeline_add;
     float *pipeline_accum;
     float *pipeline_round;
     float *pipeline_out;
-    uint8_t *pipeline_mul_valid;
-    uint8_t *pipeline_add_valid;
-    uint8_t *pipeline_accum_valid;
-    uint8_t *pipeline_round_valid;
-    uint8_t *pipeline_out_valid;
+    uint64_t *pipeline_mul_valid;
+    uint64_t *pipeline_add_valid;
+    uint64_t *pipeline_accum_valid;
+    uint64_t *pipeline_round_valid;
+    uint64_t *pipeline_out_valid;
     size_t *contrib_counts;
+    float *output_panel; /* Latest valid output of every PE (stream and batch paths). */
+    size_t capacity; /* PEs the buffers are sized for (>= rows * cols). */
+    uint64_t stream_k; /* Inner-product steps pushed since stream_begin. */
+    int stream_active;
     uint64_t cycle;
 } dsp48e1_model_t;
 
+/*
+ * One problem of a batched GEMM.  Every problem in a batch has the model's
+ * rows x cols x depth shape and the strides passed to the batch call.
+ * bias may be NULL.
+ */
+typedef struct {
+    const float *lhs;
+    const float *rhs;
+    const float *bias;
+    float *dst;
+} dsp48e1_gemm_desc_t;
+
+/*
+ * Set of models sharing one configuration whose buffers are kept between
+ * uses, so that sweeping tile shapes does not re-allocate.  A pool is not
+ * thread-safe; use one pool per thread or serialise acquire/release.
+ */
+typedef struct {
+    dsp48e1_config_t config;
+    dsp48e1_model_t *models;
+    uint8_t *in_use;
+    size_t max_models;
+} dsp48e1_model_pool_t;
+
 /**
  * Populate a format descriptor for IEEE-754 single precision.
  */
@@ -80,6 +148,12 @@ void dsp48e1_format_fp32(dsp48e1_format_desc_t *desc);
  */
 void dsp48e1_default_fp32_config(dsp48e1_config_t *cfg);
 
+/**
+ * Total pipeline latency in clocks: the number of flush cycles after the
+ * last product of a tile is issued.
+ */
+size_t dsp48e1_config_latency(const dsp48e1_config_t *cfg);
+
 /**
  * Initialise the tensor-unit model for a tile of dimension rows x cols with an
  * inner-product depth of depth (i.e. GEMM tile of size rows x cols x depth).
@@ -100,9 +174,58 @@ void dsp48e1_model_free(dsp48e1_model_t *model);
 
 /**
  * Reset the cycle counter, accumulators, and pipeline registers to zero.
+ * Only the active rows x cols region is cleared, not the full capacity.
  */
 void dsp48e1_model_reset(dsp48e1_model_t *model);
 
+/**
+ * Grow the model's buffers to hold at least capacity PEs.  Growing discards
+ * the current state (the model is reset); a capacity that already fits is a
+ * no-op.  On allocation failure -1 is returned and the model keeps its
+ * buffers, shape and state.
+ */
+int dsp48e1_model_reserve(dsp48e1_model_t *model, size_t capacity);
+
+/**
+ * Change the tile shape in place, growing the buffers only when rows * cols
+ * exceeds the current capacity, and reset the new active region.  Returns 0
+ * on success; on failure (including allocation failure) the model is left
+ * unchanged.
+ */
+int dsp48e1_model_reshape(dsp48e1_model_t *model,
+                          size_t rows,
+                          size_t cols,
+                          size_t depth);
+
+/**
+ * Create a pool of up to max_models models with the given configuration.
+ * Models are allocated lazily on first acquire.  Returns 0 on success.
+ */
+int dsp48e1_model_pool_init(dsp48e1_model_pool_t *pool,
+                            const dsp48e1_config_t *config,
+                            size_t max_models);
+
+/**
+ * Release every model and the pool bookkeeping.
+ */
+void dsp48e1_model_pool_free(dsp48e1_model_pool_t *pool);
+
+/**
+ * Take an idle model reshaped (and reset) to rows x cols x depth.  The
+ * smallest idle model that already has the capacity is preferred.
+ * Returns NULL when every model is in use or allocation fails.
+ */
+dsp48e1_model_t *dsp48e1_model_pool_acquire(dsp48e1_model_pool_t *pool,
+                                            size_t rows,
+                                            size_t cols,
+                                            size_t depth);
+
+/**
+ * Return a model obtained from dsp48e1_model_pool_acquire() to the pool.
+ * Its buffers stay allocated for the next acquire.
+ */
+void dsp48e1_model_pool_release(dsp48e1_model_pool_t *pool, dsp48e1_model_t *model);
+
 /**
  * Simulate a multiply-accumulate operation feeding one tensor output.
  *
@@ -125,6 +248,26 @@ int dsp48e1_model_step_fp32(dsp48e1_model_t *model,
                             int *out_valid,
                             float *out_value);
 
+/**
+ * Advance every PE of the tile by one clock.
+ *
+ * a, b and addend hold one value per PE in row-major order (rows * cols
+ * entries); passing NULL for any of them feeds zeros, and addend is
+ * optional.  input_valid applies to all PEs.  When non-NULL, out_valid
+ * receives valid_words packed valid flags and out_values receives one value
+ * per PE (0.0f where the output is not valid).  The cycle counter advances
+ * by one, since all PEs are clocked together.
+ *
+ * Returns 0 on success, non-zero on parameter error.
+ */
+int dsp48e1_model_step_tile_fp32(dsp48e1_model_t *model,
+                                 int input_valid,
+                                 const float *a,
+                                 const float *b,
+                                 const float *addend,
+                                 uint64_t *out_valid,
+                                 float *out_values);
+
 /**
  * Convenience routine: execute a full GEMM tile (rows x cols x depth) in FP32.
  * Bias may be NULL; when present it is assumed to have length cols.
@@ -141,6 +284,106 @@ int dsp48e1_model_gemm_fp32(dsp48e1_model_t *model,
                             float *dst,
                             size_t dst_stride);
 
+/**
+ * Execute a full GEMM tile and apply epilogue (bias, scale, activation,
+ * conversion) to the drained results, writing dst in the epilogue's output
+ * type.  See dsp48e1_model_stream_end_epilogue().  Returns 0 on success.
+ */
+int dsp48e1_model_gemm_epilogue_fp32(dsp48e1_model_t *model,
+                                     const float *lhs,
+                                     size_t lhs_stride,
+                                     const float *rhs,
+                                     size_t rhs_stride,
+                                     const dsp48e1_epilogue_t *epilogue,
+                                     void *dst,
+                                     size_t dst_stride);
+
+/**
+ * Execute count GEMM tiles of the model's shape back to back.
+ *
+ * Problems are issued on consecutive cycles without draining the pipeline
+ * in between: the accumulators restart (from the problem's bias or zero)
+ * when a problem's first product reaches them, and each dst is written when
+ * the problem's last product leaves the pipeline.  The whole batch costs
+ * count * depth + latency cycles instead of count * (depth + latency), and
+ * every dst equals what dsp48e1_model_gemm_fp32() produces for that problem.
+ *
+ * The model is reset first.  Returns 0 on success.
+ */
+int dsp48e1_model_gemm_batch_fp32(dsp48e1_model_t *model,
+                                  const dsp48e1_gemm_desc_t *batch,
+                                  size_t count,
+                                  size_t lhs_stride,
+                                  size_t rhs_stride,
+                                  size_t dst_stride);
+
+/* Signature of a GEMM tile compiled for one fixed configuration. */
+typedef int (*dsp48e1_model_gemm_fn_t)(size_t rows,
+                                       size_t cols,
+                                       size_t depth,
+                                       const float *lhs,
+                                       size_t lhs_stride,
+                                       const float *rhs,
+                                       size_t rhs_stride,
+                                       const float *bias,
+                                       float *dst,
+                                       size_t dst_stride);
+
+/**
+ * Look up a GEMM tile compiled with the latencies and rounding/saturation
+ * flags of config fixed at compile time (see dsp48e1_shim.cpp).  The
+ * returned function produces the same dst as dsp48e1_model_gemm_fp32() on a
+ * model with that configuration.  Returns NULL when no specialization
+ * exists; callers then fall back to the runtime model.
+ */
+dsp48e1_model_gemm_fn_t dsp48e1_model_specialize(const dsp48e1_config_t *config);
+
+/**
+ * Check every compiled slice and GEMM specialization against dsp48e1() and
+ * the runtime model on random operands.  Returns 0 when all agree bitwise.
+ */
+int dsp48e1_shim_self_test(void);
+
+/**
+ * Streaming GEMM: begin a tile whose K dimension arrives in chunks.
+ * The model is reset and the accumulators are preloaded with bias (length
+ * cols, may be NULL).  Accumulators stay live until stream_end(), so K is
+ * not limited by the configured depth.
+ */
+int dsp48e1_model_stream_begin(dsp48e1_model_t *model, const float *bias);
+
+/**
+ * Feed the next k_count inner-product steps.  lhs points at the first column
+ * of this chunk in a rows x K operand (row stride lhs_stride >= k_count) and
+ * rhs at the first row of the chunk in a K x cols operand.
+ * Returns 0 on success.
+ */
+int dsp48e1_model_stream_push(dsp48e1_model_t *model,
+                              const float *lhs,
+                              size_t lhs_stride,
+                              const float *rhs,
+                              size_t rhs_stride,
+                              size_t k_count);
+
+/**
+ * Drain the pipeline and write the rows x cols result to dst.
+ * Returns 0 on success.
+ */
+int dsp48e1_model_stream_end(dsp48e1_model_t *model, float *dst, size_t dst_stride);
+
+/**
+ * Drain the pipeline, then pass the drained tile through epilogue (may be
+ * NULL) in one pass that writes dst, whose element type is given by
+ * epilogue->output and whose dst_stride counts elements of that type.  No
+ * FP32 copy of the tile is written to dst first.  The epilogue's stages are
+ * added to the cycle count as if they followed the last pipeline stage.
+ * Returns 0 on success.
+ */
+int dsp48e1_model_stream_end_epilogue(dsp48e1_model_t *model,
+                                      const dsp48e1_epilogue_t *epilogue,
+                                      void *dst,
+                                      size_t dst_stride);
+
 /**
  * Lightweight self-check to validate the FP32 datapath against a scalar GEMM.
  * Returns 0 when all checks pass.
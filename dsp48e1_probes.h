@@ -0,0 +1,68 @@
+#ifndef DSP48E1_PROBES_H
+#define DSP48E1_PROBES_H
+
+/**
+ * @file dsp48e1_probes.h
+ *
+ * USDT (user-level statically defined tracing) probes on the simulation hot
+ * paths, under the provider name "dsp48e1".  With <sys/sdt.h> available
+ * (systemtap-sdt-dev / systemtap-sdt-devel) each probe is a single nop plus
+ * an ELF note, so an unattached probe costs a nop and its arguments must be
+ * values the caller already has in registers.  perf and bpftrace attach
+ * without rebuilding:
+ *
+ *   perf probe -x ./app sdt_dsp48e1:gemm__begin
+ *   bpftrace -e 'usdt:./app:dsp48e1:flush__end { @[arg1] = count(); }'
+ *
+ * round and saturate pass the valid mask of the block of up to 64 lanes
+ * they touched rather than its population count, which would be computed
+ * even with nothing attached.  gemm__end fires on every exit after
+ * gemm__begin, failed ones included.  Batches fire flush__begin/flush__end
+ * around their final drain as single GEMMs do.
+ *
+ * Probes (arguments in order):
+ *   gemm__begin     model, rows, cols, depth
+ *   gemm__end       model, cycle
+ *   batch__begin    model, problems, depth
+ *   batch__end      model, cycle
+ *   batch__dispatch problems, workers
+ *   flush__begin    model, flush cycles
+ *   flush__end      model, cycle
+ *   round           model, mask of the lanes rounded this cycle
+ *   saturate        model, mask of the lanes saturated this cycle
+ *   step            model, row, col, input_valid
+ *   slice           opmode, alumode, p
+ *   slice__batch    lanes, opmode, alumode
+ *
+ * Define DSP48E1_DISABLE_PROBES to compile every probe out; without
+ * <sys/sdt.h> they compile out as well.  Disabled probes do not evaluate
+ * their arguments.  Define DSP48E1_PROBES to require <sys/sdt.h> instead
+ * of detecting it; make.sh does so against the stub in sdt_stub/ so the
+ * enabled path is type-checked on hosts without systemtap's header.
+ */
+
+#if defined(DSP48E1_DISABLE_PROBES)
+/* Probes compiled out. */
+#elif defined(DSP48E1_PROBES)
+#include <sys/sdt.h>
+#define DSP48E1_PROBES_ENABLED 1
+#elif defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define DSP48E1_PROBES_ENABLED 1
+#endif
+#endif
+
+#ifdef DSP48E1_PROBES_ENABLED
+#define DSP48E1_PROBE1(name, a1) DTRACE_PROBE1(dsp48e1, name, a1)
+#define DSP48E1_PROBE2(name, a1, a2) DTRACE_PROBE2(dsp48e1, name, a1, a2)
+#define DSP48E1_PROBE3(name, a1, a2, a3) DTRACE_PROBE3(dsp48e1, name, a1, a2, a3)
+#define DSP48E1_PROBE4(name, a1, a2, a3, a4) DTRACE_PROBE4(dsp48e1, name, a1, a2, a3, a4)
+#else
+#define DSP48E1_PROBE1(name, a1) ((void)0)
+#define DSP48E1_PROBE2(name, a1, a2) ((void)0)
+#define DSP48E1_PROBE3(name, a1, a2, a3) ((void)0)
+#define DSP48E1_PROBE4(name, a1, a2, a3, a4) ((void)0)
+#endif
+
+#endif /* DSP48E1_PROBES_H */
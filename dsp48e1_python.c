@@ -0,0 +1,639 @@
+// CPython extension over the slice, FP32 multiplier and tensor-unit model
+// APIs.  Arrays are taken through the buffer protocol (NumPy arrays,
+// array.array, memoryview ...) and used in place: inputs are read and
+// outputs written without copies.  The GIL is released while simulating,
+// so Python threads driving separate Model objects run in parallel.
+//
+// Build with setup.py; see the docstrings below for the Python API.
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "dsp48e1.h"
+#include "dsp48e1_combined.h"
+#include "dsp48e1_model.h"
+
+// Element types accepted from buffers
+typedef enum {
+    ELEM_F32,
+    ELEM_I32,
+    ELEM_I64,
+    ELEM_U64,
+    ELEM_BOOL
+} elem_kind_t;
+
+static int format_matches(const char *format, Py_ssize_t itemsize, elem_kind_t kind) {
+    // Native or standard-size little-endian formats only
+    if (!format) {
+        format = "B";
+    }
+    if (*format == '@' || *format == '=' || (*format == '<' && PY_LITTLE_ENDIAN)) {
+        format++;
+    }
+    if (format[0] == '\0' || format[1] != '\0') {
+        return 0;
+    }
+    const char c = format[0];
+    switch (kind) {
+    case ELEM_F32:
+        return c == 'f' && itemsize == 4;
+    case ELEM_I32:
+        return (c == 'i' || c == 'l') && itemsize == 4;
+    case ELEM_I64:
+        return (c == 'q' || c == 'l') && itemsize == 8;
+    case ELEM_U64:
+        return (c == 'Q' || c == 'L' || c == 'q' || c == 'l') && itemsize == 8;
+    case ELEM_BOOL:
+        // Read through bool *, so only '?' bytes are guaranteed to be 0 or 1
+        return c == '?' && itemsize == 1;
+    }
+    return 0;
+}
+
+static const char *kind_name(elem_kind_t kind) {
+    switch (kind) {
+    case ELEM_F32:
+        return "float32";
+    case ELEM_I32:
+        return "int32";
+    case ELEM_I64:
+        return "int64";
+    case ELEM_U64:
+        return "uint64";
+    case ELEM_BOOL:
+        return "bool";
+    }
+    return "?";
+}
+
+/*
+ * Acquire a C-contiguous buffer of at least min_items elements of kind.
+ * None is accepted (view->obj stays NULL) when optional is set.
+ * Returns 0 on success, -1 with a Python exception set.
+ */
+static int get_buffer(PyObject *obj, Py_buffer *view, int writable, elem_kind_t kind,
+                      Py_ssize_t min_items, int optional, const char *name) {
+    memset(view, 0, sizeof(*view));
+    if (obj == NULL || obj == Py_None) {
+        if (optional) {
+            return 0;
+        }
+        PyErr_Format(PyExc_TypeError, "%s is required", name);
+        return -1;
+    }
+
+    const int flags = PyBUF_C_CONTIGUOUS | PyBUF_FORMAT | (writable ? PyBUF_WRITABLE : 0);
+    if (PyObject_GetBuffer(obj, view, flags) != 0) {
+        return -1;
+    }
+    if (!format_matches(view->format, view->itemsize, kind)) {
+        PyErr_Format(PyExc_TypeError, "%s must be a contiguous %s buffer", name, kind_name(kind));
+        PyBuffer_Release(view);
+        return -1;
+    }
+    if (view->len / view->itemsize < min_items) {
+        PyErr_Format(PyExc_ValueError, "%s holds %zd elements, %zd needed",
+                     name, view->len / view->itemsize, min_items);
+        PyBuffer_Release(view);
+        return -1;
+    }
+    return 0;
+}
+
+static void release_buffers(Py_buffer *views, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        if (views[i].obj) {
+            PyBuffer_Release(&views[i]);
+        }
+    }
+}
+
+static Py_ssize_t buffer_items(PyObject *obj, const char *name) {
+    Py_buffer view;
+    if (PyObject_GetBuffer(obj, &view, PyBUF_ND | PyBUF_FORMAT) != 0) {
+        PyErr_Format(PyExc_TypeError, "%s must support the buffer protocol", name);
+        return -1;
+    }
+    const Py_ssize_t items = view.len / (view.itemsize ? view.itemsize : 1);
+    PyBuffer_Release(&view);
+    return items;
+}
+
+/* ---- slice ------------------------------------------------------------- */
+
+PyDoc_STRVAR(slice_doc,
+"slice(a1, a2, b1, b2, c, d, opmode, alumode, inmode, carryinsel, carryin=False, carrycascin=False) -> int\n"
+"\n"
+"Evaluate one DSP48E1 slice and return P.");
+
+static PyObject *py_slice(PyObject *self, PyObject *args, PyObject *kwargs) {
+    (void)self;
+    static char *keywords[] = {"a1", "a2", "b1", "b2", "c", "d", "opmode", "alumode", "inmode",
+                               "carryinsel", "carryin", "carrycascin", NULL};
+    int a1, a2, b1, b2, d, opmode, alumode, inmode, carryinsel;
+    long long c;
+    int carryin = 0, carrycascin = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "iiiiLiiiii|pp", keywords, &a1, &a2, &b1, &b2, &c, &d,
+                                     &opmode, &alumode, &inmode, &carryinsel, &carryin, &carrycascin)) {
+        return NULL;
+    }
+    const int64_t p = dsp48e1(a1, a2, b1, b2, c, d, (int8_t)opmode, (int8_t)alumode, (int8_t)inmode,
+                              (int8_t)carryinsel, carryin != 0, carrycascin != 0);
+    return PyLong_FromLongLong(p);
+}
+
+PyDoc_STRVAR(slice_batch_doc,
+"slice_batch(a1, a2, b1, b2, c, d, out, opmode, alumode, inmode, carryinsel, carryin=None, carrycascin=None) -> None\n"
+"\n"
+"Evaluate len(out) slices sharing one control word.  a1, a2, b1, b2 and d are\n"
+"int32 buffers, c and out int64, carryin/carrycascin optional bool buffers\n"
+"(format '?', e.g. NumPy bool or memoryview.cast('?')).");
+
+static PyObject *py_slice_batch(PyObject *self, PyObject *args, PyObject *kwargs) {
+    (void)self;
+    static char *keywords[] = {"a1", "a2", "b1", "b2", "c", "d", "out", "opmode", "alumode", "inmode",
+                               "carryinsel", "carryin", "carrycascin", NULL};
+    PyObject *objs[9] = {NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL};
+    int opmode, alumode, inmode, carryinsel;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOOOOOOiiii|OO", keywords,
+                                     &objs[0], &objs[1], &objs[2], &objs[3], &objs[4], &objs[5], &objs[6],
+                                     &opmode, &alumode, &inmode, &carryinsel, &objs[7], &objs[8])) {
+        return NULL;
+    }
+
+    const Py_ssize_t n = buffer_items(objs[6], "out");
+    if (n < 0) {
+        return NULL;
+    }
+
+    static const char *names[9] = {"a1", "a2", "b1", "b2", "c", "d", "out", "carryin", "carrycascin"};
+    static const elem_kind_t kinds[9] = {ELEM_I32, ELEM_I32, ELEM_I32, ELEM_I32, ELEM_I64, ELEM_I32,
+                                         ELEM_I64, ELEM_BOOL, ELEM_BOOL};
+    Py_buffer views[9];
+    memset(views, 0, sizeof(views));
+    for (size_t i = 0; i < 9; ++i) {
+        if (get_buffer(objs[i], &views[i], i == 6, kinds[i], n, i >= 7, names[i]) != 0) {
+            release_buffers(views, i);
+            return NULL;
+        }
+    }
+
+    dsp48e1_batch_ports_t ports;
+    ports.a1 = (const int32_t *)views[0].buf;
+    ports.a2 = (const int32_t *)views[1].buf;
+    ports.b1 = (const int32_t *)views[2].buf;
+    ports.b2 = (const int32_t *)views[3].buf;
+    ports.c = (const int64_t *)views[4].buf;
+    ports.d = (const int32_t *)views[5].buf;
+    ports.carryin = (const bool *)views[7].buf;
+    ports.carrycascin = (const bool *)views[8].buf;
+    int64_t *p = (int64_t *)views[6].buf;
+
+    Py_BEGIN_ALLOW_THREADS
+    dsp48e1_batch(&ports, (size_t)n, (int8_t)opmode, (int8_t)alumode, (int8_t)inmode, (int8_t)carryinsel, p);
+    Py_END_ALLOW_THREADS
+
+    release_buffers(views, 9);
+    Py_RETURN_NONE;
+}
+
+/* ---- FP32 multiplier --------------------------------------------------- */
+
+PyDoc_STRVAR(fp32_mul_doc,
+"fp32_mul(a, b, out) -> None\n"
+"\n"
+"out[i] = a[i] * b[i] through the slice-based FP32 multiplier.  All three are\n"
+"float32 buffers of the same length.");
+
+static PyObject *py_fp32_mul(PyObject *self, PyObject *args) {
+    (void)self;
+    PyObject *a_obj, *b_obj, *out_obj;
+    if (!PyArg_ParseTuple(args, "OOO", &a_obj, &b_obj, &out_obj)) {
+        return NULL;
+    }
+    const Py_ssize_t n = buffer_items(out_obj, "out");
+    if (n < 0) {
+        return NULL;
+    }
+
+    Py_buffer views[3];
+    memset(views, 0, sizeof(views));
+    if (get_buffer(a_obj, &views[0], 0, ELEM_F32, n, 0, "a") != 0 ||
+        get_buffer(b_obj, &views[1], 0, ELEM_F32, n, 0, "b") != 0 ||
+        get_buffer(out_obj, &views[2], 1, ELEM_F32, n, 0, "out") != 0) {
+        release_buffers(views, 3);
+        return NULL;
+    }
+
+    const uint32_t *a = (const uint32_t *)views[0].buf;
+    const uint32_t *b = (const uint32_t *)views[1].buf;
+    uint32_t *out = (uint32_t *)views[2].buf;
+
+    Py_BEGIN_ALLOW_THREADS
+    dsp48e1_combined_batch(a, b, out, (size_t)n);
+    Py_END_ALLOW_THREADS
+
+    release_buffers(views, 3);
+    Py_RETURN_NONE;
+}
+
+/* ---- Model ------------------------------------------------------------- */
+
+typedef struct {
+    PyObject_HEAD
+    dsp48e1_model_t model;
+    int initialized;
+    int busy; // Set (under the GIL) while a call runs without the GIL
+} ModelObject;
+
+static int model_acquire(ModelObject *self) {
+    if (!self->initialized) {
+        PyErr_SetString(PyExc_RuntimeError, "model is not initialized");
+        return -1;
+    }
+    if (self->busy) {
+        PyErr_SetString(PyExc_RuntimeError, "model is in use by another thread");
+        return -1;
+    }
+    self->busy = 1;
+    return 0;
+}
+
+static int Model_init(ModelObject *self, PyObject *args, PyObject *kwargs) {
+    static char *keywords[] = {"rows", "cols", "depth", "multiplier_latency", "adder_latency",
+                               "accumulator_latency", "rounding_latency", "saturation_latency",
+                               "rounding", "saturation", "accum_mode", "accum_fraction_bits", NULL};
+    dsp48e1_config_t config;
+    dsp48e1_default_fp32_config(&config);
+
+    Py_ssize_t rows, cols, depth;
+    unsigned char mul = config.multiplier_latency, add = config.adder_latency;
+    unsigned char acc = config.accumulator_latency, rnd = config.rounding_latency;
+    unsigned char sat = config.saturation_latency, frac = config.accum_fraction_bits;
+    int rounding = config.enable_rounding, saturation = config.enable_saturation;
+    int accum_mode = (int)config.accum_mode;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "nnn|$bbbbbppib", keywords, &rows, &cols, &depth,
+                                     &mul, &add, &acc, &rnd, &sat, &rounding, &saturation,
+                                     &accum_mode, &frac)) {
+        return -1;
+    }
+    if (rows <= 0 || cols <= 0 || depth <= 0) {
+        PyErr_SetString(PyExc_ValueError, "rows, cols and depth must be positive");
+        return -1;
+    }
+    if (self->busy) {
+        PyErr_SetString(PyExc_RuntimeError, "model is in use by another thread");
+        return -1;
+    }
+
+    config.multiplier_latency = mul;
+    config.adder_latency = add;
+    config.accumulator_latency = acc;
+    config.rounding_latency = rnd;
+    config.saturation_latency = sat;
+    config.enable_rounding = rounding;
+    config.enable_saturation = saturation;
+    config.accum_mode = (dsp48e1_accum_mode_t)accum_mode;
+    config.accum_fraction_bits = frac;
+
+    if (self->initialized) {
+        dsp48e1_model_free(&self->model);
+        self->initialized = 0;
+    }
+    if (dsp48e1_model_init(&self->model, &config, (size_t)rows, (size_t)cols, (size_t)depth) != 0) {
+        PyErr_SetString(PyExc_ValueError, "invalid model configuration");
+        return -1;
+    }
+    self->initialized = 1;
+    return 0;
+}
+
+static void Model_dealloc(ModelObject *self) {
+    if (self->initialized) {
+        dsp48e1_model_free(&self->model);
+    }
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+PyDoc_STRVAR(Model_gemm_doc,
+"gemm(lhs, rhs, out, bias=None) -> int\n"
+"\n"
+"Run one rows x cols x depth tile: out = lhs @ rhs + bias.  lhs is rows x depth,\n"
+"rhs depth x cols and out rows x cols, all float32 and row-major; bias has\n"
+"cols entries.  Returns the modeled cycle count.");
+
+static PyObject *Model_gemm(ModelObject *self, PyObject *args, PyObject *kwargs) {
+    static char *keywords[] = {"lhs", "rhs", "out", "bias", NULL};
+    PyObject *lhs_obj, *rhs_obj, *out_obj, *bias_obj = Py_None;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOO|O", keywords, &lhs_obj, &rhs_obj, &out_obj, &bias_obj) ||
+        model_acquire(self) != 0) {
+        return NULL;
+    }
+
+    dsp48e1_model_t *model = &self->model;
+    Py_buffer views[4];
+    memset(views, 0, sizeof(views));
+    if (get_buffer(lhs_obj, &views[0], 0, ELEM_F32, (Py_ssize_t)(model->rows * model->depth), 0, "lhs") != 0 ||
+        get_buffer(rhs_obj, &views[1], 0, ELEM_F32, (Py_ssize_t)(model->depth * model->cols), 0, "rhs") != 0 ||
+        get_buffer(out_obj, &views[2], 1, ELEM_F32, (Py_ssize_t)(model->rows * model->cols), 0, "out") != 0 ||
+        get_buffer(bias_obj, &views[3], 0, ELEM_F32, (Py_ssize_t)model->cols, 1, "bias") != 0) {
+        release_buffers(views, 4);
+        self->busy = 0;
+        return NULL;
+    }
+
+    int status;
+    Py_BEGIN_ALLOW_THREADS
+    status = dsp48e1_model_gemm_fp32(model, (const float *)views[0].buf, model->depth,
+                                     (const float *)views[1].buf, model->cols,
+                                     (const float *)views[3].buf, (float *)views[2].buf, model->cols);
+    Py_END_ALLOW_THREADS
+
+    release_buffers(views, 4);
+    self->busy = 0;
+    if (status != 0) {
+        PyErr_SetString(PyExc_RuntimeError, "dsp48e1_model_gemm_fp32 failed");
+        return NULL;
+    }
+    return PyLong_FromUnsignedLongLong(model->cycle);
+}
+
+PyDoc_STRVAR(Model_step_doc,
+"step(a=None, b=None, addend=None, valid=True, out=None, out_valid=None) -> None\n"
+"\n"
+"Clock every PE once.  a, b and addend hold rows * cols float32 values (None\n"
+"feeds zeros); out receives rows * cols float32 outputs and out_valid\n"
+"ceil(rows * cols / 64) uint64 words of packed valid flags.");
+
+static PyObject *Model_step(ModelObject *self, PyObject *args, PyObject *kwargs) {
+    static char *keywords[] = {"a", "b", "addend", "valid", "out", "out_valid", NULL};
+    PyObject *objs[5] = {Py_None, Py_None, Py_None, Py_None, Py_None};
+    int valid = 1;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|OOOpOO", keywords, &objs[0], &objs[1], &objs[2],
+                                     &valid, &objs[3], &objs[4]) ||
+        model_acquire(self) != 0) {
+        return NULL;
+    }
+
+    dsp48e1_model_t *model = &self->model;
+    const Py_ssize_t elements = (Py_ssize_t)(model->rows * model->cols);
+    Py_buffer views[5];
+    memset(views, 0, sizeof(views));
+    if (get_buffer(objs[0], &views[0], 0, ELEM_F32, elements, 1, "a") != 0 ||
+        get_buffer(objs[1], &views[1], 0, ELEM_F32, elements, 1, "b") != 0 ||
+        get_buffer(objs[2], &views[2], 0, ELEM_F32, elements, 1, "addend") != 0 ||
+        get_buffer(objs[3], &views[3], 1, ELEM_F32, elements, 1, "out") != 0 ||
+        get_buffer(objs[4], &views[4], 1, ELEM_U64, (Py_ssize_t)model->valid_words, 1, "out_valid") != 0) {
+        release_buffers(views, 5);
+        self->busy = 0;
+        return NULL;
+    }
+
+    int status;
+    Py_BEGIN_ALLOW_THREADS
+    status = dsp48e1_model_step_tile_fp32(model, valid, (const float *)views[0].buf,
+                                          (const float *)views[1].buf, (const float *)views[2].buf,
+                                          (uint64_t *)views[4].buf, (float *)views[3].buf);
+    Py_END_ALLOW_THREADS
+
+    release_buffers(views, 5);
+    self->busy = 0;
+    if (status != 0) {
+        PyErr_SetString(PyExc_RuntimeError, "dsp48e1_model_step_tile_fp32 failed");
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(Model_stream_begin_doc,
+"stream_begin(bias=None) -> None\n"
+"\n"
+"Reset the model and start a streamed tile; bias has cols float32 entries.");
+
+static PyObject *Model_stream_begin(ModelObject *self, PyObject *args, PyObject *kwargs) {
+    static char *keywords[] = {"bias", NULL};
+    PyObject *bias_obj = Py_None;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O", keywords, &bias_obj) || model_acquire(self) != 0) {
+        return NULL;
+    }
+    Py_buffer bias;
+    int status = -1;
+    if (get_buffer(bias_obj, &bias, 0, ELEM_F32, (Py_ssize_t)self->model.cols, 1, "bias") == 0) {
+        status = dsp48e1_model_stream_begin(&self->model, (const float *)bias.buf);
+        release_buffers(&bias, 1);
+        if (status != 0) {
+            PyErr_SetString(PyExc_RuntimeError, "dsp48e1_model_stream_begin failed");
+        }
+    }
+    self->busy = 0;
+    if (status != 0) {
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(Model_stream_push_doc,
+"stream_push(lhs, rhs, k) -> None\n"
+"\n"
+"Feed k inner-product steps: lhs is rows x k and rhs k x cols float32.");
+
+static PyObject *Model_stream_push(ModelObject *self, PyObject *args) {
+    PyObject *lhs_obj, *rhs_obj;
+    Py_ssize_t k;
+    if (!PyArg_ParseTuple(args, "OOn", &lhs_obj, &rhs_obj, &k) || model_acquire(self) != 0) {
+        return NULL;
+    }
+    if (k <= 0) {
+        self->busy = 0;
+        PyErr_SetString(PyExc_ValueError, "k must be positive");
+        return NULL;
+    }
+
+    dsp48e1_model_t *model = &self->model;
+    Py_buffer views[2];
+    memset(views, 0, sizeof(views));
+    if (get_buffer(lhs_obj, &views[0], 0, ELEM_F32, (Py_ssize_t)model->rows * k, 0, "lhs") != 0 ||
+        get_buffer(rhs_obj, &views[1], 0, ELEM_F32, k * (Py_ssize_t)model->cols, 0, "rhs") != 0) {
+        release_buffers(views, 2);
+        self->busy = 0;
+        return NULL;
+    }
+
+    int status;
+    Py_BEGIN_ALLOW_THREADS
+    status = dsp48e1_model_stream_push(model, (const float *)views[0].buf, (size_t)k,
+                                       (const float *)views[1].buf, model->cols, (size_t)k);
+    Py_END_ALLOW_THREADS
+
+    release_buffers(views, 2);
+    self->busy = 0;
+    if (status != 0) {
+        PyErr_SetString(PyExc_RuntimeError, "dsp48e1_model_stream_push failed (no stream_begin?)");
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(Model_stream_end_doc,
+"stream_end(out) -> int\n"
+"\n"
+"Drain the pipeline into out (rows x cols float32); returns the cycle count.");
+
+static PyObject *Model_stream_end(ModelObject *self, PyObject *args) {
+    PyObject *out_obj;
+    if (!PyArg_ParseTuple(args, "O", &out_obj) || model_acquire(self) != 0) {
+        return NULL;
+    }
+
+    dsp48e1_model_t *model = &self->model;
+    Py_buffer out;
+    if (get_buffer(out_obj, &out, 1, ELEM_F32, (Py_ssize_t)(model->rows * model->cols), 0, "out") != 0) {
+        self->busy = 0;
+        return NULL;
+    }
+
+    int status;
+    Py_BEGIN_ALLOW_THREADS
+    status = dsp48e1_model_stream_end(model, (float *)out.buf, model->cols);
+    Py_END_ALLOW_THREADS
+
+    release_buffers(&out, 1);
+    self->busy = 0;
+    if (status != 0) {
+        PyErr_SetString(PyExc_RuntimeError, "dsp48e1_model_stream_end failed (no stream_begin?)");
+        return NULL;
+    }
+    return PyLong_FromUnsignedLongLong(model->cycle);
+}
+
+static PyObject *Model_reset(ModelObject *self, PyObject *unused) {
+    (void)unused;
+    if (model_acquire(self) != 0) {
+        return NULL;
+    }
+    dsp48e1_model_reset(&self->model);
+    self->busy = 0;
+    Py_RETURN_NONE;
+}
+
+static PyObject *Model_get_size(ModelObject *self, void *closure) {
+    if (!self->initialized) {
+        PyErr_SetString(PyExc_RuntimeError, "model is not initialized");
+        return NULL;
+    }
+    const size_t which = (size_t)(uintptr_t)closure;
+    const size_t values[4] = {self->model.rows, self->model.cols, self->model.depth,
+                              dsp48e1_config_latency(&self->model.config)};
+    return PyLong_FromSize_t(values[which]);
+}
+
+static PyObject *Model_get_cycle(ModelObject *self, void *closure) {
+    (void)closure;
+    if (!self->initialized) {
+        PyErr_SetString(PyExc_RuntimeError, "model is not initialized");
+        return NULL;
+    }
+    return PyLong_FromUnsignedLongLong(self->model.cycle);
+}
+
+static PyMethodDef Model_methods[] = {
+    {"gemm", (PyCFunction)(void (*)(void))Model_gemm, METH_VARARGS | METH_KEYWORDS, Model_gemm_doc},
+    {"step", (PyCFunction)(void (*)(void))Model_step, METH_VARARGS | METH_KEYWORDS, Model_step_doc},
+    {"stream_begin", (PyCFunction)(void (*)(void))Model_stream_begin, METH_VARARGS | METH_KEYWORDS,
+     Model_stream_begin_doc},
+    {"stream_push", (PyCFunction)Model_stream_push, METH_VARARGS, Model_stream_push_doc},
+    {"stream_end", (PyCFunction)Model_stream_end, METH_VARARGS, Model_stream_end_doc},
+    {"reset", (PyCFunction)Model_reset, METH_NOARGS, "reset() -> None\n\nZero the cycle counter and pipeline."},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyGetSetDef Model_getset[] = {
+    {"rows", (getter)Model_get_size, NULL, "PE rows.", (void *)0},
+    {"cols", (getter)Model_get_size, NULL, "PE columns.", (void *)1},
+    {"depth", (getter)Model_get_size, NULL, "Inner-product depth of gemm().", (void *)2},
+    {"latency", (getter)Model_get_size, NULL, "Pipeline latency in clocks.", (void *)3},
+    {"cycle", (getter)Model_get_cycle, NULL, "Modeled clock count.", NULL},
+    {NULL, NULL, NULL, NULL, NULL}
+};
+
+PyDoc_STRVAR(Model_doc,
+"Model(rows, cols, depth, *, multiplier_latency=2, adder_latency=1,\n"
+"      accumulator_latency=1, rounding_latency=1, saturation_latency=0,\n"
+"      rounding=True, saturation=False, accum_mode=ACCUM_FP32,\n"
+"      accum_fraction_bits=0)\n"
+"\n"
+"A rows x cols tensor unit of FP32 PEs.  A Model may be shared between\n"
+"threads but runs one call at a time; use one Model per thread for\n"
+"parallel simulation.");
+
+static PyTypeObject ModelType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "dsp48e1.Model",
+    .tp_basicsize = sizeof(ModelObject),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = Model_doc,
+    .tp_new = PyType_GenericNew,
+    .tp_init = (initproc)Model_init,
+    .tp_dealloc = (destructor)Model_dealloc,
+    .tp_methods = Model_methods,
+    .tp_getset = Model_getset,
+};
+
+/* ---- module ------------------------------------------------------------ */
+
+static PyObject *py_self_test(PyObject *self, PyObject *unused) {
+    (void)self;
+    (void)unused;
+    int slice_ok, model_ok;
+    Py_BEGIN_ALLOW_THREADS
+    slice_ok = dsp48e1_self_test() == 0;
+    model_ok = dsp48e1_model_self_test_fp32() == 0;
+    Py_END_ALLOW_THREADS
+    return Py_BuildValue("(NN)", PyBool_FromLong(slice_ok), PyBool_FromLong(model_ok));
+}
+
+static PyMethodDef module_methods[] = {
+    {"slice", (PyCFunction)(void (*)(void))py_slice, METH_VARARGS | METH_KEYWORDS, slice_doc},
+    {"slice_batch", (PyCFunction)(void (*)(void))py_slice_batch, METH_VARARGS | METH_KEYWORDS, slice_batch_doc},
+    {"fp32_mul", py_fp32_mul, METH_VARARGS, fp32_mul_doc},
+    {"self_test", py_self_test, METH_NOARGS, "self_test() -> (bool, bool)\n\nRun the slice and model self-checks."},
+    {NULL, NULL, 0, NULL}
+};
+
+static struct PyModuleDef module_def = {
+    PyModuleDef_HEAD_INIT,
+    "dsp48e1",
+    "Bit-level DSP48E1 slice emulation and FP32 tensor-unit model.",
+    -1,
+    module_methods,
+    NULL,
+    NULL,
+    NULL,
+    NULL
+};
+
+PyMODINIT_FUNC PyInit_dsp48e1(void) {
+    if (PyType_Ready(&ModelType) < 0) {
+        return NULL;
+    }
+    PyObject *module = PyModule_Create(&module_def);
+    if (!module) {
+        return NULL;
+    }
+    Py_INCREF(&ModelType);
+    if (PyModule_AddObject(module, "Model", (PyObject *)&ModelType) < 0 ||
+        PyModule_AddIntConstant(module, "ACCUM_FP32", DSP48E1_ACCUM_FP32) < 0 ||
+        PyModule_AddIntConstant(module, "ACCUM_FP64", DSP48E1_ACCUM_FP64) < 0 ||
+        PyModule_AddIntConstant(module, "ACCUM_FIXED48", DSP48E1_ACCUM_FIXED48) < 0 ||
+        PyModule_AddIntConstant(module, "ACCUM_KAHAN", DSP48E1_ACCUM_KAHAN) < 0) {
+        Py_DECREF(&ModelType);
+        Py_DECREF(module);
+        return NULL;
+    }
+    return module;
+}
@@ -0,0 +1,158 @@
+// Command-line front end for the trace replay engine.
+//
+//   dsp48e1_replay [--max-report N] TRACE
+//       Replay TRACE, print mismatches (up to N, default 10) and throughput.
+//       Exits 0 when every P matches, 1 on mismatches and 2 on errors.
+//
+//   dsp48e1_replay --generate COUNT [--seed S] [--corrupt EVERY] TRACE
+//       Write a synthetic trace of COUNT operations whose P comes from
+//       dsp48e1(); with --corrupt, every EVERY-th P is flipped so the
+//       mismatch path can be exercised.
+
+#include "dsp48e1_trace.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    uint64_t reported;
+    uint64_t max_report;
+} report_state_t;
+
+static void report_mismatch(void *user, uint64_t index, const dsp48e1_trace_op_t *op, int64_t computed_p) {
+    report_state_t *state = (report_state_t *)user;
+    if (state->reported >= state->max_report) {
+        return;
+    }
+    state->reported++;
+    printf("mismatch at op %" PRIu64 ": opmode=0x%02X alumode=0x%X inmode=0x%02X carryinsel=%d "
+           "a1=%" PRId32 " a2=%" PRId32 " b1=%" PRId32 " b2=%" PRId32 " c=%" PRId64 " d=%" PRId32
+           " recorded P=%" PRId64 " computed P=%" PRId64 "\n",
+           index, (unsigned)op->opmode, (unsigned)op->alumode, (unsigned)op->inmode, op->carryinsel,
+           op->a1, op->a2, op->b1, op->b2, op->c, op->d, op->p, computed_p);
+}
+
+static uint64_t next_random(uint64_t *state) {
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return x;
+}
+
+static int32_t random_signed(uint64_t *state, int width) {
+    return (int32_t)((int64_t)(next_random(state) << (64 - width)) >> (64 - width));
+}
+
+static int generate(const char *path, uint64_t count, uint64_t seed, uint64_t corrupt_every) {
+    // A*B, C+A*B, C-A*B, (D+A)*B, A:B+C and C logic operations
+    static const int8_t controls[][4] = {
+        {0b0000101, 0b0000, 0b00000, 0},
+        {0b0110101, 0b0000, 0b00000, 0},
+        {0b0110101, 0b0011, 0b00000, 0},
+        {0b0000101, 0b0000, 0b00100, 0},
+        {0b0110011, 0b0000, 0b00000, 0},
+        {0b0110011, 0b1100, 0b00000, 0},
+        {0b0110011, 0b0100, 0b00000, 0},
+        {0b0110101, 0b0000, 0b00000, 6},
+    };
+    const size_t control_count = sizeof(controls) / sizeof(controls[0]);
+
+    dsp48e1_trace_writer_t writer;
+    if (dsp48e1_trace_writer_open(&writer, path) != 0) {
+        return -1;
+    }
+
+    uint64_t state = seed ? seed : 88172645463325252ULL;
+    for (uint64_t i = 0; i < count; ++i) {
+        const int8_t *control = controls[next_random(&state) % control_count];
+        dsp48e1_trace_op_t op;
+        op.a1 = random_signed(&state, 30);
+        op.a2 = random_signed(&state, 30);
+        op.b1 = random_signed(&state, 18);
+        op.b2 = random_signed(&state, 18);
+        op.d = random_signed(&state, 25);
+        op.c = (int64_t)(next_random(&state) << 16) >> 16;
+        op.opmode = control[0];
+        op.alumode = control[1];
+        op.inmode = control[2];
+        op.carryinsel = control[3];
+        op.carryin = (next_random(&state) & 1) != 0;
+        op.carrycascin = false;
+        op.p = dsp48e1(op.a1, op.a2, op.b1, op.b2, op.c, op.d, op.opmode, op.alumode,
+                       op.inmode, op.carryinsel, op.carryin, op.carrycascin);
+        if (corrupt_every && i % corrupt_every == corrupt_every - 1) {
+            op.p = (int64_t)((uint64_t)(op.p ^ 1) << 16) >> 16;
+        }
+        if (dsp48e1_trace_write(&writer, &op) != 0) {
+            dsp48e1_trace_writer_close(&writer);
+            return -1;
+        }
+    }
+    return dsp48e1_trace_writer_close(&writer);
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+            "usage: %s [--max-report N] TRACE\n"
+            "       %s --generate COUNT [--seed S] [--corrupt EVERY] TRACE\n",
+            argv0, argv0);
+}
+
+int main(int argc, char **argv) {
+    uint64_t generate_count = 0;
+    int generating = 0;
+    uint64_t seed = 0;
+    uint64_t corrupt_every = 0;
+    report_state_t report = {0, 10};
+    const char *path = NULL;
+
+    for (int i = 1; i < argc; ++i) {
+        const int has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--generate") == 0 && has_value) {
+            generating = 1;
+            generate_count = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--seed") == 0 && has_value) {
+            seed = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--corrupt") == 0 && has_value) {
+            corrupt_every = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--max-report") == 0 && has_value) {
+            report.max_report = strtoull(argv[++i], NULL, 0);
+        } else if (argv[i][0] != '-' && !path) {
+            path = argv[i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (!path) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    if (generating) {
+        if (generate(path, generate_count, seed, corrupt_every) != 0) {
+            fprintf(stderr, "%s: failed to write trace\n", path);
+            return 2;
+        }
+        return 0;
+    }
+
+    dsp48e1_replay_stats_t stats;
+    if (dsp48e1_trace_replay(path, report_mismatch, &report, &stats) != 0) {
+        fprintf(stderr, "%s: unreadable or malformed trace\n", path);
+        return 2;
+    }
+
+    const double seconds = stats.seconds > 0.0 ? stats.seconds : 1e-9;
+    printf("ops:        %" PRIu64 "\n", stats.ops);
+    printf("mismatches: %" PRIu64 "\n", stats.mismatches);
+    printf("batches:    %" PRIu64 "\n", stats.batches);
+    printf("time:       %.3f s\n", stats.seconds);
+    printf("throughput: %.2f Mops/s, %.1f MB/s\n",
+           (double)stats.ops / seconds * 1e-6, (double)stats.bytes / seconds / (1024.0 * 1024.0));
+    return stats.mismatches ? 1 : 0;
+}
@@ -0,0 +1,954 @@
+#define _GNU_SOURCE /* accept4, pipe2, MSG_CMSG_CLOEXEC, F_GET_SEALS */
+
+#include "dsp48e1_server.h"
+
+#include "dsp48e1_batch.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+enum {
+    SERVER_DEFAULT_MAX_BATCH = 256,
+    SERVER_DEFAULT_POOL_MODELS = 4,
+    SERVER_MAX_READS_PER_CLIENT = 1024, /* Messages read per client per poll round. */
+    SERVER_MAX_DIMENSION = 1 << 24
+};
+
+typedef struct {
+    void *base;
+    size_t size;
+} server_region_t;
+
+typedef struct {
+    int fd; /* -1 for a free slot. */
+    int closing;
+    server_region_t regions[DSP48E1_SERVER_MAX_REGIONS];
+    /* Results the socket could not take yet, sent when it becomes writable. */
+    dsp48e1_job_result_t *outbox;
+    size_t outbox_head;
+    size_t outbox_count;
+    size_t outbox_capacity;
+} server_client_t;
+
+typedef struct {
+    dsp48e1_config_t config;
+    dsp48e1_model_pool_t pool;
+} server_pool_t;
+
+typedef struct {
+    size_t client;
+    int done;
+    dsp48e1_job_t job;
+} server_pending_t;
+
+struct dsp48e1_server {
+    int listen_fd;
+    int wake[2];
+    volatile sig_atomic_t stopping;
+    char path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+    dsp48e1_server_options_t options;
+    dsp48e1_server_stats_t stats;
+
+    server_client_t *clients;
+    size_t client_count;
+    struct pollfd *pollfds;
+
+    server_pool_t *pools;
+    size_t pool_count;
+
+    server_pending_t *pending;
+    size_t pending_count;
+    size_t pending_capacity;
+
+    dsp48e1_gemm_desc_t *descs;
+    size_t *members;
+};
+
+static int config_equal(const dsp48e1_config_t *a, const dsp48e1_config_t *b) {
+    return a->format.kind == b->format.kind &&
+           a->format.total_bits == b->format.total_bits &&
+           a->format.exponent_bits == b->format.exponent_bits &&
+           a->format.mantissa_bits == b->format.mantissa_bits &&
+           a->format.fractional_bits == b->format.fractional_bits &&
+           a->format.specials == b->format.specials &&
+           a->format.exponent_bias == b->format.exponent_bias &&
+           a->multiplier_latency == b->multiplier_latency &&
+           a->adder_latency == b->adder_latency &&
+           a->accumulator_latency == b->accumulator_latency &&
+           a->rounding_latency == b->rounding_latency &&
+           a->saturation_latency == b->saturation_latency &&
+           (a->enable_rounding != 0) == (b->enable_rounding != 0) &&
+           (a->enable_saturation != 0) == (b->enable_saturation != 0) &&
+           a->accum_mode == b->accum_mode &&
+           a->accum_fraction_bits == b->accum_fraction_bits;
+}
+
+static dsp48e1_model_pool_t *server_pool(dsp48e1_server_t *server, const dsp48e1_config_t *config) {
+    for (size_t i = 0; i < server->pool_count; ++i) {
+        if (config_equal(&server->pools[i].config, config)) {
+            return &server->pools[i].pool;
+        }
+    }
+
+    server_pool_t *pools = (server_pool_t *)realloc(server->pools,
+                                                    sizeof(server_pool_t) * (server->pool_count + 1));
+    if (!pools) {
+        return NULL;
+    }
+    server->pools = pools;
+    server_pool_t *entry = &pools[server->pool_count];
+    entry->config = *config;
+    /* One model per batch worker, so parallel batches allocate nothing. */
+    const size_t models = server->options.pool_models > server->options.threads ? server->options.pool_models
+                                                                                 : server->options.threads;
+    if (dsp48e1_model_pool_init(&entry->pool, config, models) != 0) {
+        return NULL;
+    }
+    server->pool_count++;
+    return &entry->pool;
+}
+
+/* Pointer to count floats at offset in the client's region, or NULL. */
+static float *server_resolve(const server_client_t *client, uint32_t region, uint64_t offset, uint64_t count) {
+    if (region >= DSP48E1_SERVER_MAX_REGIONS || !client->regions[region].base ||
+        offset % sizeof(float) != 0) {
+        return NULL;
+    }
+    const uint64_t size = client->regions[region].size;
+    if (offset > size || count > (size - offset) / sizeof(float)) {
+        return NULL;
+    }
+    return (float *)((unsigned char *)client->regions[region].base + offset);
+}
+
+static uint64_t span(uint64_t rows, uint64_t stride, uint64_t width) {
+    return (rows - 1) * stride + width;
+}
+
+static int server_reply(dsp48e1_server_t *server, size_t client, const dsp48e1_job_result_t *result) {
+    server_client_t *c = &server->clients[client];
+    if (c->fd < 0 || c->closing) {
+        return -1;
+    }
+    if (result->status != 0) {
+        server->stats.failed++;
+    }
+    if (c->outbox_count == 0) {
+        const ssize_t sent = send(c->fd, result, sizeof(*result), MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent == (ssize_t)sizeof(*result)) {
+            return 0;
+        }
+        if (sent >= 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+            c->closing = 1;
+            return -1;
+        }
+    }
+
+    /* A client that submits faster than it reads must not stall the server. */
+    if (c->outbox_head + c->outbox_count == c->outbox_capacity) {
+        if (c->outbox_head > 0) {
+            memmove(c->outbox, c->outbox + c->outbox_head, sizeof(*result) * c->outbox_count);
+            c->outbox_head = 0;
+        }
+        if (c->outbox_count == c->outbox_capacity) {
+            const size_t capacity = c->outbox_capacity ? c->outbox_capacity * 2 : 256;
+            dsp48e1_job_result_t *outbox = (dsp48e1_job_result_t *)realloc(c->outbox, sizeof(*result) * capacity);
+            if (!outbox) {
+                c->closing = 1;
+                return -1;
+            }
+            c->outbox = outbox;
+            c->outbox_capacity = capacity;
+        }
+    }
+    c->outbox[c->outbox_head + c->outbox_count++] = *result;
+    return 0;
+}
+
+static void server_flush_client(dsp48e1_server_t *server, size_t client) {
+    server_client_t *c = &server->clients[client];
+    while (c->outbox_count > 0) {
+        const ssize_t sent = send(c->fd, &c->outbox[c->outbox_head], sizeof(dsp48e1_job_result_t),
+                                  MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return;
+        }
+        if (sent != (ssize_t)sizeof(dsp48e1_job_result_t)) {
+            c->closing = 1;
+            return;
+        }
+        c->outbox_head++;
+        c->outbox_count--;
+    }
+    c->outbox_head = 0;
+}
+
+static void server_fail(dsp48e1_server_t *server, size_t client, uint64_t id) {
+    dsp48e1_job_result_t result;
+    memset(&result, 0, sizeof(result));
+    result.id = id;
+    result.status = -1;
+    server_reply(server, client, &result);
+}
+
+static int gemm_shape_valid(const dsp48e1_job_t *job) {
+    return job->rows > 0 && job->cols > 0 && job->depth > 0 &&
+           job->rows <= SERVER_MAX_DIMENSION && job->cols <= SERVER_MAX_DIMENSION &&
+           job->depth <= SERVER_MAX_DIMENSION &&
+           job->lhs_stride >= job->depth && job->lhs_stride <= SERVER_MAX_DIMENSION &&
+           job->rhs_stride >= job->cols && job->rhs_stride <= SERVER_MAX_DIMENSION &&
+           job->dst_stride >= job->cols && job->dst_stride <= SERVER_MAX_DIMENSION;
+}
+
+/* Resolve a GEMM job's operands; returns 0 and fills desc on success. */
+static int gemm_resolve(const server_client_t *client, const dsp48e1_job_t *job, dsp48e1_gemm_desc_t *desc) {
+    if (!gemm_shape_valid(job)) {
+        return -1;
+    }
+    desc->lhs = server_resolve(client, job->region, job->lhs_offset, span(job->rows, job->lhs_stride, job->depth));
+    desc->rhs = server_resolve(client, job->region, job->rhs_offset, span(job->depth, job->rhs_stride, job->cols));
+    desc->dst = server_resolve(client, job->region, job->dst_offset, span(job->rows, job->dst_stride, job->cols));
+    desc->bias = NULL;
+    if (job->bias_offset != DSP48E1_SERVER_NO_OFFSET) {
+        desc->bias = server_resolve(client, job->region, job->bias_offset, job->cols);
+        if (!desc->bias) {
+            return -1;
+        }
+    }
+    return desc->lhs && desc->rhs && desc->dst ? 0 : -1;
+}
+
+static int gemm_compatible(const dsp48e1_job_t *a, const dsp48e1_job_t *b) {
+    return a->rows == b->rows && a->cols == b->cols && a->depth == b->depth &&
+           a->lhs_stride == b->lhs_stride && a->rhs_stride == b->rhs_stride &&
+           a->dst_stride == b->dst_stride && config_equal(&a->config, &b->config);
+}
+
+/* Coalesce pending[first] with every later compatible GEMM and run them. */
+static void server_run_gemm(dsp48e1_server_t *server, size_t first) {
+    const dsp48e1_job_t *head = &server->pending[first].job;
+    size_t count = 0;
+
+    for (size_t i = first; i < server->pending_count && count < server->options.max_batch; ++i) {
+        server_pending_t *entry = &server->pending[i];
+        if (entry->done || entry->job.kind != DSP48E1_JOB_GEMM || !gemm_compatible(head, &entry->job)) {
+            continue;
+        }
+        entry->done = 1;
+        if (gemm_resolve(&server->clients[entry->client], &entry->job, &server->descs[count]) != 0) {
+            server_fail(server, entry->client, entry->job.id);
+            continue;
+        }
+        server->members[count++] = i;
+    }
+    if (count == 0) {
+        return;
+    }
+
+    dsp48e1_model_pool_t *pool = server_pool(server, &head->config);
+    dsp48e1_model_t *model = pool ? dsp48e1_model_pool_acquire(pool, head->rows, head->cols, head->depth) : NULL;
+    int status = -1;
+    if (model) {
+        status = dsp48e1_gemm_batch_pooled(model, pool, server->descs, count, head->lhs_stride,
+                                           head->rhs_stride, head->dst_stride, server->options.threads);
+    }
+
+    dsp48e1_job_result_t result;
+    memset(&result, 0, sizeof(result));
+    result.status = status;
+    result.cycles = head->depth + dsp48e1_config_latency(&head->config);
+    result.batch_cycles = model ? model->cycle : 0;
+    result.batch_size = (uint32_t)count;
+    if (model) {
+        dsp48e1_model_pool_release(pool, model);
+    }
+
+    server->stats.batches++;
+    for (size_t m = 0; m < count; ++m) {
+        const server_pending_t *entry = &server->pending[server->members[m]];
+        result.id = entry->job.id;
+        server_reply(server, entry->client, &result);
+    }
+}
+
+/* Product of count factors, or -1 when it does not fit in 64 bits. */
+static int checked_product(const uint64_t *factors, size_t count, uint64_t *product) {
+    uint64_t value = 1;
+    for (size_t i = 0; i < count; ++i) {
+        if (__builtin_mul_overflow(value, factors[i], &value)) {
+            return -1;
+        }
+    }
+    *product = value;
+    return 0;
+}
+
+static int conv_params_valid(const dsp48e1_conv2d_params_t *p) {
+    const size_t fields[] = {p->batch, p->in_channels, p->in_height, p->in_width, p->out_channels,
+                             p->kernel_h, p->kernel_w, p->stride_h, p->stride_w, p->pad_h, p->pad_w,
+                             p->dilation_h, p->dilation_w, p->groups};
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); ++i) {
+        if (fields[i] > SERVER_MAX_DIMENSION) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void server_run_conv(dsp48e1_server_t *server, server_pending_t *entry) {
+    const dsp48e1_job_t *job = &entry->job;
+    const server_client_t *client = &server->clients[entry->client];
+    const dsp48e1_conv2d_params_t *p = &job->conv;
+    entry->done = 1;
+
+    size_t m, n, k, groups;
+    if (job->rows == 0 || job->cols == 0 || job->depth == 0 ||
+        job->rows > SERVER_MAX_DIMENSION || job->cols > SERVER_MAX_DIMENSION ||
+        job->depth > SERVER_MAX_DIMENSION || !conv_params_valid(p) ||
+        dsp48e1_conv2d_gemm_shape(p, &m, &n, &k, &groups) != 0) {
+        server_fail(server, entry->client, job->id);
+        return;
+    }
+
+    /* Capped fields can still multiply past 64 bits, and a wrapped extent would pass the region check. */
+    const uint64_t input_factors[] = {p->batch, p->in_channels, p->in_height, p->in_width};
+    const uint64_t weight_factors[] = {p->out_channels, p->in_channels / p->groups, p->kernel_h, p->kernel_w};
+    const uint64_t output_factors[] = {p->batch, p->out_channels, dsp48e1_conv2d_out_height(p),
+                                       dsp48e1_conv2d_out_width(p)};
+    uint64_t input_count, weight_count, output_count;
+    if (checked_product(input_factors, 4, &input_count) != 0 ||
+        checked_product(weight_factors, 4, &weight_count) != 0 ||
+        checked_product(output_factors, 4, &output_count) != 0) {
+        server_fail(server, entry->client, job->id);
+        return;
+    }
+    const float *input = server_resolve(client, job->region, job->lhs_offset, input_count);
+    const float *weights = server_resolve(client, job->region, job->rhs_offset, weight_count);
+    float *output = server_resolve(client, job->region, job->dst_offset, output_count);
+    const float *bias = NULL;
+    if (job->bias_offset != DSP48E1_SERVER_NO_OFFSET) {
+        bias = server_resolve(client, job->region, job->bias_offset, p->out_channels);
+    }
+    if (!input || !weights || !output || (job->bias_offset != DSP48E1_SERVER_NO_OFFSET && !bias)) {
+        server_fail(server, entry->client, job->id);
+        return;
+    }
+
+    dsp48e1_model_pool_t *pool = server_pool(server, &job->config);
+    dsp48e1_model_t *model = pool ? dsp48e1_model_pool_acquire(pool, job->rows, job->cols, job->depth) : NULL;
+    dsp48e1_conv2d_stats_t stats;
+    memset(&stats, 0, sizeof(stats));
+    int status = -1;
+    if (model) {
+        status = dsp48e1_conv2d_fp32(model, p, input, weights, bias, output, &stats) == 0 ? 0 : -1;
+        dsp48e1_model_pool_release(pool, model);
+    }
+
+    dsp48e1_job_result_t result;
+    memset(&result, 0, sizeof(result));
+    result.id = job->id;
+    result.status = status;
+    result.cycles = stats.cycles;
+    result.batch_cycles = stats.cycles;
+    result.batch_size = 1;
+    server->stats.batches++;
+    server_reply(server, entry->client, &result);
+}
+
+static void server_attach(dsp48e1_server_t *server, size_t client, const dsp48e1_job_t *job, int shm_fd) {
+    server_client_t *c = &server->clients[client];
+    size_t slot = 0;
+    while (slot < DSP48E1_SERVER_MAX_REGIONS && c->regions[slot].base) {
+        slot++;
+    }
+
+    /*
+     * A client that shrank the file after the size check would make the
+     * server fault on its next access, so only sealed memfds are mapped.
+     */
+    struct stat st;
+    void *base = MAP_FAILED;
+    if (shm_fd >= 0 && slot < DSP48E1_SERVER_MAX_REGIONS && job->attach_size > 0 &&
+        job->attach_size <= SIZE_MAX) {
+        const int seals = fcntl(shm_fd, F_GET_SEALS);
+        if (seals >= 0 && (seals & F_SEAL_SHRINK) &&
+            fstat(shm_fd, &st) == 0 && (uint64_t)st.st_size >= job->attach_size) {
+            base = mmap(NULL, (size_t)job->attach_size, PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
+        }
+    }
+    if (shm_fd >= 0) {
+        close(shm_fd);
+    }
+    if (base == MAP_FAILED) {
+        server_fail(server, client, job->id);
+        return;
+    }
+
+    c->regions[slot].base = base;
+    c->regions[slot].size = (size_t)job->attach_size;
+
+    dsp48e1_job_result_t result;
+    memset(&result, 0, sizeof(result));
+    result.id = job->id;
+    result.region = (uint32_t)slot;
+    server_reply(server, client, &result);
+}
+
+static void server_detach(dsp48e1_server_t *server, size_t client, const dsp48e1_job_t *job) {
+    server_client_t *c = &server->clients[client];
+    if (job->region >= DSP48E1_SERVER_MAX_REGIONS || !c->regions[job->region].base) {
+        server_fail(server, client, job->id);
+        return;
+    }
+    munmap(c->regions[job->region].base, c->regions[job->region].size);
+    c->regions[job->region].base = NULL;
+    c->regions[job->region].size = 0;
+
+    dsp48e1_job_result_t result;
+    memset(&result, 0, sizeof(result));
+    result.id = job->id;
+    result.region = job->region;
+    server_reply(server, client, &result);
+}
+
+static void server_close_client(dsp48e1_server_t *server, size_t client) {
+    server_client_t *c = &server->clients[client];
+    for (size_t r = 0; r < DSP48E1_SERVER_MAX_REGIONS; ++r) {
+        if (c->regions[r].base) {
+            munmap(c->regions[r].base, c->regions[r].size);
+        }
+    }
+    if (c->fd >= 0) {
+        close(c->fd);
+    }
+    free(c->outbox);
+    memset(c, 0, sizeof(*c));
+    c->fd = -1;
+}
+
+static int server_enqueue(dsp48e1_server_t *server, size_t client, const dsp48e1_job_t *job) {
+    if (server->pending_count == server->pending_capacity) {
+        const size_t capacity = server->pending_capacity ? server->pending_capacity * 2 : 1024;
+        server_pending_t *pending = (server_pending_t *)realloc(server->pending, sizeof(server_pending_t) * capacity);
+        dsp48e1_gemm_desc_t *descs = (dsp48e1_gemm_desc_t *)realloc(server->descs,
+                                                                    sizeof(dsp48e1_gemm_desc_t) * capacity);
+        if (pending) {
+            server->pending = pending;
+        }
+        if (descs) {
+            server->descs = descs;
+        }
+        size_t *members = (size_t *)realloc(server->members, sizeof(size_t) * capacity);
+        if (members) {
+            server->members = members;
+        }
+        if (!pending || !descs || !members) {
+            return -1;
+        }
+        server->pending_capacity = capacity;
+    }
+    server_pending_t *entry = &server->pending[server->pending_count++];
+    entry->client = client;
+    entry->done = 0;
+    entry->job = *job;
+    return 0;
+}
+
+/* Read every message the client has queued (up to a fairness limit). */
+static void server_read_client(dsp48e1_server_t *server, size_t client) {
+    for (size_t reads = 0; reads < SERVER_MAX_READS_PER_CLIENT; ++reads) {
+        server_client_t *c = &server->clients[client];
+        dsp48e1_job_t job;
+        union {
+            struct cmsghdr header;
+            unsigned char bytes[CMSG_SPACE(sizeof(int))];
+        } control;
+        struct iovec iov = {&job, sizeof(job)};
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.bytes;
+        msg.msg_controllen = sizeof(control.bytes);
+
+        const ssize_t got = recvmsg(c->fd, &msg, MSG_DONTWAIT | MSG_CMSG_CLOEXEC);
+        if (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            return;
+        }
+
+        int shm_fd = -1;
+        for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+                memcpy(&shm_fd, CMSG_DATA(cmsg), sizeof(int));
+            }
+        }
+        if (got != (ssize_t)sizeof(job) || (msg.msg_flags & (MSG_TRUNC | MSG_CTRUNC))) {
+            /* Disconnect or a malformed message: drop the connection. */
+            if (shm_fd >= 0) {
+                close(shm_fd);
+            }
+            c->closing = 1;
+            return;
+        }
+
+        server->stats.jobs++;
+        if (job.kind == DSP48E1_JOB_ATTACH) {
+            server_attach(server, client, &job, shm_fd);
+            continue;
+        }
+        if (shm_fd >= 0) {
+            close(shm_fd);
+        }
+        if (job.kind == DSP48E1_JOB_DETACH) {
+            server_detach(server, client, &job);
+        } else if ((job.kind != DSP48E1_JOB_GEMM && job.kind != DSP48E1_JOB_CONV2D) ||
+                   server_enqueue(server, client, &job) != 0) {
+            server_fail(server, client, job.id);
+        }
+    }
+}
+
+static void server_accept(dsp48e1_server_t *server) {
+    for (;;) {
+        const int fd = accept4(server->listen_fd, NULL, NULL, SOCK_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+
+        size_t slot = 0;
+        while (slot < server->client_count && server->clients[slot].fd >= 0) {
+            slot++;
+        }
+        if (slot == server->client_count) {
+            server_client_t *clients = (server_client_t *)realloc(server->clients,
+                                                                  sizeof(server_client_t) * (slot + 1));
+            struct pollfd *pollfds = (struct pollfd *)realloc(server->pollfds,
+                                                              sizeof(struct pollfd) * (slot + 3));
+            if (clients) {
+                server->clients = clients;
+            }
+            if (pollfds) {
+                server->pollfds = pollfds;
+            }
+            if (!clients || !pollfds) {
+                close(fd);
+                return;
+            }
+            server->client_count++;
+        }
+        memset(&server->clients[slot], 0, sizeof(server_client_t));
+        server->clients[slot].fd = fd;
+        server->stats.connections++;
+    }
+}
+
+static void server_process(dsp48e1_server_t *server) {
+    for (size_t i = 0; i < server->pending_count; ++i) {
+        server_pending_t *entry = &server->pending[i];
+        if (entry->done) {
+            continue;
+        }
+        if (entry->job.kind == DSP48E1_JOB_GEMM) {
+            server_run_gemm(server, i);
+        } else {
+            server_run_conv(server, entry);
+        }
+    }
+    server->pending_count = 0;
+}
+
+dsp48e1_server_t *dsp48e1_server_create(const char *socket_path,
+                                        const dsp48e1_server_options_t *options) {
+    struct sockaddr_un addr;
+    if (!socket_path || strlen(socket_path) >= sizeof(addr.sun_path)) {
+        return NULL;
+    }
+
+    dsp48e1_server_t *server = (dsp48e1_server_t *)calloc(1, sizeof(dsp48e1_server_t));
+    if (!server) {
+        return NULL;
+    }
+    if (options) {
+        server->options = *options;
+    }
+    server->options.threads = server->options.threads ? server->options.threads : 1;
+    server->options.max_batch = server->options.max_batch ? server->options.max_batch : SERVER_DEFAULT_MAX_BATCH;
+    server->options.pool_models = server->options.pool_models ? server->options.pool_models
+                                                              : SERVER_DEFAULT_POOL_MODELS;
+    server->wake[0] = server->wake[1] = -1;
+    strcpy(server->path, socket_path);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, socket_path);
+
+    server->listen_fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    server->pollfds = (struct pollfd *)malloc(sizeof(struct pollfd) * 2);
+    if (server->listen_fd < 0 || !server->pollfds ||
+        pipe2(server->wake, O_CLOEXEC | O_NONBLOCK) != 0) {
+        dsp48e1_server_destroy(server);
+        return NULL;
+    }
+    unlink(socket_path);
+    if (bind(server->listen_fd, (const struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(server->listen_fd, 64) != 0) {
+        server->path[0] = '\0'; /* Not ours to unlink. */
+        dsp48e1_server_destroy(server);
+        return NULL;
+    }
+    return server;
+}
+
+int dsp48e1_server_run(dsp48e1_server_t *server) {
+    if (!server) {
+        return -1;
+    }
+
+    while (!server->stopping) {
+        struct pollfd *fds = server->pollfds;
+        fds[0].fd = server->wake[0];
+        fds[0].events = POLLIN;
+        fds[1].fd = server->listen_fd;
+        fds[1].events = POLLIN;
+        for (size_t c = 0; c < server->client_count; ++c) {
+            fds[c + 2].fd = server->clients[c].fd;
+            fds[c + 2].events = POLLIN | (server->clients[c].outbox_count ? POLLOUT : 0);
+            fds[c + 2].revents = 0;
+        }
+
+        if (poll(fds, server->client_count + 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        if (fds[0].revents & POLLIN) {
+            char drain[64];
+            while (read(server->wake[0], drain, sizeof(drain)) > 0) {
+            }
+        }
+
+        const size_t clients = server->client_count;
+        for (size_t c = 0; c < clients; ++c) {
+            if (fds[c + 2].revents & POLLOUT) {
+                server_flush_client(server, c);
+            }
+            if (fds[c + 2].revents & (POLLIN | POLLHUP | POLLERR)) {
+                server_read_client(server, c);
+            }
+        }
+        server_process(server);
+
+        for (size_t c = 0; c < server->client_count; ++c) {
+            if (server->clients[c].fd >= 0 && server->clients[c].closing) {
+                server_close_client(server, c);
+            }
+        }
+        if (fds[1].revents & POLLIN) {
+            server_accept(server);
+        }
+    }
+    return 0;
+}
+
+void dsp48e1_server_stop(dsp48e1_server_t *server) {
+    if (!server) {
+        return;
+    }
+    server->stopping = 1;
+    const char byte = 1;
+    ssize_t ignored = write(server->wake[1], &byte, 1);
+    (void)ignored;
+}
+
+void dsp48e1_server_get_stats(const dsp48e1_server_t *server, dsp48e1_server_stats_t *stats) {
+    if (server && stats) {
+        *stats = server->stats;
+    }
+}
+
+void dsp48e1_server_destroy(dsp48e1_server_t *server) {
+    if (!server) {
+        return;
+    }
+    for (size_t c = 0; c < server->client_count; ++c) {
+        if (server->clients[c].fd >= 0) {
+            server_close_client(server, c);
+        }
+    }
+    for (size_t p = 0; p < server->pool_count; ++p) {
+        dsp48e1_model_pool_free(&server->pools[p].pool);
+    }
+    if (server->listen_fd >= 0) {
+        close(server->listen_fd);
+        if (server->path[0]) {
+            unlink(server->path);
+        }
+    }
+    if (server->wake[0] >= 0) {
+        close(server->wake[0]);
+        close(server->wake[1]);
+    }
+    free(server->clients);
+    free(server->pollfds);
+    free(server->pools);
+    free(server->pending);
+    free(server->descs);
+    free(server->members);
+    free(server);
+}
+
+int dsp48e1_client_connect(const char *socket_path) {
+    struct sockaddr_un addr;
+    if (!socket_path || strlen(socket_path) >= sizeof(addr.sun_path)) {
+        return -1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, socket_path);
+
+    const int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    if (connect(fd, (const struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int dsp48e1_client_attach(int fd, int shm_fd, uint64_t size, uint32_t *region) {
+    dsp48e1_job_t job;
+    memset(&job, 0, sizeof(job));
+    job.kind = DSP48E1_JOB_ATTACH;
+    job.attach_size = size;
+
+    union {
+        struct cmsghdr header;
+        unsigned char bytes[CMSG_SPACE(sizeof(int))];
+    } control;
+    memset(&control, 0, sizeof(control));
+    struct iovec iov = {&job, sizeof(job)};
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.bytes;
+    msg.msg_controllen = sizeof(control.bytes);
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &shm_fd, sizeof(int));
+
+    dsp48e1_job_result_t result;
+    if (sendmsg(fd, &msg, MSG_NOSIGNAL) != (ssize_t)sizeof(job) ||
+        dsp48e1_client_receive(fd, &result) != 0 || result.status != 0) {
+        return -1;
+    }
+    if (region) {
+        *region = result.region;
+    }
+    return 0;
+}
+
+int dsp48e1_client_submit(int fd, const dsp48e1_job_t *job) {
+    if (!job) {
+        return -1;
+    }
+    return send(fd, job, sizeof(*job), MSG_NOSIGNAL) == (ssize_t)sizeof(*job) ? 0 : -1;
+}
+
+int dsp48e1_client_receive(int fd, dsp48e1_job_result_t *result) {
+    if (!result) {
+        return -1;
+    }
+    for (;;) {
+        const ssize_t got = recv(fd, result, sizeof(*result), 0);
+        if (got == (ssize_t)sizeof(*result)) {
+            return 0;
+        }
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        return -1;
+    }
+}
+
+void dsp48e1_job_gemm(dsp48e1_job_t *job,
+                      const dsp48e1_config_t *config,
+                      uint32_t region,
+                      size_t rows,
+                      size_t cols,
+                      size_t depth,
+                      uint64_t lhs_offset,
+                      uint64_t rhs_offset,
+                      uint64_t bias_offset,
+                      uint64_t dst_offset) {
+    memset(job, 0, sizeof(*job));
+    job->kind = DSP48E1_JOB_GEMM;
+    job->region = region;
+    job->config = *config;
+    job->rows = rows;
+    job->cols = cols;
+    job->depth = depth;
+    job->lhs_offset = lhs_offset;
+    job->rhs_offset = rhs_offset;
+    job->bias_offset = bias_offset;
+    job->dst_offset = dst_offset;
+    job->lhs_stride = depth;
+    job->rhs_stride = cols;
+    job->dst_stride = cols;
+}
+
+static void *server_test_main(void *arg) {
+    return (void *)(intptr_t)dsp48e1_server_run((dsp48e1_server_t *)arg);
+}
+
+int dsp48e1_server_self_test(void) {
+    enum { ROWS = 3, COLS = 4, K = 5, COUNT = 6 };
+    const size_t lhs_bytes = sizeof(float) * ROWS * K;
+    const size_t rhs_bytes = sizeof(float) * K * COLS;
+    const size_t dst_bytes = sizeof(float) * ROWS * COLS;
+    const size_t job_bytes = lhs_bytes + rhs_bytes + dst_bytes;
+    const size_t region_bytes = job_bytes * COUNT;
+
+    dsp48e1_config_t config;
+    dsp48e1_default_fp32_config(&config);
+    config.enable_rounding = 0;
+
+    const char *tmpdir = getenv("TMPDIR");
+    char path[108];
+    snprintf(path, sizeof(path), "%s/dsp48e1_server_%ld.sock", tmpdir ? tmpdir : "/tmp", (long)getpid());
+
+    /* More threads than the pool keeps, so batches draw every pooled model. */
+    dsp48e1_server_options_t options;
+    memset(&options, 0, sizeof(options));
+    options.threads = 3;
+    options.pool_models = 1;
+    dsp48e1_server_t *server = dsp48e1_server_create(path, &options);
+    if (!server) {
+        return -1;
+    }
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, server_test_main, server) != 0) {
+        dsp48e1_server_destroy(server);
+        return -1;
+    }
+
+    int status = 0;
+    const int fd = dsp48e1_client_connect(path);
+    const int shm_fd = memfd_create("dsp48e1_server_test", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    unsigned char *base = MAP_FAILED;
+    if (fd < 0 || shm_fd < 0 || ftruncate(shm_fd, (off_t)region_bytes) != 0) {
+        status = -1;
+    } else {
+        base = mmap(NULL, region_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
+    }
+
+    /* A descriptor that could still shrink under the server is refused. */
+    uint32_t region = 0;
+    if (status != 0 || base == MAP_FAILED ||
+        dsp48e1_client_attach(fd, shm_fd, region_bytes, &region) == 0 ||
+        fcntl(shm_fd, F_ADD_SEALS, F_SEAL_SHRINK) != 0 ||
+        dsp48e1_client_attach(fd, shm_fd, region_bytes, &region) != 0) {
+        status = -1;
+    }
+
+    dsp48e1_model_t model;
+    int have_model = 0;
+    if (status == 0) {
+        have_model = dsp48e1_model_init(&model, &config, ROWS, COLS, K) == 0;
+        status = have_model ? 0 : -1;
+    }
+    for (size_t g = 0; g < COUNT && status == 0; ++g) {
+        float *lhs = (float *)(base + g * job_bytes);
+        float *rhs = (float *)(base + g * job_bytes + lhs_bytes);
+        for (size_t i = 0; i < ROWS * K; ++i) {
+            lhs[i] = (float)((int)((i + g) * 37 % 19) - 9) * 0.375f;
+        }
+        for (size_t i = 0; i < K * COLS; ++i) {
+            rhs[i] = (float)((int)((i + 3 * g) * 11 % 23) - 11) * 0.25f;
+        }
+        dsp48e1_job_t job;
+        dsp48e1_job_gemm(&job, &config, region, ROWS, COLS, K, g * job_bytes, g * job_bytes + lhs_bytes,
+                         DSP48E1_SERVER_NO_OFFSET, g * job_bytes + lhs_bytes + rhs_bytes);
+        job.id = g;
+        status = dsp48e1_client_submit(fd, &job);
+    }
+
+    /* A conv whose input extent is 2^64 elements wraps to 0 unless checked. */
+    if (status == 0) {
+        dsp48e1_job_t job;
+        memset(&job, 0, sizeof(job));
+        job.kind = DSP48E1_JOB_CONV2D;
+        job.region = region;
+        job.id = COUNT;
+        job.config = config;
+        job.rows = ROWS;
+        job.cols = COLS;
+        job.depth = K;
+        job.bias_offset = DSP48E1_SERVER_NO_OFFSET;
+        job.conv.batch = (size_t)1 << 16;
+        job.conv.in_channels = (size_t)1 << 16;
+        job.conv.in_height = (size_t)1 << 16;
+        job.conv.in_width = (size_t)1 << 16;
+        job.conv.out_channels = 1;
+        job.conv.kernel_h = job.conv.kernel_w = 1;
+        job.conv.stride_h = job.conv.stride_w = 1;
+        job.conv.dilation_h = job.conv.dilation_w = 1;
+        job.conv.groups = 1;
+        status = dsp48e1_client_submit(fd, &job);
+    }
+
+    for (size_t r = 0; r <= COUNT && status == 0; ++r) {
+        dsp48e1_job_result_t result;
+        if (dsp48e1_client_receive(fd, &result) != 0 || result.id > COUNT ||
+            result.status != (result.id == COUNT ? -1 : 0)) {
+            status = -1;
+        }
+    }
+
+    for (size_t g = 0; g < COUNT && status == 0; ++g) {
+        const float *lhs = (const float *)(base + g * job_bytes);
+        const float *rhs = (const float *)(base + g * job_bytes + lhs_bytes);
+        float expected[ROWS * COLS];
+        if (dsp48e1_model_gemm_fp32(&model, lhs, K, rhs, COLS, NULL, expected, COLS) != 0 ||
+            memcmp(expected, base + g * job_bytes + lhs_bytes + rhs_bytes, dst_bytes) != 0) {
+            status = -1;
+        }
+    }
+
+    if (have_model) {
+        dsp48e1_model_free(&model);
+    }
+    if (base != MAP_FAILED) {
+        munmap(base, region_bytes);
+    }
+    if (shm_fd >= 0) {
+        close(shm_fd);
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+    dsp48e1_server_stop(server);
+    void *run_status = NULL;
+    pthread_join(thread, &run_status);
+    dsp48e1_server_destroy(server);
+    return status == 0 && run_status == NULL ? 0 : -1;
+}
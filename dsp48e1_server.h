@@ -0,0 +1,156 @@
+#ifndef DSP48E1_SERVER_H
+#define DSP48E1_SERVER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dsp48e1_conv.h"
+#include "dsp48e1_model.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file dsp48e1_server.h
+ *
+ * Local simulation job server.  A long-running process keeps warm model
+ * pools and accepts GEMM and conv2d jobs over a Unix domain socket
+ * (SOCK_SEQPACKET, one message per job or result).  Operands never travel
+ * over the socket: a client passes shared-memory file descriptors once
+ * (SCM_RIGHTS), the server maps them, and jobs name a region and byte
+ * offsets into it.  Results are written into the region in place.
+ *
+ * Compatible GEMM jobs (same configuration, shape and strides) that arrive
+ * together are coalesced into one back-to-back batch on a pooled model.
+ * Messages are native structs: client and server must be built from the
+ * same headers on the same machine.
+ */
+
+#define DSP48E1_SERVER_MAX_REGIONS 64
+#define DSP48E1_SERVER_NO_OFFSET UINT64_MAX /* Optional operand not given. */
+
+typedef enum {
+    DSP48E1_JOB_ATTACH = 1, /* Map the passed fd as region; size in attach_size. */
+    DSP48E1_JOB_DETACH,     /* Unmap region. */
+    DSP48E1_JOB_GEMM,
+    DSP48E1_JOB_CONV2D
+} dsp48e1_job_kind_t;
+
+typedef struct {
+    uint32_t kind;         /* dsp48e1_job_kind_t */
+    uint32_t region;       /* Region holding every operand of the job. */
+    uint64_t id;           /* Echoed in the result. */
+    uint64_t attach_size;  /* DSP48E1_JOB_ATTACH: bytes to map. */
+    dsp48e1_config_t config;
+    /* GEMM shape, or the tile shape a conv2d job is run on. */
+    uint64_t rows;
+    uint64_t cols;
+    uint64_t depth;
+    /*
+     * Byte offsets of FP32 operands in the region.  GEMM: lhs, rhs, bias,
+     * dst.  CONV2D: input, weights, bias, output.  Strides are in elements
+     * and only used by GEMM.  bias may be DSP48E1_SERVER_NO_OFFSET.
+     */
+    uint64_t lhs_offset;
+    uint64_t rhs_offset;
+    uint64_t bias_offset;
+    uint64_t dst_offset;
+    uint64_t lhs_stride;
+    uint64_t rhs_stride;
+    uint64_t dst_stride;
+    dsp48e1_conv2d_params_t conv;
+} dsp48e1_job_t;
+
+typedef struct {
+    uint64_t id;
+    int32_t status;        /* 0 on success, -1 on a rejected or failed job. */
+    uint32_t region;       /* DSP48E1_JOB_ATTACH: the region to use. */
+    uint64_t cycles;       /* The job's own modeled cycles. */
+    uint64_t batch_cycles; /* Cycles of the batch the job ran in. */
+    uint32_t batch_size;   /* Jobs coalesced into that batch. */
+    uint32_t reserved;
+} dsp48e1_job_result_t;
+
+typedef struct {
+    size_t threads;     /* Worker threads per batch; 0 = 1. */
+    size_t max_batch;   /* Largest coalesced batch; 0 = 256. */
+    size_t pool_models; /* Warm models kept per configuration; 0 = 4. */
+} dsp48e1_server_options_t;
+
+typedef struct {
+    uint64_t jobs;
+    uint64_t failed;
+    uint64_t batches;
+    uint64_t connections;
+} dsp48e1_server_stats_t;
+
+typedef struct dsp48e1_server dsp48e1_server_t;
+
+/**
+ * Bind and listen on socket_path (an existing socket file is replaced).
+ * options may be NULL.  Returns NULL on failure.
+ */
+dsp48e1_server_t *dsp48e1_server_create(const char *socket_path,
+                                        const dsp48e1_server_options_t *options);
+
+/**
+ * Serve clients until dsp48e1_server_stop() is called.
+ * Returns 0 after a stop, -1 on a fatal socket error.
+ */
+int dsp48e1_server_run(dsp48e1_server_t *server);
+
+/** Ask run() to return.  Async-signal-safe. */
+void dsp48e1_server_stop(dsp48e1_server_t *server);
+
+void dsp48e1_server_get_stats(const dsp48e1_server_t *server, dsp48e1_server_stats_t *stats);
+
+/** Close every connection, unmap regions, remove the socket file and free. */
+void dsp48e1_server_destroy(dsp48e1_server_t *server);
+
+/** Connect to a server.  Returns the socket fd or -1. */
+int dsp48e1_client_connect(const char *socket_path);
+
+/**
+ * Share size bytes of shm_fd with the server.  shm_fd must be a memfd
+ * (memfd_create() with MFD_ALLOW_SEALING) carrying F_SEAL_SHRINK, so the
+ * mapping cannot be truncated under the server; other descriptors are
+ * refused.  The caller may close shm_fd afterwards.  Waits for the reply,
+ * so call it before submitting jobs.  Returns 0 and the region id.
+ */
+int dsp48e1_client_attach(int fd, int shm_fd, uint64_t size, uint32_t *region);
+
+/**
+ * Queue a job without waiting.  Several jobs may be submitted before their
+ * results are received; that is what lets the server batch them.
+ * Returns 0 on success.
+ */
+int dsp48e1_client_submit(int fd, const dsp48e1_job_t *job);
+
+/** Wait for the next result.  Returns 0 on success, -1 on disconnect. */
+int dsp48e1_client_receive(int fd, dsp48e1_job_result_t *result);
+
+/** Fill job with a GEMM of the given shape and contiguous strides. */
+void dsp48e1_job_gemm(dsp48e1_job_t *job,
+                      const dsp48e1_config_t *config,
+                      uint32_t region,
+                      size_t rows,
+                      size_t cols,
+                      size_t depth,
+                      uint64_t lhs_offset,
+                      uint64_t rhs_offset,
+                      uint64_t bias_offset,
+                      uint64_t dst_offset);
+
+/**
+ * Run a server on a socket in $TMPDIR (default /tmp) on a thread, and check
+ * sealed attach, a multi-threaded GEMM batch and a rejected conv2d job
+ * through a client connection.  Returns 0 on success.
+ */
+int dsp48e1_server_self_test(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DSP48E1_SERVER_H */
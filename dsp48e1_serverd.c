@@ -0,0 +1,74 @@
+#define _GNU_SOURCE /* sigaction */
+
+// Command-line front end for the simulation job server.
+//
+//   dsp48e1_serverd [--threads N] [--max-batch N] [--pool-models N] SOCKET
+//       Listen on the Unix socket SOCKET until SIGINT/SIGTERM, then print
+//       job statistics.  Exits 0 on a clean stop, 2 on errors.
+
+#include "dsp48e1_server.h"
+
+#include <inttypes.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static dsp48e1_server_t *running_server;
+
+static void handle_signal(int signo) {
+    (void)signo;
+    dsp48e1_server_stop(running_server);
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr, "usage: %s [--threads N] [--max-batch N] [--pool-models N] SOCKET\n", argv0);
+}
+
+int main(int argc, char **argv) {
+    dsp48e1_server_options_t options;
+    memset(&options, 0, sizeof(options));
+    const char *path = NULL;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            options.threads = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--max-batch") == 0 && i + 1 < argc) {
+            options.max_batch = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--pool-models") == 0 && i + 1 < argc) {
+            options.pool_models = strtoull(argv[++i], NULL, 0);
+        } else if (argv[i][0] != '-' && !path) {
+            path = argv[i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (!path) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    running_server = dsp48e1_server_create(path, &options);
+    if (!running_server) {
+        fprintf(stderr, "cannot listen on %s\n", path);
+        return 2;
+    }
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = handle_signal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    const int status = dsp48e1_server_run(running_server);
+
+    dsp48e1_server_stats_t stats;
+    dsp48e1_server_get_stats(running_server, &stats);
+    printf("%" PRIu64 " jobs (%" PRIu64 " failed) in %" PRIu64 " batches, %" PRIu64 " connections\n",
+           stats.jobs, stats.failed, stats.batches, stats.connections);
+
+    dsp48e1_server_destroy(running_server);
+    return status == 0 ? 0 : 2;
+}
@@ -0,0 +1,178 @@
+/*
+ * C ABI exports for common compile-time configurations of dsp48e1.hpp.
+ */
+
+#include "dsp48e1.hpp"
+
+#include <cstring>
+
+namespace {
+
+template <int OPMODE, int ALUMODE, int INMODE, int CARRYINSEL>
+int64_t slice_specialized(int32_t a1, int32_t a2, int32_t b1, int32_t b2, int64_t c, int32_t d,
+                          int8_t, int8_t, int8_t, int8_t, bool carryin, bool carrycascin) {
+    return dsp48e1_cxx::slice_eval<OPMODE, ALUMODE, INMODE, CARRYINSEL, DSP48E1_USE_DPORT != 0>::eval(
+        a1, a2, b1, b2, c, d, carryin, carrycascin);
+}
+
+struct slice_entry {
+    int8_t opmode;
+    int8_t alumode;
+    int8_t inmode;
+    int8_t carryinsel;
+    dsp48e1_fn_t fn;
+};
+
+#define SLICE_ENTRY(OPMODE, ALUMODE, INMODE) \
+    {OPMODE, ALUMODE, INMODE, 0, &slice_specialized<OPMODE, ALUMODE, INMODE, 0>}
+
+// M, C + M, C - M and A:B + C, each with A2 only, D + A2 and D - A2
+const slice_entry slice_table[] = {
+    SLICE_ENTRY(0b0000101, 0b0000, 0b00000),
+    SLICE_ENTRY(0b0000101, 0b0000, 0b00100),
+    SLICE_ENTRY(0b0000101, 0b0000, 0b01100),
+    SLICE_ENTRY(0b0110101, 0b0000, 0b00000),
+    SLICE_ENTRY(0b0110101, 0b0000, 0b00100),
+    SLICE_ENTRY(0b0110101, 0b0000, 0b01100),
+    SLICE_ENTRY(0b0110101, 0b0011, 0b00000),
+    SLICE_ENTRY(0b0110101, 0b0011, 0b00100),
+    SLICE_ENTRY(0b0110101, 0b0011, 0b01100),
+    SLICE_ENTRY(0b0001111, 0b0000, 0b00000),
+};
+
+#undef SLICE_ENTRY
+
+template <unsigned MUL, unsigned ADD, unsigned ACC, unsigned RND, unsigned SAT, bool ROUNDING, bool SATURATION>
+int gemm_specialized(size_t rows, size_t cols, size_t depth,
+                     const float *lhs, size_t lhs_stride,
+                     const float *rhs, size_t rhs_stride,
+                     const float *bias,
+                     float *dst, size_t dst_stride) {
+    return dsp48e1_cxx::gemm_tile<dsp48e1_cxx::pe<MUL, ADD, ACC, RND, SAT, ROUNDING, SATURATION>>(
+        rows, cols, depth, lhs, lhs_stride, rhs, rhs_stride, bias, dst, dst_stride);
+}
+
+struct gemm_entry {
+    uint8_t multiplier_latency;
+    uint8_t adder_latency;
+    uint8_t accumulator_latency;
+    uint8_t rounding_latency;
+    uint8_t saturation_latency;
+    bool enable_rounding;
+    bool enable_saturation;
+    dsp48e1_model_gemm_fn_t fn;
+};
+
+#define GEMM_ENTRY(MUL, ADD, ACC, RND, SAT, ROUNDING, SATURATION) \
+    {MUL, ADD, ACC, RND, SAT, ROUNDING, SATURATION, &gemm_specialized<MUL, ADD, ACC, RND, SAT, ROUNDING, SATURATION>}
+
+// The default FP32 pipeline with and without rounding, plus a saturating variant
+const gemm_entry gemm_table[] = {
+    GEMM_ENTRY(2, 1, 1, 1, 0, true, false),
+    GEMM_ENTRY(2, 1, 1, 1, 0, false, false),
+    GEMM_ENTRY(2, 1, 1, 1, 1, true, true),
+    GEMM_ENTRY(2, 1, 1, 0, 0, false, false),
+};
+
+#undef GEMM_ENTRY
+
+} // namespace
+
+extern "C" dsp48e1_fn_t dsp48e1_specialize(int8_t opmode, int8_t alumode, int8_t inmode, int8_t carryinsel) {
+    for (const slice_entry &entry : slice_table) {
+        if (entry.opmode == (opmode & 0x7F) &&
+            entry.alumode == (alumode & 0xF) &&
+            entry.inmode == (inmode & 0x1F) &&
+            entry.carryinsel == (carryinsel & 0x7)) {
+            return entry.fn;
+        }
+    }
+    return &dsp48e1;
+}
+
+extern "C" dsp48e1_model_gemm_fn_t dsp48e1_model_specialize(const dsp48e1_config_t *config) {
+    if (!config || config->format.kind != DSP48E1_FORMAT_FP32 ||
+        config->accum_mode != DSP48E1_ACCUM_FP32) {
+        return nullptr;
+    }
+    for (const gemm_entry &entry : gemm_table) {
+        if (entry.multiplier_latency == config->multiplier_latency &&
+            entry.adder_latency == config->adder_latency &&
+            entry.accumulator_latency == config->accumulator_latency &&
+            entry.rounding_latency == config->rounding_latency &&
+            entry.saturation_latency == config->saturation_latency &&
+            entry.enable_rounding == (config->enable_rounding != 0) &&
+            entry.enable_saturation == (config->enable_saturation != 0)) {
+            return entry.fn;
+        }
+    }
+    return nullptr;
+}
+
+extern "C" int dsp48e1_shim_self_test(void) {
+    uint64_t state = 0x2545F4914F6CDD1DULL;
+    auto next = [&state]() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    };
+
+    for (const slice_entry &entry : slice_table) {
+        for (int i = 0; i < 10000; ++i) {
+            const int32_t a = (int32_t)next();
+            const int32_t b = (int32_t)next();
+            const int64_t c = (int64_t)next();
+            const int32_t d = (int32_t)next();
+            const bool carryin = next() & 1;
+            if (entry.fn(a, a, b, b, c, d, 0, 0, 0, 0, carryin, false) !=
+                dsp48e1(a, a, b, b, c, d, entry.opmode, entry.alumode, entry.inmode, entry.carryinsel, carryin, false)) {
+                return -1;
+            }
+        }
+    }
+
+    enum { ROWS = 3, COLS = 5, DEPTH = 7 };
+    float lhs[ROWS * DEPTH];
+    float rhs[DEPTH * COLS];
+    float bias[COLS];
+    for (float &v : lhs) {
+        v = (float)(int32_t)(next() % 2001) / 256.0f - 3.90625f;
+    }
+    for (float &v : rhs) {
+        v = (float)(int32_t)(next() % 2001) / 256.0f - 3.90625f;
+    }
+    for (float &v : bias) {
+        v = (float)(int32_t)(next() % 2001) / 256.0f - 3.90625f;
+    }
+
+    for (const gemm_entry &entry : gemm_table) {
+        dsp48e1_config_t config;
+        dsp48e1_default_fp32_config(&config);
+        config.multiplier_latency = entry.multiplier_latency;
+        config.adder_latency = entry.adder_latency;
+        config.accumulator_latency = entry.accumulator_latency;
+        config.rounding_latency = entry.rounding_latency;
+        config.saturation_latency = entry.saturation_latency;
+        config.enable_rounding = entry.enable_rounding;
+        config.enable_saturation = entry.enable_saturation;
+        if (dsp48e1_model_specialize(&config) != entry.fn) {
+            return -1;
+        }
+
+        dsp48e1_model_t model;
+        float expected[ROWS * COLS];
+        float actual[ROWS * COLS];
+        if (dsp48e1_model_init(&model, &config, ROWS, COLS, DEPTH) != 0) {
+            return -1;
+        }
+        const int status = dsp48e1_model_gemm_fp32(&model, lhs, DEPTH, rhs, COLS, bias, expected, COLS);
+        dsp48e1_model_free(&model);
+        if (status != 0 ||
+            entry.fn(ROWS, COLS, DEPTH, lhs, DEPTH, rhs, COLS, bias, actual, COLS) != 0 ||
+            std::memcmp(expected, actual, sizeof(expected)) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
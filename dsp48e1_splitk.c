@@ -0,0 +1,323 @@
+#include "dsp48e1_splitk.h"
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    dsp48e1_model_t *model;
+    dsp48e1_model_t own_model;
+    int owns_model;
+    const float *lhs;
+    size_t lhs_stride;
+    const float *rhs;
+    size_t rhs_stride;
+    const float *bias;
+    const size_t *offsets;  /* splits + 1 partition boundaries in K. */
+    float *partials;        /* splits tiles of rows * cols. */
+    size_t splits;
+    size_t first;           /* This worker runs partitions first, first + step, ... */
+    size_t step;
+    uint64_t max_cycles;
+    int status;
+} splitk_worker_t;
+
+static void *splitk_worker_main(void *arg) {
+    splitk_worker_t *worker = (splitk_worker_t *)arg;
+    dsp48e1_model_t *model = worker->model;
+    const size_t elements = model->rows * model->cols;
+
+    worker->status = 0;
+    for (size_t p = worker->first; p < worker->splits; p += worker->step) {
+        const size_t begin = worker->offsets[p];
+        const size_t count = worker->offsets[p + 1] - begin;
+        if (dsp48e1_model_stream_begin(model, p == 0 ? worker->bias : NULL) != 0 ||
+            dsp48e1_model_stream_push(model, worker->lhs + begin, worker->lhs_stride,
+                                      worker->rhs + begin * worker->rhs_stride,
+                                      worker->rhs_stride, count) != 0 ||
+            dsp48e1_model_stream_end(model, worker->partials + p * elements, model->cols) != 0) {
+            worker->status = -1;
+            return NULL;
+        }
+        if (model->cycle > worker->max_cycles) {
+            worker->max_cycles = model->cycle;
+        }
+    }
+    return NULL;
+}
+
+void dsp48e1_splitk_reduce_cost(const dsp48e1_config_t *config,
+                                size_t rows,
+                                size_t cols,
+                                size_t splits,
+                                dsp48e1_reduce_kind_t reduce,
+                                dsp48e1_splitk_stats_t *stats) {
+    const uint64_t stage_cycles = (uint64_t)config->adder_latency + 1U;
+    size_t stages = 0;
+
+    splits = splits == 0 ? 1 : splits;
+    if (reduce == DSP48E1_REDUCE_TREE) {
+        while (((size_t)1 << stages) < splits) {
+            stages++;
+        }
+        stats->reduce_adders = (splits - 1) * cols;
+    } else {
+        stages = splits - 1;
+        stats->reduce_adders = 0;
+    }
+
+    stats->splits = splits;
+    stats->reduce_stages = stages;
+    /* First row leaves after every stage, the rest follow one per cycle. */
+    stats->reduce_cycles = stages > 0 ? stages * stage_cycles + (rows > 0 ? rows - 1 : 0) : 0;
+}
+
+/* Fixed combination order, independent of which thread produced what. */
+static void splitk_reduce(float *partials, size_t elements, size_t splits, dsp48e1_reduce_kind_t reduce) {
+    if (reduce == DSP48E1_REDUCE_TREE) {
+        for (size_t stride = 1; stride < splits; stride *= 2) {
+            for (size_t i = 0; i + stride < splits; i += 2 * stride) {
+                float *lhs = partials + i * elements;
+                const float *rhs = partials + (i + stride) * elements;
+                for (size_t e = 0; e < elements; ++e) {
+                    lhs[e] += rhs[e];
+                }
+            }
+        }
+        return;
+    }
+
+    for (size_t p = 1; p < splits; ++p) {
+        const float *rhs = partials + p * elements;
+        for (size_t e = 0; e < elements; ++e) {
+            partials[e] += rhs[e];
+        }
+    }
+}
+
+int dsp48e1_gemm_splitk_fp32(dsp48e1_model_t *model,
+                             const float *lhs,
+                             size_t lhs_stride,
+                             const float *rhs,
+                             size_t rhs_stride,
+                             size_t k,
+                             const float *bias,
+                             float *dst,
+                             size_t dst_stride,
+                             const dsp48e1_splitk_options_t *options,
+                             dsp48e1_splitk_stats_t *stats) {
+    /* With k == 0 no partition would carry the bias through the pipeline. */
+    if (!model || !model->accumulators || !lhs || !rhs || !dst || k == 0 ||
+        lhs_stride < k || rhs_stride < model->cols || dst_stride < model->cols) {
+        return -1;
+    }
+
+    size_t splits = options && options->splits ? options->splits : 1;
+    if (splits > k) {
+        splits = k;
+    }
+    const dsp48e1_reduce_kind_t reduce = options ? options->reduce : DSP48E1_REDUCE_CASCADE;
+    size_t workers = options && options->threads ? options->threads : 1;
+    if (workers > splits) {
+        workers = splits;
+    }
+
+    const size_t rows = model->rows;
+    const size_t cols = model->cols;
+    const size_t elements = rows * cols;
+    size_t *offsets = (size_t *)malloc(sizeof(size_t) * (splits + 1));
+    float *partials = (float *)malloc(sizeof(float) * elements * splits);
+    splitk_worker_t *pool = (splitk_worker_t *)calloc(workers, sizeof(splitk_worker_t));
+    pthread_t *handles = (pthread_t *)calloc(workers, sizeof(pthread_t));
+    uint8_t *started = (uint8_t *)calloc(workers, sizeof(uint8_t));
+    if (!offsets || !partials || !pool || !handles || !started) {
+        free(offsets);
+        free(partials);
+        free(pool);
+        free(handles);
+        free(started);
+        return -1;
+    }
+
+    offsets[0] = 0;
+    for (size_t p = 0; p < splits; ++p) {
+        offsets[p + 1] = offsets[p] + k / splits + (p < k % splits ? 1U : 0U);
+    }
+
+    int status = 0;
+    for (size_t w = 0; w < workers; ++w) {
+        splitk_worker_t *worker = &pool[w];
+        worker->lhs = lhs;
+        worker->lhs_stride = lhs_stride;
+        worker->rhs = rhs;
+        worker->rhs_stride = rhs_stride;
+        worker->bias = bias;
+        worker->offsets = offsets;
+        worker->partials = partials;
+        worker->splits = splits;
+        worker->first = w;
+        worker->step = workers;
+        worker->status = -1;
+
+        if (w == 0) {
+            worker->model = model;
+            continue;
+        }
+        if (dsp48e1_model_init(&worker->own_model, &model->config, rows, cols, model->depth) != 0) {
+            status = -1;
+            break;
+        }
+        worker->owns_model = 1;
+        worker->model = &worker->own_model;
+        if (pthread_create(&handles[w], NULL, splitk_worker_main, worker) != 0) {
+            status = -1;
+            break;
+        }
+        started[w] = 1;
+    }
+
+    if (status == 0) {
+        splitk_worker_main(&pool[0]);
+    }
+
+    uint64_t partition_cycles = 0;
+    for (size_t w = 1; w < workers; ++w) {
+        if (started[w]) {
+            pthread_join(handles[w], NULL);
+        }
+    }
+    for (size_t w = 0; w < workers; ++w) {
+        if (status == 0 && pool[w].status != 0) {
+            status = -1;
+        }
+        if (pool[w].max_cycles > partition_cycles) {
+            partition_cycles = pool[w].max_cycles;
+        }
+        if (pool[w].owns_model) {
+            dsp48e1_model_free(&pool[w].own_model);
+        }
+    }
+
+    if (status == 0) {
+        splitk_reduce(partials, elements, splits, reduce);
+        for (size_t row = 0; row < rows; ++row) {
+            memcpy(dst + row * dst_stride, partials + row * cols, sizeof(float) * cols);
+        }
+
+        dsp48e1_splitk_stats_t cost;
+        dsp48e1_splitk_reduce_cost(&model->config, rows, cols, splits, reduce, &cost);
+        cost.partition_cycles = partition_cycles;
+        cost.cycles = partition_cycles + cost.reduce_cycles;
+        model->cycle = cost.cycles;
+        if (stats) {
+            *stats = cost;
+        }
+    }
+
+    free(offsets);
+    free(partials);
+    free(pool);
+    free(handles);
+    free(started);
+    return status;
+}
+
+int dsp48e1_splitk_self_test(void) {
+    enum { ROWS = 3, COLS = 5, K = 37 };
+    dsp48e1_config_t config;
+    dsp48e1_default_fp32_config(&config);
+    config.enable_rounding = 0;
+    config.adder_latency = 2;
+
+    float lhs[ROWS * K];
+    float rhs[K * COLS];
+    float bias[COLS];
+    for (size_t i = 0; i < ROWS * K; ++i) {
+        lhs[i] = (float)((int)(i * 37 % 19) - 9) * 0.1f;
+    }
+    for (size_t i = 0; i < K * COLS; ++i) {
+        rhs[i] = (float)((int)(i * 11 % 23) - 11) * 0.3f;
+    }
+    for (size_t i = 0; i < COLS; ++i) {
+        bias[i] = (float)i * 0.7f - 1.0f;
+    }
+
+    dsp48e1_model_t model;
+    if (dsp48e1_model_init(&model, &config, ROWS, COLS, K) != 0) {
+        return -1;
+    }
+    float expected[ROWS * COLS];
+    float reference[ROWS * COLS];
+    float actual[ROWS * COLS];
+    int status = dsp48e1_model_gemm_fp32(&model, lhs, K, rhs, COLS, bias, reference, COLS);
+
+    /* One split is the plain GEMM; more splits give one result for every thread count. */
+    const size_t split_counts[] = {1, 2, 3, 5, 8, K + 4};
+    for (size_t s = 0; s < sizeof(split_counts) / sizeof(split_counts[0]) && status == 0; ++s) {
+        for (int reduce = DSP48E1_REDUCE_CASCADE; reduce <= DSP48E1_REDUCE_TREE && status == 0; ++reduce) {
+            for (size_t threads = 1; threads <= 4 && status == 0; ++threads) {
+                const dsp48e1_splitk_options_t options = {split_counts[s], (dsp48e1_reduce_kind_t)reduce, threads};
+                dsp48e1_splitk_stats_t stats;
+                float *out = threads == 1 ? expected : actual;
+                if (dsp48e1_gemm_splitk_fp32(&model, lhs, K, rhs, COLS, K, bias, out, COLS, &options, &stats) != 0 ||
+                    model.cycle != stats.cycles || stats.cycles != stats.partition_cycles + stats.reduce_cycles ||
+                    (threads > 1 && memcmp(actual, expected, sizeof(actual)) != 0) ||
+                    (split_counts[s] == 1 && memcmp(out, reference, sizeof(reference)) != 0)) {
+                    status = -1;
+                }
+            }
+        }
+    }
+
+    /*
+     * Hand-computed costs with adder_latency 2 (3 cycles per stage) on the
+     * 3 x 5 tile: the second and third rows follow the first by a cycle each.
+     * Five splits need ceil(log2 5) = 3 tree stages and 4 * 5 adders, or 4
+     * cascade stages; the slowest of five partitions of K = 37 takes 8 beats
+     * plus the 6-stage pipeline.
+     */
+    static const struct {
+        size_t splits;
+        dsp48e1_reduce_kind_t reduce;
+        size_t stages;
+        size_t adders;
+        uint64_t reduce_cycles;
+    } costs[] = {
+        {0, DSP48E1_REDUCE_TREE, 0, 0, 0},
+        {1, DSP48E1_REDUCE_CASCADE, 0, 0, 0},
+        {2, DSP48E1_REDUCE_TREE, 1, 5, 5},
+        {2, DSP48E1_REDUCE_CASCADE, 1, 0, 5},
+        {5, DSP48E1_REDUCE_TREE, 3, 20, 11},
+        {5, DSP48E1_REDUCE_CASCADE, 4, 0, 14},
+        {8, DSP48E1_REDUCE_TREE, 3, 35, 11},
+        {8, DSP48E1_REDUCE_CASCADE, 7, 0, 23},
+    };
+    for (size_t c = 0; c < sizeof(costs) / sizeof(costs[0]) && status == 0; ++c) {
+        dsp48e1_splitk_stats_t cost;
+        dsp48e1_splitk_reduce_cost(&config, ROWS, COLS, costs[c].splits, costs[c].reduce, &cost);
+        if (cost.splits != (costs[c].splits ? costs[c].splits : 1) || cost.reduce_stages != costs[c].stages ||
+            cost.reduce_adders != costs[c].adders || cost.reduce_cycles != costs[c].reduce_cycles) {
+            status = -1;
+        }
+    }
+    for (int reduce = DSP48E1_REDUCE_CASCADE; reduce <= DSP48E1_REDUCE_TREE && status == 0; ++reduce) {
+        const dsp48e1_splitk_options_t five = {5, (dsp48e1_reduce_kind_t)reduce, 1};
+        dsp48e1_splitk_stats_t stats;
+        if (dsp48e1_gemm_splitk_fp32(&model, lhs, K, rhs, COLS, K, bias, actual, COLS, &five, &stats) != 0 ||
+            stats.partition_cycles != 8 + 6 ||
+            stats.cycles != 8 + 6 + (reduce == DSP48E1_REDUCE_TREE ? 11U : 14U)) {
+            status = -1;
+        }
+    }
+
+    /* An empty K is rejected rather than dropping the bias. */
+    const dsp48e1_splitk_options_t options = {2, DSP48E1_REDUCE_TREE, 2};
+    if (status == 0 && dsp48e1_gemm_splitk_fp32(&model, lhs, K, rhs, COLS, 0, bias, actual, COLS, &options, NULL) == 0) {
+        status = -1;
+    }
+
+    dsp48e1_model_free(&model);
+    return status;
+}
@@ -0,0 +1,101 @@
+#ifndef DSP48E1_SPLITK_H
+#define DSP48E1_SPLITK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dsp48e1_model.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file dsp48e1_splitk.h
+ *
+ * Split-K GEMM: the K dimension of one rows x cols tile is divided into
+ * partitions that run on separate tensor units (simulated by worker
+ * threads), and the partial sums are reduced in a fixed order.  The order
+ * depends only on the number of partitions, so dst is bitwise identical for
+ * any thread count.
+ */
+
+/* How the partial sums of the partitions are combined. */
+typedef enum {
+    /*
+     * Units are chained through their post-adders (PCOUT -> PCIN):
+     * ((p0 + p1) + p2) + ...  No extra slices, one adder stage per unit.
+     */
+    DSP48E1_REDUCE_CASCADE = 0,
+    /*
+     * A separate pairwise adder tree: level l adds partials i and
+     * i + 2^l.  ceil(log2(splits)) adder stages, splits - 1 adders per
+     * output column.
+     */
+    DSP48E1_REDUCE_TREE
+} dsp48e1_reduce_kind_t;
+
+typedef struct {
+    size_t splits;                 /* K partitions (tensor units); 0 = 1. */
+    dsp48e1_reduce_kind_t reduce;
+    size_t threads;                /* Worker threads; 0 or 1 = caller only. */
+} dsp48e1_splitk_options_t;
+
+typedef struct {
+    size_t splits;
+    uint64_t partition_cycles;  /* Slowest partition: its K + latency. */
+    uint64_t reduce_cycles;     /* Reduction, rows streamed cols wide. */
+    uint64_t cycles;            /* partition_cycles + reduce_cycles. */
+    size_t reduce_stages;       /* Adder stages a partial sum passes through. */
+    size_t reduce_adders;       /* Extra FP adders; 0 for the cascade. */
+} dsp48e1_splitk_stats_t;
+
+/**
+ * Reduction stage count and cycles for splits partial tiles of rows x cols
+ * on config, without running anything.  Each adder stage costs the
+ * configured adder latency plus one register; partial rows are streamed
+ * through the adders one row (cols lanes) per cycle.
+ */
+void dsp48e1_splitk_reduce_cost(const dsp48e1_config_t *config,
+                                size_t rows,
+                                size_t cols,
+                                size_t splits,
+                                dsp48e1_reduce_kind_t reduce,
+                                dsp48e1_splitk_stats_t *stats);
+
+/**
+ * dst = lhs (rows x k) * rhs (k x cols) + bias on the model's rows x cols
+ * shape, with k split into options->splits contiguous partitions of
+ * k / splits (the first k % splits get one more).  The model simulates the
+ * first partition; other workers use private models with the same
+ * configuration.  Bias (may be NULL) is preloaded into the first partition.
+ *
+ * On success model->cycle holds the modeled split-K cycle count and stats
+ * (may be NULL) its breakdown.  Returns 0 on success or -1 on
+ * parameter/allocation/thread errors, including k == 0.
+ */
+int dsp48e1_gemm_splitk_fp32(dsp48e1_model_t *model,
+                             const float *lhs,
+                             size_t lhs_stride,
+                             const float *rhs,
+                             size_t rhs_stride,
+                             size_t k,
+                             const float *bias,
+                             float *dst,
+                             size_t dst_stride,
+                             const dsp48e1_splitk_options_t *options,
+                             dsp48e1_splitk_stats_t *stats);
+
+/**
+ * Check that every split count, reduction and thread count gives one
+ * bitwise result, that a single split equals the plain GEMM, that an empty
+ * K is rejected, and that the reduction costs and total cycles match
+ * hand-computed values for the tree and the cascade.  Returns 0 on success.
+ */
+int dsp48e1_splitk_self_test(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DSP48E1_SPLITK_H */
@@ -0,0 +1,278 @@
+#include "dsp48e1_stream.h"
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum { STREAM_BUFFERS = 2 };
+
+typedef struct {
+    float *lhs;
+    float *rhs;
+    size_t k_count;
+    int full;
+} stream_buffer_t;
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    stream_buffer_t buffers[STREAM_BUFFERS];
+    size_t rows;
+    size_t cols;
+    size_t k_total;
+    size_t k_chunk;
+    dsp48e1_stream_loader_fn loader;
+    void *user;
+    int loader_status;
+    int abort;
+} stream_feed_t;
+
+static void *stream_loader_main(void *arg) {
+    stream_feed_t *feed = (stream_feed_t *)arg;
+    size_t slot = 0;
+
+    for (size_t k = 0; k < feed->k_total; k += feed->k_chunk) {
+        const size_t k_count = (feed->k_total - k) < feed->k_chunk ? (feed->k_total - k) : feed->k_chunk;
+        stream_buffer_t *buffer = &feed->buffers[slot];
+
+        pthread_mutex_lock(&feed->lock);
+        while (buffer->full && !feed->abort) {
+            pthread_cond_wait(&feed->changed, &feed->lock);
+        }
+        const int abort = feed->abort;
+        pthread_mutex_unlock(&feed->lock);
+        if (abort) {
+            break;
+        }
+
+        const int status = feed->loader(feed->user, k, k_count,
+                                        buffer->lhs, feed->k_chunk,
+                                        buffer->rhs, feed->cols);
+
+        pthread_mutex_lock(&feed->lock);
+        if (status != 0) {
+            feed->loader_status = status;
+            feed->abort = 1;
+        } else {
+            buffer->k_count = k_count;
+            buffer->full = 1;
+        }
+        pthread_cond_broadcast(&feed->changed);
+        pthread_mutex_unlock(&feed->lock);
+        if (status != 0) {
+            break;
+        }
+
+        slot = (slot + 1) % STREAM_BUFFERS;
+    }
+
+    return NULL;
+}
+
+int dsp48e1_stream_gemm(dsp48e1_model_t *model,
+                        size_t k_total,
+                        size_t k_chunk,
+                        dsp48e1_stream_loader_fn loader,
+                        void *user,
+                        const float *bias,
+                        float *dst,
+                        size_t dst_stride) {
+    if (!model || !loader || !dst || k_total == 0 || k_chunk == 0 ||
+        dst_stride < model->cols) {
+        return -1;
+    }
+    k_chunk = k_chunk < k_total ? k_chunk : k_total;
+
+    /* Chunk buffers of rows x k_chunk and k_chunk x cols floats. */
+    size_t lhs_bytes;
+    size_t rhs_bytes;
+    if (__builtin_mul_overflow(model->rows, k_chunk, &lhs_bytes) ||
+        __builtin_mul_overflow(lhs_bytes, sizeof(float), &lhs_bytes) ||
+        __builtin_mul_overflow(model->cols, k_chunk, &rhs_bytes) ||
+        __builtin_mul_overflow(rhs_bytes, sizeof(float), &rhs_bytes)) {
+        return -1;
+    }
+
+    stream_feed_t feed;
+    memset(&feed, 0, sizeof(feed));
+    feed.rows = model->rows;
+    feed.cols = model->cols;
+    feed.k_total = k_total;
+    feed.k_chunk = k_chunk;
+    feed.loader = loader;
+    feed.user = user;
+
+    int status = 0;
+    for (size_t i = 0; i < STREAM_BUFFERS; ++i) {
+        feed.buffers[i].lhs = (float *)malloc(lhs_bytes);
+        feed.buffers[i].rhs = (float *)malloc(rhs_bytes);
+        if (!feed.buffers[i].lhs || !feed.buffers[i].rhs) {
+            status = -1;
+        }
+    }
+    if (status == 0 && dsp48e1_model_stream_begin(model, bias) != 0) {
+        status = -1;
+    }
+    if (status != 0) {
+        for (size_t i = 0; i < STREAM_BUFFERS; ++i) {
+            free(feed.buffers[i].lhs);
+            free(feed.buffers[i].rhs);
+        }
+        return status;
+    }
+
+    pthread_mutex_init(&feed.lock, NULL);
+    pthread_cond_init(&feed.changed, NULL);
+
+    pthread_t loader_thread;
+    if (pthread_create(&loader_thread, NULL, stream_loader_main, &feed) != 0) {
+        status = -1;
+    } else {
+        size_t slot = 0;
+        for (size_t k = 0; k < k_total && status == 0; k += k_chunk) {
+            stream_buffer_t *buffer = &feed.buffers[slot];
+
+            pthread_mutex_lock(&feed.lock);
+            while (!buffer->full && !feed.abort) {
+                pthread_cond_wait(&feed.changed, &feed.lock);
+            }
+            if (!buffer->full) {
+                status = feed.loader_status != 0 ? feed.loader_status : -1;
+            }
+            pthread_mutex_unlock(&feed.lock);
+            if (status != 0) {
+                break;
+            }
+
+            status = dsp48e1_model_stream_push(model, buffer->lhs, k_chunk,
+                                               buffer->rhs, feed.cols, buffer->k_count);
+
+            pthread_mutex_lock(&feed.lock);
+            buffer->full = 0;
+            if (status != 0) {
+                feed.abort = 1;
+            }
+            pthread_cond_broadcast(&feed.changed);
+            pthread_mutex_unlock(&feed.lock);
+
+            slot = (slot + 1) % STREAM_BUFFERS;
+        }
+        pthread_join(loader_thread, NULL);
+    }
+
+    if (status == 0) {
+        status = dsp48e1_model_stream_end(model, dst, dst_stride);
+    } else {
+        model->stream_active = 0;
+    }
+
+    pthread_cond_destroy(&feed.changed);
+    pthread_mutex_destroy(&feed.lock);
+    for (size_t i = 0; i < STREAM_BUFFERS; ++i) {
+        free(feed.buffers[i].lhs);
+        free(feed.buffers[i].rhs);
+    }
+    return status;
+}
+
+typedef struct {
+    const float *lhs;  /* rows x k_total */
+    const float *rhs;  /* k_total x cols */
+    size_t rows;
+    size_t cols;
+    size_t k_total;
+    size_t calls;
+} stream_test_source_t;
+
+static int stream_test_loader(void *user,
+                              size_t k_offset,
+                              size_t k_count,
+                              float *lhs,
+                              size_t lhs_stride,
+                              float *rhs,
+                              size_t rhs_stride) {
+    stream_test_source_t *source = (stream_test_source_t *)user;
+    for (size_t row = 0; row < source->rows; ++row) {
+        memcpy(lhs + row * lhs_stride, source->lhs + row * source->k_total + k_offset, sizeof(float) * k_count);
+    }
+    for (size_t k = 0; k < k_count; ++k) {
+        memcpy(rhs + k * rhs_stride, source->rhs + (k_offset + k) * source->cols, sizeof(float) * source->cols);
+    }
+    source->calls++;
+    return 0;
+}
+
+int dsp48e1_stream_self_test(void) {
+    enum { ROWS = 3, COLS = 5, K = 11 };
+    dsp48e1_config_t config;
+    dsp48e1_default_fp32_config(&config);
+    config.enable_rounding = 0;
+
+    float lhs[ROWS * K];
+    float rhs[K * COLS];
+    float bias[COLS];
+    for (size_t i = 0; i < ROWS * K; ++i) {
+        lhs[i] = (float)((int)(i * 37 % 19) - 9) * 0.375f;
+    }
+    for (size_t i = 0; i < K * COLS; ++i) {
+        rhs[i] = (float)((int)(i * 11 % 23) - 11) * 0.25f;
+    }
+    for (size_t i = 0; i < COLS; ++i) {
+        bias[i] = (float)i - 2.0f;
+    }
+
+    dsp48e1_model_t model;
+    if (dsp48e1_model_init(&model, &config, ROWS, COLS, K) != 0) {
+        return -1;
+    }
+    const uint64_t latency = dsp48e1_config_latency(&config);
+    float expected[ROWS * COLS];
+    float actual[ROWS * COLS];
+    int status = dsp48e1_model_gemm_fp32(&model, lhs, K, rhs, COLS, bias, expected, COLS);
+
+    /* K beats, then exactly latency drain cycles, and every product made it out. */
+    if (status == 0 && model.cycle != K + latency) {
+        status = -1;
+    }
+    for (size_t row = 0; status == 0 && row < ROWS; ++row) {
+        for (size_t col = 0; col < COLS; ++col) {
+            float sum = bias[col];
+            for (size_t k = 0; k < K; ++k) {
+                sum += lhs[row * K + k] * rhs[k * COLS + col];
+            }
+            if (sum != expected[row * COLS + col]) {
+                status = -1;
+            }
+        }
+    }
+
+    /* Chunks of 4 (the last one shorter) match the one-shot GEMM bitwise. */
+    stream_test_source_t source = {lhs, rhs, ROWS, COLS, K, 0};
+    if (status == 0 &&
+        (dsp48e1_stream_gemm(&model, K, 4, stream_test_loader, &source, bias, actual, COLS) != 0 ||
+         source.calls != 3 || model.cycle != K + latency ||
+         memcmp(expected, actual, sizeof(expected)) != 0)) {
+        status = -1;
+    }
+
+    /* An oversized chunk is clamped to K. */
+    source.calls = 0;
+    if (status == 0 &&
+        (dsp48e1_stream_gemm(&model, K, SIZE_MAX, stream_test_loader, &source, bias, actual, COLS) != 0 ||
+         source.calls != 1 || memcmp(expected, actual, sizeof(expected)) != 0)) {
+        status = -1;
+    }
+
+    /* A chunk whose buffers do not fit size_t is rejected before the loader runs. */
+    source.calls = 0;
+    if (status == 0 &&
+        (dsp48e1_stream_gemm(&model, SIZE_MAX / 2, SIZE_MAX / 2, stream_test_loader, &source, NULL, actual, COLS) != -1 ||
+         source.calls != 0)) {
+        status = -1;
+    }
+
+    dsp48e1_model_free(&model);
+    return status;
+}
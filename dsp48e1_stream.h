@@ -0,0 +1,61 @@
+#ifndef DSP48E1_STREAM_H
+#define DSP48E1_STREAM_H
+
+#include <stddef.h>
+
+#include "dsp48e1_model.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file dsp48e1_stream.h
+ *
+ * Double-buffered operand feed for the streaming GEMM API.  A loader thread
+ * fills one K chunk while the simulator consumes the other, so only two
+ * chunks of the operands are ever resident.
+ */
+
+/**
+ * Produce the operands for K steps [k_offset, k_offset + k_count).
+ * lhs is a rows x k_count panel with row stride lhs_stride and rhs is a
+ * k_count x cols panel with row stride rhs_stride.  Runs on the loader
+ * thread.  Return 0 on success; any other value aborts the GEMM.
+ */
+typedef int (*dsp48e1_stream_loader_fn)(void *user,
+                                        size_t k_offset,
+                                        size_t k_count,
+                                        float *lhs,
+                                        size_t lhs_stride,
+                                        float *rhs,
+                                        size_t rhs_stride);
+
+/**
+ * Run a streaming GEMM over k_total inner-product steps delivered in chunks
+ * of k_chunk (the last chunk may be shorter).  bias may be NULL.  The
+ * rows x cols result is written to dst.
+ *
+ * Returns 0 on success, the loader's non-zero status if it failed, or -1 on
+ * parameter/allocation/thread errors.
+ */
+int dsp48e1_stream_gemm(dsp48e1_model_t *model,
+                        size_t k_total,
+                        size_t k_chunk,
+                        dsp48e1_stream_loader_fn loader,
+                        void *user,
+                        const float *bias,
+                        float *dst,
+                        size_t dst_stride);
+
+/**
+ * Check chunked streaming against a one-shot GEMM, the drain cycle count
+ * and the rejection of chunk sizes that overflow.  Returns 0 on success.
+ */
+int dsp48e1_stream_self_test(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DSP48E1_STREAM_H */
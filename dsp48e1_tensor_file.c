@@ -0,0 +1,498 @@
+#define _GNU_SOURCE /* madvise, ftruncate */
+
+#include "dsp48e1_tensor_file.h"
+
+#include <fcntl.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define TENSOR_MAGIC "D48E1TEN"
+
+enum { TENSOR_HEADER_BYTES = 64 };
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t dtype;
+    uint64_t rows;
+    uint64_t cols;
+    uint64_t row_stride;
+    uint64_t data_offset;
+    float scale;
+} tensor_header_t;
+
+static size_t tensor_element_size(dsp48e1_tensor_dtype_t dtype) {
+    switch (dtype) {
+    case DSP48E1_TENSOR_BF16:
+        return sizeof(uint16_t);
+    case DSP48E1_TENSOR_INT8:
+        return sizeof(int8_t);
+    case DSP48E1_TENSOR_FP32:
+    default:
+        return sizeof(float);
+    }
+}
+
+static int tensor_dtype_valid(uint32_t dtype) {
+    return dtype <= (uint32_t)DSP48E1_TENSOR_INT8;
+}
+
+/*
+ * Bytes spanned by the data; the last row needs only cols elements.
+ * Returns -1 when the size does not fit in size_t.
+ */
+static int tensor_data_bytes(const dsp48e1_tensor_file_t *tensor, size_t *bytes) {
+    size_t elements = 0;
+    if (tensor->rows != 0 &&
+        (__builtin_mul_overflow(tensor->rows - 1, tensor->row_stride, &elements) ||
+         __builtin_add_overflow(elements, tensor->cols, &elements))) {
+        return -1;
+    }
+    return __builtin_mul_overflow(elements, tensor_element_size(tensor->dtype), bytes) ? -1 : 0;
+}
+
+int dsp48e1_tensor_open(dsp48e1_tensor_file_t *tensor, const char *path) {
+    if (!tensor || !path) {
+        return -1;
+    }
+    memset(tensor, 0, sizeof(*tensor));
+
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < TENSOR_HEADER_BYTES) {
+        close(fd);
+        return -1;
+    }
+
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return -1;
+    }
+
+    tensor_header_t header;
+    size_t data_bytes = 0;
+    memcpy(&header, map, sizeof(header));
+    tensor->dtype = (dsp48e1_tensor_dtype_t)header.dtype;
+    tensor->rows = (size_t)header.rows;
+    tensor->cols = (size_t)header.cols;
+    tensor->row_stride = (size_t)header.row_stride;
+    tensor->scale = header.scale;
+    tensor->map = map;
+    tensor->map_size = (size_t)st.st_size;
+
+    if (memcmp(header.magic, TENSOR_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != DSP48E1_TENSOR_FILE_VERSION ||
+        !tensor_dtype_valid(header.dtype) ||
+        tensor->row_stride < tensor->cols ||
+        header.data_offset < TENSOR_HEADER_BYTES ||
+        header.data_offset % tensor_element_size(tensor->dtype) != 0 ||
+        header.data_offset > tensor->map_size ||
+        header.rows > SIZE_MAX || header.cols > SIZE_MAX || header.row_stride > SIZE_MAX ||
+        tensor_data_bytes(tensor, &data_bytes) != 0 ||
+        data_bytes > tensor->map_size - header.data_offset) {
+        dsp48e1_tensor_close(tensor);
+        return -1;
+    }
+
+    tensor->data = (unsigned char *)map + header.data_offset;
+    /* Operands are streamed once front to back. */
+    madvise(map, tensor->map_size, MADV_SEQUENTIAL);
+    return 0;
+}
+
+int dsp48e1_tensor_create(dsp48e1_tensor_file_t *tensor,
+                          const char *path,
+                          dsp48e1_tensor_dtype_t dtype,
+                          size_t rows,
+                          size_t cols,
+                          size_t row_stride,
+                          float scale) {
+    if (!tensor || !path || !tensor_dtype_valid((uint32_t)dtype) ||
+        rows == 0 || cols == 0 || (row_stride != 0 && row_stride < cols)) {
+        return -1;
+    }
+    memset(tensor, 0, sizeof(*tensor));
+    tensor->dtype = dtype;
+    tensor->rows = rows;
+    tensor->cols = cols;
+    tensor->row_stride = row_stride ? row_stride : cols;
+    tensor->scale = scale;
+    tensor->writable = 1;
+    size_t data_bytes = 0;
+    if (tensor_data_bytes(tensor, &data_bytes) != 0 ||
+        __builtin_add_overflow(data_bytes, (size_t)TENSOR_HEADER_BYTES, &tensor->map_size) ||
+        tensor->map_size > (size_t)INT64_MAX) {
+        memset(tensor, 0, sizeof(*tensor));
+        return -1;
+    }
+
+    const int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return -1;
+    }
+    if (ftruncate(fd, (off_t)tensor->map_size) != 0) {
+        close(fd);
+        return -1;
+    }
+    void *map = mmap(NULL, tensor->map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return -1;
+    }
+
+    tensor_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TENSOR_MAGIC, sizeof(header.magic));
+    header.version = DSP48E1_TENSOR_FILE_VERSION;
+    header.dtype = (uint32_t)dtype;
+    header.rows = rows;
+    header.cols = cols;
+    header.row_stride = tensor->row_stride;
+    header.data_offset = TENSOR_HEADER_BYTES;
+    header.scale = scale;
+    memcpy(map, &header, sizeof(header));
+
+    tensor->map = map;
+    tensor->data = (unsigned char *)map + TENSOR_HEADER_BYTES;
+    return 0;
+}
+
+int dsp48e1_tensor_sync(dsp48e1_tensor_file_t *tensor) {
+    if (!tensor || !tensor->map) {
+        return -1;
+    }
+    if (!tensor->writable) {
+        return 0;
+    }
+    return msync(tensor->map, tensor->map_size, MS_SYNC) == 0 ? 0 : -1;
+}
+
+void dsp48e1_tensor_close(dsp48e1_tensor_file_t *tensor) {
+    if (!tensor) {
+        return;
+    }
+    if (tensor->map) {
+        munmap(tensor->map, tensor->map_size);
+    }
+    memset(tensor, 0, sizeof(*tensor));
+}
+
+static float tensor_bf16_to_fp32(uint16_t value) {
+    const uint32_t bits = (uint32_t)value << 16;
+    float result;
+    memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+/* Widen a rows x cols block starting at (row0, col0) into a dense panel. */
+static void tensor_widen(const dsp48e1_tensor_file_t *tensor,
+                         size_t row0,
+                         size_t rows,
+                         size_t col0,
+                         size_t cols,
+                         float *panel) {
+    for (size_t row = 0; row < rows; ++row) {
+        const size_t offset = (row0 + row) * tensor->row_stride + col0;
+        float *out = panel + row * cols;
+        if (tensor->dtype == DSP48E1_TENSOR_BF16) {
+            const uint16_t *in = (const uint16_t *)tensor->data + offset;
+            for (size_t col = 0; col < cols; ++col) {
+                out[col] = tensor_bf16_to_fp32(in[col]);
+            }
+        } else {
+            const int8_t *in = (const int8_t *)tensor->data + offset;
+            for (size_t col = 0; col < cols; ++col) {
+                out[col] = (float)in[col] * tensor->scale;
+            }
+        }
+    }
+}
+
+int dsp48e1_tensor_gemm(dsp48e1_model_t *model,
+                        const dsp48e1_tensor_file_t *lhs,
+                        const dsp48e1_tensor_file_t *rhs,
+                        const float *bias,
+                        dsp48e1_tensor_file_t *out,
+                        uint64_t *cycles) {
+    if (!model || !model->accumulators || !lhs || !lhs->data || !rhs || !rhs->data ||
+        !out || !out->data || !out->writable ||
+        lhs->cols != rhs->rows || out->rows != lhs->rows || out->cols != rhs->cols ||
+        (out->dtype == DSP48E1_TENSOR_INT8 && out->scale == 0.0f)) {
+        return -1;
+    }
+
+    const size_t tile_rows = model->rows;
+    const size_t tile_cols = model->cols;
+    const size_t tile_depth = model->depth;
+    const size_t gemm_m = lhs->rows;
+    const size_t gemm_n = rhs->cols;
+    const size_t gemm_k = lhs->cols;
+    const int lhs_direct = lhs->dtype == DSP48E1_TENSOR_FP32;
+    const int rhs_direct = rhs->dtype == DSP48E1_TENSOR_FP32;
+    const size_t out_element = tensor_element_size(out->dtype);
+
+    float *lhs_panel = lhs_direct ? NULL : (float *)malloc(sizeof(float) * tile_rows * tile_depth);
+    float *rhs_panel = rhs_direct ? NULL : (float *)malloc(sizeof(float) * tile_depth * tile_cols);
+    float *requant = NULL;
+    if (out->dtype == DSP48E1_TENSOR_INT8) {
+        requant = (float *)malloc(sizeof(float) * tile_cols);
+    }
+    if ((!lhs_direct && !lhs_panel) || (!rhs_direct && !rhs_panel) ||
+        (out->dtype == DSP48E1_TENSOR_INT8 && !requant)) {
+        free(lhs_panel);
+        free(rhs_panel);
+        free(requant);
+        return -1;
+    }
+
+    dsp48e1_epilogue_t epilogue;
+    memset(&epilogue, 0, sizeof(epilogue));
+    switch (out->dtype) {
+    case DSP48E1_TENSOR_BF16:
+        epilogue.output = DSP48E1_EPILOGUE_BF16;
+        break;
+    case DSP48E1_TENSOR_INT8:
+        epilogue.output = DSP48E1_EPILOGUE_INT8;
+        epilogue.scale = requant;
+        for (size_t col = 0; col < tile_cols; ++col) {
+            requant[col] = 1.0f / out->scale;
+        }
+        break;
+    case DSP48E1_TENSOR_FP32:
+    default:
+        epilogue.output = DSP48E1_EPILOGUE_FP32;
+        break;
+    }
+
+    uint64_t total_cycles = 0;
+    int status = 0;
+    for (size_t m0 = 0; m0 < gemm_m && status == 0; m0 += tile_rows) {
+        const size_t rows = (gemm_m - m0) < tile_rows ? (gemm_m - m0) : tile_rows;
+        for (size_t n0 = 0; n0 < gemm_n && status == 0; n0 += tile_cols) {
+            const size_t cols = (gemm_n - n0) < tile_cols ? (gemm_n - n0) : tile_cols;
+
+            if ((rows != model->rows || cols != model->cols) &&
+                dsp48e1_model_reshape(model, rows, cols, tile_depth) != 0) {
+                status = -1;
+                break;
+            }
+
+            status = dsp48e1_model_stream_begin(model, bias ? bias + n0 : NULL);
+            for (size_t k0 = 0; k0 < gemm_k && status == 0; k0 += tile_depth) {
+                const size_t k_count = (gemm_k - k0) < tile_depth ? (gemm_k - k0) : tile_depth;
+                const float *lhs_ptr;
+                size_t lhs_stride;
+                const float *rhs_ptr;
+                size_t rhs_stride;
+
+                if (lhs_direct) {
+                    lhs_ptr = (const float *)lhs->data + m0 * lhs->row_stride + k0;
+                    lhs_stride = lhs->row_stride;
+                } else {
+                    tensor_widen(lhs, m0, rows, k0, k_count, lhs_panel);
+                    lhs_ptr = lhs_panel;
+                    lhs_stride = k_count;
+                }
+                if (rhs_direct) {
+                    rhs_ptr = (const float *)rhs->data + k0 * rhs->row_stride + n0;
+                    rhs_stride = rhs->row_stride;
+                } else {
+                    tensor_widen(rhs, k0, k_count, n0, cols, rhs_panel);
+                    rhs_ptr = rhs_panel;
+                    rhs_stride = cols;
+                }
+                status = dsp48e1_model_stream_push(model, lhs_ptr, lhs_stride,
+                                                   rhs_ptr, rhs_stride, k_count);
+            }
+            if (status == 0) {
+                void *dst = (unsigned char *)out->data + (m0 * out->row_stride + n0) * out_element;
+                status = dsp48e1_model_stream_end_epilogue(model, &epilogue, dst, out->row_stride);
+            }
+            if (status == 0) {
+                total_cycles += model->cycle;
+            }
+        }
+    }
+
+    if (model->rows != tile_rows || model->cols != tile_cols) {
+        dsp48e1_model_reshape(model, tile_rows, tile_cols, tile_depth);
+    }
+    if (cycles) {
+        *cycles = total_cycles;
+    }
+
+    free(lhs_panel);
+    free(rhs_panel);
+    free(requant);
+    return status;
+}
+
+int dsp48e1_tensor_file_self_test(void) {
+    enum { M = 5, N = 6, K = 7, LHS_STRIDE = 9 };
+    const char *tmpdir = getenv("TMPDIR");
+    tmpdir = tmpdir ? tmpdir : "/tmp";
+    char lhs_path[512];
+    char rhs_path[512];
+    char out_path[512];
+    char bad_path[512];
+    snprintf(lhs_path, sizeof(lhs_path), "%s/dsp48e1_tensor_%ld.lhs", tmpdir, (long)getpid());
+    snprintf(rhs_path, sizeof(rhs_path), "%s/dsp48e1_tensor_%ld.rhs", tmpdir, (long)getpid());
+    snprintf(out_path, sizeof(out_path), "%s/dsp48e1_tensor_%ld.out", tmpdir, (long)getpid());
+    snprintf(bad_path, sizeof(bad_path), "%s/dsp48e1_tensor_%ld.bad", tmpdir, (long)getpid());
+
+    /* Quarter-integers are exact in BF16 and keep every sum exact. */
+    float lhs[M * K];
+    float rhs[K * N];
+    float bias[N];
+    for (size_t i = 0; i < M * K; ++i) {
+        lhs[i] = (float)((int)(i * 37 % 19) - 9) * 0.25f;
+    }
+    for (size_t i = 0; i < K * N; ++i) {
+        rhs[i] = (float)((int)(i * 11 % 23) - 11) * 0.25f;
+    }
+    for (size_t i = 0; i < N; ++i) {
+        bias[i] = (float)i - 2.0f;
+    }
+
+    dsp48e1_config_t config;
+    dsp48e1_default_fp32_config(&config);
+    config.enable_rounding = 0;
+    dsp48e1_model_t reference;
+    dsp48e1_model_t model;
+    float expected[M * N];
+    if (dsp48e1_model_init(&reference, &config, M, N, K) != 0) {
+        return -1;
+    }
+    int status = dsp48e1_model_gemm_fp32(&reference, lhs, K, rhs, N, bias, expected, N);
+    dsp48e1_model_free(&reference);
+    if (status != 0 || dsp48e1_model_init(&model, &config, 2, 4, 3) != 0) {
+        return -1;
+    }
+
+    dsp48e1_tensor_file_t a;
+    dsp48e1_tensor_file_t b;
+    dsp48e1_tensor_file_t c;
+    memset(&a, 0, sizeof(a));
+    memset(&b, 0, sizeof(b));
+    memset(&c, 0, sizeof(c));
+    if (dsp48e1_tensor_create(&a, lhs_path, DSP48E1_TENSOR_FP32, M, K, LHS_STRIDE, 1.0f) != 0 ||
+        dsp48e1_tensor_create(&b, rhs_path, DSP48E1_TENSOR_BF16, K, N, 0, 1.0f) != 0 ||
+        dsp48e1_tensor_create(&c, out_path, DSP48E1_TENSOR_FP32, M, N, 0, 1.0f) != 0) {
+        status = -1;
+    }
+    for (size_t row = 0; status == 0 && row < M; ++row) {
+        memcpy((float *)a.data + row * LHS_STRIDE, lhs + row * K, sizeof(float) * K);
+    }
+    for (size_t i = 0; status == 0 && i < K * N; ++i) {
+        uint32_t bits;
+        memcpy(&bits, &rhs[i], sizeof(bits));
+        ((uint16_t *)b.data)[i] = (uint16_t)(bits >> 16);
+    }
+    if (status == 0 && (dsp48e1_tensor_gemm(&model, &a, &b, bias, &c, NULL) != 0 ||
+                        model.rows != 2 || model.cols != 4 ||
+                        dsp48e1_tensor_sync(&c) != 0)) {
+        status = -1;
+    }
+    dsp48e1_tensor_close(&c);
+    if (status == 0 && (dsp48e1_tensor_open(&c, out_path) != 0 ||
+                        memcmp(c.data, expected, sizeof(expected)) != 0)) {
+        status = -1;
+    }
+    dsp48e1_tensor_close(&a);
+    dsp48e1_tensor_close(&b);
+    dsp48e1_tensor_close(&c);
+
+    /*
+     * INT8 lhs with scale 0.25 holds the quarter-integers exactly; rhs is
+     * strided FP32.  The result is requantized to INT8 with out->scale and
+     * narrowed to BF16 in a strided file, both rounding to nearest even.
+     */
+    for (int narrow = DSP48E1_TENSOR_BF16; status == 0 && narrow <= DSP48E1_TENSOR_INT8; ++narrow) {
+        const size_t out_stride = narrow == DSP48E1_TENSOR_BF16 ? N + 3 : N;
+        const float out_scale = 0.5f;
+        if (dsp48e1_tensor_create(&a, lhs_path, DSP48E1_TENSOR_INT8, M, K, 0, 0.25f) != 0 ||
+            dsp48e1_tensor_create(&b, rhs_path, DSP48E1_TENSOR_FP32, K, N, N + 2, 1.0f) != 0 ||
+            dsp48e1_tensor_create(&c, out_path, (dsp48e1_tensor_dtype_t)narrow, M, N, out_stride, out_scale) != 0) {
+            status = -1;
+        }
+        for (size_t i = 0; status == 0 && i < M * K; ++i) {
+            ((int8_t *)a.data)[i] = (int8_t)(lhs[i] * 4.0f);
+        }
+        for (size_t row = 0; status == 0 && row < K; ++row) {
+            memcpy((float *)b.data + row * (N + 2), rhs + row * N, sizeof(float) * N);
+        }
+        if (status == 0 && dsp48e1_tensor_gemm(&model, &a, &b, bias, &c, NULL) != 0) {
+            status = -1;
+        }
+        for (size_t row = 0; status == 0 && row < M; ++row) {
+            for (size_t col = 0; col < out_stride; ++col) {
+                const float value = col < N ? expected[row * N + col] : 0.0f;
+                if (narrow == DSP48E1_TENSOR_INT8) {
+                    float q = nearbyintf(value / out_scale);
+                    q = q > 127.0f ? 127.0f : (q < -128.0f ? -128.0f : q);
+                    if (((int8_t *)c.data)[row * out_stride + col] != (int8_t)q) {
+                        status = -1;
+                    }
+                } else {
+                    uint32_t bits;
+                    memcpy(&bits, &value, sizeof(bits));
+                    const uint16_t rounded = (uint16_t)((bits + 0x7FFFU + ((bits >> 16) & 1U)) >> 16);
+                    if (((uint16_t *)c.data)[row * out_stride + col] != rounded) {
+                        status = -1;
+                    }
+                }
+            }
+        }
+        dsp48e1_tensor_close(&a);
+        dsp48e1_tensor_close(&b);
+        dsp48e1_tensor_close(&c);
+    }
+
+    /* (rows - 1) * row_stride wraps to 0, so an unchecked size would be 4 bytes. */
+    unsigned char file[TENSOR_HEADER_BYTES + sizeof(float)];
+    tensor_header_t header;
+    memset(file, 0, sizeof(file));
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TENSOR_MAGIC, sizeof(header.magic));
+    header.version = DSP48E1_TENSOR_FILE_VERSION;
+    header.dtype = DSP48E1_TENSOR_FP32;
+    header.rows = ((uint64_t)1 << 62) + 1;
+    header.cols = 1;
+    header.row_stride = 4;
+    header.data_offset = TENSOR_HEADER_BYTES;
+    header.scale = 1.0f;
+    memcpy(file, &header, sizeof(header));
+    FILE *stream = fopen(bad_path, "wb");
+    if (!stream || fwrite(file, sizeof(file), 1, stream) != 1) {
+        status = -1;
+    }
+    if (stream && fclose(stream) != 0) {
+        status = -1;
+    }
+    if (status == 0 && dsp48e1_tensor_open(&a, bad_path) == 0) {
+        dsp48e1_tensor_close(&a);
+        status = -1;
+    }
+    if (status == 0 && dsp48e1_tensor_create(&a, bad_path, DSP48E1_TENSOR_FP32, SIZE_MAX / 2, 4, 0, 1.0f) == 0) {
+        dsp48e1_tensor_close(&a);
+        status = -1;
+    }
+
+    unlink(lhs_path);
+    unlink(rhs_path);
+    unlink(out_path);
+    unlink(bad_path);
+    dsp48e1_model_free(&model);
+    return status;
+}
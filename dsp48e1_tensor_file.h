@@ -0,0 +1,116 @@
+#ifndef DSP48E1_TENSOR_FILE_H
+#define DSP48E1_TENSOR_FILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dsp48e1_model.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file dsp48e1_tensor_file.h
+ *
+ * Memory-mapped 2-D tensor files used as GEMM operands and results.
+ *
+ * A file is a 64-byte header followed by row-major data at data_offset:
+ *
+ *   char     magic[8]     "D48E1TEN"
+ *   uint32_t version      DSP48E1_TENSOR_FILE_VERSION
+ *   uint32_t dtype        dsp48e1_tensor_dtype_t
+ *   uint64_t rows
+ *   uint64_t cols
+ *   uint64_t row_stride   in elements, >= cols
+ *   uint64_t data_offset  in bytes from the start of the file
+ *   float    scale        INT8 only: real value = q * scale
+ *   (zero padding to 64 bytes)
+ *
+ * All fields use the native byte order.
+ */
+
+#define DSP48E1_TENSOR_FILE_VERSION 1
+
+typedef enum {
+    DSP48E1_TENSOR_FP32 = 0,
+    DSP48E1_TENSOR_BF16,
+    DSP48E1_TENSOR_INT8
+} dsp48e1_tensor_dtype_t;
+
+typedef struct {
+    dsp48e1_tensor_dtype_t dtype;
+    size_t rows;
+    size_t cols;
+    size_t row_stride; /* Elements between consecutive rows. */
+    float scale;
+    void *data; /* First element of row 0 inside the mapping. */
+    void *map;
+    size_t map_size;
+    int writable;
+} dsp48e1_tensor_file_t;
+
+/**
+ * Map an existing tensor file read-only.  Returns 0 on success, -1 on I/O
+ * error or a malformed header, including one whose data size overflows.
+ */
+int dsp48e1_tensor_open(dsp48e1_tensor_file_t *tensor, const char *path);
+
+/**
+ * Create (or truncate) a tensor file of the given shape and map it
+ * read-write.  row_stride 0 means cols.  Data starts zeroed.
+ * Returns 0 on success, -1 on I/O error or a shape whose size overflows.
+ */
+int dsp48e1_tensor_create(dsp48e1_tensor_file_t *tensor,
+                          const char *path,
+                          dsp48e1_tensor_dtype_t dtype,
+                          size_t rows,
+                          size_t cols,
+                          size_t row_stride,
+                          float scale);
+
+/**
+ * Flush a writable mapping to disk.  Returns 0 on success.
+ */
+int dsp48e1_tensor_sync(dsp48e1_tensor_file_t *tensor);
+
+/**
+ * Unmap the tensor.  Dirty pages of a writable mapping are written back by
+ * the kernel; call dsp48e1_tensor_sync() first to wait for them.
+ */
+void dsp48e1_tensor_close(dsp48e1_tensor_file_t *tensor);
+
+/**
+ * out = lhs x rhs (+ bias, length rhs->cols, may be NULL) over the whole
+ * matrices, tiled onto the model's rows x cols tile with K streamed in
+ * chunks of the model's depth.
+ *
+ * FP32 operands are passed to the model straight from the mapping through
+ * the lhs/rhs strides, so nothing is copied; BF16/INT8 operands are widened
+ * one tile-sized chunk at a time.  Results are written into out's mapping
+ * through the epilogue, which narrows to BF16 or requantizes to INT8 with
+ * out->scale.  The model's shape is restored before returning.
+ * When cycles is non-NULL it receives the modelled clocks of all tiles.
+ *
+ * Returns 0 on success, -1 on shape mismatch or allocation failure.
+ */
+int dsp48e1_tensor_gemm(dsp48e1_model_t *model,
+                        const dsp48e1_tensor_file_t *lhs,
+                        const dsp48e1_tensor_file_t *rhs,
+                        const float *bias,
+                        dsp48e1_tensor_file_t *out,
+                        uint64_t *cycles);
+
+/**
+ * Round-trip FP32, BF16 and INT8 tensors through files in $TMPDIR (default
+ * /tmp): tiled GEMMs with FP32/BF16 and INT8/FP32 operands, and FP32, BF16
+ * and requantized INT8 results, are checked against the model.  Headers
+ * whose data size wraps around must be rejected.  Returns 0 on success.
+ */
+int dsp48e1_tensor_file_self_test(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DSP48E1_TENSOR_FILE_H */
@@ -0,0 +1,88 @@
+/*
+ * Self-test driver: runs the self-test of every module, or of the modules
+ * named on the command line, and exits non-zero when any of them fails.
+ *
+ *   ./dsp48e1_test.exe [module...]
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "dsp48e1.h"
+#include "dsp48e1_batch.h"
+#include "dsp48e1_bfp.h"
+#include "dsp48e1_checkpoint.h"
+#include "dsp48e1_combined.h"
+#include "dsp48e1_conv.h"
+#include "dsp48e1_dse.h"
+#include "dsp48e1_epilogue.h"
+#include "dsp48e1_estimate.h"
+#include "dsp48e1_fault.h"
+#include "dsp48e1_format.h"
+#include "dsp48e1_memory.h"
+#include "dsp48e1_model.h"
+#include "dsp48e1_server.h"
+#include "dsp48e1_splitk.h"
+#include "dsp48e1_stream.h"
+#include "dsp48e1_tensor_file.h"
+#include "dsp48e1_trace.h"
+
+typedef struct {
+    const char *name;
+    int (*run)(void);
+} test_entry_t;
+
+static const test_entry_t tests[] = {
+    {"slice", dsp48e1_self_test},
+    {"model", dsp48e1_model_self_test_fp32},
+    {"shim", dsp48e1_shim_self_test},
+    {"stream", dsp48e1_stream_self_test},
+    {"conv", dsp48e1_conv_self_test},
+    {"batch", dsp48e1_batch_self_test},
+    {"epilogue", dsp48e1_epilogue_self_test},
+    {"checkpoint", dsp48e1_checkpoint_self_test},
+    {"tensor_file", dsp48e1_tensor_file_self_test},
+    {"trace", dsp48e1_trace_self_test},
+    {"estimate", dsp48e1_estimate_self_test},
+    {"dse", dsp48e1_dse_self_test},
+    {"splitk", dsp48e1_splitk_self_test},
+    {"server", dsp48e1_server_self_test},
+    {"combined", dsp48e1_combined_self_test},
+    {"format", dsp48e1_format_self_test},
+    {"bfp", dsp48e1_bfp_self_test},
+    {"memory", dsp48e1_memory_self_test},
+    {"fault", dsp48e1_fault_self_test},
+};
+
+static int test_selected(const char *name, int argc, char **argv) {
+    if (argc < 2) {
+        return 1;
+    }
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], name) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    int failures = 0;
+    int ran = 0;
+
+    for (size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); ++i) {
+        if (!test_selected(tests[i].name, argc, argv)) {
+            continue;
+        }
+        const int status = tests[i].run();
+        printf("%-12s %s\n", tests[i].name, status == 0 ? "ok" : "FAILED");
+        failures += status != 0;
+        ran++;
+    }
+
+    if (ran == 0) {
+        fprintf(stderr, "no such test\n");
+        return 2;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,592 @@
+#define _GNU_SOURCE /* clock_gettime, CLOCK_MONOTONIC */
+
+#include "dsp48e1_trace.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define TRACE_MAGIC "D48E1TRC"
+
+enum {
+    TRACE_HEADER_SIZE = 16,
+    TRACE_CHUNK_RECORDS = 1 << 16,
+    TRACE_READ_BUFFERS = 2,
+    /* OPMODE(7) | ALUMODE(4) | INMODE(5) | CARRYINSEL(3) */
+    TRACE_KEY_BITS = 19,
+    TRACE_NO_GROUP = 0xFFFFFFFFU
+};
+
+static void put_le(unsigned char *out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out[i] = (unsigned char)(value >> (8 * i));
+    }
+}
+
+static inline uint64_t get_le(const unsigned char *in, int bytes) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    // Single unaligned load on little-endian hosts
+    uint64_t value = 0;
+    memcpy(&value, in, (size_t)bytes);
+    return value;
+#else
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; ++i) {
+        value |= (uint64_t)in[i] << (8 * i);
+    }
+    return value;
+#endif
+}
+
+static int64_t sign_extend(uint64_t value, int width) {
+    return (int64_t)(value << (64 - width)) >> (64 - width);
+}
+
+static void trace_encode(const dsp48e1_trace_op_t *op, unsigned char *out) {
+    put_le(out + 0, (uint32_t)op->a1, 4);
+    put_le(out + 4, (uint32_t)op->a2, 4);
+    put_le(out + 8, (uint32_t)op->b1, 4);
+    put_le(out + 12, (uint32_t)op->b2, 4);
+    put_le(out + 16, (uint32_t)op->d, 4);
+    put_le(out + 20, (uint64_t)op->c, 6);
+    put_le(out + 26, (uint64_t)op->p, 6);
+    out[32] = (unsigned char)(op->opmode & 0x7F);
+    out[33] = (unsigned char)(op->alumode & 0xF);
+    out[34] = (unsigned char)(op->inmode & 0x1F);
+    out[35] = (unsigned char)((op->carryinsel & 0x7) |
+                              (op->carryin ? 0x08 : 0) |
+                              (op->carrycascin ? 0x10 : 0));
+}
+
+static inline void trace_decode(const unsigned char *in, dsp48e1_trace_op_t *op) {
+    op->a1 = (int32_t)(uint32_t)get_le(in + 0, 4);
+    op->a2 = (int32_t)(uint32_t)get_le(in + 4, 4);
+    op->b1 = (int32_t)(uint32_t)get_le(in + 8, 4);
+    op->b2 = (int32_t)(uint32_t)get_le(in + 12, 4);
+    op->d = (int32_t)(uint32_t)get_le(in + 16, 4);
+    op->c = sign_extend(get_le(in + 20, 6), 48);
+    op->p = sign_extend(get_le(in + 26, 6), 48);
+    op->opmode = (int8_t)(in[32] & 0x7F);
+    op->alumode = (int8_t)(in[33] & 0xF);
+    op->inmode = (int8_t)(in[34] & 0x1F);
+    op->carryinsel = (int8_t)(in[35] & 0x7);
+    op->carryin = (in[35] & 0x08) != 0;
+    op->carrycascin = (in[35] & 0x10) != 0;
+}
+
+static uint32_t trace_key(const unsigned char *record) {
+    return (uint32_t)(record[32] & 0x7F) |
+           ((uint32_t)(record[33] & 0xF) << 7) |
+           ((uint32_t)(record[34] & 0x1F) << 11) |
+           ((uint32_t)(record[35] & 0x7) << 16);
+}
+
+int dsp48e1_trace_writer_open(dsp48e1_trace_writer_t *writer, const char *path) {
+    if (!writer || !path) {
+        return -1;
+    }
+    memset(writer, 0, sizeof(*writer));
+
+    writer->capacity = (size_t)TRACE_CHUNK_RECORDS * DSP48E1_TRACE_RECORD_SIZE;
+    writer->buffer = (unsigned char *)malloc(writer->capacity);
+    writer->file = fopen(path, "wb");
+    if (!writer->buffer || !writer->file) {
+        free(writer->buffer);
+        if (writer->file) {
+            fclose(writer->file);
+        }
+        memset(writer, 0, sizeof(*writer));
+        return -1;
+    }
+
+    unsigned char header[TRACE_HEADER_SIZE];
+    memcpy(header, TRACE_MAGIC, 8);
+    put_le(header + 8, DSP48E1_TRACE_VERSION, 4);
+    put_le(header + 12, DSP48E1_TRACE_RECORD_SIZE, 4);
+    if (fwrite(header, 1, sizeof(header), writer->file) != sizeof(header)) {
+        dsp48e1_trace_writer_close(writer);
+        return -1;
+    }
+    return 0;
+}
+
+int dsp48e1_trace_write(dsp48e1_trace_writer_t *writer, const dsp48e1_trace_op_t *op) {
+    if (!writer || !writer->file || !op) {
+        return -1;
+    }
+    if (writer->used + DSP48E1_TRACE_RECORD_SIZE > writer->capacity) {
+        if (fwrite(writer->buffer, 1, writer->used, writer->file) != writer->used) {
+            return -1;
+        }
+        writer->used = 0;
+    }
+    trace_encode(op, writer->buffer + writer->used);
+    writer->used += DSP48E1_TRACE_RECORD_SIZE;
+    return 0;
+}
+
+int dsp48e1_trace_writer_close(dsp48e1_trace_writer_t *writer) {
+    if (!writer || !writer->file) {
+        return -1;
+    }
+
+    int status = 0;
+    if (writer->used > 0 &&
+        fwrite(writer->buffer, 1, writer->used, writer->file) != writer->used) {
+        status = -1;
+    }
+    if (fclose(writer->file) != 0) {
+        status = -1;
+    }
+    free(writer->buffer);
+    memset(writer, 0, sizeof(*writer));
+    return status;
+}
+
+/* Per-chunk scratch: records regrouped by control word in SoA form. */
+typedef struct {
+    uint32_t *group_of_key; /* TRACE_NO_GROUP when the key is unused. */
+    uint32_t *keys;         /* Distinct keys of the chunk, first-seen order. */
+    uint32_t *group_start;
+    uint32_t *group_next;   /* Next free slot of each group while scattering. */
+    uint32_t *record_group; /* Group of each chunk record. */
+    uint32_t *order;        /* Chunk record index for each grouped slot. */
+    int32_t *a1;
+    int32_t *a2;
+    int32_t *b1;
+    int32_t *b2;
+    int32_t *d;
+    int64_t *c;
+    int64_t *expected;
+    int64_t *p;
+    bool *carryin;
+    bool *carrycascin;
+} replay_scratch_t;
+
+static void replay_scratch_free(replay_scratch_t *s) {
+    free(s->group_of_key);
+    free(s->keys);
+    free(s->group_start);
+    free(s->group_next);
+    free(s->record_group);
+    free(s->order);
+    free(s->a1);
+    free(s->a2);
+    free(s->b1);
+    free(s->b2);
+    free(s->d);
+    free(s->c);
+    free(s->expected);
+    free(s->p);
+    free(s->carryin);
+    free(s->carrycascin);
+}
+
+static int replay_scratch_alloc(replay_scratch_t *s) {
+    const size_t n = TRACE_CHUNK_RECORDS;
+    memset(s, 0, sizeof(*s));
+    s->group_of_key = (uint32_t *)malloc(sizeof(uint32_t) << TRACE_KEY_BITS);
+    s->keys = (uint32_t *)malloc(sizeof(uint32_t) * n);
+    s->group_start = (uint32_t *)malloc(sizeof(uint32_t) * (n + 1));
+    s->group_next = (uint32_t *)malloc(sizeof(uint32_t) * n);
+    s->record_group = (uint32_t *)malloc(sizeof(uint32_t) * n);
+    s->order = (uint32_t *)malloc(sizeof(uint32_t) * n);
+    s->a1 = (int32_t *)malloc(sizeof(int32_t) * n);
+    s->a2 = (int32_t *)malloc(sizeof(int32_t) * n);
+    s->b1 = (int32_t *)malloc(sizeof(int32_t) * n);
+    s->b2 = (int32_t *)malloc(sizeof(int32_t) * n);
+    s->d = (int32_t *)malloc(sizeof(int32_t) * n);
+    s->c = (int64_t *)malloc(sizeof(int64_t) * n);
+    s->expected = (int64_t *)malloc(sizeof(int64_t) * n);
+    s->p = (int64_t *)malloc(sizeof(int64_t) * n);
+    s->carryin = (bool *)malloc(sizeof(bool) * n);
+    s->carrycascin = (bool *)malloc(sizeof(bool) * n);
+    if (!s->group_of_key || !s->keys || !s->group_start || !s->group_next || !s->record_group || !s->order ||
+        !s->a1 || !s->a2 || !s->b1 || !s->b2 || !s->d || !s->c || !s->expected ||
+        !s->p || !s->carryin || !s->carrycascin) {
+        replay_scratch_free(s);
+        memset(s, 0, sizeof(*s));
+        return -1;
+    }
+    memset(s->group_of_key, 0xFF, sizeof(uint32_t) << TRACE_KEY_BITS);
+    return 0;
+}
+
+/*
+ * Counting sort of the chunk by control word, decode into the grouped SoA
+ * arrays, then one dsp48e1_batch() per group.
+ */
+static void replay_chunk(replay_scratch_t *s,
+                         const unsigned char *raw,
+                         size_t count,
+                         uint64_t first_index,
+                         dsp48e1_replay_mismatch_fn on_mismatch,
+                         void *user,
+                         dsp48e1_replay_stats_t *stats) {
+    size_t groups = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        const uint32_t key = trace_key(raw + i * DSP48E1_TRACE_RECORD_SIZE);
+        if (s->group_of_key[key] == TRACE_NO_GROUP) {
+            s->group_of_key[key] = (uint32_t)groups;
+            s->keys[groups] = key;
+            s->group_start[groups] = 0;
+            groups++;
+        }
+        s->record_group[i] = s->group_of_key[key];
+        s->group_start[s->record_group[i]]++;
+    }
+
+    uint32_t offset = 0;
+    for (size_t g = 0; g < groups; ++g) {
+        const uint32_t size = s->group_start[g];
+        s->group_start[g] = offset;
+        offset += size;
+    }
+    s->group_start[groups] = offset;
+
+    memcpy(s->group_next, s->group_start, sizeof(uint32_t) * groups);
+
+    for (size_t i = 0; i < count; ++i) {
+        const unsigned char *record = raw + i * DSP48E1_TRACE_RECORD_SIZE;
+        const uint32_t slot = s->group_next[s->record_group[i]]++;
+        dsp48e1_trace_op_t op;
+        trace_decode(record, &op);
+        s->order[slot] = (uint32_t)i;
+        s->a1[slot] = op.a1;
+        s->a2[slot] = op.a2;
+        s->b1[slot] = op.b1;
+        s->b2[slot] = op.b2;
+        s->d[slot] = op.d;
+        s->c[slot] = op.c;
+        s->expected[slot] = op.p;
+        s->carryin[slot] = op.carryin;
+        s->carrycascin[slot] = op.carrycascin;
+    }
+
+    for (size_t g = 0; g < groups; ++g) {
+        const uint32_t key = s->keys[g];
+        const uint32_t start = s->group_start[g];
+        const uint32_t n = s->group_start[g + 1] - start;
+        const int8_t opmode = (int8_t)(key & 0x7F);
+        const int8_t alumode = (int8_t)((key >> 7) & 0xF);
+        const int8_t inmode = (int8_t)((key >> 11) & 0x1F);
+        const int8_t carryinsel = (int8_t)((key >> 16) & 0x7);
+
+        const dsp48e1_batch_ports_t ports = {
+            s->a1 + start, s->a2 + start, s->b1 + start, s->b2 + start,
+            s->c + start, s->d + start, s->carryin + start, s->carrycascin + start
+        };
+        dsp48e1_batch(&ports, n, opmode, alumode, inmode, carryinsel, s->p + start);
+
+        for (uint32_t j = start; j < start + n; ++j) {
+            if (s->p[j] != s->expected[j]) {
+                stats->mismatches++;
+                if (on_mismatch) {
+                    dsp48e1_trace_op_t op;
+                    trace_decode(raw + (size_t)s->order[j] * DSP48E1_TRACE_RECORD_SIZE, &op);
+                    on_mismatch(user, first_index + s->order[j], &op, s->p[j]);
+                }
+            }
+        }
+        s->group_of_key[key] = TRACE_NO_GROUP;
+    }
+    stats->batches += groups;
+}
+
+static double replay_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+typedef struct {
+    unsigned char *data;
+    size_t bytes;
+    int full;
+    int last; /* No data follows this buffer. */
+} replay_buffer_t;
+
+/* A reader thread fills one buffer while the caller replays the other. */
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    replay_buffer_t buffers[TRACE_READ_BUFFERS];
+    FILE *file;
+    int error;
+} replay_feed_t;
+
+static void *replay_reader_main(void *arg) {
+    replay_feed_t *feed = (replay_feed_t *)arg;
+    const size_t capacity = (size_t)TRACE_CHUNK_RECORDS * DSP48E1_TRACE_RECORD_SIZE;
+    size_t slot = 0;
+
+    for (;;) {
+        replay_buffer_t *buffer = &feed->buffers[slot];
+
+        pthread_mutex_lock(&feed->lock);
+        while (buffer->full) {
+            pthread_cond_wait(&feed->changed, &feed->lock);
+        }
+        pthread_mutex_unlock(&feed->lock);
+
+        const size_t bytes = fread(buffer->data, 1, capacity, feed->file);
+        /* A short read is the end of the file; a partial record means truncation. */
+        const int error = ferror(feed->file) || bytes % DSP48E1_TRACE_RECORD_SIZE != 0;
+        const int last = bytes < capacity || error;
+
+        pthread_mutex_lock(&feed->lock);
+        buffer->bytes = error ? 0 : bytes;
+        buffer->last = last;
+        buffer->full = 1;
+        feed->error = error;
+        pthread_cond_broadcast(&feed->changed);
+        pthread_mutex_unlock(&feed->lock);
+        if (last) {
+            break;
+        }
+
+        slot = (slot + 1) % TRACE_READ_BUFFERS;
+    }
+
+    return NULL;
+}
+
+int dsp48e1_trace_replay(const char *path,
+                         dsp48e1_replay_mismatch_fn on_mismatch,
+                         void *user,
+                         dsp48e1_replay_stats_t *stats) {
+    if (!path || !stats) {
+        return -1;
+    }
+    memset(stats, 0, sizeof(*stats));
+    const double start = replay_now();
+
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return -1;
+    }
+    /* Chunks are read straight into our buffers; stdio buffering only adds a copy. */
+    setvbuf(file, NULL, _IONBF, 0);
+
+    unsigned char header[TRACE_HEADER_SIZE];
+    if (fread(header, 1, sizeof(header), file) != sizeof(header) ||
+        memcmp(header, TRACE_MAGIC, 8) != 0 ||
+        get_le(header + 8, 4) != DSP48E1_TRACE_VERSION ||
+        get_le(header + 12, 4) != DSP48E1_TRACE_RECORD_SIZE) {
+        fclose(file);
+        return -1;
+    }
+    stats->bytes = sizeof(header);
+
+    replay_feed_t feed;
+    memset(&feed, 0, sizeof(feed));
+    feed.file = file;
+
+    replay_scratch_t scratch;
+    int status = replay_scratch_alloc(&scratch);
+    for (size_t i = 0; i < TRACE_READ_BUFFERS; ++i) {
+        feed.buffers[i].data = (unsigned char *)malloc((size_t)TRACE_CHUNK_RECORDS * DSP48E1_TRACE_RECORD_SIZE);
+        if (!feed.buffers[i].data) {
+            status = -1;
+        }
+    }
+    if (status != 0) {
+        replay_scratch_free(&scratch);
+        for (size_t i = 0; i < TRACE_READ_BUFFERS; ++i) {
+            free(feed.buffers[i].data);
+        }
+        fclose(file);
+        return -1;
+    }
+
+    pthread_mutex_init(&feed.lock, NULL);
+    pthread_cond_init(&feed.changed, NULL);
+
+    pthread_t reader;
+    if (pthread_create(&reader, NULL, replay_reader_main, &feed) != 0) {
+        status = -1;
+    } else {
+        size_t slot = 0;
+        for (;;) {
+            replay_buffer_t *buffer = &feed.buffers[slot];
+
+            pthread_mutex_lock(&feed.lock);
+            while (!buffer->full) {
+                pthread_cond_wait(&feed.changed, &feed.lock);
+            }
+            pthread_mutex_unlock(&feed.lock);
+
+            const size_t count = buffer->bytes / DSP48E1_TRACE_RECORD_SIZE;
+            if (count > 0) {
+                replay_chunk(&scratch, buffer->data, count, stats->ops, on_mismatch, user, stats);
+                stats->ops += count;
+                stats->bytes += buffer->bytes;
+            }
+            if (buffer->last) {
+                break;
+            }
+
+            pthread_mutex_lock(&feed.lock);
+            buffer->full = 0;
+            pthread_cond_broadcast(&feed.changed);
+            pthread_mutex_unlock(&feed.lock);
+
+            slot = (slot + 1) % TRACE_READ_BUFFERS;
+        }
+        pthread_join(reader, NULL);
+        if (feed.error) {
+            status = -1;
+        }
+    }
+
+    pthread_cond_destroy(&feed.changed);
+    pthread_mutex_destroy(&feed.lock);
+    replay_scratch_free(&scratch);
+    for (size_t i = 0; i < TRACE_READ_BUFFERS; ++i) {
+        free(feed.buffers[i].data);
+    }
+    fclose(file);
+    stats->seconds = replay_now() - start;
+    return status;
+}
+
+typedef struct {
+    uint64_t mismatches;
+    uint64_t misplaced;
+} trace_test_state_t;
+
+enum { TRACE_TEST_CORRUPT_EVERY = 1000 };
+
+static void trace_test_mismatch(void *user, uint64_t index, const dsp48e1_trace_op_t *op, int64_t computed_p) {
+    trace_test_state_t *state = (trace_test_state_t *)user;
+    state->mismatches++;
+    if (index % TRACE_TEST_CORRUPT_EVERY != TRACE_TEST_CORRUPT_EVERY - 1 ||
+        sign_extend((uint64_t)(computed_p ^ 1), 48) != op->p) {
+        state->misplaced++;
+    }
+}
+
+/* Random operands for one record; P is left for the caller. */
+static void trace_test_operands(uint64_t seed, dsp48e1_trace_op_t *op) {
+    op->a1 = (int32_t)sign_extend(seed >> 3, 30);
+    op->a2 = (int32_t)sign_extend(seed >> 7, 30);
+    op->b1 = (int32_t)sign_extend(seed >> 11, 18);
+    op->b2 = (int32_t)sign_extend(seed >> 29, 18);
+    op->d = (int32_t)sign_extend(seed >> 17, 25);
+    op->c = sign_extend(seed * 0xD1B54A32D192ED03ULL, 48);
+    op->carryin = (seed >> 42) & 1;
+    op->carrycascin = (seed >> 43) & 1;
+}
+
+int dsp48e1_trace_self_test(void) {
+    /* A*B, C+A*B, A:B+C and C XOR A:B; the count spans more than one read chunk. */
+    static const int8_t controls[][3] = {
+        {0x05, 0x0, 0x00},
+        {0x35, 0x0, 0x00},
+        {0x33, 0x0, 0x00},
+        {0x33, 0x4, 0x00},
+    };
+    const uint64_t count = (uint64_t)TRACE_CHUNK_RECORDS + 37;
+    const char *tmpdir = getenv("TMPDIR");
+    char path[512];
+    snprintf(path, sizeof(path), "%s/dsp48e1_trace_%ld.trc", tmpdir ? tmpdir : "/tmp", (long)getpid());
+
+    dsp48e1_trace_writer_t writer;
+    if (dsp48e1_trace_writer_open(&writer, path) != 0) {
+        return -1;
+    }
+    int status = 0;
+    uint64_t corrupted = 0;
+    uint64_t seed = 0x9E3779B97F4A7C15ULL;
+    for (uint64_t i = 0; i < count && status == 0; ++i) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        const int8_t *control = controls[(seed >> 60) % 4];
+        dsp48e1_trace_op_t op;
+        trace_test_operands(seed, &op);
+        op.opmode = control[0];
+        op.alumode = control[1];
+        op.inmode = control[2];
+        op.carryinsel = 0;
+        op.carrycascin = false;
+        op.p = dsp48e1(op.a1, op.a2, op.b1, op.b2, op.c, op.d, op.opmode, op.alumode,
+                       op.inmode, op.carryinsel, op.carryin, op.carrycascin);
+        if (i % TRACE_TEST_CORRUPT_EVERY == TRACE_TEST_CORRUPT_EVERY - 1) {
+            op.p = sign_extend((uint64_t)(op.p ^ 1), 48);
+            corrupted++;
+        }
+        status = dsp48e1_trace_write(&writer, &op);
+    }
+    if (dsp48e1_trace_writer_close(&writer) != 0) {
+        status = -1;
+    }
+
+    trace_test_state_t state = {0, 0};
+    dsp48e1_replay_stats_t stats;
+    if (status == 0 &&
+        (dsp48e1_trace_replay(path, trace_test_mismatch, &state, &stats) != 0 ||
+         stats.ops != count || stats.mismatches != corrupted ||
+         state.mismatches != corrupted || state.misplaced != 0 ||
+         stats.bytes != TRACE_HEADER_SIZE + count * DSP48E1_TRACE_RECORD_SIZE)) {
+        status = -1;
+    }
+
+    /*
+     * C+A*B with the pre-adder, A/B register selects and carry sources all
+     * varied: every (INMODE, CARRYINSEL) pair is its own group, and the
+     * whole trace replays bit-exactly.
+     */
+    static const int8_t inmodes[] = {0x00, 0x01, 0x02, 0x04, 0x0C, 0x11, 0x15};
+    static const int8_t carryinsels[] = {0, 2, 5, 7};
+    enum { MIXED_COUNT = 4000, MIXED_CONTROLS = 7 * 4 };
+    uint32_t used = 0;
+    if (status != 0 || dsp48e1_trace_writer_open(&writer, path) != 0) {
+        unlink(path);
+        return -1;
+    }
+    for (uint64_t i = 0; i < MIXED_COUNT && status == 0; ++i) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        const unsigned inmode = (unsigned)((seed >> 56) % 7);
+        const unsigned carryinsel = (unsigned)((seed >> 48) % 4);
+        dsp48e1_trace_op_t op;
+        trace_test_operands(seed, &op);
+        op.opmode = 0x35;
+        op.alumode = 0x0;
+        op.inmode = inmodes[inmode];
+        op.carryinsel = carryinsels[carryinsel];
+        op.p = dsp48e1(op.a1, op.a2, op.b1, op.b2, op.c, op.d, op.opmode, op.alumode,
+                       op.inmode, op.carryinsel, op.carryin, op.carrycascin);
+        used |= (uint32_t)1 << (inmode * 4 + carryinsel);
+        status = dsp48e1_trace_write(&writer, &op);
+    }
+    if (dsp48e1_trace_writer_close(&writer) != 0) {
+        status = -1;
+    }
+    if (status == 0 &&
+        (used != ((uint32_t)1 << MIXED_CONTROLS) - 1 ||
+         dsp48e1_trace_replay(path, NULL, NULL, &stats) != 0 ||
+         stats.ops != MIXED_COUNT || stats.mismatches != 0 || stats.batches != MIXED_CONTROLS)) {
+        status = -1;
+    }
+
+    /* A file that is not a trace is rejected. */
+    FILE *file = fopen(path, "wb");
+    if (!file || fwrite("not a trace file", 1, 16, file) != 16) {
+        status = -1;
+    }
+    if (file && fclose(file) != 0) {
+        status = -1;
+    }
+    if (status == 0 && dsp48e1_trace_replay(path, NULL, NULL, &stats) == 0) {
+        status = -1;
+    }
+
+    unlink(path);
+    return status;
+}
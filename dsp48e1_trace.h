@@ -0,0 +1,119 @@
+#ifndef DSP48E1_TRACE_H
+#define DSP48E1_TRACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "dsp48e1.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file dsp48e1_trace.h
+ *
+ * Binary traces of recorded slice operations and a replay engine that
+ * cross-checks them against dsp48e1().
+ *
+ * A trace is a 16-byte header ("D48E1TRC", uint32 version, uint32 record
+ * size) followed by fixed 36-byte little-endian records:
+ *
+ *   offset  size  field
+ *        0     4  A1 (30-bit, sign-extended)
+ *        4     4  A2
+ *        8     4  B1 (18-bit, sign-extended)
+ *       12     4  B2
+ *       16     4  D  (25-bit, sign-extended)
+ *       20     6  C  (48-bit two's complement)
+ *       26     6  P  (48-bit, as recorded by the RTL simulation)
+ *       32     1  OPMODE
+ *       33     1  ALUMODE
+ *       34     1  INMODE
+ *       35     1  bits 0-2 CARRYINSEL, bit 3 CARRYIN, bit 4 CARRYCASCIN
+ */
+
+#define DSP48E1_TRACE_VERSION 1
+#define DSP48E1_TRACE_RECORD_SIZE 36
+
+typedef struct {
+    int32_t a1;
+    int32_t a2;
+    int32_t b1;
+    int32_t b2;
+    int32_t d;
+    int64_t c;
+    int64_t p; /* Recorded P, sign-extended from 48 bits. */
+    int8_t opmode;
+    int8_t alumode;
+    int8_t inmode;
+    int8_t carryinsel;
+    bool carryin;
+    bool carrycascin;
+} dsp48e1_trace_op_t;
+
+typedef struct {
+    FILE *file;
+    unsigned char *buffer;
+    size_t used;
+    size_t capacity;
+} dsp48e1_trace_writer_t;
+
+typedef struct {
+    uint64_t ops;
+    uint64_t mismatches;
+    uint64_t bytes;
+    uint64_t batches;  /* Kernel dispatches, one per control word per chunk. */
+    double seconds;    /* Wall time of the whole replay, including I/O. */
+} dsp48e1_replay_stats_t;
+
+/* Called for each mismatch with the record index and the computed P. */
+typedef void (*dsp48e1_replay_mismatch_fn)(void *user,
+                                           uint64_t index,
+                                           const dsp48e1_trace_op_t *op,
+                                           int64_t computed_p);
+
+/**
+ * Create a trace file and write its header.  Records are buffered and
+ * written in large blocks.  Returns 0 on success.
+ */
+int dsp48e1_trace_writer_open(dsp48e1_trace_writer_t *writer, const char *path);
+
+/** Append one record.  Returns 0 on success. */
+int dsp48e1_trace_write(dsp48e1_trace_writer_t *writer, const dsp48e1_trace_op_t *op);
+
+/** Flush buffered records and close the file.  Returns 0 on success. */
+int dsp48e1_trace_writer_close(dsp48e1_trace_writer_t *writer);
+
+/**
+ * Replay every record of the trace at path through dsp48e1().
+ *
+ * The file is read in large sequential chunks.  Within a chunk, records are
+ * grouped by control word (OPMODE, ALUMODE, INMODE, CARRYINSEL) and each
+ * group is evaluated by one dsp48e1_batch() call.  on_mismatch (may be
+ * NULL) sees every record whose computed P differs from the recorded one,
+ * in file order within each group.
+ *
+ * Returns 0 when the trace was read completely (mismatches are reported in
+ * stats, not as an error), -1 on I/O error or a malformed file.
+ */
+int dsp48e1_trace_replay(const char *path,
+                         dsp48e1_replay_mismatch_fn on_mismatch,
+                         void *user,
+                         dsp48e1_replay_stats_t *stats);
+
+/**
+ * Write a trace spanning more than one read chunk with a known set of
+ * corrupted P values to $TMPDIR (default /tmp), and check that replay finds
+ * exactly those records.  A second trace varying INMODE and CARRYINSEL must
+ * replay bit-exactly with one batch per control word.  Returns 0 on success.
+ */
+int dsp48e1_trace_self_test(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DSP48E1_TRACE_H */
@@ -2,8 +2,7 @@
 #include <stdint.h>
 #include <string.h>
 
-
-uint32_t dsp48e1_combined(uint32_t a, uint32_t b);
+#include "dsp48e1_combined.h"
 
 
 static inline uint32_t f2u(float x) {
@@ -1 +1,28 @@
-gcc dsp48e1.c -o dsp48e1.exe
\ No newline at end of file
+#!/bin/sh
+# Build the self-test driver.  CC, CXX, CFLAGS and CXXFLAGS may be overridden.
+set -e
+
+CC=${CC:-gcc}
+CXX=${CXX:-g++}
+CFLAGS=${CFLAGS:-"-O2 -std=c11 -Wall -Wextra"}
+CXXFLAGS=${CXXFLAGS:-"-O2 -std=c++17 -Wall -Wextra"}
+
+# Library translation units; the model depends on the epilogue stages.
+SOURCES="dsp48e1.c dsp48e1_model.c dsp48e1_epilogue.c dsp48e1_stream.c dsp48e1_conv.c dsp48e1_batch.c dsp48e1_checkpoint.c dsp48e1_tensor_file.c dsp48e1_trace.c dsp48e1_estimate.c dsp48e1_format.c dsp48e1_dse.c dsp48e1_splitk.c dsp48e1_server.c dsp48e1_combined.c dsp48e1_bfp.c dsp48e1_memory.c dsp48e1_fault.c"
+
+$CXX $CXXFLAGS -c dsp48e1_shim.cpp -o dsp48e1_shim.o
+$CC $CFLAGS -DDSP48E1_NO_MAIN $SOURCES dsp48e1_test.c dsp48e1_shim.o -o dsp48e1_test.exe -lm -lpthread -lstdc++
+
+# Type-check the enabled probes against the compile-only <sys/sdt.h> stub.
+$CC $CFLAGS -Werror -fsyntax-only -DDSP48E1_PROBES -Isdt_stub dsp48e1.c dsp48e1_model.c dsp48e1_batch.c
+
+# Command-line tools.
+$CC $CFLAGS dsp48e1.c dsp48e1_trace.c dsp48e1_replay.c -o dsp48e1_replay.exe -lpthread
+$CC $CFLAGS -DDSP48E1_NO_MAIN dsp48e1.c dsp48e1_model.c dsp48e1_epilogue.c dsp48e1_conv.c dsp48e1_batch.c dsp48e1_server.c dsp48e1_serverd.c -o dsp48e1_serverd.exe -lm -lpthread
+$CC $CFLAGS dsp48e1.c dsp48e1_combined.c main.c -o dsp48e1_mul_demo.exe
+
+# Python extension, when the interpreter's headers are installed.
+PYTHON=${PYTHON:-python3}
+if "$PYTHON" -c 'import os, setuptools, sysconfig; raise SystemExit(not os.path.exists(os.path.join(sysconfig.get_paths()["include"], "Python.h")))' 2>/dev/null; then
+    "$PYTHON" setup.py -q build_ext --inplace
+fi
@@ -1,2 +1,4 @@
+#!/bin/sh
+set -e
 ./make.sh
-./run.sh
\ No newline at end of file
+./run.sh "$@"
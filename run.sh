@@ -1 +1,9 @@
-./dsp48e1.exe
\ No newline at end of file
+#!/bin/sh
+# Run every module self-test; pass module names to run a subset.
+set -e
+./dsp48e1_test.exe "$@"
+
+# The Python extension tests, when make.sh built the extension.
+if [ $# -eq 0 ] && ls dsp48e1.*.so >/dev/null 2>&1; then
+    ${PYTHON:-python3} test_dsp48e1_python.py
+fi
@@ -0,0 +1,25 @@
+#ifndef SDT_STUB_SYS_SDT_H
+#define SDT_STUB_SYS_SDT_H
+
+/**
+ * @file sdt_stub/sys/sdt.h
+ *
+ * Compile-only stand-in for systemtap's <sys/sdt.h>, used by make.sh to
+ * type-check the enabled DSP48E1_PROBE* path on hosts without the real
+ * header.  Provider and probe names must be plain identifiers and each
+ * argument a scalar, as the real asm operands require; nothing is emitted.
+ */
+
+#define SDT_STUB_ARG(a) ((void)((a) + 0))
+#define SDT_STUB_NAME(provider, name) ((void)sizeof(#provider "__" #name))
+
+#define DTRACE_PROBE1(provider, name, a1) \
+    do { SDT_STUB_NAME(provider, name); SDT_STUB_ARG(a1); } while (0)
+#define DTRACE_PROBE2(provider, name, a1, a2) \
+    do { SDT_STUB_NAME(provider, name); SDT_STUB_ARG(a1); SDT_STUB_ARG(a2); } while (0)
+#define DTRACE_PROBE3(provider, name, a1, a2, a3) \
+    do { SDT_STUB_NAME(provider, name); SDT_STUB_ARG(a1); SDT_STUB_ARG(a2); SDT_STUB_ARG(a3); } while (0)
+#define DTRACE_PROBE4(provider, name, a1, a2, a3, a4) \
+    do { SDT_STUB_NAME(provider, name); SDT_STUB_ARG(a1); SDT_STUB_ARG(a2); SDT_STUB_ARG(a3); SDT_STUB_ARG(a4); } while (0)
+
+#endif /* SDT_STUB_SYS_SDT_H */
@@ -0,0 +1,28 @@
+# Build the dsp48e1 Python extension in place:
+#
+#   python setup.py build_ext --inplace
+#   python test_dsp48e1_python.py
+#
+# Only the standard library is needed; NumPy arrays work through the buffer
+# protocol when available.
+from setuptools import Extension, setup
+
+extension = Extension(
+    "dsp48e1",
+    sources=[
+        "dsp48e1_python.c",
+        "dsp48e1.c",
+        "dsp48e1_combined.c",
+        "dsp48e1_model.c",
+        "dsp48e1_epilogue.c",
+    ],
+    define_macros=[("DSP48E1_NO_MAIN", "1")],
+    extra_compile_args=["-O2"],
+)
+
+setup(
+    name="dsp48e1",
+    version="0.1.0",
+    description="Bit-level DSP48E1 slice emulation and FP32 tensor-unit model",
+    ext_modules=[extension],
+)
@@ -0,0 +1,158 @@
+"""Tests of the dsp48e1 Python extension; run after
+``python setup.py build_ext --inplace``.
+
+Only the standard library is used: array.array and memoryview provide the
+buffers.  Covers the buffer checks (format, contiguity, length), in-place
+writes, the busy guard of a Model shared between threads and the release of
+the GIL while simulating.
+"""
+
+import threading
+import unittest
+from array import array
+
+import dsp48e1
+
+
+def gemm_reference(lhs, rhs, bias, rows, cols, depth):
+    out = []
+    for row in range(rows):
+        for col in range(cols):
+            total = bias[col]
+            for k in range(depth):
+                total += lhs[row * depth + k] * rhs[k * cols + col]
+            out.append(total)
+    return out
+
+
+class BufferTest(unittest.TestCase):
+    def setUp(self):
+        self.model = dsp48e1.Model(2, 3, 4, rounding=False)
+        self.lhs = array("f", [1, 2, 3, 4, -1, -2, -3, -4])
+        self.rhs = array("f", range(12))
+        self.bias = array("f", [0.5, -0.5, 1.0])
+
+    def test_gemm_writes_in_place(self):
+        out = array("f", [0.0] * 6)
+        cycles = self.model.gemm(self.lhs, self.rhs, out, self.bias)
+        self.assertEqual(cycles, 4 + self.model.latency)
+        self.assertEqual(list(out), gemm_reference(self.lhs, self.rhs, self.bias, 2, 3, 4))
+
+    def test_memoryview_out(self):
+        storage = bytearray(6 * 4)
+        out = memoryview(storage).cast("f")
+        self.model.gemm(self.lhs, self.rhs, out)
+        self.assertEqual(out.tolist(), gemm_reference(self.lhs, self.rhs, [0, 0, 0], 2, 3, 4))
+
+    def test_wrong_format(self):
+        with self.assertRaises(TypeError):
+            self.model.gemm(array("d", self.lhs), self.rhs, array("f", [0.0] * 6))
+        with self.assertRaises(TypeError):
+            self.model.gemm(self.lhs, self.rhs, array("i", [0] * 6))
+
+    def test_not_contiguous(self):
+        strided = memoryview(array("f", [0.0] * 12))[::2]
+        with self.assertRaises(BufferError):
+            self.model.gemm(self.lhs, self.rhs, strided)
+
+    def test_too_short(self):
+        with self.assertRaises(ValueError):
+            self.model.gemm(self.lhs, self.rhs, array("f", [0.0] * 5))
+        with self.assertRaises(ValueError):
+            self.model.gemm(self.lhs, self.rhs, array("f", [0.0] * 6), array("f", [0.0] * 2))
+
+    def test_read_only_out(self):
+        with self.assertRaises(BufferError):
+            self.model.gemm(self.lhs, self.rhs, bytes(6 * 4))
+
+    def test_failed_call_releases_model(self):
+        with self.assertRaises(ValueError):
+            self.model.gemm(self.lhs, self.rhs, array("f", [0.0] * 5))
+        self.model.gemm(self.lhs, self.rhs, array("f", [0.0] * 6))
+
+    def test_slice_batch(self):
+        n = 5
+        a = array("i", [3, -7, 100, 0, 1 << 20])
+        b = array("i", [5, 9, -2, 8, 3])
+        zeros = array("i", [0] * n)
+        c = array("q", [1, 2, 3, 4, 5])
+        out = array("q", [0] * n)
+        carryin = memoryview(bytearray([1, 0, 1, 0, 1])).cast("?")
+        # OPMODE C + A*B, ALUMODE add, CARRYINSEL CARRYIN.
+        dsp48e1.slice_batch(a, a, b, b, c, zeros, out, 0x35, 0, 0, 0, carryin)
+        for i in range(n):
+            expected = dsp48e1.slice(a[i], a[i], b[i], b[i], c[i], 0, 0x35, 0, 0, 0, bool(carryin[i]))
+            self.assertEqual(out[i], expected)
+        self.assertEqual(out[0], 3 * 5 + 1 + 1)
+
+    def test_slice_batch_rejects_byte_carries(self):
+        n = 2
+        ints = array("i", [0] * n)
+        longs = array("q", [0] * n)
+        with self.assertRaises(TypeError):
+            dsp48e1.slice_batch(ints, ints, ints, ints, longs, ints, array("q", [0] * n),
+                                0x35, 0, 0, 0, bytearray(n))
+
+    def test_fp32_mul(self):
+        a = array("f", [1.5, -2.0, 0.0])
+        b = array("f", [2.0, 3.25, -1.0])
+        out = array("f", [9.0] * 3)
+        dsp48e1.fp32_mul(a, b, out)
+        self.assertEqual(list(out), [3.0, -6.5, -0.0])
+
+
+class ThreadTest(unittest.TestCase):
+    ROWS, COLS, DEPTH = 64, 64, 2048
+
+    def long_gemm(self, model, out, started, errors):
+        lhs = array("f", [1.0]) * (self.ROWS * self.DEPTH)
+        rhs = array("f", [1.0]) * (self.DEPTH * self.COLS)
+        started.set()
+        try:
+            model.gemm(lhs, rhs, out)
+        except Exception as error:
+            errors.append(error)
+
+    def test_busy_guard_and_gil_release(self):
+        model = dsp48e1.Model(self.ROWS, self.COLS, self.DEPTH, rounding=False)
+        out = array("f", [0.0]) * (self.ROWS * self.COLS)
+        started = threading.Event()
+        errors = []
+        worker = threading.Thread(target=self.long_gemm, args=(model, out, started, errors))
+        worker.start()
+        started.wait()
+        # reset() holds the GIL throughout, so it can only see the model busy
+        # when gemm() is running with the GIL released.
+        saw_busy = False
+        while worker.is_alive() and not saw_busy:
+            try:
+                model.reset()
+            except RuntimeError:
+                saw_busy = True
+        worker.join()
+        self.assertEqual(errors, [])
+        self.assertTrue(saw_busy)
+        self.assertEqual(set(out), {float(self.DEPTH)})
+        model.reset()
+
+    def test_separate_models_run_concurrently(self):
+        models = [dsp48e1.Model(self.ROWS, self.COLS, self.DEPTH // 4, rounding=False) for _ in range(2)]
+        outs = [array("f", [0.0]) * (self.ROWS * self.COLS) for _ in range(2)]
+        lhs = array("f", [2.0]) * (self.ROWS * (self.DEPTH // 4))
+        rhs = array("f", [0.5]) * ((self.DEPTH // 4) * self.COLS)
+        threads = [threading.Thread(target=m.gemm, args=(lhs, rhs, o)) for m, o in zip(models, outs)]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        for out in outs:
+            self.assertEqual(set(out), {float(self.DEPTH // 4)})
+
+
+class SelfTest(unittest.TestCase):
+    def test_self_test(self):
+        self.assertEqual(dsp48e1.self_test(), (True, True))
+
+
+if __name__ == "__main__":
+    unittest.main()